@@ -0,0 +1,257 @@
+// 请求分发内存分配基准：模拟服务端处理一次请求——解析请求消息、业务填充带 repeated 嵌套消息的响应、
+// 响应序列化进发送缓冲区，对比两种分配方式每次调用的耗时与堆分配次数：
+//   heap  : 原 callServiceMethod 的做法——GetRequestPrototype(...).New() / GetResponsePrototype(...).New()，
+//           每个嵌套消息、每个字段单独向堆申请，调用结束逐个释放
+//   arena : 线程内可复用的 google::protobuf::Arena（常驻首块），请求/响应消息都从 arena 分配，发送后整体 Reset
+// 异步服务方法（done 在别的线程运行）时，调用上下文在工作线程取、在 done 线程还：
+//   async-slot : 原先每线程只缓存一个上下文，工作线程的缓存总是空的，每次调用新建上下文（含 64KB 首块）
+//   async-pool : ObjectPool，上下文经全局空闲链表流回工作线程，稳定状态下不再分配
+// 消息用 test/protobuf/test.proto 的 GetFriendListRequest / GetFriendListResponse（repeated User）
+//
+// 用法：arena_dispatch_bench [iterations_scale]
+#include "../include/buffer.h"
+#include "../include/object_pool.h"
+#include "../include/rpc_protocol_helper.h"
+#include "../include/transport.h"
+#include "../test/protobuf/test.pb.h"
+#include <google/protobuf/arena.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0}; // 全局 operator new 调用次数（所有线程）
+
+} // namespace
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+using namespace rpc;
+
+namespace {
+
+const size_t kArenaBlockSize = 64 * 1024; // 与 RpcServer 线程 arena 的首块大小一致
+
+// 业务逻辑：按请求填充好友列表
+void fillResponse(const fixbug::GetFriendListRequest& request, size_t friends, fixbug::GetFriendListResponse& response) {
+    response.mutable_code()->set_errcode(0);
+    response.mutable_code()->set_errmsg("ok");
+    char name[32];
+    for (size_t i = 0; i < friends; ++i) {
+        fixbug::User* user = response.add_user_list();
+        std::snprintf(name, sizeof(name), "friend_%05zu", i);
+        user->set_name(name);
+        user->set_age(static_cast<int32_t>(request.userid() + i) % 100);
+        user->set_gender(i % 2 ? fixbug::User::WOMAN : fixbug::User::MAN);
+    }
+}
+
+// 响应序列化进发送缓冲区
+size_t sendResponse(const google::protobuf::Message& message, Buffer& out) {
+    RpcResponse response;
+    response.request_id = 1;
+    response.success = true;
+    out.retrieveAll();
+    RpcProtocolHelper::serializeResponse(response, &message, out);
+    return out.readableBytes();
+}
+
+// 原实现：消息从堆上分配
+size_t dispatchHeap(const std::string& request_data, size_t friends, Buffer& out) {
+    const google::protobuf::Message& request_prototype = fixbug::GetFriendListRequest::default_instance();
+    const google::protobuf::Message& response_prototype = fixbug::GetFriendListResponse::default_instance();
+    std::unique_ptr<google::protobuf::Message> request(request_prototype.New());
+    request->ParseFromString(request_data);
+    std::unique_ptr<google::protobuf::Message> response(response_prototype.New());
+    fillResponse(static_cast<const fixbug::GetFriendListRequest&>(*request), friends,
+                 static_cast<fixbug::GetFriendListResponse&>(*response));
+    return sendResponse(*response, out);
+}
+
+// 线程 arena：发送后 Reset，首块常驻
+size_t dispatchArena(const std::string& request_data, size_t friends, Buffer& out) {
+    static std::vector<char> initial_block(kArenaBlockSize);
+    static google::protobuf::Arena arena([]() {
+        google::protobuf::ArenaOptions options;
+        options.initial_block = initial_block.data();
+        options.initial_block_size = initial_block.size();
+        return options;
+    }());
+    const google::protobuf::Message& request_prototype = fixbug::GetFriendListRequest::default_instance();
+    const google::protobuf::Message& response_prototype = fixbug::GetFriendListResponse::default_instance();
+    google::protobuf::Message* request = request_prototype.New(&arena);
+    request->ParseFromString(request_data);
+    google::protobuf::Message* response = response_prototype.New(&arena);
+    fillResponse(static_cast<const fixbug::GetFriendListRequest&>(*request), friends,
+                 static_cast<fixbug::GetFriendListResponse&>(*response));
+    size_t bytes = sendResponse(*response, out);
+    arena.Reset();
+    return bytes;
+}
+
+void runCase(const std::string& name, size_t friends, uint64_t iterations,
+             size_t (*dispatch)(const std::string&, size_t, Buffer&)) {
+    fixbug::GetFriendListRequest request;
+    request.set_userid(7);
+    std::string request_data = request.SerializeAsString();
+    Buffer out;
+    size_t frame_bytes = dispatch(request_data, friends, out); // 预热：缓冲区、arena 首块
+
+    uint64_t allocations_before = g_allocations;
+    auto begin = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        frame_bytes = dispatch(request_data, friends, out);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    uint64_t allocations = g_allocations - allocations_before;
+
+    std::cout << name << " friends=" << friends
+              << " ns_per_call=" << static_cast<uint64_t>(seconds * 1e9 / iterations)
+              << " allocs_per_call=" << static_cast<double>(allocations) / iterations
+              << " response_bytes=" << frame_bytes
+              << std::endl;
+}
+
+// 一次调用的上下文：与 RpcServer::CallContext 一样带不清零的常驻首块
+struct AsyncContext {
+    std::unique_ptr<char[]> initial_block;
+    google::protobuf::Arena arena;
+    google::protobuf::Message* response = nullptr;
+
+    AsyncContext()
+        :initial_block(new char[kArenaBlockSize]),
+         arena([this]() {
+             google::protobuf::ArenaOptions options;
+             options.initial_block = initial_block.get();
+             options.initial_block_size = kArenaBlockSize;
+             return options;
+         }()) {}
+};
+
+// 原实现：每线程缓存一个上下文，取和还在不同线程时工作线程的缓存总是空的
+struct ThreadSlotCache {
+    static std::unique_ptr<AsyncContext>& slot() {
+        thread_local std::unique_ptr<AsyncContext> cached;
+        return cached;
+    }
+    static std::unique_ptr<AsyncContext> acquire() {
+        std::unique_ptr<AsyncContext>& cached = slot();
+        return cached ? std::move(cached) : std::make_unique<AsyncContext>();
+    }
+    static void release(std::unique_ptr<AsyncContext> context) {
+        std::unique_ptr<AsyncContext>& cached = slot();
+        if (!cached) {
+            cached = std::move(context);
+        }
+    }
+};
+
+// 工作线程解析请求、填充响应后把上下文交给 done 线程；done 线程序列化响应后归还
+template <typename Cache>
+void runAsyncCase(const std::string& name, size_t friends, uint64_t iterations) {
+    fixbug::GetFriendListRequest request;
+    request.set_userid(7);
+    std::string request_data = request.SerializeAsString();
+    std::atomic<AsyncContext*> handoff{nullptr};
+    std::atomic<bool> stop{false};
+    size_t frame_bytes = 0;
+
+    std::thread done_thread([&]() {
+        Buffer out;
+        while (true) {
+            AsyncContext* context = handoff.load(std::memory_order_acquire);
+            if (!context) {
+                if (stop.load(std::memory_order_acquire)) {
+                    return;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+            frame_bytes = sendResponse(*context->response, out);
+            context->response = nullptr;
+            handoff.store(nullptr, std::memory_order_release);
+            Cache::release(std::unique_ptr<AsyncContext>(context));
+        }
+    });
+
+    auto dispatch = [&]() {
+        std::unique_ptr<AsyncContext> context = Cache::acquire();
+        context->arena.Reset(); // 与 RpcServer 一样在分配的线程上 Reset，首块归这个线程用
+        google::protobuf::Message* message = fixbug::GetFriendListRequest::default_instance().New(&context->arena);
+        message->ParseFromString(request_data);
+        context->response = fixbug::GetFriendListResponse::default_instance().New(&context->arena);
+        fillResponse(static_cast<const fixbug::GetFriendListRequest&>(*message), friends,
+                     static_cast<fixbug::GetFriendListResponse&>(*context->response));
+        while (handoff.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        handoff.store(context.release(), std::memory_order_release);
+    };
+    auto drain = [&]() {
+        while (handoff.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    };
+
+    // 预热：缓冲区、线程缓存、池里的上下文
+    for (int i = 0; i < 64; ++i) {
+        dispatch();
+    }
+    drain();
+
+    uint64_t allocations_before = g_allocations;
+    auto begin = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        dispatch();
+    }
+    drain();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    uint64_t allocations = g_allocations - allocations_before;
+    stop = true;
+    done_thread.join();
+
+    std::cout << name << " friends=" << friends
+              << " ns_per_call=" << static_cast<uint64_t>(seconds * 1e9 / iterations)
+              << " allocs_per_call=" << static_cast<double>(allocations) / iterations
+              << " response_bytes=" << frame_bytes
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t scale = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1;
+    const size_t friend_counts[] = {0, 1, 8, 64, 512};
+    for (size_t friends : friend_counts) {
+        uint64_t iterations = std::max<uint64_t>(100, scale * 2000000 / (friends + 4));
+        runCase("heap ", friends, iterations, dispatchHeap);
+        runCase("arena", friends, iterations, dispatchArena);
+        runAsyncCase<ThreadSlotCache>("async-slot", friends, iterations);
+        runAsyncCase<ObjectPool<AsyncContext>>("async-pool", friends, iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+// 基准测试共用的小工具：延迟分位数、按时执行任务的定时线程
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+// 已排序样本的 p 分位数（p 取 0~1），没有样本时返回 0
+inline double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+// 到点执行任务的定时线程：模拟不占工作线程的慢下游
+class DelayQueue {
+public:
+    DelayQueue() : running_(true), thread_(&DelayQueue::run, this) {}
+
+    ~DelayQueue() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    DelayQueue(const DelayQueue&) = delete;
+    DelayQueue& operator=(const DelayQueue&) = delete;
+
+    // delay_ms 毫秒后在定时线程里执行 task
+    void schedule(int delay_ms, std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace(std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms), std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> tasks_;
+    bool running_;
+    std::thread thread_;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            if (tasks_.empty()) {
+                cv_.wait(lock);
+                continue;
+            }
+            auto first = tasks_.begin();
+            if (cv_.wait_until(lock, first->first) == std::cv_status::no_timeout) {
+                continue; // 新任务或退出，重新看队首
+            }
+            first = tasks_.begin();
+            if (first->first > std::chrono::steady_clock::now()) {
+                continue;
+            }
+            std::function<void()> task = std::move(first->second);
+            tasks_.erase(first);
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+};
+
+} // namespace bench
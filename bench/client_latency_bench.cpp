@@ -0,0 +1,189 @@
+// 客户端接收等待延迟基准：单个客户端一问一答，测小帧往返的 p50/p99 延迟，对比
+//   socket    : 阻塞 socket 直接收发（下限参考）
+//   tcp_client: TcpClientImpl::send + receive（非阻塞 socket，没有数据时等它可读）
+//   rpc_call  : RpcClientStubImpl::callMethod 到 RpcServer（多路复用连接 + 读线程）
+// TcpClientImpl 原先没有数据时 sleep 1ms 轮询，每次往返平均多出约半毫秒到一毫秒
+//
+// 用法：client_latency_bench [requests] [payload_bytes]
+#include "../include/tcp_server.h"
+#include "../include/tcp_connection.h"
+#include "../include/tcp_client.h"
+#include "../include/frame_codec.h"
+#include "../include/rpc_serser.h"
+#include "../include/rpc_client.h"
+#include "../proto/calculator.pb.h"
+#include "bench_util.h"
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace rpc;
+
+namespace {
+
+using bench::percentile;
+
+const uint16_t kEchoPort = 9340;
+const uint16_t kRpcPort = 9341;
+
+// 阻塞 socket 客户端：发送整帧，收回一帧
+class SocketEchoClient {
+public:
+    SocketEchoClient() : fd_(-1) {}
+    ~SocketEchoClient() {
+        if (fd_ != -1) {
+            close(fd_);
+        }
+    }
+
+    bool connect(const std::string& host, uint16_t port) {
+        SocketAddress address;
+        if (!address.parse(host, port)) {
+            return false;
+        }
+        fd_ = socket(address.getFamily(), SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0 || ::connect(fd_, address.getSockAddr(), address.getLength()) < 0) {
+            return false;
+        }
+        int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return true;
+    }
+
+    bool roundTrip(const std::vector<uint8_t>& frame, std::vector<uint8_t>& reply) {
+        reply.resize(frame.size());
+        return transfer(frame.data(), frame.size(), true) && transfer(reply.data(), reply.size(), false);
+    }
+
+private:
+    int fd_;
+
+    bool transfer(const uint8_t* data, size_t len, bool sending) {
+        while (len > 0) {
+            ssize_t n = sending ? ::send(fd_, data, len, MSG_NOSIGNAL) : ::recv(fd_, const_cast<uint8_t*>(data), len, 0);
+            if (n <= 0) {
+                return false;
+            }
+            data += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+};
+
+// 立即返回 a + b
+class EchoCalculator : public CalculatorService {
+public:
+    void Add(google::protobuf::RpcController*, const AddRequest* request, AddResponse* response,
+             google::protobuf::Closure* done) override {
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+// 跑 requests 次 round_trip，报告延迟分布（微秒）
+void measure(const std::string& name, int requests, const std::function<bool()>& round_trip) {
+    std::vector<double> latencies;
+    latencies.reserve(requests);
+    int failures = 0;
+    for (int i = 0; i < requests; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        if (!round_trip()) {
+            failures++;
+            continue;
+        }
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0.0;
+    for (double latency : latencies) {
+        total += latency;
+    }
+    std::cout << name << ": calls=" << latencies.size()
+              << " failures=" << failures
+              << " mean=" << (latencies.empty() ? 0.0 : total / latencies.size()) << "us"
+              << " p50=" << percentile(latencies, 0.50) << "us"
+              << " p99=" << percentile(latencies, 0.99) << "us" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int requests = argc > 1 ? std::atoi(argv[1]) : 5000;
+    size_t payload_bytes = argc > 2 ? static_cast<size_t>(std::atoll(argv[2])) : 64;
+
+    std::cout << "requests=" << requests << " payload_bytes=" << payload_bytes << std::endl;
+
+    // 回显服务
+    TcpServerImpl echo_server;
+    FrameCodec server_codec;
+    echo_server.setConnectionCallback([&server_codec](std::shared_ptr<TcpConnection> conn) {
+        conn->setMessageCallback([&server_codec](std::shared_ptr<TcpConnection> c, const std::vector<uint8_t>& message) {
+            c->send(server_codec.encode(message));
+        });
+    });
+    if (!echo_server.start(kEchoPort, "127.0.0.1")) {
+        std::cerr << "echo server start failed" << std::endl;
+        return 1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    FrameCodec codec;
+    std::vector<uint8_t> payload(payload_bytes, 'x');
+    std::vector<uint8_t> frame = codec.encode(payload);
+
+    SocketEchoClient socket_client;
+    if (!socket_client.connect("127.0.0.1", kEchoPort)) {
+        std::cerr << "socket connect failed" << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> reply;
+    measure("socket    ", requests, [&]() { return socket_client.roundTrip(frame, reply); });
+
+    TcpClientImpl tcp_client;
+    if (!tcp_client.connect("127.0.0.1", kEchoPort)) {
+        std::cerr << "tcp client connect failed" << std::endl;
+        return 1;
+    }
+    measure("tcp_client", requests, [&]() {
+        const uint8_t* data = nullptr;
+        size_t length = 0;
+        return tcp_client.send(frame) && tcp_client.receive(data, length) && length == payload_bytes;
+    });
+    tcp_client.disconnect();
+    echo_server.stop();
+
+    // 完整 RPC 调用
+    EchoCalculator service;
+    RpcServerConfig config;
+    config.host = "127.0.0.1";
+    config.port = kRpcPort;
+    config.enable_registry = false;
+    RpcServer server(config);
+    server.registerService(&service);
+    if (!server.start()) {
+        std::cerr << "rpc server start failed" << std::endl;
+        return 1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    RpcClientStubImpl stub("CalculatorService", "127.0.0.1", kRpcPort);
+    AddRequest request;
+    request.set_a(1);
+    request.set_b(2);
+    AddResponse response;
+    stub.callMethod("Add", request, response); // 建连 + 方法目录握手
+    measure("rpc_call  ", requests, [&]() { return stub.callMethod("Add", request, response) && response.result() == 3; });
+    stub.disconnect();
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,209 @@
+// 协程服务方法基准：前端服务的 Add 把请求转发给下游服务（下游 delay_ms 毫秒后返回），
+// 前端只有 1 个工作线程，客户端同时发出 concurrency 个请求，对比两种前端写法完成一轮的耗时：
+//   blocking : 服务方法里同步 callMethod 下游，等待期间占着工作线程——一轮约 concurrency * delay_ms
+//   coroutine: 服务方法是协程，co_await 下游调用时让出工作线程，在连接的 I/O 线程里恢复——一轮约 delay_ms
+// 客户端本身也用协程：每个请求一个 spawn 出来的协程 co_await awaitCall
+//
+// 需要 C++20：cmake -DBUILD_BENCHMARKS=ON -DENABLE_COROUTINES=ON
+// 用法：coroutine_bench [concurrency] [delay_ms] [rounds]
+#include "../include/rpc_serser.h"
+#include "../include/rpc_client.h"
+#include "../include/rpc_coroutine.h"
+#include "../proto/calculator.pb.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace rpc;
+
+namespace {
+
+using bench::DelayQueue;
+using bench::percentile;
+
+const uint16_t kBackendPort = 9330;
+const uint16_t kFrontPort = 9331;
+
+// 下游：a 毫秒后返回 a + b，不占工作线程
+class BackendCalculator : public CalculatorService {
+public:
+    explicit BackendCalculator(DelayQueue& queue) : queue_(queue) {}
+
+    void Add(google::protobuf::RpcController*, const AddRequest* request, AddResponse* response,
+             google::protobuf::Closure* done) override {
+        int32_t a = request->a();
+        int32_t b = request->b();
+        queue_.schedule(a, [response, done, a, b]() {
+            response->set_result(a + b);
+            done->Run();
+        });
+    }
+
+private:
+    DelayQueue& queue_;
+};
+
+// 前端：同步转发，等待下游期间占着工作线程
+class BlockingFront : public CalculatorService {
+public:
+    explicit BlockingFront(RpcClientStub& backend) : backend_(backend) {}
+
+    void Add(google::protobuf::RpcController* controller, const AddRequest* request, AddResponse* response,
+             google::protobuf::Closure* done) override {
+        if (!backend_.callMethod("Add", *request, *response)) {
+            controller->SetFailed("backend call failed");
+        }
+        done->Run();
+    }
+
+private:
+    RpcClientStub& backend_;
+};
+
+// 前端：协程转发，co_await 下游时让出工作线程
+class CoroutineFront : public CalculatorService {
+public:
+    explicit CoroutineFront(RpcClientStub& backend) : backend_(backend) {}
+
+    void Add(google::protobuf::RpcController* controller, const AddRequest* request, AddResponse* response,
+             google::protobuf::Closure* done) override {
+        runCoroutine(controller, done, forward(controller, request, response));
+    }
+
+private:
+    RpcClientStub& backend_;
+
+    Task<void> forward(google::protobuf::RpcController* controller, const AddRequest* request, AddResponse* response) {
+        bool ok = co_await awaitCall(backend_, "Add", *request, response);
+        if (!ok) {
+            controller->SetFailed("backend call failed");
+        }
+    }
+};
+
+// 等 count 个协程结束
+class Latch {
+public:
+    explicit Latch(size_t count) : count_(count) {}
+
+    void countDown() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--count_ == 0) {
+            cv_.notify_all();
+        }
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return count_ == 0; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t count_;
+};
+
+Task<void> clientCall(RpcClientStub& stub, int delay_ms, int index, std::atomic<int>& matched, Latch& latch) {
+    AddRequest request;
+    request.set_a(delay_ms);
+    request.set_b(index);
+    AddResponse response;
+    bool ok = co_await awaitCall(stub, "Add", request, &response);
+    if (ok && response.result() == delay_ms + index) {
+        matched++;
+    }
+    latch.countDown();
+}
+
+void runCase(const std::string& name, CalculatorService& front, int concurrency, int delay_ms, int rounds) {
+    RpcServerConfig config;
+    config.host = "127.0.0.1";
+    config.port = kFrontPort;
+    config.thread_pool_size = 1;
+    config.enable_registry = false;
+    RpcServer server(config);
+    server.registerService(&front);
+    if (!server.start()) {
+        std::cerr << "Failed to start front server" << std::endl;
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    RpcClientStubImpl stub("CalculatorService", "127.0.0.1", kFrontPort);
+    AddRequest warmup_request;
+    AddResponse warmup_response;
+    stub.callMethod("Add", warmup_request, warmup_response); // 建连 + 方法目录握手
+
+    std::vector<double> round_ms;
+    bool all_ok = true;
+    for (int r = 0; r < rounds; ++r) {
+        std::atomic<int> matched{0};
+        Latch latch(concurrency);
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < concurrency; ++i) {
+            spawn(clientCall(stub, delay_ms, i, matched, latch));
+        }
+        latch.wait();
+        round_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+        all_ok = all_ok && matched.load() == concurrency;
+    }
+    std::sort(round_ms.begin(), round_ms.end());
+
+    std::cout << name << " workers=" << config.thread_pool_size
+              << " concurrency=" << concurrency
+              << " delay_ms=" << delay_ms
+              << " p50_round_ms=" << percentile(round_ms, 0.50)
+              << " max_round_ms=" << round_ms.back()
+              << " results=" << (all_ok ? "ok" : "MISMATCH")
+              << std::endl;
+
+    stub.disconnect();
+    server.stop();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int concurrency = argc > 1 ? std::atoi(argv[1]) : 64;
+    int delay_ms = argc > 2 ? std::atoi(argv[2]) : 10;
+    int rounds = argc > 3 ? std::atoi(argv[3]) : 5;
+
+    DelayQueue queue;
+    BackendCalculator backend_service(queue);
+    RpcServerConfig config;
+    config.host = "127.0.0.1";
+    config.port = kBackendPort;
+    config.thread_pool_size = 1;
+    config.enable_registry = false;
+    RpcServer backend(config);
+    backend.registerService(&backend_service);
+    if (!backend.start()) {
+        std::cerr << "Failed to start backend server" << std::endl;
+        return 1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    RpcClientStubImpl backend_stub("CalculatorService", "127.0.0.1", kBackendPort);
+    AddRequest warmup_request;
+    AddResponse warmup_response;
+    backend_stub.callMethod("Add", warmup_request, warmup_response);
+
+    BlockingFront blocking(backend_stub);
+    CoroutineFront coroutine(backend_stub);
+    runCase("blocking ", blocking, concurrency, delay_ms, std::min(rounds, 2));
+    runCase("coroutine", coroutine, concurrency, delay_ms, rounds);
+
+    backend_stub.disconnect();
+    backend.stop();
+    return 0;
+}
@@ -0,0 +1,163 @@
+// 扇出调用基准：一次要向同一个服务发 width 个请求，第 i 个请求在服务端耗时 delay_i 毫秒（1 ~ max_delay_ms 均匀分布），
+// 对比三种客户端写法完成一轮的耗时：
+//   serial  : 逐个 callMethod，一个返回再发下一个——耗时约为各请求耗时之和
+//   future  : 逐个 asyncCallMethod 拿到 future，全部发出后再依次 get
+//   callMany: 一次交给 callMany 扇出
+// 后两种所有请求同时在一条多路复用连接上在途，耗时应接近最慢的那一个。
+// 服务方法用异步 done：到点由定时线程填结果并 done->Run()，不占服务端工作线程
+//
+// 用法：fanout_bench [width] [max_delay_ms] [rounds]
+#include "../include/rpc_serser.h"
+#include "../include/rpc_client.h"
+#include "../proto/calculator.pb.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace rpc;
+
+namespace {
+
+using bench::DelayQueue;
+using bench::percentile;
+
+const uint16_t kPort = 9320;
+
+// Add 的耗时由请求决定：a 毫秒后返回 a + b
+class DelayedCalculator : public CalculatorService {
+public:
+    explicit DelayedCalculator(DelayQueue& queue) : queue_(queue) {}
+
+    void Add(google::protobuf::RpcController*, const AddRequest* request, AddResponse* response,
+             google::protobuf::Closure* done) override {
+        int32_t a = request->a();
+        int32_t b = request->b();
+        queue_.schedule(a, [response, done, a, b]() {
+            response->set_result(a + b);
+            done->Run();
+        });
+    }
+
+private:
+    DelayQueue& queue_;
+};
+
+struct Round {
+    std::vector<AddRequest> requests;
+    std::vector<AddResponse> responses;
+};
+
+Round makeRound(int width, int max_delay_ms) {
+    Round round;
+    round.requests.resize(width);
+    round.responses.resize(width);
+    for (int i = 0; i < width; ++i) {
+        round.requests[i].set_a(width > 1 ? 1 + i * (max_delay_ms - 1) / (width - 1) : max_delay_ms);
+        round.requests[i].set_b(i);
+    }
+    return round;
+}
+
+bool verify(const Round& round) {
+    for (size_t i = 0; i < round.requests.size(); ++i) {
+        if (round.responses[i].result() != round.requests[i].a() + round.requests[i].b()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool runSerial(RpcClientStubImpl& stub, Round& round) {
+    for (size_t i = 0; i < round.requests.size(); ++i) {
+        stub.callMethod("Add", round.requests[i], round.responses[i]);
+    }
+    return verify(round);
+}
+
+bool runFutures(RpcClientStubImpl& stub, Round& round) {
+    std::vector<std::future<bool>> futures;
+    for (size_t i = 0; i < round.requests.size(); ++i) {
+        futures.push_back(stub.asyncCallMethod("Add", round.requests[i], &round.responses[i]));
+    }
+    bool ok = true;
+    for (auto& future : futures) {
+        ok = future.get() && ok;
+    }
+    return ok && verify(round);
+}
+
+bool runCallMany(RpcClientStubImpl& stub, Round& round) {
+    std::vector<RpcCall> calls;
+    for (size_t i = 0; i < round.requests.size(); ++i) {
+        calls.emplace_back("Add", &round.requests[i], &round.responses[i]);
+    }
+    return stub.callMany(calls) == calls.size() && verify(round);
+}
+
+void runCase(const std::string& name, RpcClientStubImpl& stub, int width, int max_delay_ms, int rounds,
+             bool (*run)(RpcClientStubImpl&, Round&)) {
+    std::vector<double> round_ms;
+    bool all_ok = true;
+    for (int r = 0; r < rounds; ++r) {
+        Round round = makeRound(width, max_delay_ms);
+        auto begin = std::chrono::steady_clock::now();
+        all_ok = run(stub, round) && all_ok;
+        round_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+    }
+    std::sort(round_ms.begin(), round_ms.end());
+
+    Round shape = makeRound(width, max_delay_ms);
+    int sum_ms = 0;
+    for (const AddRequest& request : shape.requests) {
+        sum_ms += request.a();
+    }
+    std::cout << name << " width=" << width
+              << " sum_of_delays_ms=" << sum_ms
+              << " max_delay_ms=" << max_delay_ms
+              << " p50_round_ms=" << percentile(round_ms, 0.50)
+              << " max_round_ms=" << round_ms.back()
+              << " results=" << (all_ok ? "ok" : "MISMATCH")
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int width = argc > 1 ? std::atoi(argv[1]) : 20;
+    int max_delay_ms = argc > 2 ? std::atoi(argv[2]) : 20;
+    int rounds = argc > 3 ? std::atoi(argv[3]) : 10;
+
+    DelayQueue queue;
+    DelayedCalculator service(queue);
+    RpcServerConfig config;
+    config.host = "127.0.0.1";
+    config.port = kPort;
+    config.thread_pool_size = 2;
+    config.enable_registry = false;
+    RpcServer server(config);
+    server.registerService(&service);
+    if (!server.start()) {
+        std::cerr << "Failed to start server" << std::endl;
+        return 1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    RpcClientStubImpl stub("CalculatorService", "127.0.0.1", kPort);
+    AddRequest warmup_request;
+    AddResponse warmup_response;
+    stub.callMethod("Add", warmup_request, warmup_response); // 建连 + 方法目录握手
+
+    runCase("serial  ", stub, width, max_delay_ms, std::min(rounds, 3), runSerial);
+    runCase("future  ", stub, width, max_delay_ms, rounds, runFutures);
+    runCase("callMany", stub, width, max_delay_ms, rounds, runCallMany);
+
+    stub.disconnect();
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,97 @@
+// 切帧基准：一次收到一批流水线帧后逐帧解码，对比两种接收缓冲区的耗时：
+//   legacy : 原 FrameCodec::decode——std::vector 接收缓冲区，每取出一帧 erase 一次头部（批内 O(N²) 字节搬移）
+//   stream : FrameCodec::decode(Buffer&)——只前移读指针，帧体以视图返回
+//
+// 用法：frame_decode_bench [scale]
+#include "../include/buffer.h"
+#include "../include/frame_codec.h"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace rpc;
+
+namespace {
+
+// 原实现
+bool legacyDecode(std::vector<uint8_t>& buffer, std::vector<uint8_t>& message) {
+    if (buffer.size() < 4) {
+        return false;
+    }
+    uint32_t network_length;
+    std::memcpy(&network_length, buffer.data(), 4);
+    uint32_t message_length = ntohl(network_length);
+    size_t total_frame_size = 4 + message_length;
+    if (buffer.size() < total_frame_size) {
+        return false;
+    }
+    message.assign(buffer.begin() + 4, buffer.begin() + total_frame_size);
+    buffer.erase(buffer.begin(), buffer.begin() + total_frame_size);
+    return true;
+}
+
+std::vector<uint8_t> makeBatch(size_t payload, size_t frames) {
+    FrameCodec codec;
+    std::vector<uint8_t> frame = codec.encode(std::vector<uint8_t>(payload, 'p'));
+    std::vector<uint8_t> batch;
+    batch.reserve(frame.size() * frames);
+    for (size_t i = 0; i < frames; ++i) {
+        batch.insert(batch.end(), frame.begin(), frame.end());
+    }
+    return batch;
+}
+
+void runCase(size_t payload, size_t frames, uint64_t rounds) {
+    std::vector<uint8_t> batch = makeBatch(payload, frames);
+    FrameCodec codec;
+    std::vector<uint8_t> message;
+
+    uint64_t decoded = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (uint64_t r = 0; r < rounds; ++r) {
+        std::vector<uint8_t> buffer;
+        buffer.insert(buffer.end(), batch.begin(), batch.end());
+        while (legacyDecode(buffer, message)) {
+            ++decoded;
+        }
+    }
+    double legacy_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    begin = std::chrono::steady_clock::now();
+    for (uint64_t r = 0; r < rounds; ++r) {
+        Buffer buffer;
+        buffer.append(batch.data(), batch.size());
+        const uint8_t* body = nullptr;
+        size_t length = 0;
+        while (codec.decode(buffer, body, length) == FrameStatus::kComplete) {
+            ++decoded;
+        }
+    }
+    double stream_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    double total = static_cast<double>(rounds * frames);
+    std::cout << "payload=" << payload << " frames_per_batch=" << frames
+              << " legacy_ns_per_frame=" << static_cast<uint64_t>(legacy_s * 1e9 / total)
+              << " stream_ns_per_frame=" << static_cast<uint64_t>(stream_s * 1e9 / total)
+              << " decoded=" << decoded << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t scale = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1;
+    const size_t payloads[] = {64, 1024};
+    const size_t batches[] = {16, 256, 4096};
+    for (size_t payload : payloads) {
+        for (size_t frames : batches) {
+            runCase(payload, frames, std::max<uint64_t>(4, scale * 65536 / frames));
+        }
+    }
+    return 0;
+}
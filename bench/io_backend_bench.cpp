@@ -0,0 +1,199 @@
+// I/O 后端对比基准：同一个回显服务分别跑在 epoll 与 io_uring 后端上，
+// 若干客户端做一问一答（可选每次流水线发送多帧），对比吞吐与 p50/p99 延迟。
+// 客户端统一用阻塞 socket，只有服务端后端不同。
+//
+// 用法：io_backend_bench [clients] [requests_per_client] [payload_bytes] [pipeline_depth] [io_threads]
+#include "../include/tcp_server.h"
+#include "../include/tcp_connection.h"
+#include "../include/frame_codec.h"
+#include "../include/io_uring_ring.h"
+#include "bench_util.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace rpc;
+
+namespace {
+
+using bench::percentile;
+
+int connectTo(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    timeval timeout;
+    timeout.tv_sec = 5;
+    timeout.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+bool writeAll(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool readAll(int fd, uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::recv(fd, data, len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+struct BenchOptions {
+    int clients;
+    int requests_per_client;
+    size_t payload_bytes;
+    int pipeline_depth;
+    size_t io_threads;
+};
+
+// 一轮的结果
+struct RoundResult {
+    std::vector<double> latencies; // 每批（pipeline_depth 帧）往返延迟（微秒），已排序
+    double seconds = 0.0;          // 总耗时
+    size_t frames = 0;             // 完成的帧数
+    int failures = 0;              // 出错断开的客户端数
+};
+
+// 跑一轮
+RoundResult runRound(const std::string& backend, uint16_t port, const BenchOptions& options) {
+    TcpServerConfig config;
+    config.io_thread_count = options.io_threads;
+    config.io_backend = backend;
+    std::unique_ptr<TcpServer> server = createTcpServer(config);
+
+    // 原样回显
+    server->setConnectionCallback([](std::shared_ptr<TcpConnection> conn) {
+        conn->setMessageCallback([](std::shared_ptr<TcpConnection> c, const std::vector<uint8_t>& message) {
+            FrameCodec codec;
+            c->send(codec.encode(message));
+        });
+    });
+    if (!server->start(port, "127.0.0.1")) {
+        std::cerr << "server start failed on port " << port << std::endl;
+        std::exit(1);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::mutex result_mutex;
+    RoundResult result;
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.clients; ++i) {
+        threads.emplace_back([&, port]() {
+            int fd = connectTo(port);
+            if (fd < 0) {
+                std::lock_guard<std::mutex> lock(result_mutex);
+                result.failures++;
+                return;
+            }
+            FrameCodec codec;
+            std::vector<uint8_t> frame = codec.encode(std::vector<uint8_t>(options.payload_bytes, 'x'));
+            std::vector<uint8_t> batch;
+            for (int k = 0; k < options.pipeline_depth; ++k) {
+                batch.insert(batch.end(), frame.begin(), frame.end());
+            }
+            std::vector<uint8_t> reply(batch.size());
+            std::vector<double> local;
+            local.reserve(options.requests_per_client);
+            bool failed = false;
+            for (int k = 0; k < options.requests_per_client; ++k) {
+                auto start = std::chrono::steady_clock::now();
+                if (!writeAll(fd, batch.data(), batch.size()) || !readAll(fd, reply.data(), reply.size())) {
+                    failed = true;
+                    break;
+                }
+                auto end = std::chrono::steady_clock::now();
+                local.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+            }
+            close(fd);
+            std::lock_guard<std::mutex> lock(result_mutex);
+            result.latencies.insert(result.latencies.end(), local.begin(), local.end());
+            result.frames += local.size() * options.pipeline_depth;
+            if (failed) {
+                result.failures++;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    server->stop();
+
+    std::sort(result.latencies.begin(), result.latencies.end());
+    return result;
+}
+
+void report(const std::string& name, const RoundResult& result) {
+    const std::vector<double>& latencies = result.latencies;
+    double rate = result.seconds > 0 ? result.frames / result.seconds : 0.0;
+    std::cout << name << ": frames=" << result.frames
+              << " failures=" << result.failures
+              << " throughput=" << static_cast<uint64_t>(rate) << " frames/s"
+              << " p50=" << percentile(latencies, 0.50) << "us"
+              << " p99=" << percentile(latencies, 0.99) << "us"
+              << " max=" << (latencies.empty() ? 0.0 : latencies.back()) << "us" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    options.clients = argc > 1 ? std::atoi(argv[1]) : 16;
+    options.requests_per_client = argc > 2 ? std::atoi(argv[2]) : 5000;
+    options.payload_bytes = argc > 3 ? static_cast<size_t>(std::atoll(argv[3])) : 128;
+    options.pipeline_depth = argc > 4 ? std::max(1, std::atoi(argv[4])) : 1;
+    options.io_threads = argc > 5 ? static_cast<size_t>(std::atoi(argv[5])) : 2;
+
+    std::cout << "clients=" << options.clients << " requests_per_client=" << options.requests_per_client
+              << " payload_bytes=" << options.payload_bytes << " pipeline_depth=" << options.pipeline_depth
+              << " io_threads=" << options.io_threads << std::endl;
+
+    report("epoll   ", runRound("epoll", 9103, options));
+    if (IoUringRing::isSupported()) {
+        report("io_uring", runRound("io_uring", 9104, options));
+    } else {
+        std::cout << "io_uring: not supported by this kernel, skipped" << std::endl;
+    }
+    return 0;
+}
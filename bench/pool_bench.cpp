@@ -0,0 +1,124 @@
+// 服务发现模式下的连接复用基准：instances 个实例注册在内存注册中心里，轮询负载均衡，每次调用都换一个实例，
+// 测一问一答的 p50/p99 延迟与建立的连接数：
+//   stub   : 一个 stub 连续调用 requests 次
+//   stub x2: 再新建一个 stub 调用同一服务，连接池里的连接直接复用（不新建连接）
+// 原先实例一变就断开重连，轮询下几乎每次调用都要重新建连、握手
+//
+// 用法：pool_bench [instances] [requests]
+#include "../include/rpc_serser.h"
+#include "../include/rpc_client.h"
+#include "../include/connection_pool.h"
+#include "../proto/calculator.pb.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace rpc;
+
+namespace {
+
+using bench::percentile;
+
+const uint16_t kBasePort = 9350;
+
+// 立即返回 a + b
+class EchoCalculator : public CalculatorService {
+public:
+    void Add(google::protobuf::RpcController*, const AddRequest* request, AddResponse* response,
+             google::protobuf::Closure* done) override {
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+// 固定实例列表的注册中心
+class StaticRegistry : public ServiceRegistry {
+public:
+    explicit StaticRegistry(std::vector<ServiceInstance> instances) : instances_(std::move(instances)) {}
+
+    bool registerService(const ServiceInstance&) override { return true; }
+    bool unregisterService(const std::string&, const std::string&) override { return true; }
+    std::vector<ServiceInstance> discoverService(const std::string&) override { return instances_; }
+    bool subsribeService(const std::string&, ServiceInstanceCallback) override { return true; }
+    bool unsubsribeService(const std::string&) override { return true; }
+    bool sendHeartbeat(const std::string&, const std::string&) override { return true; }
+    std::vector<std::string> getAllService() override { return {"CalculatorService"}; }
+
+private:
+    std::vector<ServiceInstance> instances_;
+};
+
+// 用一个新的服务发现模式 stub 调用 requests 次，报告延迟分布（微秒）与期间新建的连接数
+void measure(const std::string& name, const std::vector<ServiceInstance>& instances, int requests) {
+    RpcClientStubImpl stub("CalculatorService", std::make_unique<StaticRegistry>(instances),
+                           LoadBalancerFactory::getInstance().create("RoundRobin"));
+    stub.setPreferUnixSocket(false);
+    uint64_t connects_before = ClientConnectionPool::instance().totalConnects();
+
+    std::vector<double> latencies;
+    latencies.reserve(requests);
+    int failures = 0;
+    AddRequest request;
+    request.set_a(1);
+    request.set_b(2);
+    for (int i = 0; i < requests; ++i) {
+        AddResponse response;
+        auto start = std::chrono::steady_clock::now();
+        if (!stub.callMethod("Add", request, response) || response.result() != 3) {
+            failures++;
+            continue;
+        }
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << name << ": calls=" << latencies.size()
+              << " failures=" << failures
+              << " connects=" << ClientConnectionPool::instance().totalConnects() - connects_before
+              << " p50=" << percentile(latencies, 0.50) << "us"
+              << " p99=" << percentile(latencies, 0.99) << "us" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int instance_count = argc > 1 ? std::atoi(argv[1]) : 3;
+    int requests = argc > 2 ? std::atoi(argv[2]) : 3000;
+
+    std::cout << "instances=" << instance_count << " requests=" << requests << std::endl;
+
+    EchoCalculator service;
+    std::vector<std::unique_ptr<RpcServer>> servers;
+    std::vector<ServiceInstance> instances;
+    for (int i = 0; i < instance_count; ++i) {
+        RpcServerConfig config;
+        config.host = "127.0.0.1";
+        config.port = static_cast<uint16_t>(kBasePort + i);
+        config.thread_pool_size = 2;
+        config.enable_registry = false;
+        auto server = std::make_unique<RpcServer>(config);
+        server->registerService(&service);
+        if (!server->start()) {
+            std::cerr << "rpc server start failed on port " << config.port << std::endl;
+            return 1;
+        }
+        servers.push_back(std::move(server));
+        instances.emplace_back("CalculatorService", "127.0.0.1", config.port);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    measure("stub   ", instances, requests);
+    measure("stub x2", instances, requests);
+
+    ClientConnectionPool::instance().clear();
+    for (auto& server : servers) {
+        server->stop();
+    }
+    return 0;
+}
@@ -0,0 +1,212 @@
+// 读公平性基准：少量"重"客户端持续灌大帧，"轻"客户端做小帧 ping-pong，
+// 对比不限预算与有读取预算两种配置下轻客户端的尾延迟。
+//
+// 用法：read_fairness_bench [heavy_clients] [light_clients] [requests_per_light_client]
+#include "../include/tcp_server.h"
+#include "../include/tcp_connection.h"
+#include "../include/frame_codec.h"
+#include "bench_util.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace rpc;
+
+namespace {
+
+using bench::percentile;
+
+const size_t kHeavyFrameSize = 16 * 1024; // 重客户端每帧大小
+const size_t kLightFrameSize = 32;        // 轻客户端每帧大小
+const auto kRoundDeadline = std::chrono::seconds(10); // 每轮最长运行时间，不限预算时轻客户端可能极慢
+
+int connectTo(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    // 不限预算时 I/O 线程可能被重连接长期霸占，给收发设超时，避免基准本身卡死
+    timeval timeout;
+    timeout.tv_sec = 2;
+    timeout.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+bool writeAll(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool readAll(int fd, uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::recv(fd, data, len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 一轮的结果
+struct RoundResult {
+    std::vector<double> latencies; // 轻客户端请求延迟（微秒），已排序
+    int timeouts = 0;              // 2 秒内没拿到回复的请求数
+};
+
+// 跑一轮
+RoundResult runRound(uint16_t port, size_t budget_bytes, size_t budget_frames,
+                             int heavy_clients, int light_clients, int requests_per_client) {
+    TcpServerConfig config;
+    config.io_thread_count = 1; // 单个 I/O 循环，让重/轻连接竞争同一个线程
+    config.read_budget_bytes = budget_bytes;
+    config.read_budget_frames = budget_frames;
+    TcpServerImpl server(config);
+
+    // 小帧原样回显，大帧只消费不回复
+    server.setConnectionCallback([](std::shared_ptr<TcpConnection> conn) {
+        conn->setMessageCallback([](std::shared_ptr<TcpConnection> c, const std::vector<uint8_t>& message) {
+            if (message.size() <= kLightFrameSize) {
+                FrameCodec codec;
+                c->send(codec.encode(message));
+            }
+        });
+    });
+    if (!server.start(port, "127.0.0.1")) {
+        std::cerr << "server start failed on port " << port << std::endl;
+        std::exit(1);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> heavy_threads;
+    for (int i = 0; i < heavy_clients; ++i) {
+        heavy_threads.emplace_back([port, &stop]() {
+            int fd = connectTo(port);
+            if (fd < 0) {
+                return;
+            }
+            FrameCodec codec;
+            std::vector<uint8_t> frame = codec.encode(std::vector<uint8_t>(kHeavyFrameSize, 'h'));
+            // 一次写出多帧，尽量把 socket 接收缓冲区灌满
+            std::vector<uint8_t> batch;
+            for (int k = 0; k < 16; ++k) {
+                batch.insert(batch.end(), frame.begin(), frame.end());
+            }
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (!writeAll(fd, batch.data(), batch.size())) {
+                    break;
+                }
+            }
+            close(fd);
+        });
+    }
+    // 让重客户端先把服务端压满
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    std::mutex latency_mutex;
+    RoundResult result;
+    std::vector<std::thread> light_threads;
+    for (int i = 0; i < light_clients; ++i) {
+        light_threads.emplace_back([&, port]() {
+            int fd = connectTo(port);
+            if (fd < 0) {
+                return;
+            }
+            FrameCodec codec;
+            std::vector<uint8_t> frame = codec.encode(std::vector<uint8_t>(kLightFrameSize, 'l'));
+            std::vector<uint8_t> reply(frame.size());
+            std::vector<double> local;
+            local.reserve(requests_per_client);
+            auto deadline = std::chrono::steady_clock::now() + kRoundDeadline;
+            for (int k = 0; k < requests_per_client; ++k) {
+                auto begin = std::chrono::steady_clock::now();
+                if (begin > deadline) {
+                    break;
+                }
+                if (!writeAll(fd, frame.data(), frame.size()) || !readAll(fd, reply.data(), reply.size())) {
+                    std::lock_guard<std::mutex> lock(latency_mutex);
+                    result.timeouts++;
+                    break;
+                }
+                auto end = std::chrono::steady_clock::now();
+                local.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+            }
+            close(fd);
+            std::lock_guard<std::mutex> lock(latency_mutex);
+            result.latencies.insert(result.latencies.end(), local.begin(), local.end());
+        });
+    }
+    for (auto& t : light_threads) {
+        t.join();
+    }
+    stop = true;
+    server.stop(); // 关闭连接，解除重客户端的阻塞写
+    for (auto& t : heavy_threads) {
+        t.join();
+    }
+
+    std::sort(result.latencies.begin(), result.latencies.end());
+    return result;
+}
+
+void report(const char* name, const RoundResult& result) {
+    const std::vector<double>& latencies = result.latencies;
+    std::cout << name << ": samples=" << latencies.size()
+              << " timeouts=" << result.timeouts
+              << " p50=" << percentile(latencies, 0.50) << "us"
+              << " p99=" << percentile(latencies, 0.99) << "us"
+              << " p999=" << percentile(latencies, 0.999) << "us"
+              << " max=" << (latencies.empty() ? 0.0 : latencies.back()) << "us" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int heavy_clients = argc > 1 ? std::atoi(argv[1]) : 2;
+    int light_clients = argc > 2 ? std::atoi(argv[2]) : 4;
+    int requests_per_client = argc > 3 ? std::atoi(argv[3]) : 500;
+
+    std::cout << "heavy_clients=" << heavy_clients << " light_clients=" << light_clients
+              << " requests_per_light_client=" << requests_per_client << std::endl;
+
+    const size_t unlimited = std::numeric_limits<size_t>::max();
+    report("unbounded     ", runRound(9101, unlimited, unlimited, heavy_clients, light_clients, requests_per_client));
+    report("budget 256K/64", runRound(9102, EventLoop::kDefaultReadBudgetBytes, EventLoop::kDefaultReadBudgetFrames,
+                                      heavy_clients, light_clients, requests_per_client));
+    return 0;
+}
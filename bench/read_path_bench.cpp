@@ -0,0 +1,237 @@
+// 读路径基准：对端通过 TCP 回环持续发送长度前缀帧，接收端分别用三种方式读取并切帧，
+// 对比不同帧大小（64B ~ 8MB）下的吞吐、每次 read 的平均字节数和用户态额外拷贝的字节数：
+//   legacy : 原 Buffer::readFromFd 的做法——可写区 + 栈上 64KB extra_buf，溢出部分再 append，帧拷成 vector
+//   buffer : Buffer::readFromFd 按 AdaptiveReadSizer 预留空间直接读入，帧以指针访问
+//   iobuf  : IoBuf::readFromFd 按自适应大小 / 帧长挂块，帧用 cutFront 零拷贝切出
+//
+// 用法：read_path_bench [megabytes_per_size]
+#include "../include/buffer.h"
+#include "../include/io_buf.h"
+#include "../include/read_sizer.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rpc;
+
+namespace {
+
+const uint16_t kPort = 9106;
+const size_t kMaxFrameSize = 10 * 1024 * 1024;
+
+// 一轮的统计
+struct ReadStats {
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    uint64_t reads = 0;        // read/readv 调用次数
+    uint64_t extra_copied = 0; // 内核到用户态之外，用户态再拷贝的字节数（可统计的部分）
+};
+
+// 连上一个 127.0.0.1 的 TCP 连接对
+bool makeTcpPair(int& writer_fd, int& reader_fd) {
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kPort);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listen_fd, 1) < 0) {
+        close(listen_fd);
+        return false;
+    }
+    writer_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (::connect(writer_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(listen_fd);
+        return false;
+    }
+    reader_fd = accept(listen_fd, nullptr, nullptr);
+    close(listen_fd);
+    setsockopt(writer_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return reader_fd >= 0;
+}
+
+// 发送端：frames 个 payload 字节的帧，小帧先拼成约 1MB 的批次再发
+void writeFrames(int fd, size_t payload, uint64_t frames) {
+    std::vector<uint8_t> frame(4 + payload, 'p');
+    uint32_t length = htonl(static_cast<uint32_t>(payload));
+    std::memcpy(frame.data(), &length, 4);
+    uint64_t per_batch = std::max<uint64_t>(1, (1024 * 1024) / frame.size());
+    std::vector<uint8_t> batch;
+    for (uint64_t i = 0; i < per_batch; ++i) {
+        batch.insert(batch.end(), frame.begin(), frame.end());
+    }
+    uint64_t sent = 0;
+    while (sent < frames) {
+        uint64_t count = std::min(per_batch, frames - sent);
+        const uint8_t* data = batch.data();
+        size_t len = count * frame.size();
+        while (len > 0) {
+            ssize_t n = ::send(fd, data, len, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return;
+            }
+            data += n;
+            len -= static_cast<size_t>(n);
+        }
+        sent += count;
+    }
+}
+
+// 原实现：可写区 + 栈上 64KB 临时缓冲区，溢出部分 append 进 Buffer
+ssize_t legacyReadFromFd(Buffer& buffer, int fd, ReadStats& stats) {
+    char extra_buf[65536];
+    struct iovec vec[2];
+    const size_t writable = buffer.writableBytes();
+    vec[0].iov_base = buffer.beginWrite();
+    vec[0].iov_len = writable;
+    vec[1].iov_base = extra_buf;
+    vec[1].iov_len = sizeof(extra_buf);
+    const int iovcnt = (writable < sizeof(extra_buf)) ? 2 : 1;
+    const ssize_t n = ::readv(fd, vec, iovcnt);
+    if (n > 0 && static_cast<size_t>(n) > writable) {
+        buffer.hasWritten(writable);
+        buffer.append(extra_buf, n - writable);
+        stats.extra_copied += n - writable;
+    } else if (n > 0) {
+        buffer.hasWritten(static_cast<size_t>(n));
+    }
+    return n;
+}
+
+ReadStats readLegacy(int fd, uint64_t frames) {
+    ReadStats stats;
+    Buffer buffer;
+    while (stats.frames < frames) {
+        ssize_t n = legacyReadFromFd(buffer, fd, stats);
+        if (n <= 0) {
+            break;
+        }
+        stats.reads++;
+        stats.bytes += n;
+        while (buffer.readableBytes() >= 4) {
+            uint32_t length = buffer.peekInt<uint32_t>();
+            if (buffer.readableBytes() < 4 + length) {
+                break;
+            }
+            buffer.retrieve(4);
+            std::vector<uint8_t> frame = buffer.retrieveAsVector(length);
+            stats.extra_copied += frame.size();
+            stats.frames++;
+        }
+    }
+    return stats;
+}
+
+ReadStats readBuffer(int fd, uint64_t frames) {
+    ReadStats stats;
+    Buffer buffer;
+    AdaptiveReadSizer sizer;
+    while (stats.frames < frames) {
+        int saved_errno = 0;
+        ssize_t n = buffer.readFromFd(fd, &saved_errno, sizer.next());
+        if (n <= 0) {
+            break;
+        }
+        sizer.record(static_cast<size_t>(n));
+        stats.reads++;
+        stats.bytes += n;
+        while (buffer.readableBytes() >= 4) {
+            uint32_t length = buffer.peekInt<uint32_t>();
+            if (buffer.readableBytes() < 4 + length) {
+                break;
+            }
+            volatile uint8_t first = buffer.peek()[4];  // 帧体就地访问
+            (void)first;
+            buffer.retrieve(4 + length);
+            stats.frames++;
+        }
+    }
+    return stats;
+}
+
+ReadStats readIoBuf(int fd, uint64_t frames) {
+    ReadStats stats;
+    IoBuf buffer;
+    AdaptiveReadSizer sizer;
+    while (stats.frames < frames) {
+        // 与 TcpConnectionImpl::nextReadSize 相同：半帧时按帧的剩余部分预留（随已到达的字节增长）
+        size_t read_size = sizer.next();
+        if (buffer.readableBytes() >= 4) {
+            size_t frame_bytes = 4 + static_cast<size_t>(buffer.peekInt<uint32_t>());
+            if (frame_bytes <= kMaxFrameSize + 4) {
+                read_size = sizer.nextForFrame(frame_bytes, buffer.readableBytes());
+            }
+        }
+        int saved_errno = 0;
+        ssize_t n = buffer.readFromFd(fd, &saved_errno, read_size);
+        if (n <= 0) {
+            break;
+        }
+        sizer.record(static_cast<size_t>(n));
+        stats.reads++;
+        stats.bytes += n;
+        while (buffer.readableBytes() >= 4) {
+            uint32_t length = buffer.peekInt<uint32_t>();
+            if (buffer.readableBytes() < 4 + length) {
+                break;
+            }
+            buffer.retrieve(4);
+            IoBuf frame = buffer.cutFront(length);
+            stats.frames++;
+        }
+    }
+    return stats;
+}
+
+void runCase(const std::string& name, size_t payload, uint64_t frames, ReadStats (*reader)(int, uint64_t)) {
+    int writer_fd = -1;
+    int reader_fd = -1;
+    if (!makeTcpPair(writer_fd, reader_fd)) {
+        std::cerr << "failed to set up loopback connection on port " << kPort << std::endl;
+        std::exit(1);
+    }
+    auto begin = std::chrono::steady_clock::now();
+    std::thread writer(writeFrames, writer_fd, payload, frames);
+    ReadStats stats = reader(reader_fd, frames);
+    writer.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    close(writer_fd);
+    close(reader_fd);
+
+    double mb_per_s = seconds > 0 ? stats.bytes / seconds / (1024.0 * 1024.0) : 0.0;
+    std::cout << name << " payload=" << payload
+              << " frames=" << stats.frames
+              << " throughput=" << static_cast<uint64_t>(mb_per_s) << "MB/s"
+              << " bytes_per_read=" << (stats.reads ? stats.bytes / stats.reads : 0)
+              << " extra_copied_per_frame=" << (stats.frames ? stats.extra_copied / stats.frames : 0) << "B"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+    const size_t payloads[] = {64, 512, 4 * 1024, 64 * 1024, 512 * 1024, 1024 * 1024, 8 * 1024 * 1024};
+    std::cout << "megabytes_per_size=" << megabytes << std::endl;
+    for (size_t payload : payloads) {
+        uint64_t frames = std::max<uint64_t>(4, megabytes * 1024 * 1024 / (payload + 4));
+        runCase("legacy", payload, frames, readLegacy);
+        runCase("buffer", payload, frames, readBuffer);
+        runCase("iobuf ", payload, frames, readIoBuf);
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+// 响应编码基准：服务端从拿到响应消息到得到可发送帧的这一段，对比两种做法每个响应的耗时与用户态拷贝字节数：
+//   legacy : 原 callServiceMethod + sendResponse 的做法——响应消息 SerializeToString 再拷成 vector，
+//            赋给 RpcResponse，createResponseProto 再拷进信封，信封 SerializeToString 再拷成 vector，
+//            最后 FrameCodec::encode 拼上长度前缀又拷一遍
+//   buffer : RpcProtocolHelper::serializeResponse(response, payload, Buffer&) 把信封和响应消息一次写进 Buffer，
+//            FrameCodec::encode(Buffer&) 把长度前缀写进预留头部
+// 两种做法得到的帧都直接交给发送队列聚集写出，发送路径上不再有拷贝，这里不计入
+//
+// 用法：response_encode_bench [iterations_scale]
+#include "../include/buffer.h"
+#include "../include/frame_codec.h"
+#include "../include/rpc_protocol_helper.h"
+#include "../include/transport.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace rpc;
+
+namespace {
+
+struct EncodeStats {
+    uint64_t frame_bytes = 0;
+    uint64_t copied = 0; // 用户态拷贝的字节数（含序列化本身）
+};
+
+// 原实现
+EncodeStats encodeLegacy(const google::protobuf::Message& message, FrameCodec& codec) {
+    EncodeStats stats;
+    std::string response_data;
+    message.SerializeToString(&response_data);
+    stats.copied += response_data.size();
+    std::vector<uint8_t> data(response_data.begin(), response_data.end());
+    stats.copied += data.size();
+
+    RpcResponse response;
+    response.request_id = 1;
+    response.success = true;
+    response.response_data = data;
+    stats.copied += data.size();
+
+    // createResponseProto 拷一次，SerializeToString 写一次，转 vector 再拷一次
+    std::vector<uint8_t> body = RpcProtocolHelper::serializeResponse(response);
+    stats.copied += response.response_data.size() + 2 * body.size();
+
+    std::vector<uint8_t> frame = codec.encode(body);
+    stats.copied += frame.size();
+    stats.frame_bytes = frame.size();
+    return stats;
+}
+
+// 直接写进 Buffer
+EncodeStats encodeBuffer(const google::protobuf::Message& message, FrameCodec& codec) {
+    EncodeStats stats;
+    RpcResponse response;
+    response.request_id = 1;
+    response.success = true;
+
+    Buffer frame;
+    RpcProtocolHelper::serializeResponse(response, &message, frame);
+    stats.copied += frame.readableBytes();
+    codec.encode(frame);
+    stats.copied += codec.getHeaderSize();
+    stats.frame_bytes = frame.readableBytes();
+    return stats;
+}
+
+void runCase(const std::string& name, size_t payload, uint64_t iterations,
+             EncodeStats (*encoder)(const google::protobuf::Message&, FrameCodec&)) {
+    RpcRequestProto message;
+    message.set_request_id(42);
+    message.set_service_name("BenchService");
+    message.set_request_data(std::string(payload, 'p'));
+    FrameCodec codec;
+
+    EncodeStats total;
+    auto begin = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        EncodeStats stats = encoder(message, codec);
+        total.frame_bytes += stats.frame_bytes;
+        total.copied += stats.copied;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << name << " payload=" << payload
+              << " ns_per_response=" << static_cast<uint64_t>(seconds * 1e9 / iterations)
+              << " frame_bytes=" << total.frame_bytes / iterations
+              << " copied_per_response=" << total.copied / iterations << "B"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t scale = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1;
+    const size_t payloads[] = {64, 512, 4 * 1024, 64 * 1024, 1024 * 1024};
+    for (size_t payload : payloads) {
+        uint64_t iterations = std::max<uint64_t>(20, scale * 64 * 1024 * 1024 / (payload + 64));
+        iterations = std::min<uint64_t>(iterations, scale * 200000);
+        runCase("legacy", payload, iterations, encodeLegacy);
+        runCase("buffer", payload, iterations, encodeBuffer);
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+// 同机传输对比基准：同一个回显服务分别通过 TCP 回环、Unix 域套接字、共享内存环提供，
+// 若干客户端做一问一答，对比小帧往返的 p50/p99 延迟与吞吐。
+// TCP / Unix 域套接字客户端用阻塞 socket，共享内存用 ShmTcpClient。
+//
+// 用法：same_host_bench [clients] [requests_per_client] [payload_bytes]
+#include "../include/tcp_server.h"
+#include "../include/tcp_connection.h"
+#include "../include/shm_server.h"
+#include "../include/shm_client.h"
+#include "../include/frame_codec.h"
+#include "../include/socket_address.h"
+#include "bench_util.h"
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace rpc;
+
+namespace {
+
+using bench::percentile;
+
+// 一个阻塞 socket 客户端：发送整帧，收回一帧
+class SocketEchoClient {
+public:
+    SocketEchoClient() : fd_(-1) {}
+    ~SocketEchoClient() {
+        if (fd_ != -1) {
+            close(fd_);
+        }
+    }
+
+    bool connect(const std::string& host, uint16_t port) {
+        SocketAddress address;
+        if (!address.parse(host, port)) {
+            return false;
+        }
+        fd_ = socket(address.getFamily(), SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0 || ::connect(fd_, address.getSockAddr(), address.getLength()) < 0) {
+            return false;
+        }
+        if (!address.isUnix()) {
+            int one = 1;
+            setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        return true;
+    }
+
+    bool roundTrip(const std::vector<uint8_t>& frame, std::vector<uint8_t>& reply) {
+        reply.resize(frame.size());
+        return transfer(frame.data(), frame.size(), true) && transfer(reply.data(), reply.size(), false);
+    }
+
+private:
+    int fd_;
+
+    bool transfer(const uint8_t* data, size_t len, bool sending) {
+        while (len > 0) {
+            ssize_t n = sending ? ::send(fd_, data, len, MSG_NOSIGNAL) : ::recv(fd_, const_cast<uint8_t*>(data), len, 0);
+            if (n <= 0) {
+                return false;
+            }
+            data += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+};
+
+struct BenchOptions {
+    int clients;
+    int requests_per_client;
+    size_t payload_bytes;
+};
+
+// 一轮的结果
+struct RoundResult {
+    std::vector<double> latencies; // 每次往返延迟（微秒），已排序
+    double seconds = 0.0;          // 总耗时
+    int failures = 0;              // 出错的客户端数
+};
+
+// 跑一轮：在 address 上启动回显服务，客户端并发一问一答
+RoundResult runRound(TcpServer& server, const std::string& address, uint16_t port, const BenchOptions& options) {
+    FrameCodec server_codec;
+    server.setConnectionCallback([&server_codec](std::shared_ptr<TcpConnection> conn) {
+        conn->setMessageCallback([&server_codec](std::shared_ptr<TcpConnection> c, const std::vector<uint8_t>& message) {
+            c->send(server_codec.encode(message));
+        });
+    });
+    if (!server.start(port, address)) {
+        std::cerr << "server start failed on " << address << std::endl;
+        std::exit(1);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::mutex result_mutex;
+    RoundResult result;
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.clients; ++i) {
+        threads.emplace_back([&]() {
+            bool use_shm = ShmRegion::isShmAddress(address);
+            ShmTcpClient shm_client;
+            SocketEchoClient socket_client;
+            bool connected = use_shm ? shm_client.connect(address, port) : socket_client.connect(address, port);
+            if (!connected) {
+                std::lock_guard<std::mutex> lock(result_mutex);
+                result.failures++;
+                return;
+            }
+            FrameCodec codec;
+            std::vector<uint8_t> frame = codec.encode(std::vector<uint8_t>(options.payload_bytes, 'x'));
+            std::vector<uint8_t> reply;
+            std::vector<double> local;
+            local.reserve(options.requests_per_client);
+            bool failed = false;
+            for (int k = 0; k < options.requests_per_client; ++k) {
+                auto start = std::chrono::steady_clock::now();
+                bool ok = use_shm ? shm_client.send(frame) && shm_client.receive(reply)
+                                  : socket_client.roundTrip(frame, reply);
+                if (!ok) {
+                    failed = true;
+                    break;
+                }
+                auto end = std::chrono::steady_clock::now();
+                local.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+            }
+            shm_client.disconnect();
+            std::lock_guard<std::mutex> lock(result_mutex);
+            result.latencies.insert(result.latencies.end(), local.begin(), local.end());
+            if (failed) {
+                result.failures++;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    server.stop();
+
+    std::sort(result.latencies.begin(), result.latencies.end());
+    return result;
+}
+
+void report(const std::string& name, const RoundResult& result) {
+    const std::vector<double>& latencies = result.latencies;
+    double rate = result.seconds > 0 ? latencies.size() / result.seconds : 0.0;
+    std::cout << name << ": calls=" << latencies.size()
+              << " failures=" << result.failures
+              << " throughput=" << static_cast<uint64_t>(rate) << " calls/s"
+              << " p50=" << percentile(latencies, 0.50) << "us"
+              << " p99=" << percentile(latencies, 0.99) << "us"
+              << " max=" << (latencies.empty() ? 0.0 : latencies.back()) << "us" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    options.clients = argc > 1 ? std::atoi(argv[1]) : 4;
+    options.requests_per_client = argc > 2 ? std::atoi(argv[2]) : 20000;
+    options.payload_bytes = argc > 3 ? static_cast<size_t>(std::atoll(argv[3])) : 128;
+
+    std::cout << "clients=" << options.clients << " requests_per_client=" << options.requests_per_client
+              << " payload_bytes=" << options.payload_bytes << std::endl;
+
+    TcpServerConfig config;
+    config.io_thread_count = 2;
+
+    TcpServerImpl tcp_server(config);
+    report("tcp ", runRound(tcp_server, "127.0.0.1", 9105, options));
+    TcpServerImpl unix_server(config);
+    report("unix", runRound(unix_server, "unix:/tmp/myrpc_same_host_bench.sock", 0, options));
+    ShmTcpServer shm_server(config);
+    report("shm ", runRound(shm_server, "shm:/tmp/myrpc_same_host_bench.shm", 0, options));
+    return 0;
+}
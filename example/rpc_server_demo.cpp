@@ -15,8 +15,11 @@ void runServer(bool use_registry = false) {
     config.host = "0.0.0.0"; // 监听所有接口
     config.port = 9000; // 监听端口
     config.thread_pool_size = 4; // 线程池大小
+    config.io_thread_count = 2; // I/O 线程数
     config.max_connections = 100; // 最大连接数
     config.serializer_type = "protobuf"; // 序列化方式
+    config.unix_address = "unix:/tmp/myrpc_demo.sock"; // 同机客户端可经 Unix 域套接字访问
+    config.shm_address = "shm:/tmp/myrpc_demo.shm";    // 同机客户端优先经共享内存环访问
     if (use_registry) {
         // 配置服务注册中心
         config.enable_registry = true;
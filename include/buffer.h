@@ -7,6 +7,7 @@
 #include <stdexcept>
 #include <arpa/inet.h>
 #include <endian.h>
+#include "slab_pool.h"
 
 namespace rpc {
 
@@ -17,26 +18,43 @@ namespace rpc {
  * 2. 内存连续，读写高效
  * 3. 支持peek操作（不移除数据）
  * 4. 自动回收空闲内存
+ * 5. 底层存储从 SlabPool 分配，扩容与销毁走线程缓存而不是 malloc
  */
 class Buffer {
 public:
-    static const size_t kInitialSize = 1024;        // 初始大小 1KB
-    static const size_t kPrependSize = 8;           // 预留头部空间
-    static const size_t kMaxBufferSize = 64 * 1024 * 1024; // 最大64MB
+    static constexpr size_t kInitialSize = 1024;        // 初始大小 1KB
+    static constexpr size_t kPrependSize = 8;           // 预留头部空间
+    static constexpr size_t kMaxBufferSize = 64 * 1024 * 1024; // 最大64MB
+    static constexpr size_t kDefaultReadSize = 16 * 1024;     // readFromFd 默认预留的可写空间
 
     explicit Buffer(size_t initial_size = kInitialSize)
-        : buffer_(kPrependSize + initial_size)
+        : buffer_(static_cast<uint8_t*>(SlabPool::allocate(kPrependSize + initial_size)))
+        , capacity_(kPrependSize + initial_size)
         , reader_index_(kPrependSize)
         , writer_index_(kPrependSize) {
     }
 
-    ~Buffer() = default;
+    ~Buffer() {
+        SlabPool::deallocate(buffer_, capacity_);
+    }
 
     // 禁用拷贝，允许移动
     Buffer(const Buffer&) = delete;
     Buffer& operator=(const Buffer&) = delete;
-    Buffer(Buffer&&) noexcept = default;
-    Buffer& operator=(Buffer&&) noexcept = default;
+    Buffer(Buffer&& rhs) noexcept
+        : buffer_(rhs.buffer_)
+        , capacity_(rhs.capacity_)
+        , reader_index_(rhs.reader_index_)
+        , writer_index_(rhs.writer_index_) {
+        rhs.buffer_ = nullptr;
+        rhs.capacity_ = 0;
+        rhs.reader_index_ = 0;
+        rhs.writer_index_ = 0;
+    }
+    Buffer& operator=(Buffer&& rhs) noexcept {
+        swap(rhs);
+        return *this;
+    }
 
     // 可读字节数
     size_t readableBytes() const {
@@ -45,7 +63,7 @@ public:
 
     // 可写字节数
     size_t writableBytes() const {
-        return buffer_.size() - writer_index_;
+        return capacity_ - writer_index_;
     }
 
     // 预留空间大小
@@ -55,7 +73,7 @@ public:
 
     // 获取可读数据指针（不移除）
     const uint8_t* peek() const {
-        return &buffer_[reader_index_];
+        return buffer_ + reader_index_;
     }
 
     // 查找CRLF（用于HTTP等协议）
@@ -167,7 +185,7 @@ public:
             throw std::runtime_error("Not enough prepend space");
         }
         reader_index_ -= len;
-        std::memcpy(&buffer_[reader_index_], data, len);
+        std::memcpy(buffer_ + reader_index_, data, len);
     }
 
     template<typename T>
@@ -179,16 +197,8 @@ public:
 
     // 收缩缓冲区（释放过多的内存）
     void shrink(size_t reserve = 0) {
-        // 将有效数据移到前面
-        size_t readable = readableBytes();
-        std::memmove(&buffer_[kPrependSize], peek(), readable);
-        reader_index_ = kPrependSize;
-        writer_index_ = reader_index_ + readable;
-        
-        // 收缩缓冲区
-        size_t new_size = kPrependSize + readable + reserve;
-        buffer_.resize(new_size);
-        buffer_.shrink_to_fit();
+        // 将有效数据搬到新的（更小的）存储前面
+        reallocate(kPrependSize + readableBytes() + reserve);
     }
 
     // 确保可写空间
@@ -205,24 +215,25 @@ public:
 
     // 获取写指针
     uint8_t* beginWrite() {
-        return &buffer_[writer_index_];
+        return buffer_ + writer_index_;
     }
 
     const uint8_t* beginWrite() const {
-        return &buffer_[writer_index_];
+        return buffer_ + writer_index_;
     }
 
-    // 从socket读取数据
-    ssize_t readFromFd(int fd, int* saved_errno);
+    // 从socket读取数据：先预留 read_size 字节可写空间再直接读入（read_size 可由 AdaptiveReadSizer 给出）
+    ssize_t readFromFd(int fd, int* saved_errno, size_t read_size = kDefaultReadSize);
 
     // 获取缓冲区总大小
     size_t capacity() const {
-        return buffer_.size();
+        return capacity_;
     }
 
     // 交换
     void swap(Buffer& rhs) noexcept {
-        buffer_.swap(rhs.buffer_);
+        std::swap(buffer_, rhs.buffer_);
+        std::swap(capacity_, rhs.capacity_);
         std::swap(reader_index_, rhs.reader_index_);
         std::swap(writer_index_, rhs.writer_index_);
     }
@@ -231,21 +242,33 @@ private:
     void makeSpace(size_t len) {
         // 如果可写空间+预留空间不足，则扩容
         if (writableBytes() + prependableBytes() < len + kPrependSize) {
-            // 需要扩容
-            size_t new_size = writer_index_ + len;
-            if (new_size > kMaxBufferSize) {
+            // 需要扩容：至少翻倍，摊还搬移次数；扩容时顺带把数据移到前面
+            size_t needed = kPrependSize + readableBytes() + len;
+            if (needed > kMaxBufferSize) {
                 throw std::runtime_error("Buffer size exceeds maximum limit");
             }
-            buffer_.resize(new_size);
+            reallocate(std::max(needed, std::min(capacity_ * 2, kMaxBufferSize)));
         } else {
             // 空间足够，将数据移到前面
             size_t readable = readableBytes();
-            std::memmove(&buffer_[kPrependSize], peek(), readable);
+            std::memmove(buffer_ + kPrependSize, peek(), readable);
             reader_index_ = kPrependSize;
             writer_index_ = reader_index_ + readable;
         }
     }
 
+    // 换成 new_capacity 大小的存储，可读数据拷到预留空间之后
+    void reallocate(size_t new_capacity) {
+        size_t readable = readableBytes();
+        uint8_t* storage = static_cast<uint8_t*>(SlabPool::allocate(new_capacity));
+        std::memcpy(storage + kPrependSize, peek(), readable);
+        SlabPool::deallocate(buffer_, capacity_);
+        buffer_ = storage;
+        capacity_ = new_capacity;
+        reader_index_ = kPrependSize;
+        writer_index_ = kPrependSize + readable;
+    }
+
     // 字节序转换
     template<typename T>
     T networkToHost(T value) const {
@@ -306,7 +329,8 @@ private:
     }
 
 private:
-    std::vector<uint8_t> buffer_;   // 底层存储
+    uint8_t* buffer_;               // 底层存储（从 SlabPool 分配）
+    size_t capacity_;               // 存储大小
     size_t reader_index_;            // 读索引
     size_t writer_index_;            // 写索引
 };
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <google/protobuf/message.h>
+#include "tcp_client.h"
+#include "transport.h"
+#include "frame_codec.h"
+#include "timer_wheel.h"
+
+namespace rpc {
+
+/**
+ * 客户端的一条多路复用连接：同一连接上可以同时有任意多个在途调用
+ * 1. 每个请求带连接内唯一的请求 ID，先登记到在途表再发出；发送只在写出这一帧期间持锁，不等响应
+ * 2. 读线程按响应里的请求 ID 找到在途调用，把响应消息直接从接收缓冲区解析进它的 response 后完成它，响应可以乱序到达
+ * 3. 没有在途调用时读线程睡在条件变量上；连接出错或关闭时，所有在途调用以失败完成
+ *    每个在途调用带截止时间，挂在读线程独占的时间轮上：发起时登记，读线程取走后加定时器，响应到达时取消，到期时以超时失败；
+ *    receive 至多等到下一个定时器到期（最长 kSweepIntervalMs，以便取走新登记的截止时间）
+ * 4. 方法目录（握手取回的方法 ID）属于连接，首次带帧头调用时握手一次
+ * 5. 必须由 shared_ptr 持有：读线程执行完成回调期间持有自身的引用，回调里放开最后一个外部引用（如重试时换下这条连接）
+ *    也不会把正在运行的读线程所在的对象析构掉；在读线程里关闭、析构连接时不 join 读线程自己
+ */
+class ClientConnection : public std::enable_shared_from_this<ClientConnection> {
+public:
+    // 响应从哪来：对端回复的哪种格式，或者根本没有回复
+    enum class ReplyFormat {
+        kNone,   // 没有收到对端的回复（超时、连接断开或关闭），response 里是本地生成的错误
+        kLegacy, // 对端回复了不带帧头的旧格式响应
+        kFramed, // 对端回复了带帧头的响应
+    };
+
+    // 调用完成：response 是解析好的响应（失败时带错误信息），format 表示响应的来源与格式
+    using Completion = std::function<void(RpcResponse& response, ReplyFormat format)>;
+
+    static constexpr uint32_t kDefaultCallTimeoutMs = 5000; // 同步调用等待响应的最短时间
+    static constexpr uint64_t kHandshakeRequestId = 0;      // 握手的请求 ID：旧版本服务端解析失败时回复的请求 ID 也是 0
+    static constexpr uint32_t kSweepIntervalMs = 100;       // 读线程一次 receive 最多等待的时间
+
+    // tcp_client 必须已连接，其接收超时由读线程管理；创建后交给 shared_ptr（std::make_shared）
+    ClientConnection(std::shared_ptr<TcpClient> tcp_client, const std::string& service_name);
+    ~ClientConnection();
+
+    ClientConnection(const ClientConnection&) = delete;
+    ClientConnection& operator=(const ClientConnection&) = delete;
+
+    // 分配连接内唯一的请求 ID（从 1 开始）
+    uint64_t nextRequestId();
+
+    // 登记在途调用并发出 frame（已编码，request_id 已写进帧），不等响应。连接已关闭或发送失败（含发送缓冲区满超过 timeout_ms）时抛异常，
+    // complete 不会被调用；否则 complete 恰好被调用一次：读线程收到响应时，超过 timeout_ms 没有响应时，或连接出错、关闭时。
+    // complete 在读线程里执行，不能在里面等待本连接上的同步调用
+    void start(uint64_t request_id, const Buffer& frame, google::protobuf::Message* response, uint32_t timeout_ms,
+               Completion complete);
+
+    // 同步调用：start 后等待完成，timeout_ms 内没有响应时撤回该调用并抛异常
+    RpcResponse call(uint64_t request_id, const Buffer& frame, google::protobuf::Message* response,
+                     uint32_t timeout_ms, ReplyFormat* reply_format = nullptr);
+
+    // 取方法 ID：本连接首次调用时握手取回方法目录。对端以旧格式回复握手（不认识帧头的旧版本）时返回 false（本连接改走旧格式），
+    // 方法不存在或握手失败时抛异常；握手超时、连接断开不算旧版本，抛异常，下次调用重新握手
+    bool lookupMethodId(const std::string& method_name, uint32_t& method_id);
+
+    // 方法目录已就绪（已握手，或已知对端是旧版本）：之后的 lookupMethodId 不再阻塞
+    bool isDirectoryReady() const;
+
+    // 关闭连接：在途调用以失败完成，等读线程退出后断开（在读线程自己的回调里调用时不等，由读线程回到循环后自行退出）
+    void close();
+
+    // 连接是否可用：读线程发现连接出错、或已关闭时为 false
+    bool isOpen() const;
+
+    // 在途调用数
+    size_t pendingCount() const;
+
+private:
+    // 在途调用：响应消息由读线程直接解析进 response
+    struct PendingCall {
+        google::protobuf::Message* response;
+        Completion complete;
+    };
+
+    // 已登记、还没挂到时间轮上的截止时间
+    struct Deadline {
+        uint64_t request_id;
+        uint64_t expire_ms; // TimerWheel::nowMs() 时刻
+    };
+
+    std::shared_ptr<TcpClient> tcp_client_;
+    std::string service_name_; // 握手时发给服务端
+    FrameCodec frame_codec_;
+    std::atomic<bool> open_;   // 可以发起新调用
+    std::atomic<bool> closed_; // close() 已调用
+    std::atomic<uint64_t> next_request_id_;
+    std::mutex send_mutex_;    // 一帧必须整体写出，不能和别的帧交错
+    mutable std::mutex pending_mutex_;
+    std::condition_variable pending_cv_; // 读线程等待出现在途调用
+    std::unordered_map<uint64_t, PendingCall> pending_; // 请求 ID -> 在途调用
+    std::vector<Deadline> unscheduled_; // 发起线程登记、读线程取走后加到时间轮（pending_mutex_ 保护）
+    TimerWheel deadline_wheel_; // 在途调用的截止时间，只由读线程访问
+    std::unordered_map<uint64_t, TimerWheel::TimerId> deadline_timers_; // 请求 ID -> 截止时间定时器，只由读线程访问
+    std::thread reader_;
+    std::mutex directory_mutex_; // 握手只做一次，其余调用等它完成
+    std::unordered_map<std::string, uint32_t> method_ids_; // 方法名 -> 方法 ID
+    std::atomic<bool> directory_ready_; // 已完成握手
+    std::atomic<bool> legacy_peer_;     // 对端不认识帧头
+    bool* reader_destroyed_; // 读线程栈上的标志：析构发生在读线程里时置位，读线程据此不再访问成员
+
+    // 读线程：等到有在途调用后，持有自身引用执行 readOnce
+    void readLoop();
+
+    // 收一帧（或等到接收超时）并完成对应的调用，连接断开或已关闭时返回 false
+    bool readOnce();
+
+    // 把新登记的截止时间加到时间轮上（读线程调用，deadlines 是在 pending_mutex_ 下取走的）
+    void scheduleDeadlines(const std::vector<Deadline>& deadlines);
+
+    // 截止时间到了还没有响应：以超时失败（时间轮在读线程里回调）
+    void expire(uint64_t request_id);
+
+    // 从在途表取出调用，已被完成（或撤回）时返回 false；谁取到谁负责完成它。
+    // 截止时间定时器只在读线程里取消：别的线程撤回的调用，定时器到期时发现已被取走，什么也不做
+    bool takePending(uint64_t request_id, PendingCall& call);
+
+    // 请求 ID 为 0 的响应对不上号时（旧版本服务端的错误响应不回显请求 ID），唯一的在途调用就是它的
+    bool takeSolePending(uint64_t& request_id, PendingCall& call);
+
+    // 连接不可用：之后不再接受新调用，所有在途调用以 error 失败完成
+    void failAll(const std::string& error);
+};
+
+}
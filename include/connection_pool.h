@@ -0,0 +1,114 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include "client_connection.h"
+
+namespace rpc {
+
+// 连接池配置
+struct ConnectionPoolConfig {
+    size_t min_connections; // 每个端点至少保持的连接数：空闲回收不会低于它
+    size_t max_connections; // 每个端点最多的连接数
+    size_t max_pending_per_connection; // 连接上的在途调用达到它、且连接数未到上限时，再建一条连接分担
+    uint32_t idle_timeout_ms;      // 连接空闲（没有在途调用、也没被取用）超过它就关闭，0 表示不回收
+    uint32_t unhealthy_backoff_ms; // 端点建连失败后标为不健康，这段时间内不再尝试建连
+
+    ConnectionPoolConfig()
+        :min_connections(1),
+         max_connections(4),
+         max_pending_per_connection(64),
+         idle_timeout_ms(60000),
+         unhealthy_backoff_ms(1000) {}
+};
+
+/**
+ * 客户端连接池：按端点（服务名 + 服务实例 ID + 传输方式）保存已建立的多路复用连接，
+ * 同一进程里的所有 RpcClientStubImpl 共用 instance()，负载均衡器在实例间轮换时直接取已有的连接，不用每次重新建连、握手
+ * 1. acquire 取在途调用最少的连接；都忙（在途调用达到 max_pending_per_connection）且未到 max_connections 时新建一条
+ * 2. 建连失败的端点标为不健康，unhealthy_backoff_ms 内 acquire 直接失败（负载均衡时跳过它），过后再试；建连成功恢复健康
+ * 3. 已断开的连接在取用时移出；超过 idle_timeout_ms 没用过的空闲连接在 acquire 时顺带回收（每个端点保留 min_connections 条）
+ * 建连在池锁外进行，关闭连接（要等读线程退出）也在池锁外进行
+ */
+class ClientConnectionPool {
+public:
+    // 建立一条到端点的连接，失败返回 nullptr
+    using Connector = std::function<std::shared_ptr<ClientConnection>()>;
+
+    explicit ClientConnectionPool(const ConnectionPoolConfig& config = ConnectionPoolConfig());
+    ~ClientConnectionPool();
+
+    ClientConnectionPool(const ClientConnectionPool&) = delete;
+    ClientConnectionPool& operator=(const ClientConnectionPool&) = delete;
+
+    // 进程内共享的连接池
+    static ClientConnectionPool& instance();
+
+    // 端点键：同一服务、同一实例、同样传输方式的连接可以互相替代
+    static std::string makeKey(const std::string& service_name, const std::string& instance_id, const std::string& transport);
+
+    // 取 key 对应端点的一条可用连接，需要新建时调用 connect；端点不健康或建连失败返回 nullptr
+    std::shared_ptr<ClientConnection> acquire(const std::string& key, const Connector& connect);
+
+    // 不建连地取 key 对应端点的一条可用连接：acquire 此时需要建连（没有可用连接，或都忙且还能再建）时返回 nullptr，
+    // 由调用方换到可以阻塞的线程再 acquire。不回收连接，不会阻塞
+    std::shared_ptr<ClientConnection> tryAcquire(const std::string& key);
+
+    // 端点是否可用：不健康且还在退避期内时返回 false，没有记录的端点视为健康
+    bool isHealthy(const std::string& key) const;
+
+    // 关闭所有端点上超时的空闲连接，返回关闭的条数（acquire 也会定期做）
+    size_t reapIdle();
+
+    // 关闭所有连接，清空端点（在途调用以失败完成）
+    void clear();
+
+    // 修改配置，之后的 acquire 按新配置执行
+    void setConfig(const ConnectionPoolConfig& config);
+
+    // 端点当前的连接数
+    size_t connectionCount(const std::string& key) const;
+
+    // 累计建立的连接数
+    uint64_t totalConnects() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // 池中的一条连接
+    struct PooledConnection {
+        std::shared_ptr<ClientConnection> connection;
+        Clock::time_point last_used; // 最近一次被取用或有在途调用的时间
+    };
+
+    // 一个端点的连接与健康状态
+    struct Endpoint {
+        std::vector<PooledConnection> connections;
+        size_t connecting = 0;         // 正在建立（池锁外）的连接数，计入连接上限
+        bool healthy = true;
+        Clock::time_point retry_after; // 不健康时，到这个时间之后才再次尝试建连
+    };
+
+    ConnectionPoolConfig config_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Endpoint> endpoints_;
+    Clock::time_point next_reap_; // 下一次在 acquire 里回收空闲连接的时间
+    uint64_t total_connects_;
+
+    // 移出端点上已断开的连接与超时的空闲连接，放进 retired 由调用方在池锁外关闭（调用方持有 mutex_）
+    void pruneLocked(Endpoint& endpoint, Clock::time_point now, std::vector<std::shared_ptr<ClientConnection>>& retired);
+
+    // 对所有端点执行 pruneLocked，删掉已经空了的端点（还在退避期内的不健康端点保留）（调用方持有 mutex_）
+    void reapLocked(Clock::time_point now, std::vector<std::shared_ptr<ClientConnection>>& retired);
+
+    // 端点上在途调用最少的连接，没有时返回 nullptr（调用方持有 mutex_）
+    static PooledConnection* leastLoaded(Endpoint& endpoint);
+};
+
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "tcp_connection.h"
+#include "mpsc_queue.h"
+#include "slot_map.h"
+#include "timer_wheel.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <sys/epoll.h>
+
+namespace rpc {
+
+// I/O 事件循环（sub-reactor）
+// 每个循环独占一个线程、一个 epoll 实例以及自己的连接集合，
+// 连接一旦交给某个循环，它的读事件、帧解码和关闭都只在这个线程里处理。
+class EventLoop {
+public:
+    using Functor = std::function<void()>;
+
+    static constexpr size_t kDefaultReadBudgetBytes = 256 * 1024; // 每个连接每轮默认最多读 256KB
+    static constexpr size_t kDefaultReadBudgetFrames = 64;        // 每个连接每轮默认最多解码 64 帧
+
+    explicit EventLoop(size_t index);
+    ~EventLoop();
+
+    // 禁用拷贝
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // 启动事件循环线程
+    bool start();
+
+    // 停止事件循环线程，并关闭所有连接
+    void stop();
+
+    // 在循环线程中执行任务（当前就是循环线程时直接执行）
+    void runInLoop(Functor task);
+
+    // 将任务放入队列，唤醒循环线程后执行
+    void queueInLoop(Functor task);
+
+    // 当前线程是否为循环线程
+    bool isInLoopThread() const;
+
+    // 设置每个连接每轮的读取预算（字节数/帧数），必须在 start() 之前调用
+    void setReadBudget(size_t budget_bytes, size_t budget_frames);
+
+    // 设置空闲连接超时（毫秒，0 表示不检测），必须在 start() 之前调用
+    void setIdleTimeout(uint64_t idle_timeout_ms);
+
+    // delay_ms 后在循环线程执行 callback（只能在循环线程调用），返回定时器 ID
+    TimerWheel::TimerId runAfter(uint64_t delay_ms, Functor callback);
+
+    // 取消定时器（只能在循环线程调用），已到期或不存在返回 false
+    bool cancelTimer(TimerWheel::TimerId timer_id);
+
+    // 设置本循环自己的监听 socket（SO_REUSEPORT 模式），必须在 start() 之前调用
+    void setAcceptor(int listen_fd, Functor accept_callback);
+
+    // 接管一个新连接（可在任意线程调用）
+    void addConnection(std::shared_ptr<TcpConnectionImpl> connection);
+
+    // 投递一帧待发送数据（任意线程，无锁），由循环线程合并后写出
+    void queueWrite(std::shared_ptr<TcpConnectionImpl> connection, OutputFrame&& frame);
+
+    // 按连接当前关注的事件更新 epoll（循环线程）
+    void updateConnection(TcpConnectionImpl* connection);
+
+    // 关闭并移除连接（可在任意线程调用）
+    void closeConnection(std::shared_ptr<TcpConnectionImpl> connection);
+
+    // 获取当前连接数
+    size_t getConnectionCount() const;
+
+    // 获取循环编号
+    size_t getIndex() const;
+
+    // 获取运行状态
+    bool isRunning() const;
+
+private:
+    // epoll 保留句柄：代数为 0，连接表永远不会发出
+    static constexpr uint64_t kWakeupHandle = 0xFFFFFFFFull;
+    static constexpr uint64_t kListenHandle = 0xFFFFFFFEull;
+    static constexpr uint64_t kTimerHandle = 0xFFFFFFFDull;
+
+    size_t index_; // 循环编号
+    int epoll_fd_;
+    int wakeup_fd_; // eventfd，用于跨线程唤醒 epoll_wait
+    int timer_fd_;  // timerfd，驱动时间轮
+    int listen_fd_; // 本循环的监听 socket（不持有所有权），-1 表示不负责 accept
+    Functor accept_callback_; // 监听 socket 可读时的回调
+    std::atomic<bool> running_;
+    std::thread thread_; // 循环线程
+    std::atomic<std::thread::id> thread_id_;
+    // 连接表（只在循环线程访问），epoll 的 data.u64 存放连接在表中的句柄，
+    // 连接关闭后旧句柄自动失效，同一批次里残留的事件不会落到已释放或复用了 fd 的连接上
+    SlotMap<std::shared_ptr<TcpConnectionImpl>> connections_;
+    std::atomic<size_t> connection_count_;
+    std::mutex pending_mutex_;
+    std::vector<Functor> pending_functors_; // 待执行任务
+
+    // 待发送的帧
+    struct PendingWrite {
+        std::shared_ptr<TcpConnectionImpl> connection;
+        OutputFrame frame;
+    };
+    MpscQueue<PendingWrite> write_queue_; // 工作线程 -> 循环线程的发送队列
+    std::atomic<bool> write_wakeup_pending_; // 是否已有生产者写过 eventfd，合并唤醒
+
+    size_t read_budget_bytes_;  // 每个连接每轮最多读取的字节数
+    size_t read_budget_frames_; // 每个连接每轮最多解码的帧数
+    std::vector<std::shared_ptr<TcpConnectionImpl>> pending_reads_; // 预算用完、仍可读的连接
+
+    TimerWheel timer_wheel_;       // 时间轮（只在循环线程访问）
+    uint64_t timer_deadline_ms_;   // timerfd 当前设定的到期时刻，0 表示未设定
+    uint64_t idle_timeout_ms_;     // 空闲连接超时，0 表示不检测
+
+    // 循环线程主函数
+    void loopMain();
+
+    // 唤醒循环线程
+    void wakeup();
+
+    // 处理唤醒事件
+    void handleWakeup();
+
+    // 处理 timerfd 事件：推进时间轮
+    void handleTimer();
+
+    // 按时间轮最近的到期时刻设置 timerfd（只会提前，不会推后）
+    void scheduleTimerFd();
+
+    // 为连接启动空闲检测定时器
+    void startIdleTimer(uint64_t handle, uint64_t delay_ms);
+
+    // 空闲检测定时器到期：仍然空闲则关闭，否则按剩余时间重新计时
+    void handleIdleTimeout(uint64_t handle);
+
+    // 执行待处理任务
+    void doPendingFunctors();
+
+    // 取出发送队列中的所有帧，按连接分组后各用一次 sendmsg 写出
+    void flushPendingWrites();
+
+    // 将连接注册到 epoll（循环线程）
+    void registerConnection(const std::shared_ptr<TcpConnectionImpl>& connection);
+
+    // 处理客户端事件
+    void handleClientEvent(const struct epoll_event& event);
+
+    // 处理读事件：读到 EAGAIN 或用完预算，返回 true 表示预算用完仍可读
+    bool handleClientRead(TcpConnectionImpl* connection);
+
+    // 将预算用完的连接放入待读列表
+    void schedulePendingRead(TcpConnectionImpl* connection);
+
+    // 处理待读列表
+    void processPendingReads();
+
+    // 处理关闭事件
+    void handleClientClose(TcpConnectionImpl* connection);
+
+    // 关闭所有连接
+    void closeAllConnections();
+};
+
+}
@@ -1,28 +1,97 @@
 #pragma once
 
-#include "tcp_connection.h"
+#include "buffer.h"
 #include <memory>        // 智能指针相关头文件
 #include <vector>        // 向量容器头文件
 #include <cstdint>       // 固定宽度整数类型头文件
 #include <functional>    // 函数对象头文件
+#include <iostream>
 
 namespace rpc {
 
 class TcpConnection;
 
+// 缓冲区开头一帧的状态
+enum class FrameStatus {
+    kIncomplete, // 半包，等待更多数据
+    kComplete,   // 帧完整
+    kInvalid     // 长度非法（0 或超过上限），数据流已无法继续解析
+};
+
+// 同步客户端把接收缓冲区读到指定长度的结果
+enum class FillStatus {
+    kFilled,  // 数据已够
+    kTimeout, // 接收超时：连接仍可用，由调用方决定是否继续等
+    kFailed   // 对端关闭或出错，连接已不可用
+};
+
 // 编解码器
 class FrameCodec {
 public:
+    static constexpr size_t kHeaderSize = 4;                    // 长度前缀
+    static constexpr uint32_t kMaxFrameSize = 10 * 1024 * 1024; // 最大帧长 10MB
+
     FrameCodec() = default;
     ~FrameCodec() = default;
 
     // 编码：消息长度+消息正文
     std::vector<uint8_t> encode(const std::vector<uint8_t>& message);
 
-    // 解码：将buffer解码至message
-    bool decode(std::vector<uint8_t>& buffer, std::vector<uint8_t>& message);
+    // 原地编码：消息已写在 message 里，长度前缀写进它的预留头部，不搬动正文
+    void encode(Buffer& message);
+
+    // 检查缓冲区开头的一帧（不移除数据），Buffer 与 IoBuf 通用；完整时 body_length 为帧体长度。
+    // 各传输层的切帧都经过这里，长度校验只有这一份
+    template<typename InputBuffer>
+    static FrameStatus inspect(const InputBuffer& buffer, uint32_t& body_length) {
+        if (buffer.readableBytes() < kHeaderSize) {
+            return FrameStatus::kIncomplete;
+        }
+        body_length = buffer.template peekInt<uint32_t>();
+        if (body_length == 0 || body_length > kMaxFrameSize) {
+            return FrameStatus::kInvalid;
+        }
+        if (buffer.readableBytes() < kHeaderSize + body_length) {
+            return FrameStatus::kIncomplete;
+        }
+        return FrameStatus::kComplete;
+    }
+
+    // 流式解码一帧：帧体以视图返回，只前移读指针，不搬动后面的数据（Buffer 只在空间不够时才整理一次）。
+    // 视图在下一次向 buffer 写入之前有效
+    FrameStatus decode(Buffer& buffer, const uint8_t*& body, size_t& body_length) const;
+
+    // 流式解码一帧，帧体拷到 message
+    FrameStatus decode(Buffer& buffer, std::vector<uint8_t>& message) const;
+
+    // 同步读取一帧（各同步客户端的 receive 共用）：fill(n) 把 buffer 读到至少 n 字节，返回 FillStatus。
+    // 多读进来的后续帧留在 buffer 里，下一次直接解码；out 与 decode 相同，拷进 vector 或以视图返回。
+    // 超时返回 false 但不打印错误：多路复用连接的读线程靠接收超时定期检查过期调用，超时是常态
+    template<typename Fill, typename... Out>
+    bool readFrame(Buffer& buffer, Fill&& fill, Out&... out) const {
+        FillStatus status = fill(kHeaderSize);
+        if (status != FillStatus::kFilled) {
+            if (status == FillStatus::kFailed) {
+                std::cerr << "Failed to read length prefix" << std::endl;
+            }
+            return false;
+        }
+        uint32_t length = 0;
+        if (inspect(buffer, length) == FrameStatus::kInvalid) {
+            std::cerr << "Invalid message length: " << length << std::endl;
+            return false;
+        }
+        status = fill(kHeaderSize + length);
+        if (status != FillStatus::kFilled) {
+            if (status == FillStatus::kFailed) {
+                std::cerr << "Failed to read message data" << std::endl;
+            }
+            return false;
+        }
+        return decode(buffer, out...) == FrameStatus::kComplete;
+    }
 
-    // 获取消息长度
+    // 获取消息头长度
     size_t getHeaderSize() const;
 
 private:
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rpc {
+
+class IoBuf;
+
+/**
+ * 定长二进制帧头（长度前缀之后、消息体之前）
+ * 布局（网络序，共 24 字节）：
+ *   magic(2) version(1) flags(1) header_length(2) compression(1) reserved(1)
+ *   request_id(8) method_id(4) deadline_ms(4)
+ * 特点：
+ * 1. 服务端不解析 protobuf 就能拿到请求 ID、方法 ID 和截止时间，路由、超时设置和过载保护都在解析之前完成
+ * 2. 请求的消息体直接是方法的请求消息，不再包一层 RpcRequestProto；响应成功时是响应消息，失败时是错误信息
+ * 3. 魔数首字节的低 3 位是 7（protobuf 没有这种 wire type），旧格式的帧体（RpcRequestProto）不可能以它开头，
+ *    服务端据此区分新旧格式，旧客户端照常工作
+ * 4. header_length 允许同一版本在尾部追加字段，接收方按它跳到消息体
+ */
+struct FrameHeader {
+    static constexpr uint16_t kMagic = 0xF752;
+    static constexpr uint8_t kVersion = 1;
+    static constexpr size_t kSize = 24;
+
+    // flags
+    static constexpr uint8_t kFlagResponse = 0x01; // 响应帧
+    static constexpr uint8_t kFlagError = 0x02;    // 响应失败，消息体是错误信息
+    static constexpr uint8_t kFlagHandshake = 0x04; // 握手：消息体是 MethodDirectoryProto，不走方法分发
+
+    // compression
+    static constexpr uint8_t kCompressionNone = 0;
+
+    uint8_t version;
+    uint8_t flags;
+    uint16_t header_length; // 帧头总长，消息体从这里开始
+    uint8_t compression;    // 消息体压缩算法
+    uint64_t request_id;
+    uint32_t method_id;     // 方法 ID：服务端注册时分配，客户端握手时取回
+    uint32_t deadline_ms;   // 请求的剩余时间预算（毫秒，相对值，不依赖两端时钟同步），0 表示不限
+
+    FrameHeader()
+        :version(kVersion),
+         flags(0),
+         header_length(static_cast<uint16_t>(kSize)),
+         compression(kCompressionNone),
+         request_id(0),
+         method_id(0),
+         deadline_ms(0) {}
+
+    // 帧体是否以帧头开始（只看魔数）
+    static bool detect(const uint8_t* data, size_t len);
+    static bool detect(const IoBuf& body);
+
+    // 写出 kSize 字节的帧头
+    void encode(uint8_t* out) const;
+
+    // 从帧体开头解析帧头：长度不够或 header_length 非法时返回 false（版本号由调用方检查）
+    bool decode(const uint8_t* data, size_t len);
+    bool decode(const IoBuf& body);
+
+private:
+    // 解析定长部分（调用方已确认有 kSize 字节且魔数正确）
+    void decodeFixed(const uint8_t* data);
+};
+
+} // namespace rpc
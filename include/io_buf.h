@@ -0,0 +1,249 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <sys/types.h>
+#include "slab_pool.h"
+
+namespace rpc {
+
+// 引用计数的内存块：块头后紧跟数据区
+struct IoBufBlock {
+    std::atomic<uint32_t> refs; // 引用计数，归零时还给块池
+    uint32_t capacity;          // 数据区大小
+    uint32_t used;              // 已写入字节数（只有持有写权的 IoBuf 推进）
+
+    uint8_t* data() {
+        return reinterpret_cast<uint8_t*>(this + 1);
+    }
+};
+
+// IoBuf 的块分配：块头连同数据区从 SlabPool 整块分配，定长块正好占满一个规格
+class IoBufBlockPool {
+public:
+    static constexpr size_t kBlockAllocSize = 16 * 1024;                        // 定长块整体大小
+    static constexpr size_t kBlockSize = kBlockAllocSize - sizeof(IoBufBlock);  // 定长块数据区大小
+    static constexpr size_t kMaxPooledCapacity = SlabPool::kMaxClassSize - sizeof(IoBufBlock); // 仍由 SlabPool 缓存的最大数据区
+
+    // 分配至少 min_capacity 字节的块（数据区向上取到规格大小），引用计数为 1
+    static IoBufBlock* allocate(size_t min_capacity = kBlockSize);
+
+    static void retain(IoBufBlock* block);
+    static void release(IoBufBlock* block);
+};
+
+/**
+ * 链式缓冲区
+ * 特点：
+ * 1. 数据存放在 SlabPool 分配的定长块中，由若干段（块 + 偏移 + 长度）串起来，追加时不搬移已有数据
+ * 2. 块带引用计数，cutFront() 切出的帧与原缓冲区共享块，不拷贝；段全部释放后块回到块池
+ * 3. 只有缓冲区自己的尾块（写块）可以继续写入，切出的视图只读，可以安全地交给其他线程
+ * 4. 接口与 Buffer 保持一致（peek/retrieve/append/readFromFd），解码时整帧多数落在一段内，可直接拿指针
+ */
+class IoBuf {
+public:
+    // 一段数据
+    struct Slice {
+        IoBufBlock* block;
+        uint32_t offset;
+        uint32_t length;
+
+        const uint8_t* data() const {
+            return block->data() + offset;
+        }
+    };
+
+    static constexpr int kMaxReadBlocks = 4; // readFromFd 一次最多新挂的定长块数，要读更多时改挂一个大块
+
+    IoBuf();
+    ~IoBuf();
+
+    // 拷贝只增加块的引用计数（副本没有写块）
+    IoBuf(const IoBuf& other);
+    IoBuf& operator=(const IoBuf& other);
+    IoBuf(IoBuf&& other) noexcept;
+    IoBuf& operator=(IoBuf&& other) noexcept;
+
+    // 可读字节数
+    size_t readableBytes() const {
+        return readable_;
+    }
+
+    bool empty() const {
+        return readable_ == 0;
+    }
+
+    // 段数
+    size_t sliceCount() const {
+        return slices_.size();
+    }
+
+    // 是否只有一段（可以直接用 peek() 访问全部数据）
+    bool isContiguous() const {
+        return slices_.size() <= 1;
+    }
+
+    // 第一段的起始地址与长度
+    const uint8_t* peek() const;
+    size_t contiguousBytes() const;
+
+    // 从 offset 开始拷出 len 字节，数据不足返回 false
+    bool copyOut(void* dest, size_t len, size_t offset = 0) const;
+
+    // 读取整数（网络字节序转主机字节序，可以跨段）
+    template<typename T>
+    T peekInt() const {
+        static_assert(std::is_integral<T>::value, "T must be an integral type");
+        uint8_t bytes[sizeof(T)];
+        const uint8_t* source = bytes;
+        if (contiguousBytes() >= sizeof(T)) {
+            source = peek();  // 多数情况整数落在第一段内
+        } else if (!copyOut(bytes, sizeof(T))) {
+            throw std::runtime_error("IoBuf has insufficient data for peekInt");
+        }
+        typename std::make_unsigned<T>::type value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            value = static_cast<typename std::make_unsigned<T>::type>((value << 8) | source[i]);
+        }
+        return static_cast<T>(value);
+    }
+
+    // 移除前 len 字节
+    void retrieve(size_t len);
+    void retrieveAll();
+
+    // 零拷贝切出前 len 字节（与本缓冲区共享块）
+    IoBuf cutFront(size_t len);
+
+    // 拷贝出前 len 字节并移除
+    std::vector<uint8_t> retrieveAsVector(size_t len);
+    std::vector<uint8_t> retrieveAllAsVector();
+
+    // 拷贝出全部数据（不移除）
+    std::vector<uint8_t> toVector() const;
+    std::string toString() const;
+
+    // 合并成一段并返回起始地址（多段时拷贝一次）
+    const uint8_t* coalesce();
+
+    // 追加数据：先填满写块，剩余部分按需分配新块
+    void append(const void* data, size_t len);
+    void append(const std::vector<uint8_t>& data) {
+        append(data.data(), data.size());
+    }
+    void append(const std::string& data) {
+        append(data.data(), data.size());
+    }
+
+    // 追加另一个缓冲区的全部段（不拷贝数据）
+    void append(IoBuf&& other);
+
+    // 从 fd 读取最多约 read_size 字节：readv 同时填写块剩余空间和按需挂上的新块，不经过栈上临时缓冲区；
+    // 超过 kMaxReadBlocks 个定长块的读取改用一个连续大块，大帧只有内核到块的一次拷贝
+    ssize_t readFromFd(int fd, int* saved_errno, size_t read_size = IoBufBlockPool::kBlockSize);
+
+    // 依次访问每一段（如拼 iovec 或 protobuf 零拷贝输入流）
+    template<typename Func>
+    void forEachSlice(Func func) const {
+        for (const Slice& slice : slices_) {
+            func(slice.data(), static_cast<size_t>(slice.length));
+        }
+    }
+
+private:
+    // 段队列：尾部追加、头部弹出。前两段存在对象内部（切出的帧通常只有一段，构造/销毁都不分配内存），
+    // 更多时换到 SlabPool 分配的存储；弹出只前移头下标，尾部满了再把剩余段挪回开头
+    class SliceQueue {
+    public:
+        SliceQueue() : data_(inline_), head_(0), tail_(0), capacity_(kInlineSlices) {}
+        ~SliceQueue() {
+            releaseStorage();
+        }
+        SliceQueue(const SliceQueue& other) : SliceQueue() {
+            *this = other;
+        }
+        SliceQueue& operator=(const SliceQueue& other) {
+            if (this != &other) {
+                clear();
+                for (const Slice& slice : other) {
+                    push_back(slice);
+                }
+            }
+            return *this;
+        }
+        SliceQueue(SliceQueue&& other) noexcept : SliceQueue() {
+            *this = std::move(other);
+        }
+        SliceQueue& operator=(SliceQueue&& other) noexcept;
+
+        bool empty() const {
+            return head_ == tail_;
+        }
+        size_t size() const {
+            return tail_ - head_;
+        }
+        Slice& front() {
+            return data_[head_];
+        }
+        const Slice& front() const {
+            return data_[head_];
+        }
+        Slice& back() {
+            return data_[tail_ - 1];
+        }
+        void push_back(const Slice& slice) {
+            if (tail_ == capacity_) {
+                makeRoom();
+            }
+            data_[tail_++] = slice;
+        }
+        void pop_front() {
+            if (++head_ == tail_) {
+                head_ = 0;
+                tail_ = 0;
+            }
+        }
+        void clear() {
+            head_ = 0;
+            tail_ = 0;
+        }
+        const Slice* begin() const {
+            return data_ + head_;
+        }
+        const Slice* end() const {
+            return data_ + tail_;
+        }
+
+    private:
+        static constexpr uint32_t kInlineSlices = 2;
+
+        Slice inline_[kInlineSlices];
+        Slice* data_;       // inline_ 或堆上存储
+        uint32_t head_;
+        uint32_t tail_;
+        uint32_t capacity_;
+
+        // 尾部已满：头部有空位就挪回开头，否则扩容一倍
+        void makeRoom();
+        void releaseStorage();
+    };
+
+    SliceQueue slices_;
+    size_t readable_;
+    IoBufBlock* write_block_; // 独占写入的尾块（持有一份引用），没有时为空
+
+    // 记录写块上新写入的 len 字节（与上一段相连时合并）
+    void commitWrite(size_t len);
+
+    // 释放写块
+    void releaseWriteBlock();
+
+    void clear();
+};
+
+} // namespace rpc
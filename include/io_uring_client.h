@@ -0,0 +1,85 @@
+#pragma once
+
+#include "tcp_client.h"
+#include "io_uring_ring.h"
+#include "buffer.h"
+#include <mutex>
+
+namespace rpc {
+
+// io_uring 后端的 TCP 客户端：接口与 TcpClientImpl 一致（同步收发），
+// 每个操作带 IORING_OP_LINK_TIMEOUT 链接超时，提交与等待合并为一次 io_uring_enter
+class IoUringTcpClient : public TcpClient {
+public:
+    static constexpr int64_t kConnectTimeoutMs = 5000; // 连接超时
+    static constexpr int64_t kIoTimeoutMs = 5000;      // 收发超时
+
+    IoUringTcpClient();
+    ~IoUringTcpClient();
+
+    // 连接服务器
+    bool connect(const std::string& host, uint16_t port) override;
+
+    // 断开连接
+    void disconnect() override;
+
+    // 关闭读写两个方向，唤醒阻塞在收发里的线程
+    void shutdown() override;
+
+    // 发送消息（调用方已加好长度前缀）
+    bool send(const std::vector<uint8_t>& data) override;
+    bool send(const Buffer& frame) override;
+
+    // 接收一帧消息（去掉 4 字节长度前缀）
+    bool receive(std::vector<uint8_t>& data) override;
+    bool receive(const uint8_t*& data, size_t& length) override;
+
+    // 设置接收超时（默认 kIoTimeoutMs）
+    void setReceiveTimeout(uint32_t timeout_ms) override;
+
+    // 设置发送超时（默认 kIoTimeoutMs）
+    void setSendTimeout(uint32_t timeout_ms) override;
+
+    // 获取连接状态
+    ConnectionState getState() const override;
+
+    // 设置回调
+    void setMessageCallback(MessageCallback callback) override;
+    void setConnectionCallback(ConnectionCallback callback) override;
+    void setErrorCallback(ErrorCallback callback) override;
+
+    // 返回服务器地址
+    std::string getServerAddress() const;
+
+private:
+    int sockfd_;
+    std::atomic<ConnectionState> state_;
+    std::atomic<uint32_t> receive_timeout_ms_;
+    std::atomic<uint32_t> send_timeout_ms_;
+    std::string server_addr_;
+    IoUringRing send_ring_;     // 收发各用一个 ring：一个线程阻塞在 recv 时，另一个线程照常发送
+    IoUringRing receive_ring_;
+    bool ring_ready_;
+    std::mutex send_mutex_;     // ring 只能由一个线程使用
+    std::mutex receive_mutex_;
+    Buffer input_buffer_;   // 一次 recv 可能带回多帧或半帧
+    FrameCodec frame_codec_;
+
+    MessageCallback message_callback_;
+    ConnectionCallback connection_callback_;
+    ErrorCallback error_callback_;
+
+    // 给已填写的操作附加链接超时并提交，等待两者都完成，返回操作结果（超时返回 -ETIMEDOUT）
+    int runWithTimeout(IoUringRing& ring, struct io_uring_sqe* op_sqe, int64_t timeout_ms);
+
+    // 读到输入缓冲区至少有 length 字节，超时与连接失败分开报告
+    FillStatus fill(size_t length);
+
+    // 发送 length 字节（两个 send 共用）
+    bool sendBytes(const uint8_t* data, size_t length);
+
+    // 处理错误：只标记断开，socket 在 disconnect() / 重连时关闭（另一方向可能正在使用）
+    void handleError(const std::string& error_msg);
+};
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <linux/io_uring.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace rpc {
+
+/**
+ * io_uring 的最小封装（直接使用系统调用，不依赖 liburing）
+ * 特点：
+ * 1. getSqe() 只在用户态填写提交队列，submit()/submitAndWait() 一次 io_uring_enter 批量提交并等待
+ * 2. forEachCqe() 遍历并消费完成队列
+ * 3. 支持注册一个 provided buffer ring，供多发（multishot）recv 按需取用缓冲区
+ * 4. 非线程安全：一个 ring 只由一个线程使用
+ */
+class IoUringRing {
+public:
+    IoUringRing();
+    ~IoUringRing();
+
+    // 禁用拷贝
+    IoUringRing(const IoUringRing&) = delete;
+    IoUringRing& operator=(const IoUringRing&) = delete;
+
+    // 创建 ring，entries 为提交队列长度
+    bool init(unsigned entries);
+
+    // 释放 ring 与 buffer ring
+    void exit();
+
+    // 当前内核是否支持本项目用到的全部特性（多发 accept/recv、provided buffer ring、带超时等待）
+    static bool isSupported();
+
+    // 取一个空闲 SQE（已清零），提交队列满时先提交再取，仍然失败返回 nullptr
+    struct io_uring_sqe* getSqe();
+
+    // 提交队列剩余空位（用于保证一条链接链不被拆到两次提交里）
+    unsigned sqSpaceLeft() const;
+
+    // 提交所有已填写的 SQE，返回提交个数，失败返回 -errno
+    int submit();
+
+    // 提交并至少等待 wait_nr 个完成事件，timeout_ms < 0 表示一直等
+    int submitAndWait(unsigned wait_nr, int64_t timeout_ms);
+
+    // 遍历完成队列，对每个 CQE 调用 func，遍历完统一推进队头，返回处理个数
+    template<typename Func>
+    unsigned forEachCqe(Func func) {
+        unsigned head = *cq_khead_;
+        unsigned tail = __atomic_load_n(cq_ktail_, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+        while (head != tail) {
+            func(cqes_[head & *cq_kring_mask_]);
+            ++head;
+            ++count;
+        }
+        __atomic_store_n(cq_khead_, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    // 注册 provided buffer ring：entries 个（2 的幂）大小为 buffer_size 的缓冲区，组号 group_id
+    bool setupBufferRing(uint16_t group_id, unsigned entries, size_t buffer_size);
+
+    // 按缓冲区编号取地址
+    uint8_t* getBuffer(uint16_t buffer_id) const;
+
+    // 缓冲区用完后归还给内核
+    void recycleBuffer(uint16_t buffer_id);
+
+    size_t getBufferSize() const;
+
+    int getFd() const;
+
+private:
+    int ring_fd_;
+    unsigned features_;
+
+    // 提交队列
+    void* sq_ring_ptr_;
+    size_t sq_ring_size_;
+    unsigned* sq_khead_;
+    unsigned* sq_ktail_;
+    unsigned* sq_kring_mask_;
+    unsigned* sq_kring_entries_;
+    unsigned* sq_array_;
+    struct io_uring_sqe* sqes_;
+    size_t sqes_size_;
+    unsigned sqe_head_;  // 已提交给内核的位置
+    unsigned sqe_tail_;  // 已填写的位置
+
+    // 完成队列（IORING_FEAT_SINGLE_MMAP 时与提交队列共用一次映射）
+    void* cq_ring_ptr_;
+    size_t cq_ring_size_;
+    unsigned* cq_khead_;
+    unsigned* cq_ktail_;
+    unsigned* cq_kring_mask_;
+    struct io_uring_cqe* cqes_;
+
+    // provided buffer ring
+    struct io_uring_buf_ring* buf_ring_;
+    size_t buf_ring_size_;
+    uint8_t* buffers_;
+    size_t buffers_size_;
+    size_t buffer_size_;
+    unsigned buf_entries_;
+    uint16_t buf_group_id_;
+    uint16_t buf_tail_;
+
+    // 把已填写的 SQE 发布给内核，返回待提交个数
+    unsigned flushSq();
+
+    // 调用 io_uring_enter
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags, const void* arg, size_t arg_size);
+};
+
+}
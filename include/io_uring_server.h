@@ -0,0 +1,268 @@
+#pragma once
+
+#include "tcp_server.h"
+#include "tcp_connection.h"
+#include "io_uring_ring.h"
+#include "mpsc_queue.h"
+#include "slot_map.h"
+#include "timer_wheel.h"
+#include "socket_address.h"
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rpc {
+
+class IoUringLoop;
+
+// io_uring 后端的连接：接口与 TcpConnectionImpl 一致，收发都由所属 IoUringLoop 通过 ring 完成
+class IoUringConnection : public TcpConnection {
+public:
+    static constexpr size_t kDefaultHighWaterMark = 64 * 1024 * 1024; // 默认高水位 64MB
+
+    IoUringConnection(int sockfd, const std::string& peer_addr, IoUringLoop* loop);
+    ~IoUringConnection();
+
+    // 发送数据：投递到所属循环的发送队列（可在任意线程调用）
+    bool send(const std::vector<uint8_t>& data) override;
+    bool send(std::vector<uint8_t>&& data) override;
+
+    // 关闭连接（可在任意线程调用）
+    void close() override;
+
+    ConnectionState getState() const override;
+    std::string getRemoteAddress() const override;
+
+    void setMessageCallback(MessageCallback callback) override;
+    void setConnectionCallback(ConnectionCallback callback) override;
+    void setWriteCompleteCallback(WriteCompleteCallback callback) override;
+    void setErrorCallback(ErrorCallback callback) override;
+    void setHighWaterMarkCallback(HighWaterMarkCallback callback, size_t high_water_mark) override;
+    void setLowWaterMarkCallback(LowWaterMarkCallback callback, size_t low_water_mark) override;
+
+    // 暂停/恢复读取：取消/重新提交多发 recv（可在任意线程调用）
+    void startReading() override;
+    void stopReading() override;
+
+    // 在所属循环的时间轮上注册定时器（循环线程调用）
+    uint64_t runAfter(uint64_t delay_ms, std::function<void()> callback) override;
+
+    // 取消 runAfter 注册的定时器（循环线程调用）
+    bool cancelTimer(uint64_t timer_id) override;
+
+    // 投递任务到所属循环（任意线程调用）
+    void queueInLoop(std::function<void()> task) override;
+
+    MessageCallback& getMessageCallback() override;
+    ConnectionCallback& getConnectionCallback() override;
+    WriteCompleteCallback& getWriteCompleteCallback() override;
+    ErrorCallback& getErrorCallback() override;
+
+    int getSocketFd() const;
+
+    // 获取输出积压字节数（已投递、尚未发送完成）
+    size_t getPendingOutputBytes() const;
+
+private:
+    friend class IoUringLoop;
+
+    int sockfd_;
+    std::string peer_addr_;
+    std::atomic<ConnectionState> state_;
+    IoUringLoop* loop_;
+    std::atomic<bool> reading_;
+    std::atomic<size_t> pending_output_bytes_;
+
+    // 以下只在循环线程访问
+    uint64_t handle_;                 // 在所属循环连接表中的句柄
+    Buffer input_buffer_;             // 输入缓冲区
+    bool recv_armed_;                 // 是否有多发 recv 在内核中
+    bool closing_;                    // 正在关闭，等待内核中的操作全部完成
+    int pending_ops_;                 // 内核中尚未完成的操作数
+    // 一次 SENDMSG 聚集写出的一批帧；帧、iovec 与 msghdr 在完成前必须保持有效（deque 尾部追加不移动已有元素）
+    struct SendBatch {
+        std::vector<std::vector<uint8_t>> frames;
+        std::vector<struct iovec> iov;
+        struct msghdr msg;
+        size_t bytes;
+    };
+    std::deque<SendBatch> sending_;   // 已提交给内核的批次
+    std::vector<std::vector<uint8_t>> waiting_; // 等当前链完成后再提交的帧
+    bool above_high_water_;
+    size_t high_water_mark_;
+    size_t low_water_mark_;
+    uint64_t last_active_ms_;
+    uint64_t idle_timer_id_;
+
+    MessageCallback message_callback_;
+    ConnectionCallback connection_callback_;
+    WriteCompleteCallback write_complete_callback_;
+    ErrorCallback error_callback_;
+    HighWaterMarkCallback high_water_mark_callback_;
+    LowWaterMarkCallback low_water_mark_callback_;
+};
+
+// io_uring 事件循环：一个线程一个 ring，多发 accept 接收新连接，多发 recv + provided buffer ring 读取，
+// 同一连接的多帧聚集成 SENDMSG，多个 SENDMSG 用 IOSQE_IO_LINK 串成一条发送链，一次 io_uring_enter 同时完成提交与等待
+class IoUringLoop {
+public:
+    using Functor = std::function<void()>;
+    using NewConnectionCallback = std::function<bool(int sockfd)>; // 返回 false 表示拒绝
+
+    static constexpr unsigned kRingEntries = 4096;     // 提交队列长度
+    static constexpr unsigned kBufferCount = 1024;     // provided buffer 个数
+    static constexpr size_t kBufferSize = 16 * 1024;   // 每个 provided buffer 大小
+    static constexpr size_t kMaxSendIovecs = 64;       // 一次 SENDMSG 最多聚集的帧数
+    static constexpr size_t kMaxLinkedSends = 16;      // 一条发送链最多的 SENDMSG 数
+
+    explicit IoUringLoop(size_t index);
+    ~IoUringLoop();
+
+    // 禁用拷贝
+    IoUringLoop(const IoUringLoop&) = delete;
+    IoUringLoop& operator=(const IoUringLoop&) = delete;
+
+    // 设置本循环的监听 socket 与新连接回调，必须在 start() 之前调用
+    void setAcceptor(int listen_fd, NewConnectionCallback callback);
+
+    // 设置空闲连接超时，必须在 start() 之前调用
+    void setIdleTimeout(uint64_t idle_timeout_ms);
+
+    // 设置建立连接后交给上层的回调
+    void setConnectionCallback(ConnectionCallback callback);
+
+    // 启动/停止循环线程
+    bool start();
+    void stop();
+
+    // 在循环线程中执行任务
+    void runInLoop(Functor task);
+    void queueInLoop(Functor task);
+    bool isInLoopThread() const;
+
+    // 投递一帧待发送数据（任意线程，无锁）
+    void queueWrite(std::shared_ptr<IoUringConnection> connection, std::vector<uint8_t>&& frame);
+
+    // 关闭连接（任意线程）
+    void closeConnection(std::shared_ptr<IoUringConnection> connection);
+
+    // 暂停/恢复读取（循环线程）
+    void updateReading(IoUringConnection* connection);
+
+    // 定时器（循环线程）
+    TimerWheel::TimerId runAfter(uint64_t delay_ms, Functor callback);
+    bool cancelTimer(TimerWheel::TimerId timer_id);
+
+    size_t getConnectionCount() const;
+    size_t getIndex() const;
+
+private:
+    // user_data 高 8 位为操作类型，低 56 位为连接句柄（代数只保留低 24 位）
+    enum Op : uint64_t {
+        kOpAccept = 1,
+        kOpWakeup = 2,
+        kOpRecv = 3,
+        kOpSend = 4,
+        kOpCancel = 5
+    };
+    static constexpr int kOpShift = 56;
+    static constexpr uint64_t kHandleMask = (uint64_t(1) << kOpShift) - 1;
+    static constexpr uint32_t kGenerationMask = 0xFFFFFF;
+    static constexpr uint16_t kBufferGroupId = 0;
+
+    size_t index_;
+    FrameCodec frame_codec_; // 切帧（长度校验与 TcpConnectionImpl 共用）
+    IoUringRing ring_;
+    int listen_fd_;
+    NewConnectionCallback new_connection_callback_;
+    ConnectionCallback connection_callback_;
+    int wakeup_fd_;
+    uint64_t wakeup_value_;  // eventfd 读缓冲区，读请求在内核中时必须有效
+    std::atomic<bool> running_;
+    std::thread thread_;
+    std::atomic<std::thread::id> thread_id_;
+    SlotMap<std::shared_ptr<IoUringConnection>> connections_;
+    std::atomic<size_t> connection_count_;
+    std::mutex pending_mutex_;
+    std::vector<Functor> pending_functors_;
+
+    struct PendingWrite {
+        std::shared_ptr<IoUringConnection> connection;
+        std::vector<uint8_t> frame;
+    };
+    MpscQueue<PendingWrite> write_queue_;
+    std::atomic<bool> write_wakeup_pending_;
+
+    TimerWheel timer_wheel_;
+    uint64_t idle_timeout_ms_;
+
+    void loopMain();
+    void wakeup();
+
+    // 提交各类请求
+    struct io_uring_sqe* getSqe();
+    void armAccept();
+    void armWakeup();
+    void armRecv(IoUringConnection* connection);
+    void submitSends(IoUringConnection* connection);
+    void cancelRecv(IoUringConnection* connection);
+
+    // 处理完成事件
+    void handleCqe(const struct io_uring_cqe& cqe);
+    void handleAccept(const struct io_uring_cqe& cqe);
+    void handleRecv(IoUringConnection* connection, const struct io_uring_cqe& cqe);
+    void handleSend(IoUringConnection* connection, const struct io_uring_cqe& cqe);
+
+    // 注册新连接
+    void addConnection(int sockfd);
+
+    // 开始关闭：shutdown 让内核中的操作尽快结束，全部完成后 finishClose 释放
+    void beginClose(IoUringConnection* connection);
+    void maybeFinishClose(IoUringConnection* connection);
+
+    void doPendingFunctors();
+    void flushPendingWrites();
+    void startIdleTimer(uint64_t handle, uint64_t delay_ms);
+    void handleIdleTimeout(uint64_t handle);
+    void closeAllConnections();
+
+    static uint64_t makeUserData(Op op, uint64_t handle);
+};
+
+// io_uring 后端的 TCP 服务器：接口与 TcpServerImpl 一致，由 createTcpServer 按配置选择
+class IoUringTcpServer : public TcpServer {
+public:
+    explicit IoUringTcpServer(const TcpServerConfig& config = TcpServerConfig());
+    ~IoUringTcpServer();
+
+    bool start(uint16_t port, const std::string& host = "0.0.0.0") override;
+    void stop() override;
+    void setConnectionCallback(ConnectionCallback callback) override;
+    bool isRunning() const override;
+
+    // 获取当前连接数
+    size_t getConnectionCount() const;
+
+    // 获取 I/O 循环数
+    size_t getIoLoopCount() const;
+
+private:
+    TcpServerConfig config_;
+    SocketAddress listen_addr_;
+    std::vector<int> listen_fds_;
+    std::vector<std::unique_ptr<IoUringLoop>> loops_;
+    std::atomic<bool> running_;
+    ConnectionCallback connection_callback_;
+
+    int createListenSocket(const SocketAddress& address, bool reuse_port);
+    void closeListenSockets();
+};
+
+}
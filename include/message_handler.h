@@ -29,7 +29,8 @@ public:
 
 private:
     std::unique_ptr<FrameCodec> codec_; // 编解码器
-    std::vector<uint8_t> receive_buffer_; // 接收缓冲区:保存网络数据
+    Buffer receive_buffer_; // 接收缓冲区:保存网络数据，解码只前移读指针
+    std::vector<uint8_t> message_; // 交给回调的帧体，跨帧复用容量
     MessageCallback message_callback_; // 回调
 
 };
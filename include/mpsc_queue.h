@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace rpc {
+
+/**
+ * 无锁多生产者单消费者队列（Vyukov MPSC）
+ * 特点：
+ * 1. push 只做一次原子 exchange，任意线程可并发调用，不会阻塞
+ * 2. pop 只能由唯一的消费者线程（I/O 循环）调用
+ * 3. 生产者 push 到一半时 pop 可能暂时返回 false，消费者稍后重试即可
+ */
+template<typename T>
+class MpscQueue {
+public:
+    MpscQueue()
+        : head_(new Node())
+        , tail_(head_.load()) {
+    }
+
+    ~MpscQueue() {
+        T value;
+        while (pop(value)) {
+        }
+        delete tail_;
+    }
+
+    // 禁用拷贝
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // 入队（任意线程）
+    void push(T value) {
+        Node* node = new Node(std::move(value));
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // 出队（仅消费者线程），队列为空返回 false
+    bool pop(T& value) {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        value = std::move(next->value);
+        tail_ = next;
+        delete tail;
+        return true;
+    }
+
+    // 是否为空（仅消费者线程）
+    bool empty() const {
+        return tail_->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next;
+        T value;
+
+        Node() : next(nullptr) {}
+        explicit Node(T&& v) : next(nullptr), value(std::move(v)) {}
+    };
+
+    std::atomic<Node*> head_;  // 生产者端
+    Node* tail_;               // 消费者端（当前哑节点）
+};
+
+} // namespace rpc
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace rpc {
+
+/**
+ * 可跨线程归还的对象池（按类型全局共享，接口均为静态）
+ * 特点：
+ * 1. 每个线程最多缓存 kThreadCacheSize 个空闲对象，命中时不加锁
+ * 2. 线程缓存满了归还到全局空闲链表，线程缓存空了从全局链表取（加锁，只在两者之间搬运时发生）；
+ *    A 线程取、B 线程还（如工作线程取调用上下文、异步服务方法在别的线程运行 done）的对象经全局链表流回 A
+ * 3. 全局链表最多保留 kMaxCentralSize 个，多出的直接释放；线程退出时缓存整体交回全局链表
+ * 对象由调用方在归还前重置，池不调用任何重置接口
+ */
+template <typename T>
+class ObjectPool {
+public:
+    static constexpr size_t kThreadCacheSize = 16;
+    static constexpr size_t kMaxCentralSize = 256;
+
+    // 取一个空闲对象，没有时 new T()
+    static std::unique_ptr<T> acquire() {
+        ThreadCache& cache = threadCache();
+        if (cache.objects.empty()) {
+            Central& central = centralList();
+            std::lock_guard<std::mutex> lock(central.mutex);
+            size_t count = std::min(central.objects.size(), kThreadCacheSize / 2);
+            for (size_t i = 0; i < count; ++i) {
+                cache.objects.push_back(std::move(central.objects.back()));
+                central.objects.pop_back();
+            }
+        }
+        if (cache.objects.empty()) {
+            return std::make_unique<T>();
+        }
+        std::unique_ptr<T> object = std::move(cache.objects.back());
+        cache.objects.pop_back();
+        return object;
+    }
+
+    // 归还对象（已由调用方重置），可以在任意线程调用
+    static void release(std::unique_ptr<T> object) {
+        ThreadCache& cache = threadCache();
+        if (cache.objects.size() >= kThreadCacheSize) {
+            // 留一半在本线程，另一半交回全局链表
+            Central& central = centralList();
+            std::lock_guard<std::mutex> lock(central.mutex);
+            while (cache.objects.size() > kThreadCacheSize / 2) {
+                if (central.objects.size() < kMaxCentralSize) {
+                    central.objects.push_back(std::move(cache.objects.back()));
+                }
+                cache.objects.pop_back();
+            }
+        }
+        cache.objects.push_back(std::move(object));
+    }
+
+private:
+    struct Central {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<T>> objects;
+
+        Central() { objects.reserve(kMaxCentralSize); }
+    };
+
+    struct ThreadCache {
+        std::vector<std::unique_ptr<T>> objects;
+
+        ThreadCache() { objects.reserve(kThreadCacheSize); }
+
+        ~ThreadCache() {
+            Central& central = centralList();
+            std::lock_guard<std::mutex> lock(central.mutex);
+            for (auto& object : objects) {
+                if (central.objects.size() >= kMaxCentralSize) {
+                    break;
+                }
+                central.objects.push_back(std::move(object));
+            }
+        }
+    };
+
+    // 全局链表不析构：进程退出时其他线程的缓存可能晚于静态对象析构交回
+    static Central& centralList() {
+        static Central* central = new Central();
+        return *central;
+    }
+
+    static ThreadCache& threadCache() {
+        thread_local ThreadCache cache;
+        return cache;
+    }
+};
+
+} // namespace rpc
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+namespace rpc {
+
+/**
+ * 自适应读取大小
+ * 特点：
+ * 1. 按连接记录最近的读取量，决定下一次读取预留多少可写空间
+ * 2. 一次读满预留空间说明 socket 里还有更多，立即翻倍；连续两次不到一半才减半，避免来回抖动
+ * 3. 在 [kMinReadSize, kMaxReadSize] 之间变化，小请求的连接不会一直占着大块内存
+ * 4. 非线程安全，由连接所属的 I/O 线程独占访问
+ */
+class AdaptiveReadSizer {
+public:
+    static constexpr size_t kMinReadSize = 512;             // 最小预留
+    static constexpr size_t kInitialReadSize = 16 * 1024;   // 初始预留
+    static constexpr size_t kMaxReadSize = 256 * 1024;      // 最大预留（更大的帧见 nextForFrame）
+
+    AdaptiveReadSizer() : size_(kInitialReadSize), shrink_pending_(false) {}
+
+    // 下一次读取预留的字节数
+    size_t next() const {
+        return size_;
+    }
+
+    // 缓冲区里有一个不完整的帧（共 frame_bytes 字节，已到 readable 字节）时下一次读取预留的字节数：
+    // 按帧的剩余部分预留，但不超过 max(kMaxReadSize, readable)，即预留随已到达的字节翻倍增长。
+    // 只发来帧长、帧体迟迟不到的连接最多占 kMaxReadSize，而不是按声明的帧长占一整块
+    size_t nextForFrame(size_t frame_bytes, size_t readable) const {
+        if (frame_bytes <= readable) {
+            return size_;
+        }
+        size_t limit = std::max(kMaxReadSize, readable);
+        return std::max(size_, std::min(frame_bytes - readable, limit));
+    }
+
+    // 记录一次读取的字节数
+    void record(size_t bytes_read) {
+        if (bytes_read >= size_) {
+            size_ = std::min(size_ * 2, kMaxReadSize);
+            shrink_pending_ = false;
+        } else if (bytes_read <= size_ / 2) {
+            if (shrink_pending_) {
+                size_ = std::max(size_ / 2, kMinReadSize);
+                shrink_pending_ = false;
+            } else {
+                shrink_pending_ = true;
+            }
+        } else {
+            shrink_pending_ = false;
+        }
+    }
+
+private:
+    size_t size_;
+    bool shrink_pending_; // 上一次读取已经不到一半
+};
+
+} // namespace rpc
@@ -40,6 +40,43 @@ struct ServiceInstance {
     std::string getId() const {
         return host + ":" + std::to_string(port);
     }
+
+    // 元数据键：实例额外监听的 Unix 域套接字地址，以及实例所在主机名
+    static constexpr const char* kUnixSocketKey = "unix_socket";
+    static constexpr const char* kHostNameKey = "hostname";
+
+    // 通告 Unix 域套接字地址（"unix:/path"），同机客户端据此绕过 TCP/IP 协议栈
+    void setUnixSocket(const std::string& address, const std::string& host_name) {
+        metadata[kUnixSocketKey] = address;
+        metadata[kHostNameKey] = host_name;
+    }
+
+    // 获取通告的 Unix 域套接字地址，没有返回空
+    std::string getUnixSocket() const {
+        auto it = metadata.find(kUnixSocketKey);
+        return it == metadata.end() ? "" : it->second;
+    }
+
+    // 元数据键：实例额外监听的共享内存握手地址
+    static constexpr const char* kSharedMemoryKey = "shm";
+
+    // 通告共享内存地址（"shm:/path"），同机客户端优先使用
+    void setSharedMemory(const std::string& address, const std::string& host_name) {
+        metadata[kSharedMemoryKey] = address;
+        metadata[kHostNameKey] = host_name;
+    }
+
+    // 获取通告的共享内存地址，没有返回空
+    std::string getSharedMemory() const {
+        auto it = metadata.find(kSharedMemoryKey);
+        return it == metadata.end() ? "" : it->second;
+    }
+
+    // 获取实例所在主机名，没有返回空
+    std::string getHostName() const {
+        auto it = metadata.find(kHostNameKey);
+        return it == metadata.end() ? "" : it->second;
+    }
 };
 
 // 实例变化->回调函数
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "registry.h"
 
 namespace rpc {
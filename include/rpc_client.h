@@ -1,12 +1,18 @@
 #pragma once
 
 #include <string>
-#include <atomic>
+#include <unordered_map>
 #include <mutex>
 #include <memory>
+#include <vector>
+#include <functional>
+#include <future>
+#include <chrono>
 #include <google/protobuf/service.h>
 #include <google/protobuf/message.h>
 #include "tcp_client.h"
+#include "client_connection.h"
+#include "connection_pool.h"
 #include "rpc_protocol_helper.h"
 #include "transport.h"
 #include "registry_factory.h"
@@ -15,9 +21,25 @@
 
 namespace rpc {
 
+// 扇出调用中的一项：调用前填好方法名、请求与响应，完成后读 success / error_message
+struct RpcCall {
+    std::string method_name;
+    const google::protobuf::Message* request;
+    google::protobuf::Message* response;
+    bool success;
+    std::string error_message;
+
+    RpcCall():request(nullptr),response(nullptr),success(false) {}
+    RpcCall(const std::string& method, const google::protobuf::Message* req, google::protobuf::Message* resp)
+        :method_name(method),request(req),response(resp),success(false) {}
+};
+
 // RPC 客户端stub基类
 class RpcClientStub {
 public:
+    // 异步调用完成：success 为 false 时 error_message 是失败原因
+    using CallCallback = std::function<void(bool success, const std::string& error_message)>;
+
     virtual ~RpcClientStub() = default;
 
     // 调用RPC方法
@@ -25,9 +47,39 @@ public:
                             const google::protobuf::Message& request,
                             google::protobuf::Message& response) = 0;
 
+    // 异步调用：请求发出后立即返回，不等响应。done 恰好执行一次——收到响应、超时或连接断开时在连接的读线程里执行，
+    // 请求没能发出时在调用线程里直接执行。response 必须活到 done 执行；done 里不能再发起同步调用。
+    // 不等响应不等于不阻塞：发出之前的准备在调用线程里做，RpcClientStubImpl 会在以下情况阻塞调用线程——
+    // 1. 直连模式下还没有连接或连接已断开：建连（TCP 握手，连不上时到超时为止）
+    // 2. 请求带帧头且这条连接还没取回方法目录：一次握手往返，最长 ClientConnection::kDefaultCallTimeoutMs
+    // 3. 服务发现模式：RpcClientStubImpl::kDiscoveryCacheMs 内没有查过注册中心时查一次（ZooKeeper 往返），所选实例在连接池里没有可用连接时建连、握手
+    // 4. 对端读得慢、发送缓冲区满：等到可写，最长为本次调用的超时
+    // 不能阻塞的线程（如服务端 I/O 线程）先用 tryAsyncCallMethod，返回 false 时换到别的线程再调用本方法
+    virtual void asyncCallMethod(const std::string& method_name,
+                                 const google::protobuf::Message& request,
+                                 google::protobuf::Message* response,
+                                 CallCallback done) = 0;
+
+    // 不阻塞地发起异步调用：只有马上就能发出（已有可用连接，需要时方法目录也已握手）时才发出并返回 true，
+    // 否则什么也不做、返回 false（done 不会执行），由调用方换到可以阻塞的线程再调用 asyncCallMethod。默认总是返回 false
+    virtual bool tryAsyncCallMethod(const std::string& method_name,
+                                    const google::protobuf::Message& request,
+                                    google::protobuf::Message* response,
+                                    CallCallback done);
+
+    // 异步调用，结果以 future 返回（true 表示成功）
+    std::future<bool> asyncCallMethod(const std::string& method_name,
+                                      const google::protobuf::Message& request,
+                                      google::protobuf::Message* response);
+
+    // 扇出：所有调用一起发出，全部完成后返回，总耗时取决于最慢的一个而不是各自耗时之和；返回成功的个数。
+    // 调用在当前线程里依次经 asyncCallMethod 发出，发出前的准备（建连、握手、查注册中心）按其说明阻塞，不并行
+    size_t callMany(std::vector<RpcCall>& calls);
+
 };
 
-// RPC 客户端stub实现类
+// RPC 客户端stub实现类：可以被多个线程同时调用，调用在同一条连接上多路复用（见 ClientConnection）。
+// 服务发现模式下连接取自进程内共享的连接池（见 ClientConnectionPool），负载均衡器换实例不用重新建连
 class RpcClientStubImpl : public RpcClientStub{
 public:
     // 直连模式，不使用服务发现
@@ -42,11 +94,25 @@ public:
     bool callMethod(const std::string& method_name,
                             const google::protobuf::Message& request,
                             google::protobuf::Message& response) override;
+
+    // 异步调用RPC方法：哪些情况会阻塞调用线程见 RpcClientStub::asyncCallMethod
+    void asyncCallMethod(const std::string& method_name,
+                         const google::protobuf::Message& request,
+                         google::protobuf::Message* response,
+                         CallCallback done) override;
+    using RpcClientStub::asyncCallMethod;
+
+    // 不阻塞地发起异步调用：直连模式下连接已建立、方法目录已握手时发出；服务发现模式下用 kDiscoveryCacheMs 内发现过的实例列表选实例，
+    // 连接池里已有它的可用连接（不用新建，方法目录已握手）时发出。需要查注册中心、建连或握手时返回 false
+    bool tryAsyncCallMethod(const std::string& method_name,
+                            const google::protobuf::Message& request,
+                            google::protobuf::Message* response,
+                            CallCallback done) override;
     
     // 连接服务器
     bool connect();
 
-    // 断开连接
+    // 断开连接：服务发现模式下的连接属于连接池，只放开引用
     void disconnect();
 
     // 检查连接状态
@@ -57,28 +123,75 @@ public:
 
     // 获取负载均衡器
     LoadBalancer* getLoadBalancer() const;
+
+    // 设置 I/O 后端（epoll / io_uring），下次连接时生效
+    void setIoBackend(const std::string& io_backend);
+
+    // 服务发现模式下，实例与本机同主机时是否优先使用它通告的共享内存、Unix 域套接字（默认开启）
+    void setPreferUnixSocket(bool prefer);
+
+    // 请求是否带定长帧头（默认开启，服务端不解析 protobuf 即可路由）；对端是不认识帧头的旧版本服务端时关闭
+    void setFrameHeader(bool enable);
+
+    // 每次调用的时间预算（毫秒），随帧头发给服务端作为截止时间，0 表示由服务端配置决定
+    void setRequestTimeout(uint32_t timeout_ms);
 private:
     std::string service_name_; // 服务名
     std::string host_;  // 服务器地址
     uint16_t port_;  // 服务器端口
-    std::shared_ptr<TcpClient> tcp_client_; // tcp客户端
-    std::atomic<bool> connected_;  // 连接状态
-    std::mutex mutex_;  // 互斥锁
+    std::shared_ptr<ClientConnection> connection_; // 当前连接（服务发现模式下是最近一次从连接池取到的）：多个调用同时在上面复用，同步调用期间各自持有引用
+    std::vector<std::shared_ptr<ClientConnection>> draining_; // 直连模式下被换下、还有在途调用的旧连接，调用都完成后关闭
+    mutable std::mutex mutex_;  // 保护连接的建立与替换、配置，不在调用期间持有
     std::unique_ptr<FrameCodec> frame_codec_;
+    std::string io_backend_; // I/O 后端
+    bool prefer_unix_socket_; // 同机实例优先走共享内存 / Unix 域套接字
+    bool frame_header_; // 请求带定长帧头
+    uint32_t request_timeout_ms_; // 随帧头发送的时间预算
     // 服务发现相关
     bool use_service_discovery_; // 是否使用服务发现
     std::unique_ptr<ServiceRegistry> registry_; // 服务注册中心
     std::unique_ptr<LoadBalancer> load_balancer_; // 负载均衡器
     std::string current_instance_id_; // 当前实例ID
+    std::shared_ptr<const std::vector<ServiceInstance>> discovered_instances_; // 最近一次从注册中心发现的实例，供 tryAsyncCallMethod 选实例
+    std::chrono::steady_clock::time_point discovered_until_; // discovered_instances_ 的有效期
+
+    static constexpr uint32_t kDiscoveryCacheMs = 1000; // 异步调用沿用发现结果的时间，过期后由下一次阻塞的调用重新查注册中心
+
+    // 按连接的协议把请求编码成一帧：带帧头（方法 ID、截止时间，首次调用时握手）或旧格式信封，返回请求 ID。
+    // 请求消息直接序列化进帧，响应消息由读线程直接从响应帧解析进 response
+    uint64_t encodeRequest(ClientConnection& connection, const std::string& method_name,
+                           const google::protobuf::Message& request, Buffer& frame);
+
+    // 在已取得的连接上发出异步调用，done 恰好执行一次（instance_id 供最少连接数负载均衡器计数）
+    void startCall(const std::shared_ptr<ClientConnection>& connection, const std::string& instance_id,
+                   const std::string& method_name, const google::protobuf::Message& request,
+                   google::protobuf::Message* response, CallCallback done);
+
+    // 同步调用等待响应的时间上限：不短于随帧头发出的时间预算（服务端在截止时间回复超时错误）
+    uint32_t callTimeoutMs() const;
+
+    // 取连接：服务发现模式下先选实例，再从连接池取该实例的连接；直连模式下没有或已失效时建立。失败返回 nullptr。
+    // instance_id 返回所选实例（最少连接数负载均衡器据此计数）
+    std::shared_ptr<ClientConnection> acquireConnection(std::string& instance_id);
+
+    // 不阻塞地取连接：取不到（需要查注册中心、建连或握手）时返回 nullptr，instance_id 同 acquireConnection
+    std::shared_ptr<ClientConnection> tryAcquireConnection(std::string& instance_id);
+
+    // 换下当前连接放进 draining_，已经没有在途调用的旧连接移到 retired，由调用方在释放 mutex_ 之后关闭（调用方持有 mutex_）
+    void retireConnectionLocked(std::vector<std::shared_ptr<ClientConnection>>& retired);
+
+    // 建立直连（调用方持有 mutex_）
+    bool connectLocked();
 
-    // 发送 RPC请求
-    RpcResponse sendRpcRequest(const RpcRequest& request);
+    // 从注册中心发现服务（记进 discovered_instances_），再 chooseServiceInstance
+    ServiceInstance selectServiceInstance(const std::string& transport);
 
-    // 从注册中心发现服务，选择实例
-    ServiceInstance selectServiceInstance();
+    // 跳过连接池里还在退避期的不健康实例（全都不健康时照常选），用负载均衡器选择实例
+    ServiceInstance chooseServiceInstance(const std::vector<ServiceInstance>& instances, const std::string& transport);
 
-    // 连接到指定的服务实例
-    bool connectToInstance(const ServiceInstance& instance);
+    // 建立到指定服务实例的连接，失败返回 nullptr（由连接池在池锁外调用，不访问 mutex_ 保护的成员）
+    std::shared_ptr<ClientConnection> connectToInstance(const ServiceInstance& instance, const std::string& io_backend,
+                                                        bool prefer_unix_socket) const;
 
 };
 
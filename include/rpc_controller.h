@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <google/protobuf/service.h>
+
+namespace rpc {
+
+// RpcController 实现：服务方法用 SetFailed 报告的错误会作为错误响应回给客户端。
+// 失败信息与取消状态可以在任意线程读写（服务方法可能在别的线程里完成）
+class RpcControllerImpl : public google::protobuf::RpcController {
+public:
+    RpcControllerImpl();
+    ~RpcControllerImpl() override;
+
+    RpcControllerImpl(const RpcControllerImpl&) = delete;
+    RpcControllerImpl& operator=(const RpcControllerImpl&) = delete;
+
+    // 客户端
+    void Reset() override;
+    bool Failed() const override;
+    std::string ErrorText() const override;
+    void StartCancel() override;
+
+    // 服务端
+    void SetFailed(const std::string& reason) override;
+    bool IsCanceled() const override;
+    void NotifyOnCancel(google::protobuf::Closure* callback) override;
+
+    // 调用结束：还没执行的取消回调在这里执行，保证每个回调恰好执行一次
+    void complete();
+
+    // 把 task 投递到调用所属的线程执行：服务端是请求连接所在的 I/O 循环，其余情况直接在当前线程执行。
+    // 协程服务方法（rpc_coroutine.h）在这里恢复，不占线程池工作线程
+    virtual void post(std::function<void()> task);
+
+private:
+    mutable std::mutex mutex_;
+    bool failed_;
+    std::string error_text_;
+    std::atomic<bool> canceled_;
+    google::protobuf::Closure* cancel_callback_; // NotifyOnCancel 登记的回调，执行后置空
+};
+
+}
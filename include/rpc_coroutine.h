@@ -0,0 +1,378 @@
+#pragma once
+
+// C++20 协程接口：使用方需要按 C++20 编译（cmake -DENABLE_COROUTINES=ON）。
+// 注意：GCC 12 对写在 if / while 条件里的 co_await 生成的代码有误（恢复时跳到无效的挂起点），
+// 先把结果存进局部变量再判断：bool ok = co_await awaitCall(...); if (!ok) { ... }
+#if !defined(__cpp_impl_coroutine)
+#error "rpc_coroutine.h requires C++20 coroutines (configure with -DENABLE_COROUTINES=ON)"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <google/protobuf/message.h>
+#include <google/protobuf/service.h>
+#include "rpc_client.h"
+#include "rpc_controller.h"
+#include "thread_pool.h"
+
+namespace rpc {
+
+// 执行器：把任务投递到某个线程执行。协程在哪个执行器上恢复，co_await 之后的代码就在哪个线程里运行
+using Executor = std::function<void(std::function<void()>)>;
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+// 当前线程上正在运行的协程所属的执行器：co_await RPC 时记下，响应到达后回到它上面恢复
+inline Executor& currentExecutor() {
+    thread_local Executor executor;
+    return executor;
+}
+
+// 作用域内 currentExecutor() 指向 executor，退出时恢复原值
+class ExecutorScope {
+public:
+    explicit ExecutorScope(Executor executor) : previous_(std::move(currentExecutor())) {
+        currentExecutor() = std::move(executor);
+    }
+    ~ExecutorScope() {
+        currentExecutor() = std::move(previous_);
+    }
+
+    ExecutorScope(const ExecutorScope&) = delete;
+    ExecutorScope& operator=(const ExecutorScope&) = delete;
+
+private:
+    Executor previous_;
+};
+
+// 在 executor 上恢复协程；executor 为空时在当前线程直接恢复
+inline void resumeOn(Executor executor, std::coroutine_handle<> handle) {
+    if (!executor) {
+        handle.resume();
+        return;
+    }
+    Executor target = executor;
+    target([executor = std::move(executor), handle]() {
+        ExecutorScope scope(executor);
+        handle.resume();
+    });
+}
+
+// Task 的 promise 公共部分：创建后先挂起，co_await 时才开始运行；结束时直接切回等待它的协程（对称转移，不增加栈深度）
+struct TaskPromiseBase {
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::coroutine_handle<> continuation; // 等待本协程结束的协程
+    std::exception_ptr exception;
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() { exception = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+
+    template <typename U>
+    void return_value(U&& result) {
+        value.emplace(std::forward<U>(result));
+    }
+
+    T result() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+
+    void return_void() const noexcept {}
+
+    void result() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+// 不被等待的协程：立即运行，结束时自行销毁
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+// blockingCallPool 的线程数与线程池本身：线程池在第一次用到时按当时的线程数创建
+struct BlockingCallPoolState {
+    std::mutex mutex;
+    size_t threads = std::max<size_t>(2, std::thread::hardware_concurrency());
+    std::unique_ptr<ThreadPool> pool;
+};
+
+inline BlockingCallPoolState& blockingCallPoolState() {
+    static BlockingCallPoolState state;
+    return state;
+}
+
+// 发起可能阻塞的调用（建连、方法目录握手、查注册中心）的线程：协程可能在服务端的 I/O 线程里恢复，
+// 不能在那里等这些操作，否则整个事件循环上的连接都会停住。只有连接没就绪的调用走这里，不在热路径上
+inline ThreadPool& blockingCallPool() {
+    BlockingCallPoolState& state = blockingCallPoolState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.pool) {
+        state.pool = std::make_unique<ThreadPool>(state.threads);
+    }
+    return *state.pool;
+}
+
+// 运行 task，结束（或抛出异常）后调用 finish
+inline DetachedTask runDetached(Task<void> task, std::function<void(std::exception_ptr)> finish);
+
+} // namespace detail
+
+// 设置 blockingCallPool 的线程数（默认取 CPU 核数，至少 2），即同时进行的建连、握手、查注册中心最多几个。
+// 必须在第一次有调用换线程发出之前设置：线程池已经创建时不生效，返回 false
+inline bool setBlockingCallThreads(size_t threads) {
+    detail::BlockingCallPoolState& state = detail::blockingCallPoolState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.pool) {
+        return false;
+    }
+    state.threads = std::max<size_t>(1, threads);
+    return true;
+}
+
+/**
+ * 协程任务：返回 Task<T> 的函数是协程，调用时先不运行，被 co_await 时才开始，结果（或异常）交给等待方。
+ * 顶层的 Task 用 spawn（客户端）或 runCoroutine（服务端）启动
+ */
+template <typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    // 记下等待方并切到本协程运行
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+
+    T await_resume() {
+        return handle_.promise().result();
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+inline DetachedTask runDetached(Task<void> task, std::function<void(std::exception_ptr)> finish) {
+    std::exception_ptr exception;
+    try {
+        co_await task;
+    } catch (...) {
+        exception = std::current_exception();
+    }
+    finish(exception);
+}
+
+} // namespace detail
+
+/**
+ * co_await 一次 RPC 调用：请求发出后挂起当前协程，不占用任何线程；
+ * 响应到达（或超时、连接断开）后回到发起时的执行器上恢复，结果为 true 表示成功。
+ * 连接已就绪时在当前线程直接发出（tryAsyncCallMethod，服务发现模式下用最近发现的实例列表、连接池里已有的连接）；
+ * 需要建连、握手或查注册中心时交给 blockingCallPool 发出，
+ * 所以在服务端 I/O 线程里恢复的协程也可以放心 co_await。
+ * 没有执行器时（如直接 spawn 的客户端协程）在连接的读线程里恢复，之后的代码不能阻塞，也不能发起同步调用
+ */
+class CallAwaiter {
+public:
+    CallAwaiter(RpcClientStub& stub, const std::string& method_name,
+                const google::protobuf::Message& request, google::protobuf::Message* response)
+        :stub_(stub),
+         method_name_(method_name),
+         request_(request),
+         response_(response),
+         completed_(false),
+         success_(false) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    // 回调与 await_suspend 谁后到谁负责继续：回调先完成（请求没能发出）时不挂起
+    bool await_suspend(std::coroutine_handle<> handle) {
+        handle_ = handle;
+        executor_ = detail::currentExecutor();
+        RpcClientStub::CallCallback done = [this](bool success, const std::string& error_message) {
+            success_ = success;
+            error_message_ = error_message;
+            if (completed_.exchange(true, std::memory_order_acq_rel)) {
+                // 恢复后本对象随协程继续执行而销毁，先取出要用的成员
+                Executor executor = std::move(executor_);
+                std::coroutine_handle<> resume = handle_;
+                detail::resumeOn(std::move(executor), resume);
+            }
+        };
+        if (!stub_.tryAsyncCallMethod(method_name_, request_, response_, done)) {
+            // done 可能在发出之前就恢复协程、销毁本对象：任务里只用拷贝出来的值
+            RpcClientStub* stub = &stub_;
+            const google::protobuf::Message* request = &request_;
+            google::protobuf::Message* response = response_;
+            try {
+                detail::blockingCallPool().submit([stub, method_name = method_name_, request, response, done]() {
+                    stub->asyncCallMethod(method_name, *request, response, done);
+                });
+            } catch (const std::exception&) {
+                // 线程池已停止（进程退出中）：只能在当前线程发出
+                stub_.asyncCallMethod(method_name_, request_, response_, std::move(done));
+            }
+        }
+        return !completed_.exchange(true, std::memory_order_acq_rel);
+    }
+
+    bool await_resume() {
+        if (!success_) {
+            std::cerr << "Rpc_Coroutine.h::RPC call failed: " << error_message_ << std::endl;
+        }
+        return success_;
+    }
+
+    // 失败原因（co_await 返回 false 时）
+    const std::string& errorMessage() const { return error_message_; }
+
+private:
+    RpcClientStub& stub_;
+    std::string method_name_;
+    const google::protobuf::Message& request_;
+    google::protobuf::Message* response_;
+    std::coroutine_handle<> handle_;
+    Executor executor_;
+    std::atomic<bool> completed_;
+    bool success_;
+    std::string error_message_;
+};
+
+// co_await awaitCall(stub, "Add", request, &response)：request 与 response 必须活到 co_await 返回
+inline CallAwaiter awaitCall(RpcClientStub& stub, const std::string& method_name,
+                             const google::protobuf::Message& request, google::protobuf::Message* response) {
+    return CallAwaiter(stub, method_name, request, response);
+}
+
+// 启动顶层协程：立即在当前线程运行到第一个挂起点后返回。executor 决定协程之后在哪里恢复，
+// 为空时在响应到达的线程（连接的读线程）里恢复；协程抛出的异常打印后丢弃
+inline void spawn(Task<void> task, Executor executor = {}) {
+    detail::ExecutorScope scope(std::move(executor));
+    detail::runDetached(std::move(task), [](std::exception_ptr exception) {
+        if (!exception) {
+            return;
+        }
+        try {
+            std::rethrow_exception(exception);
+        } catch (const std::exception& e) {
+            std::cerr << "Rpc_Coroutine.h::Unhandled exception in coroutine: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "Rpc_Coroutine.h::Unhandled exception in coroutine" << std::endl;
+        }
+    });
+}
+
+/**
+ * 用协程实现服务方法：生成的服务方法里把协程交给 runCoroutine 后直接返回，例如
+ *     void Add(RpcController* controller, const AddRequest* request, AddResponse* response, Closure* done) override {
+ *         runCoroutine(controller, done, addAsync(request, response));
+ *     }
+ * 协程先在工作线程里运行到第一次挂起就让出工作线程，之后在请求连接所在的 I/O 线程里恢复，
+ * 结束时运行 done 回复；抛出的异常经 controller->SetFailed 作为错误响应回给客户端。
+ * 恢复后的代码跑在 I/O 线程上，不能阻塞（下游调用用 co_await awaitCall）
+ */
+inline void runCoroutine(google::protobuf::RpcController* controller, google::protobuf::Closure* done, Task<void> task) {
+    Executor executor;
+    if (auto* impl = dynamic_cast<RpcControllerImpl*>(controller)) {
+        // 控制器活到 done 运行，协程只在这之前恢复
+        executor = [impl](std::function<void()> resume) { impl->post(std::move(resume)); };
+    }
+    detail::ExecutorScope scope(std::move(executor));
+    detail::runDetached(std::move(task), [controller, done](std::exception_ptr exception) {
+        if (exception) {
+            try {
+                std::rethrow_exception(exception);
+            } catch (const std::exception& e) {
+                controller->SetFailed(e.what());
+            } catch (...) {
+                controller->SetFailed("Unknown exception in coroutine");
+            }
+        }
+        done->Run();
+    });
+}
+
+}
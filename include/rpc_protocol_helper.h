@@ -6,12 +6,15 @@
 #include <memory>
 #include "../proto/rpc_protocol.pb.h"
 #include <google/protobuf/message.h>
+#include "frame_header.h"
 
 namespace rpc {
 
 // 前向声明(不需要再引入头文件)
 struct RpcRequest;
 struct RpcResponse;
+class IoBuf;
+class Buffer;
 
 // 协议序列化辅助类
 class RpcProtocolHelper {
@@ -19,15 +22,51 @@ public:
     // 将RpcRequest序列化为字节数组
     static std::vector<uint8_t> serializeRequest(const RpcRequest& request);
 
+    // 将RpcRequest直接序列化到out末尾：payload 不为空时把它原地序列化为 request_data 字段，否则使用 request.request_data
+    static void serializeRequest(const RpcRequest& request, const google::protobuf::Message* payload, Buffer& out);
+
     // 将字节数组反序列化为RpcRequest
     static RpcRequest parseRequest(const std::vector<uint8_t>& data);
 
+    // 直接从链式缓冲区反序列化（多段时按段喂给 protobuf，不先拼成连续内存）
+    static RpcRequest parseRequest(const IoBuf& data);
+
+    // 解析请求信封但不拷出 request_data：payload 是它在 data 中的切片（与 data 共享块），请求消息直接从中解析
+    static bool parseRequestEnvelope(const IoBuf& data, RpcRequestProto& envelope, IoBuf& payload);
+
     // 将RpcResponse序列化为字节数组
     static std::vector<uint8_t> serializeResponse(const RpcResponse& response);
 
+    // 将RpcResponse直接序列化到out末尾：payload 不为空时把它原地序列化为 response_data 字段，
+    // 否则使用 response.response_data。一次算好总长，整个响应只写一遍，不经过中间的 string/vector
+    static void serializeResponse(const RpcResponse& response, const google::protobuf::Message* payload, Buffer& out);
+
     // 将字节数组反序列化为RpcResponse
     static RpcResponse parseResponse(const std::vector<uint8_t>& data);
 
+    // 解析响应信封，response_data 不拷出，直接从帧内解析进 payload（为空时忽略响应消息）
+    static RpcResponse parseResponse(const uint8_t* data, size_t length, google::protobuf::Message* payload);
+
+    // 从链式缓冲区解析任意消息（多段时按段喂给 protobuf），失败返回 false
+    static bool parseMessage(const IoBuf& data, google::protobuf::Message& message);
+
+    // 带帧头的请求：帧头后面直接是请求消息，追加到 out
+    static void serializeFramedRequest(const FrameHeader& header, const google::protobuf::Message& request, Buffer& out);
+
+    // 带帧头的响应：成功时帧头后面是响应消息（payload 为空时用 response.response_data），失败时是错误信息，追加到 out
+    static void serializeFramedResponse(const RpcResponse& response, const google::protobuf::Message* payload,
+                                        uint32_t method_id, Buffer& out);
+
+    // 解析带帧头的响应帧体
+    static RpcResponse parseFramedResponse(const std::vector<uint8_t>& data);
+
+    // 解析带帧头的响应帧体，成功时响应消息直接从帧内解析进 payload（为空时忽略响应消息）
+    static RpcResponse parseFramedResponse(const uint8_t* data, size_t length, google::protobuf::Message* payload);
+
+    // 只取响应帧体里的请求 ID（带帧头的读帧头，旧格式扫出信封的 request_id 字段），不解析响应消息；
+    // 客户端据此先找到在途调用，再把响应消息解析进它的 response。帧体非法时返回 false
+    static bool peekResponseId(const uint8_t* data, size_t length, uint64_t& request_id);
+
     // 创建 RpcRequestProto 消息
     static RpcRequestProto createRequestProto(const RpcRequest& request);
 
@@ -11,26 +11,44 @@
 #include <functional>
 #include "google/protobuf/service.h"
 #include "google/protobuf/message.h"
+#include "google/protobuf/arena.h"
 #include "tcp_connection.h"
+#include "io_buf.h"
+#include "slab_pool.h"
 #include "serializer.h"
 #include "serializer_factory.h"
 #include "tcp_server.h"
 #include "frame_codec.h"
+#include "frame_header.h"
 #include "thread_pool.h"
 #include "registry.h"
 #include "registry_factory.h"
 
 namespace rpc {
 
+class RpcRequestProto;
 
 // rpc 服务器配置
 struct RpcServerConfig {
     std::string host; // 服务器监听地址
     uint16_t port;    // 服务器监听端口
     size_t thread_pool_size; // 线程池大小
+    size_t io_thread_count;  // I/O 线程数（每个线程一个 epoll 事件循环）
+    std::string io_balance_strategy; // 新连接在 I/O 线程间的分配策略：RoundRobin / LeastConnection
     size_t max_connections;  // 最大连接数
-    int connection_timeout_ms; // 连接超时（毫秒）
-    int request_timeout_ms;    // 请求超时（毫秒）
+    bool reuse_port;         // 是否为每个 I/O 线程开一个 SO_REUSEPORT 监听 socket
+    int listen_backlog;      // listen 队列长度
+    size_t output_high_water_mark; // 连接输出缓冲区高水位：超过后暂停读取该连接的新请求
+    size_t output_low_water_mark;  // 连接输出缓冲区低水位：回落到此以下恢复读取
+    size_t read_budget_bytes;      // 每个连接每轮事件循环最多读取的字节数，防止单个客户端饿死其他连接
+    size_t read_budget_frames;     // 每个连接每轮事件循环最多解码的帧数
+    int connection_timeout_ms; // 空闲连接超时（毫秒）：这么久没收到请求就关闭连接，0 表示不检测
+    int request_timeout_ms;    // 请求超时（毫秒）：超时未处理完回复超时错误并丢弃迟到的结果，0 表示不检测
+    std::string io_backend;    // I/O 后端：epoll / io_uring（内核不支持 io_uring 时自动退回 epoll）
+    std::string unix_address;  // 额外监听的 Unix 域套接字地址（如 unix:/tmp/myrpc.sock），注册时一并通告，空表示不启用
+    std::string shm_address;   // 额外监听的共享内存握手地址（如 shm:/tmp/myrpc.shm），注册时一并通告，空表示不启用
+    size_t slab_thread_cache_bytes; // 每个线程在 SlabPool 中缓存的空闲内存上限（字节），超出部分交回全局链表（进程级设置）
+    size_t max_pending_requests;    // 线程池排队请求上限：超过后带帧头的新请求不解析、直接回复过载，0 表示不限
     std::string serializer_type; // 序列化器类型
     // 配置服务注册中心
     bool enable_registry; // 是否启用服务注册中心
@@ -43,9 +61,22 @@ struct RpcServerConfig {
         :host("0.0.0.0"),
          port(8080),
          thread_pool_size(std::thread::hardware_concurrency()),
+         io_thread_count(1),
+         io_balance_strategy("RoundRobin"),
          max_connections(1000),
+         reuse_port(false),
+         listen_backlog(1024),
+         output_high_water_mark(4 * 1024 * 1024),
+         output_low_water_mark(1024 * 1024),
+         read_budget_bytes(256 * 1024),
+         read_budget_frames(64),
          connection_timeout_ms(30000),
          request_timeout_ms(5000),
+         io_backend("epoll"),
+         unix_address(""),
+         shm_address(""),
+         slab_thread_cache_bytes(SlabPool::kDefaultMaxThreadCacheBytes),
+         max_pending_requests(0),
          serializer_type("protobuf"),
          enable_registry(false),
          registry_type("zookeeper"),
@@ -92,25 +123,49 @@ public:
     // 获取线程池大小
     size_t getThreadPoolSize() const;
 
+    // 还挂在时间轮上的请求超时定时器个数（已注册、未到期也未取消）
+    size_t getPendingRequestTimers() const;
+
     // 设置服务注册中心
     void setRegistry(std::unique_ptr<ServiceRegistry> registry);
 
     // 获取注册中心
     ServiceRegistry* getRegistry() const;
 private:
+    struct InFlightRequest; // 在途请求状态（超时控制）
+    class CallContext;      // 一次服务方法调用的上下文（arena、控制器、done）
+
     RpcServerConfig config_; // 服务器配置
     std::unique_ptr<TcpServer> tcp_server_; // TCP服务器
+    std::unique_ptr<TcpServer> unix_server_; // Unix 域套接字服务器（配置了 unix_address 时启用）
+    std::unique_ptr<TcpServer> shm_server_;  // 共享内存服务器（配置了 shm_address 时启用）
     std::unique_ptr<FrameCodec> frame_codec_; // 编解码器
     std::unique_ptr<Serializer> serializer_; // 序列化器
     std::unique_ptr<ThreadPool> thread_pool_; // 线程池
     std::unique_ptr<ServiceRegistry> registry_; // 服务注册中心
     std::unordered_map<std::string, google::protobuf::Service*> services_; // 服务映射表
+    // 分发表中的一个方法：方法和请求/响应原型在注册时定位好，调用时不再查找
+    struct MethodEntry {
+        google::protobuf::Service* service = nullptr; // 为空表示该 ID 对应的服务已注销
+        const google::protobuf::MethodDescriptor* method = nullptr;
+        const google::protobuf::Message* request_prototype = nullptr;
+        const google::protobuf::Message* response_prototype = nullptr;
+    };
+    // 不可变的分发表：注册/注销时整体重建后原子发布，调用路径只做一次原子读和一次数组下标
+    struct DispatchTable {
+        std::vector<MethodEntry> methods; // 下标即方法 ID
+        std::unordered_map<std::string, uint32_t> method_ids; // "服务名.方法名" -> 方法 ID（旧格式请求和握手用）
+    };
+    std::unordered_map<std::string, uint32_t> interned_ids_; // 已分配的方法 ID，只增不减，服务重新注册后 ID 不变（services_mutex_ 保护）
+    std::atomic<const DispatchTable*> dispatch_table_; // 当前分发表
+    std::vector<std::unique_ptr<const DispatchTable>> dispatch_tables_; // 发布过的分发表，析构时释放，读者无需加锁（services_mutex_ 保护）
     std::unordered_map<std::shared_ptr<TcpConnection>, std::string> connections_; // 连接映射表
     mutable std::shared_mutex connections_mutex_; 
     mutable std::shared_mutex services_mutex_;
     std::atomic<bool> running_; // 运行状态标志
     std::thread heartbeat_thread_; // 心跳线程
     std::atomic<bool> heartbeat_running_; // 心跳线程是否运行
+    std::atomic<size_t> request_timers_; // 时间轮上的请求超时定时器个数
 
     // 初始化组件
     bool initializeComponents();
@@ -118,11 +173,26 @@ private:
     // 处理新连接
     void handleNewConnection(std::shared_ptr<TcpConnection> connection);
 
-    // 处理消息
-    void handleMessage(std::shared_ptr<TcpConnection> connection, const std::vector<uint8_t>& data);
+    // 处理消息（frame 与连接输入缓冲区共享块，移交给工作线程时不拷贝）
+    void handleMessage(std::shared_ptr<TcpConnection> connection, IoBuf&& frame);
+
+    // 解析前的准入检查（I/O 线程）：版本、压缩算法、方法路由、过载保护，通过返回空串，否则返回错误信息
+    std::string admitRequest(const FrameHeader& header);
+
+    // 处理rpc请求：header 不为空时 request_data 是去掉帧头的请求消息，否则是 RpcRequestProto；
+    // 服务方法可以异步完成，回复在它运行 done 时发出
+    void handleRpcRequest(std::shared_ptr<TcpConnection> connection, const IoBuf& request_data,
+                          const FrameHeader* header = nullptr,
+                          const std::shared_ptr<InFlightRequest>& in_flight = nullptr);
+
+    // 请求超时（在连接所属的 I/O 线程执行）
+    void handleRequestTimeout(std::shared_ptr<TcpConnection> connection, const std::shared_ptr<InFlightRequest>& in_flight);
+
+    // 请求已回复（不再需要超时）：把取消定时器投递到它所在的 I/O 线程，不让回复过的请求在时间轮上留到超时
+    void cancelRequestTimer(const std::shared_ptr<TcpConnection>& connection, const InFlightRequest& in_flight);
 
-    // 处理rpc请求
-    void handleRpcRequest(std::shared_ptr<TcpConnection> connection, const std::vector<uint8_t>& request_data);
+    // 发送超时错误响应
+    void sendTimeoutResponse(std::shared_ptr<TcpConnection> connection, const InFlightRequest& in_flight);
 
     // 处理连接断开
     void handleConnectionClosed(std::shared_ptr<TcpConnection> connection);
@@ -130,17 +200,37 @@ private:
     // 处理错误
     void handleError(std::shared_ptr<TcpConnection> connection, const std::string& error_message);
 
-    // 发送响应
-    void sendResponse(std::shared_ptr<TcpConnection> connection, const RpcResponse& response);
+    // 发送响应：payload 不为空时直接序列化进发送缓冲区，作为 response_data；
+    // request_header 不为空时按带帧头的格式回复
+    void sendResponse(std::shared_ptr<TcpConnection> connection, const RpcResponse& response,
+                      const google::protobuf::Message* payload = nullptr, const FrameHeader* request_header = nullptr);
+
+    // 解析rpc请求信封（旧格式），信封分配在 arena 上；request_data 不拷出，以 data 的切片交给 payload
+    RpcRequestProto* parseRpcRequest(const IoBuf& data, IoBuf& payload, google::protobuf::Arena* arena);
+
+    // 序列化rpc响应（追加到 out，帧头留在预留空间里）
+    void serializeRpcResponse(const RpcResponse& response, const google::protobuf::Message* payload,
+                              const FrameHeader* request_header, Buffer& out);
+
+    // 定位方法：方法 ID 或旧格式信封里的服务名、方法名，找不到时抛出异常
+    const MethodEntry& resolveMethod(uint32_t method_id) const;
+    const MethodEntry& resolveMethod(const RpcRequestProto& envelope) const;
+
+    // 服务方法完成（done->Run()，可在任意线程）：回复并回收调用上下文
+    void completeCall(CallContext* call);
+
+    // 调用上下文经 ObjectPool 复用：工作线程取，运行 done 的线程（可能是别的线程）重置后归还
+    static std::unique_ptr<CallContext> acquireCallContext();
+    static void releaseCallContext(std::unique_ptr<CallContext> call);
 
-    // 解析rpc请求
-    RpcRequest parseRpcRequest(const std::vector<uint8_t>& data);
+    // 按方法 ID 查分发表，ID 未分配或服务已注销时返回 nullptr
+    const MethodEntry* findMethod(uint32_t method_id) const;
 
-    // 序列化rpc响应
-    std::vector<uint8_t> serializeRpcResponse(const RpcResponse& response);
+    // 按 services_ 重建分发表并发布（调用方持有 services_mutex_ 写锁）
+    void publishDispatchTable();
 
-    // 调用服务方法
-    std::vector<uint8_t> callServiceMethod(const std::string& service_name, const std::string& method_name, const std::vector<uint8_t>& request_data);
+    // 处理方法目录握手（I/O 线程）：回复请求的服务的方法名 -> 方法 ID
+    void handleHandshake(std::shared_ptr<TcpConnection> connection, const FrameHeader& header, const IoBuf& body);
 
     // 注册服务到注册中心
     bool registerToRegistry(const std::string& service_name);
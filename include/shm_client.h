@@ -0,0 +1,90 @@
+#pragma once
+
+#include "tcp_client.h"
+#include "shm_ring.h"
+#include "buffer.h"
+#include <mutex>
+
+namespace rpc {
+
+// 共享内存客户端：接口与 TcpClientImpl 一致（同步收发），连接 "shm:/path" 时
+// 创建 memfd 区域并经 Unix 域套接字交给服务端，之后请求写 c2s 环、响应从 s2c 环读取，
+// 等待时先自适应自旋，再置等待标志 poll 对应的 eventfd
+class ShmTcpClient : public TcpClient {
+public:
+    static constexpr int kConnectTimeoutMs = 5000; // 握手超时
+    static constexpr int kIoTimeoutMs = 5000;      // 收发超时
+
+    explicit ShmTcpClient(size_t ring_capacity = ShmRegion::kDefaultRingCapacity);
+    ~ShmTcpClient();
+
+    // 连接服务器：host 必须是 shm: 地址（忽略 port）
+    bool connect(const std::string& host, uint16_t port) override;
+
+    // 断开连接
+    void disconnect() override;
+
+    // 关闭读写两个方向，唤醒阻塞在收发里的线程
+    void shutdown() override;
+
+    // 发送消息（调用方已加好长度前缀），环满时等待服务端读走
+    bool send(const std::vector<uint8_t>& data) override;
+    bool send(const Buffer& frame) override;
+
+    // 接收一帧消息（去掉 4 字节长度前缀）
+    bool receive(std::vector<uint8_t>& data) override;
+    bool receive(const uint8_t*& data, size_t& length) override;
+
+    // 设置接收超时（默认 kIoTimeoutMs）
+    void setReceiveTimeout(uint32_t timeout_ms) override;
+
+    // 设置发送超时（默认 kIoTimeoutMs）
+    void setSendTimeout(uint32_t timeout_ms) override;
+
+    // 获取连接状态
+    ConnectionState getState() const override;
+
+    // 设置回调
+    void setMessageCallback(MessageCallback callback) override;
+    void setConnectionCallback(ConnectionCallback callback) override;
+    void setErrorCallback(ErrorCallback callback) override;
+
+    // 返回服务器地址
+    std::string getServerAddress() const;
+
+private:
+    size_t ring_capacity_;
+    int control_fd_;
+    ShmRegion region_;
+    std::atomic<ConnectionState> state_;
+    std::atomic<uint32_t> receive_timeout_ms_;
+    std::atomic<uint32_t> send_timeout_ms_;
+    std::string server_addr_;
+    std::mutex send_mutex_;     // c2s 环只能有一个生产者
+    std::mutex receive_mutex_;  // s2c 环只能有一个消费者
+    Buffer input_buffer_;       // 一次读出可能带回多帧或半帧
+    FrameCodec frame_codec_;
+    AdaptiveSpinner send_spinner_;
+    AdaptiveSpinner receive_spinner_;
+
+    MessageCallback message_callback_;
+    ConnectionCallback connection_callback_;
+    ErrorCallback error_callback_;
+
+    // 等待 event_fd 可读：返回 1 表示被唤醒，0 表示超时，-1 表示控制套接字断开（对端退出）
+    int waitFor(int event_fd, int timeout_ms);
+
+    // 读到输入缓冲区至少有 length 字节，超时与连接失败分开报告
+    FillStatus fill(size_t length);
+
+    // 发送 length 字节（两个 send 共用）
+    bool sendBytes(const uint8_t* data, size_t length);
+
+    // 处理错误：只标记断开，映射与 fd 在 disconnect() 中释放（另一方向可能正在使用）
+    void handleError(const std::string& error_msg);
+
+    // 释放区域与控制套接字（调用方持有两把锁）
+    void closeLocked();
+};
+
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "buffer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace rpc {
+
+/**
+ * 共享内存中的单生产者单消费者字节环
+ * 特点：
+ * 1. head（消费位置）/tail（生产位置）单调递增，各占一条缓存行，容量为 2 的幂，取模用掩码
+ * 2. 环里流动的就是 TCP 上的字节流（4 字节长度 + 消息体），两端复用同一套分帧逻辑
+ * 3. 等待方先置 waiting 标志、再复查环，对端发布数据/腾出空间后看到标志才写 eventfd，
+ *    双方都在忙时不产生任何系统调用
+ * 4. 位置来自对端进程，读取时校验，越界视为协议错误
+ */
+struct ShmRingHeader {
+    alignas(64) std::atomic<uint64_t> head;           // 消费者已读到的位置
+    alignas(64) std::atomic<uint64_t> tail;           // 生产者已写到的位置
+    alignas(64) std::atomic<uint32_t> consumer_waiting; // 消费者准备睡眠，生产者发布后需要唤醒
+    std::atomic<uint32_t> producer_waiting;             // 生产者因环满准备睡眠，消费者腾出空间后需要唤醒
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory ring needs lock-free 64-bit atomics");
+
+class ShmRing {
+public:
+    ShmRing();
+    ShmRing(ShmRingHeader* header, uint8_t* data, size_t capacity);
+
+    // 生产者：尽量写入，返回实际写入的字节数（环满时可能小于 len）
+    size_t write(const uint8_t* data, size_t len);
+
+    // 消费者：读出全部可读字节追加到 buffer，返回读出字节数；位置非法返回 -1
+    ssize_t readInto(Buffer& buffer);
+
+    // 可读/可写字节数
+    size_t readableBytes() const;
+    size_t writableBytes() const;
+
+    // 发布后按需唤醒消费者/生产者（event_fd 为对端等待的 eventfd）
+    void notifyConsumer(int event_fd);
+    void notifyProducer(int event_fd);
+
+    // 准备睡眠：置等待标志并复查，返回 true 表示确实无事可做、可以睡眠；返回 false 时标志已清除
+    bool prepareConsumerWait();
+    bool prepareProducerWait();
+
+    // 醒来或放弃睡眠后清除等待标志
+    void cancelConsumerWait();
+    void cancelProducerWait();
+
+    size_t getCapacity() const;
+
+private:
+    ShmRingHeader* header_;
+    uint8_t* data_;
+    size_t capacity_;
+};
+
+// 自适应自旋：等待前先忙等一小段，命中就把下次自旋上限加倍，落空就减半，
+// 对端持续繁忙时几乎不睡眠，空闲时很快退化为直接睡眠
+class AdaptiveSpinner {
+public:
+    static constexpr uint32_t kMinSpins = 16;
+    static constexpr uint32_t kMaxSpins = 16 * 1024;
+
+    AdaptiveSpinner();
+
+    // 自旋直到 ready() 为真或用完本次额度，返回 ready() 是否成立
+    template<typename Pred>
+    bool spin(Pred ready) {
+        for (uint32_t i = 0; i < limit_; ++i) {
+            if (ready()) {
+                if (limit_ < kMaxSpins) {
+                    limit_ *= 2;
+                }
+                return true;
+            }
+            cpuRelax();
+        }
+        if (limit_ > kMinSpins) {
+            limit_ /= 2;
+        }
+        return false;
+    }
+
+    uint32_t getLimit() const;
+
+private:
+    uint32_t limit_;
+
+    static void cpuRelax();
+};
+
+/**
+ * 一条共享内存连接的映射区域（由客户端 memfd_create 创建，经 Unix 域套接字 SCM_RIGHTS 传给服务端）
+ * 布局：区域头 | c2s 环头 | s2c 环头 | (页对齐) c2s 数据 | s2c 数据
+ * 同时传递 4 个 eventfd：c2s 有数据、c2s 有空间、s2c 有数据、s2c 有空间
+ */
+class ShmRegion {
+public:
+    static constexpr uint32_t kMagic = 0x4D52504D;  // "MRPM"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kDefaultRingCapacity = 1024 * 1024;  // 每个方向 1MB
+    static constexpr const char* kShmScheme = "shm:";
+
+    // host 是否为 shm: 地址（"shm:/path" 或 "shm:@name"）
+    static bool isShmAddress(const std::string& host);
+
+    // shm: 地址对应的握手用 Unix 域套接字地址（"unix:/path"）
+    static std::string toControlAddress(const std::string& host);
+
+    // 传递的 fd 下标
+    enum FdIndex {
+        kMemFd = 0,
+        kClientDataFd,   // 服务端 -> 客户端有数据（客户端等待）
+        kClientSpaceFd,  // c2s 有空间（客户端等待）
+        kServerDataFd,   // 客户端 -> 服务端有数据（服务端等待）
+        kServerSpaceFd,  // s2c 有空间（服务端等待）
+        kFdCount
+    };
+
+    ShmRegion();
+    ~ShmRegion();
+
+    // 禁用拷贝
+    ShmRegion(const ShmRegion&) = delete;
+    ShmRegion& operator=(const ShmRegion&) = delete;
+
+    // 客户端：创建 memfd（封死大小）与 eventfd 并初始化两个环
+    bool create(size_t ring_capacity = kDefaultRingCapacity);
+
+    // 服务端：接管收到的 fd 并映射，校验大小封条（不可缩小/增长）、大小、魔数与版本
+    bool attach(const int fds[kFdCount]);
+
+    // 释放映射并关闭所有 fd
+    void release();
+
+    ShmRing& getClientToServer();
+    ShmRing& getServerToClient();
+    int getFd(FdIndex index) const;
+
+    // 经 Unix 域套接字发送/接收全部 fd（附带 1 字节负载）
+    bool sendFds(int sockfd) const;
+    static bool receiveFds(int sockfd, int fds[kFdCount]);
+
+private:
+    struct RegionHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t ring_capacity;
+    };
+
+    int fds_[kFdCount];
+    void* base_;
+    size_t size_;
+    ShmRing c2s_;
+    ShmRing s2c_;
+
+    static size_t dataOffset();
+    static size_t regionSize(size_t ring_capacity);
+    bool map(size_t ring_capacity, bool initialize);
+};
+
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include "tcp_server.h"
+#include "tcp_connection.h"
+#include "shm_ring.h"
+#include "slot_map.h"
+#include "timer_wheel.h"
+#include "socket_address.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rpc {
+
+class ShmLoop;
+
+// 共享内存连接：请求从 c2s 环读出，响应直接写入 s2c 环，环满时暂存输出缓冲区，
+// 等客户端腾出空间（kServerSpaceFd）后由所属 ShmLoop 续写；控制用的 Unix 域套接字只用来感知对端退出
+class ShmConnection : public TcpConnection {
+public:
+    static constexpr size_t kDefaultHighWaterMark = 32 * 1024 * 1024; // 默认高水位 32MB（输出缓冲区上限 64MB）
+
+    ShmConnection(int control_fd, std::unique_ptr<ShmRegion> region, const std::string& peer_addr, ShmLoop* loop);
+    ~ShmConnection();
+
+    // 发送数据：持输出锁直接写入 s2c 环（可在任意线程调用），写不下的部分进入输出缓冲区
+    bool send(const std::vector<uint8_t>& data) override;
+
+    // 关闭连接（可在任意线程调用）
+    void close() override;
+
+    ConnectionState getState() const override;
+    std::string getRemoteAddress() const override;
+
+    void setMessageCallback(MessageCallback callback) override;
+    void setConnectionCallback(ConnectionCallback callback) override;
+    void setWriteCompleteCallback(WriteCompleteCallback callback) override;
+    void setErrorCallback(ErrorCallback callback) override;
+    void setHighWaterMarkCallback(HighWaterMarkCallback callback, size_t high_water_mark) override;
+    void setLowWaterMarkCallback(LowWaterMarkCallback callback, size_t low_water_mark) override;
+
+    // 暂停/恢复读取 c2s 环（可在任意线程调用）
+    void startReading() override;
+    void stopReading() override;
+
+    // 在所属循环的时间轮上注册定时器（循环线程调用）
+    uint64_t runAfter(uint64_t delay_ms, std::function<void()> callback) override;
+
+    // 取消 runAfter 注册的定时器（循环线程调用）
+    bool cancelTimer(uint64_t timer_id) override;
+
+    // 投递任务到所属循环（任意线程调用）
+    void queueInLoop(std::function<void()> task) override;
+
+    MessageCallback& getMessageCallback() override;
+    ConnectionCallback& getConnectionCallback() override;
+    WriteCompleteCallback& getWriteCompleteCallback() override;
+    ErrorCallback& getErrorCallback() override;
+
+    // 获取输出缓冲区积压字节数
+    size_t getPendingOutputBytes() const;
+
+private:
+    friend class ShmLoop;
+
+    int control_fd_;
+    std::unique_ptr<ShmRegion> region_;
+    std::string peer_addr_;
+    std::atomic<ConnectionState> state_;
+    ShmLoop* loop_;
+    std::atomic<bool> reading_;
+
+    mutable std::mutex output_mutex_; // 保护 s2c 环的生产端、输出缓冲区与区域的释放
+    Buffer output_buffer_;            // s2c 环写不下的数据
+    bool above_high_water_;
+    size_t high_water_mark_;
+    size_t low_water_mark_;
+
+    // 以下只在循环线程访问
+    uint64_t handle_;
+    Buffer input_buffer_;
+    bool closing_;
+    uint64_t last_active_ms_;
+    uint64_t idle_timer_id_;
+
+    MessageCallback message_callback_;
+    ConnectionCallback connection_callback_;
+    WriteCompleteCallback write_complete_callback_;
+    ErrorCallback error_callback_;
+    HighWaterMarkCallback high_water_mark_callback_;
+    LowWaterMarkCallback low_water_mark_callback_;
+
+    // 把输出缓冲区写入 s2c 环，写不下时登记等待空间（调用方持有 output_mutex_）
+    void flushOutputLocked();
+};
+
+// 共享内存事件循环：一个线程服务若干共享内存连接。
+// 睡眠前先自适应自旋检查各连接的 c2s 环，都空了才置等待标志进入 epoll_wait；
+// 客户端只有在看到等待标志时才写 eventfd，双方都忙时收发不经过内核
+class ShmLoop {
+public:
+    using Functor = std::function<void()>;
+
+    static constexpr int kMaxEvents = 64;
+
+    explicit ShmLoop(size_t index);
+    ~ShmLoop();
+
+    // 禁用拷贝
+    ShmLoop(const ShmLoop&) = delete;
+    ShmLoop& operator=(const ShmLoop&) = delete;
+
+    // 设置空闲连接超时，必须在 start() 之前调用
+    void setIdleTimeout(uint64_t idle_timeout_ms);
+
+    // 设置建立连接后交给上层的回调
+    void setConnectionCallback(ConnectionCallback callback);
+
+    // 启动/停止循环线程
+    bool start();
+    void stop();
+
+    // 在循环线程中执行任务
+    void runInLoop(Functor task);
+    void queueInLoop(Functor task);
+    bool isInLoopThread() const;
+
+    // 接管一条已完成握手的连接（任意线程）
+    void addConnection(int control_fd, std::unique_ptr<ShmRegion> region, const std::string& peer_addr);
+
+    // 关闭连接（任意线程）
+    void closeConnection(std::shared_ptr<ShmConnection> connection);
+
+    // 恢复读取后处理环中积压的数据（循环线程）
+    void updateReading(ShmConnection* connection);
+
+    // 定时器（循环线程）
+    TimerWheel::TimerId runAfter(uint64_t delay_ms, Functor callback);
+    bool cancelTimer(TimerWheel::TimerId timer_id);
+
+    size_t getConnectionCount() const;
+    size_t getIndex() const;
+
+private:
+    // epoll data.u64 高 8 位为事件来源，低 56 位为连接句柄（代数只保留低 24 位）
+    enum Source : uint64_t {
+        kSourceWakeup = 1,
+        kSourceControl = 2,  // 控制套接字：对端退出
+        kSourceData = 3,     // c2s 环有数据
+        kSourceSpace = 4     // s2c 环有空间
+    };
+    static constexpr int kSourceShift = 56;
+    static constexpr uint64_t kHandleMask = (uint64_t(1) << kSourceShift) - 1;
+    static constexpr uint32_t kGenerationMask = 0xFFFFFF;
+
+    size_t index_;
+    FrameCodec frame_codec_; // 切帧（长度校验与 TcpConnectionImpl 共用）
+    int epoll_fd_;
+    int wakeup_fd_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+    std::atomic<std::thread::id> thread_id_;
+    SlotMap<std::shared_ptr<ShmConnection>> connections_;
+    std::atomic<size_t> connection_count_;
+    std::mutex pending_mutex_;
+    std::vector<Functor> pending_functors_;
+    std::atomic<bool> functors_pending_; // 自旋时据此及时处理跨线程任务
+    ConnectionCallback connection_callback_;
+    TimerWheel timer_wheel_;
+    uint64_t idle_timeout_ms_;
+    AdaptiveSpinner spinner_;
+
+    void loopMain();
+    void wakeup();
+
+    // 是否有连接的 c2s 环可读
+    bool anyReadable();
+    // 给所有读取中的连接置等待标志，有连接在复查时可读返回 false
+    bool prepareSleep();
+    void cancelSleep();
+
+    void handleEvent(uint64_t data, uint32_t events);
+    void handleRead(ShmConnection* connection);
+    void handleSpace(ShmConnection* connection);
+
+    void registerConnection(std::shared_ptr<ShmConnection> connection);
+    void removeConnection(ShmConnection* connection);
+
+    void doPendingFunctors();
+    void startIdleTimer(uint64_t handle, uint64_t delay_ms);
+    void handleIdleTimeout(uint64_t handle);
+    void closeAllConnections();
+
+    static uint64_t makeEventData(Source source, uint64_t handle);
+};
+
+// 共享内存服务器：在 "shm:/path"（或 "shm:@name"）对应的 Unix 域套接字上接受握手，
+// 收到客户端的 memfd 与 eventfd 后映射区域、回复确认，再把连接轮询分配给 ShmLoop
+class ShmTcpServer : public TcpServer {
+public:
+    static constexpr int kHandshakeTimeoutMs = 1000;
+
+    explicit ShmTcpServer(const TcpServerConfig& config = TcpServerConfig());
+    ~ShmTcpServer();
+
+    // 启动服务器：host 必须是 shm: 地址（忽略 port）
+    bool start(uint16_t port, const std::string& host) override;
+    void stop() override;
+    void setConnectionCallback(ConnectionCallback callback) override;
+    bool isRunning() const override;
+
+    // 获取当前连接数
+    size_t getConnectionCount() const;
+
+private:
+    TcpServerConfig config_;
+    SocketAddress listen_addr_;
+    int listen_fd_;
+    std::atomic<bool> running_;
+    std::thread acceptor_thread_;
+    std::vector<std::unique_ptr<ShmLoop>> loops_;
+    size_t next_loop_;
+    ConnectionCallback connection_callback_;
+
+    void acceptorMain();
+
+    // 完成握手：接收 fd、映射并校验区域、回复确认
+    void handshake(int control_fd);
+
+    void closeListenSocket();
+};
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rpc {
+
+// 块池统计
+struct SlabPoolStats {
+    uint64_t hits;             // 从线程缓存或全局空闲链表拿到内存的次数
+    uint64_t misses;           // 落到系统分配器的次数（含超过最大规格的大块）
+    size_t thread_cache_bytes; // 所有线程缓存持有的空闲字节数
+    size_t central_bytes;      // 全局空闲链表持有的空闲字节数
+    size_t thread_caches;      // 当前存活的线程缓存数
+
+    SlabPoolStats()
+        :hits(0),
+         misses(0),
+         thread_cache_bytes(0),
+         central_bytes(0),
+         thread_caches(0) {}
+};
+
+/**
+ * 按规格分级的线程本地块池
+ * 特点：
+ * 1. 64B ~ 256KB 按 2 的幂分 13 级，每个线程每级一条空闲链表，命中时不加锁
+ * 2. 线程缓存为空时从全局空闲链表成批取，超过上限时成批还回去；
+ *    A 线程分配、B 线程释放（如 I/O 线程读入、工作线程处理完释放）的内存先进 B 的缓存，多了再经全局链表流回 A
+ * 3. 线程退出时缓存整体交回全局链表；全局链表也有上限，超出部分还给系统
+ * 4. 释放时需要给出分配时的大小（与 std::allocator 一致），块本身不带头部
+ */
+class SlabPool {
+public:
+    static constexpr size_t kMinClassSize = 64;                        // 最小规格
+    static constexpr size_t kMaxClassSize = 256 * 1024;                // 最大规格，更大的直接走系统分配器
+    static constexpr int kClassCount = 13;                             // 规格数
+    static constexpr size_t kBatchBytes = 64 * 1024;                   // 线程缓存与全局链表间一次搬运的字节数
+    static constexpr size_t kDefaultMaxThreadCacheBytes = 4 * 1024 * 1024; // 默认每线程缓存上限 4MB
+    static constexpr size_t kMaxCentralBytes = 64 * 1024 * 1024;       // 全局空闲链表上限 64MB
+
+    static void* allocate(size_t size);
+    static void deallocate(void* ptr, size_t size);
+
+    // 每个线程缓存持有空闲内存的上限（字节），0 表示不在线程内缓存
+    static void setMaxThreadCacheBytes(size_t bytes);
+    static size_t getMaxThreadCacheBytes();
+
+    // 把当前线程缓存的空闲内存全部交回全局链表
+    static void flushThreadCache();
+
+    static SlabPoolStats getStats();
+
+    // size 对应的规格大小（超过最大规格时原样返回）
+    static size_t roundUp(size_t size);
+};
+
+// 让标准容器使用 SlabPool 的分配器
+template<typename T>
+class SlabAllocator {
+public:
+    using value_type = T;
+
+    SlabAllocator() noexcept = default;
+    template<typename U>
+    SlabAllocator(const SlabAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(SlabPool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        SlabPool::deallocate(ptr, n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const SlabAllocator<U>&) const noexcept {
+        return true;
+    }
+    template<typename U>
+    bool operator!=(const SlabAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+} // namespace rpc
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace rpc {
+
+/**
+ * 带代数（generation）的槽位表
+ * 特点：
+ * 1. 句柄 = 高 32 位代数 + 低 32 位槽位下标，插入/查找/删除均为 O(1)
+ * 2. 删除时槽位代数加一并放回空闲链表，旧句柄再来查找会因代数不符而失效
+ * 3. 代数从 1 开始，因此代数为 0 的句柄永远无效，可留给调用方作保留值
+ * 4. 非线程安全，由所属线程（如 I/O 循环）独占访问
+ */
+template<typename T>
+class SlotMap {
+public:
+    using Handle = uint64_t;
+
+    static constexpr Handle kInvalidHandle = 0;
+
+    SlotMap() : size_(0) {}
+
+    // 插入元素，返回句柄
+    Handle insert(T value) {
+        uint32_t index;
+        if (!free_list_.empty()) {
+            index = free_list_.back();
+            free_list_.pop_back();
+        } else {
+            index = static_cast<uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+        Slot& slot = slots_[index];
+        slot.value = std::move(value);
+        slot.occupied = true;
+        ++size_;
+        return makeHandle(slot.generation, index);
+    }
+
+    // 按句柄查找，句柄已失效返回 nullptr
+    T* get(Handle handle) {
+        uint32_t index = static_cast<uint32_t>(handle);
+        if (index >= slots_.size()) {
+            return nullptr;
+        }
+        Slot& slot = slots_[index];
+        if (!slot.occupied || slot.generation != static_cast<uint32_t>(handle >> 32)) {
+            return nullptr;
+        }
+        return &slot.value;
+    }
+
+    // 按句柄查找，只比较代数的低位（句柄要和其他信息共用 64 位、只能保留部分代数时使用）
+    T* getMasked(Handle handle, uint32_t generation_mask) {
+        uint32_t index = static_cast<uint32_t>(handle);
+        if (index >= slots_.size()) {
+            return nullptr;
+        }
+        Slot& slot = slots_[index];
+        if (!slot.occupied || (slot.generation & generation_mask) != (static_cast<uint32_t>(handle >> 32) & generation_mask)) {
+            return nullptr;
+        }
+        return &slot.value;
+    }
+
+    // 按句柄删除，元素移动到 out（可为空），句柄已失效返回 false
+    bool remove(Handle handle, T* out = nullptr) {
+        T* value = get(handle);
+        if (value == nullptr) {
+            return false;
+        }
+        uint32_t index = static_cast<uint32_t>(handle);
+        Slot& slot = slots_[index];
+        if (out != nullptr) {
+            *out = std::move(slot.value);
+        }
+        slot.value = T();
+        slot.occupied = false;
+        // 代数回绕时跳过 0，保证不会发出无效句柄
+        if (++slot.generation == 0) {
+            slot.generation = 1;
+        }
+        free_list_.push_back(index);
+        --size_;
+        return true;
+    }
+
+    // 遍历所有元素
+    template<typename Func>
+    void forEach(Func func) {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            if (slots_[i].occupied) {
+                func(makeHandle(slots_[i].generation, static_cast<uint32_t>(i)), slots_[i].value);
+            }
+        }
+    }
+
+    // 清空（所有已发出的句柄随之失效）
+    void clear() {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            if (slots_[i].occupied) {
+                remove(makeHandle(slots_[i].generation, static_cast<uint32_t>(i)));
+            }
+        }
+    }
+
+    // 元素个数
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+private:
+    struct Slot {
+        T value;
+        uint32_t generation;
+        bool occupied;
+
+        Slot() : generation(1), occupied(false) {}
+    };
+
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_list_; // 空闲槽位下标
+    size_t size_;
+
+    static Handle makeHandle(uint32_t generation, uint32_t index) {
+        return (static_cast<Handle>(generation) << 32) | index;
+    }
+};
+
+} // namespace rpc
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <sys/socket.h>
+#include <cstdint>
+#include <string>
+
+namespace rpc {
+
+/**
+ * 监听/连接地址
+ * 1. "unix:/path" 为 Unix 域套接字（端口被忽略），"unix:@name" 为 Linux 抽象命名空间
+ * 2. 其余按 IPv4 点分十进制处理
+ * 服务端和客户端统一用它创建 socket，同机调用配置成 unix: 地址即可绕过 TCP/IP 协议栈
+ */
+class SocketAddress {
+public:
+    static constexpr const char* kUnixScheme = "unix:";
+
+    SocketAddress();
+
+    // 解析地址，失败返回 false
+    bool parse(const std::string& host, uint16_t port);
+
+    // host 是否为 unix: 地址
+    static bool isUnix(const std::string& host);
+
+    bool isUnix() const;
+    int getFamily() const;
+    const struct sockaddr* getSockAddr() const;
+    socklen_t getLength() const;
+
+    // Unix 域套接字路径（抽象命名空间以 @ 开头），IPv4 地址为空
+    const std::string& getPath() const;
+
+    // "unix:/path" 或 "ip:port"
+    std::string toString() const;
+
+    // 已连接 socket 的对端地址：Unix 域对端通常未绑定，此时返回本端（监听）路径
+    static std::string getPeerName(int sockfd);
+
+    // 本机主机名（用于判断服务实例是否与客户端同机）
+    static std::string getLocalHostName();
+
+private:
+    struct sockaddr_storage storage_;
+    socklen_t length_;
+    std::string path_;
+    uint16_t port_;
+};
+
+}
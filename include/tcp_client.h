@@ -9,28 +9,50 @@
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <chrono>
 #include <sys/epoll.h>
 #include "frame_codec.h"
+#include "buffer.h"
+#include "socket_address.h"
 
 namespace rpc {
 
 // TCP客户端抽象基类
 class TcpClient {
 public:
+    static constexpr uint32_t kDefaultReceiveTimeoutMs = 5000; // receive 等待数据的默认最长时间
+    static constexpr uint32_t kDefaultSendTimeoutMs = 5000;    // send 等待发送缓冲区腾出空间的默认最长时间
+
     virtual ~TcpClient() = default;
 
-    // 连接服务器
+    // 连接服务器：host 为 "unix:/path" 时连接 Unix 域套接字（忽略 port），
+    // 为 "shm:/path" 时走共享内存（只有 createTcpClient 按该地址创建的客户端支持）
     virtual bool connect(const std::string& host, uint16_t port) = 0;
 
     // 断开连接
     virtual void disconnect() = 0;
 
+    // 关闭读写两个方向：阻塞在 receive / send 里的线程立即失败返回，资源仍由 disconnect() 释放
+    virtual void shutdown() = 0;
+
     // 发送消息
     virtual bool send(const std::vector<uint8_t>& data) = 0;
 
+    // 发送已编码好的帧（如 FrameCodec::encode(Buffer&) 的结果），直接从缓冲区写出
+    virtual bool send(const Buffer& frame) = 0;
+
     // 接收消息
     virtual bool receive(std::vector<uint8_t>& data) = 0;
 
+    // 接收一帧，帧体以视图返回（指向客户端的接收缓冲区，下一次 receive 之前有效），不拷出
+    virtual bool receive(const uint8_t*& data, size_t& length) = 0;
+
+    // receive 等待数据的最长时间：超时 receive 返回 false，连接仍为 CONNECTED，收到的半帧留在接收缓冲区
+    virtual void setReceiveTimeout(uint32_t timeout_ms) = 0;
+
+    // send 等待发送缓冲区（对端读得慢）腾出空间的最长时间：超时 send 返回 false，连接断开（帧可能只写出一部分）
+    virtual void setSendTimeout(uint32_t timeout_ms) = 0;
+
     // 获取连接状态
     virtual ConnectionState getState() const = 0;
 
@@ -40,6 +62,10 @@ public:
     virtual void setErrorCallback(ErrorCallback callback) = 0;
 };
 
+// 按 io_backend（epoll / io_uring）创建 TCP 客户端：io_uring 不可用时使用 epoll 实现；
+// host 为 shm: 地址时创建共享内存客户端（与 io_backend 无关）
+std::shared_ptr<TcpClient> createTcpClient(const std::string& io_backend = "epoll", const std::string& host = "");
+
 class TcpClientImpl : public TcpClient, public std::enable_shared_from_this<TcpClientImpl> {
 public:
     TcpClientImpl();
@@ -51,11 +77,22 @@ public:
     // 断开连接
     void disconnect() override;
 
+    // 关闭读写两个方向
+    void shutdown() override;
+
     // 发送消息
     bool send(const std::vector<uint8_t>& data) override;
+    bool send(const Buffer& frame) override;
 
     // 接收消息
     bool receive(std::vector<uint8_t>& data) override;
+    bool receive(const uint8_t*& data, size_t& length) override;
+
+    // 设置接收超时
+    void setReceiveTimeout(uint32_t timeout_ms) override;
+
+    // 设置发送超时
+    void setSendTimeout(uint32_t timeout_ms) override;
 
     // 获取连接状态
     ConnectionState getState() const override;
@@ -76,11 +113,15 @@ private:
     int epoll_fd_;
     std::atomic<bool> running_;
     std::string server_addr_;
-    ConnectionState state_;
+    std::atomic<ConnectionState> state_; // 发送与接收可能在不同线程
+    std::atomic<uint32_t> receive_timeout_ms_;
+    std::atomic<uint32_t> send_timeout_ms_;
     std::thread event_thread_;
     std::mutex send_mutex_;
     std::vector<uint8_t> buffer_;
     std::mutex buffer_mutex_;
+    Buffer input_buffer_; // 接收缓冲区：一次 recv 可能带回多帧或半帧
+    FrameCodec frame_codec_;
 
     MessageCallback message_callback_;
     ConnectionCallback connection_callback_;
@@ -93,7 +134,7 @@ private:
     void handleRead(std::vector<uint8_t>& data);
     
     // 处理写事件
-    bool handleWrite(const std::vector<uint8_t>& data);
+    bool handleWrite(const uint8_t* data, size_t length);
     
     // 处理错误事件
     void handleError();
@@ -101,7 +142,10 @@ private:
     // 处理错误
     void handleError(const std::string& error_msg);
 
-    // 读取指定长度的数据
-    bool readExactly(size_t length, std::vector<uint8_t>& data);
+    // 读到输入缓冲区至少有 length 字节，超时与连接失败分开报告
+    FillStatus fill(size_t length);
+
+    // 等 socket 可读（events 为 POLLIN）或可写（POLLOUT），截止时间已到返回 false
+    bool waitReady(short events, std::chrono::steady_clock::time_point deadline);
 };
 }
\ No newline at end of file
@@ -2,15 +2,47 @@
 
 #include "transport.h"
 #include "buffer.h"
+#include "io_buf.h"
+#include "read_sizer.h"
+#include "frame_codec.h"
 #include <memory>
 #include <functional>
 #include <string>
 #include <vector>
 #include <cstdint>
 #include <mutex>
+#include <atomic>
+#include <variant>
 
 namespace rpc {
 
+class EventLoop;
+
+// 一帧待发送数据：调用方给的 vector，或直接编码好的 Buffer（帧头写在预留空间里），两种都不再拷贝
+class OutputFrame {
+public:
+    OutputFrame() = default;
+    explicit OutputFrame(std::vector<uint8_t>&& bytes) : storage_(std::move(bytes)) {}
+    explicit OutputFrame(Buffer&& buffer) : storage_(std::move(buffer)) {}
+
+    const uint8_t* data() const {
+        if (const Buffer* buffer = std::get_if<Buffer>(&storage_)) {
+            return buffer->peek();
+        }
+        return std::get<std::vector<uint8_t>>(storage_).data();
+    }
+
+    size_t size() const {
+        if (const Buffer* buffer = std::get_if<Buffer>(&storage_)) {
+            return buffer->readableBytes();
+        }
+        return std::get<std::vector<uint8_t>>(storage_).size();
+    }
+
+private:
+    std::variant<std::vector<uint8_t>, Buffer> storage_;
+};
+
 // TCP连接抽象基类
 class TcpConnection : public std::enable_shared_from_this<TcpConnection> {
 public:
@@ -19,6 +51,16 @@ public:
     // 发送数据
     virtual bool send(const std::vector<uint8_t>& data) = 0;
 
+    // 发送数据（移动语义，避免拷贝整帧）
+    virtual bool send(std::vector<uint8_t>&& data) {
+        return send(static_cast<const std::vector<uint8_t>&>(data));
+    }
+
+    // 发送已编码好的帧（如 FrameCodec::encode(Buffer&) 的结果）。默认拷成 vector，epoll 连接直接排队发送
+    virtual bool send(Buffer&& frame) {
+        return send(std::vector<uint8_t>(frame.peek(), frame.peek() + frame.readableBytes()));
+    }
+
     // 关闭连接
     virtual void close() = 0;
 
@@ -33,6 +75,33 @@ public:
     virtual void setConnectionCallback(ConnectionCallback callback) = 0;
     virtual void setWriteCompleteCallback(WriteCompleteCallback callback) = 0;
     virtual void setErrorCallback(ErrorCallback callback) = 0;
+    virtual void setHighWaterMarkCallback(HighWaterMarkCallback callback, size_t high_water_mark) = 0;
+    virtual void setLowWaterMarkCallback(LowWaterMarkCallback callback, size_t low_water_mark) = 0;
+
+    // 设置帧回调（优先于消息回调）。默认把消息回调收到的 vector 拷进 IoBuf，
+    // 输入缓冲区本身就是 IoBuf 的连接重写它，直接交出切片视图
+    virtual void setFrameCallback(FrameCallback callback) {
+        setMessageCallback([callback](std::shared_ptr<TcpConnection> conn, const std::vector<uint8_t>& message) {
+            IoBuf frame;
+            frame.append(message);
+            callback(std::move(conn), std::move(frame));
+        });
+    }
+
+    // 暂停/恢复读取（用于背压：对端不读响应时停止接收它的新请求）
+    virtual void startReading() = 0;
+    virtual void stopReading() = 0;
+
+    // delay_ms 后在连接所属的 I/O 线程执行 callback（只能在该线程调用，如消息回调中），
+    // 返回定时器 ID，连接未交给 I/O 循环时返回 0
+    virtual uint64_t runAfter(uint64_t delay_ms, std::function<void()> callback) = 0;
+
+    // 取消 runAfter 返回的定时器（只能在连接所属的 I/O 线程调用，如 queueInLoop 的任务中），已到期或不存在返回 false
+    virtual bool cancelTimer(uint64_t timer_id) = 0;
+
+    // 把 task 投递到连接所属的 I/O 线程执行（任意线程可调用，总是排队、不在调用方栈上直接执行），
+    // 连接未交给 I/O 循环时在当前线程直接执行
+    virtual void queueInLoop(std::function<void()> task) = 0;
 
     virtual MessageCallback& getMessageCallback() = 0;
     virtual ConnectionCallback& getConnectionCallback() = 0;
@@ -42,11 +111,16 @@ public:
 
 class TcpConnectionImpl : public TcpConnection {
 public:
+    static const size_t kDefaultHighWaterMark = 64 * 1024 * 1024; // 默认高水位 64MB
+    static const int kMaxIovecCount = 64; // 一次 sendmsg 聚集的最大帧数
+
     TcpConnectionImpl(int sockfd, const std::string& peer_addr);
     ~TcpConnectionImpl();
 
-    // 发送数据
+    // 发送数据：投递到所属 I/O 循环的发送队列（可在任意线程调用），由循环线程合并写出
     bool send(const std::vector<uint8_t>& data) override;
+    bool send(std::vector<uint8_t>&& data) override;
+    bool send(Buffer&& frame) override;
 
     // 关闭连接
     void close() override;
@@ -62,35 +136,126 @@ public:
     void setConnectionCallback(ConnectionCallback callback) override;
     void setWriteCompleteCallback(WriteCompleteCallback callback) override;
     void setErrorCallback(ErrorCallback callback) override;
+    void setHighWaterMarkCallback(HighWaterMarkCallback callback, size_t high_water_mark) override;
+    void setLowWaterMarkCallback(LowWaterMarkCallback callback, size_t low_water_mark) override;
+    void setFrameCallback(FrameCallback callback) override;
+
+    // 暂停/恢复读取（可在任意线程调用）
+    void startReading() override;
+    void stopReading() override;
+
+    // 在所属 I/O 循环的时间轮上注册定时器（循环线程调用）
+    uint64_t runAfter(uint64_t delay_ms, std::function<void()> callback) override;
+
+    // 取消所属 I/O 循环上的定时器（循环线程调用）
+    bool cancelTimer(uint64_t timer_id) override;
+
+    // 投递任务到所属 I/O 循环（任意线程调用）
+    void queueInLoop(std::function<void()> task) override;
 
     MessageCallback& getMessageCallback() override;
     ConnectionCallback& getConnectionCallback() override;
     WriteCompleteCallback& getWriteCompleteCallback() override;
     ErrorCallback& getErrorCallback() override;
+    FrameCallback& getFrameCallback();
 
     // 获取 socket
     int getSocketFd() const;
     // 获取输入缓冲区
-    Buffer* getInputBuffer();
+    IoBuf* getInputBuffer();
     // 获取输出缓冲区
     Buffer* getOutputBuffer();
-    // 解码一个完整的帧
-    bool decodeFrame(std::vector<uint8_t>& frame_data);
+    // 解码一个完整的帧：帧体从输入缓冲区零拷贝切出
+    bool decodeFrame(IoBuf& frame);
+
+    // 下一次读取预留的字节数（循环线程调用）：自适应大小，输入缓冲区里有半帧时至少把这一帧读完整
+    size_t nextReadSize() const;
+    // 记录一次读取的字节数（循环线程调用）
+    void recordRead(size_t bytes_read);
+
+    // 设置/获取所属 I/O 循环
+    void setLoop(EventLoop* loop);
+    EventLoop* getLoop() const;
+
+    // 当前关注的 epoll 事件（只在循环线程访问）
+    uint32_t getEvents() const;
+
+    // 是否正在读取
+    bool isReading() const;
+
+    // 连接在所属循环连接表中的句柄，同时作为 epoll 的 data.u64（只在循环线程访问）
+    uint64_t getLoopHandle() const;
+    void setLoopHandle(uint64_t handle);
+
+    // 最近一次收到数据的时刻与空闲检测定时器（只在循环线程访问）
+    uint64_t getLastActiveMs() const;
+    void setLastActiveMs(uint64_t now_ms);
+    uint64_t getIdleTimerId() const;
+    void setIdleTimerId(uint64_t timer_id);
+
+    // 是否在所属循环的待读列表中（只在循环线程访问）
+    bool isReadPending() const;
+    void setReadPending(bool pending);
+
+    // 写入一批帧（循环线程调用）：一次 sendmsg 聚集写出，出错返回 false
+    bool writeFrames(std::vector<OutputFrame>& frames);
+
+    // 处理可写事件：把输出缓冲区中的数据写入 socket（循环线程调用），出错返回 false
+    bool handleWrite();
+
+    // 获取输出缓冲区积压字节数
+    size_t getPendingOutputBytes() const;
 
 private:
     int sockfd_; // 客户端fd
     std::string peer_addr_; // 对端地址
-    ConnectionState state_; // 连接状态
-    Buffer input_buffer_; // 输入缓冲区（使用新的Buffer类）
+    std::atomic<ConnectionState> state_; // 连接状态
+    IoBuf input_buffer_; // 输入缓冲区（链式块，解码出的帧与它共享块）
+    AdaptiveReadSizer read_sizer_; // 按最近读取量调整每次读取的预留大小
     Buffer output_buffer_; // 输出缓冲区
     std::mutex buffer_mutex_; // 缓冲区锁
+    mutable std::mutex output_mutex_; // 输出缓冲区锁（写只发生在循环线程，这里保护跨线程的查询与关闭）
+    EventLoop* loop_; // 所属 I/O 循环
+    uint32_t events_; // 当前关注的 epoll 事件
+    std::atomic<bool> reading_; // 是否读取
+    bool read_pending_; // 是否在待读列表中
+    uint64_t loop_handle_; // 所属循环连接表中的句柄，0 表示未注册
+    uint64_t last_active_ms_; // 最近一次收到数据的时刻
+    uint64_t idle_timer_id_; // 空闲检测定时器，0 表示没有
+    bool above_high_water_; // 是否处于高水位之上
+    size_t high_water_mark_;
+    size_t low_water_mark_;
     MessageCallback message_callback_;
+    FrameCallback frame_callback_;
     ConnectionCallback connection_callback_;
     WriteCompleteCallback write_complete_callback_;
     ErrorCallback error_callback_;
+    HighWaterMarkCallback high_water_mark_callback_;
+    LowWaterMarkCallback low_water_mark_callback_;
     
+    // 一次写操作的结果，回调在锁外触发
+    struct WriteResult {
+        bool write_complete = false;
+        bool high_water = false;
+        bool low_water = false;
+        size_t pending = 0;
+        std::string error_msg;
+    };
+
     // 处理错误
     void handleError(const std::string& error_msg);
+
+    // 写出输出缓冲区中的数据（调用方持有 output_mutex_）
+    void drainOutputBufferLocked(WriteResult& result);
+
+    // 调整 EPOLLOUT 与低水位状态（调用方持有 output_mutex_）
+    void updateWriteInterestLocked(WriteResult& result);
+
+    // 触发写相关回调
+    bool finishWrite(const WriteResult& result);
+
+    // 修改关注的事件（循环线程）
+    void updateEvents(uint32_t events);
     
 };
 
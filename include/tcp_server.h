@@ -2,6 +2,8 @@
 
 #include "transport.h"
 #include "tcp_connection.h"
+#include "event_loop.h"
+#include "socket_address.h"
 #include <atomic>
 #include <thread>
 #include <vector>
@@ -17,12 +19,36 @@
 
 namespace rpc {
 
+// TCP服务器配置
+struct TcpServerConfig {
+    size_t io_thread_count; // I/O 线程（sub-reactor）数量，每个线程一个 epoll
+    std::string loop_balance_strategy; // 新连接分配策略：RoundRobin / LeastConnection
+    size_t max_connections; // 最大连接数
+    bool reuse_port; // 是否启用 SO_REUSEPORT：每个 I/O 循环一个监听 socket，由内核分摊新连接
+    int listen_backlog; // listen 队列长度
+    size_t read_budget_bytes;  // 每个连接每轮事件循环最多读取的字节数（公平性预算）
+    size_t read_budget_frames; // 每个连接每轮事件循环最多解码的帧数
+    uint64_t idle_timeout_ms;  // 空闲连接超时：这么久没收到数据就关闭，0 表示不检测
+    std::string io_backend;    // I/O 后端：epoll / io_uring（内核不支持 io_uring 时自动退回 epoll）
+
+    TcpServerConfig()
+        :io_thread_count(1),
+         loop_balance_strategy("RoundRobin"),
+         max_connections(1000),
+         reuse_port(false),
+         listen_backlog(1024),
+         read_budget_bytes(EventLoop::kDefaultReadBudgetBytes),
+         read_budget_frames(EventLoop::kDefaultReadBudgetFrames),
+         idle_timeout_ms(0),
+         io_backend("epoll") {}
+};
+
 // TCP服务器抽象基类
 class TcpServer {
 public:
     virtual ~TcpServer() = default;
 
-    // 启动服务器
+    // 启动服务器：host 为 "unix:/path" 时监听 Unix 域套接字（忽略 port）
     virtual bool start(uint16_t port, const std::string& host = "0.0.0.0") = 0;
 
     // 停止服务器
@@ -35,9 +61,12 @@ public:
     virtual bool isRunning() const = 0; 
 };
 
+// 按 config.io_backend 创建 TCP 服务器：io_uring 不可用时打印提示并使用 epoll 实现
+std::unique_ptr<TcpServer> createTcpServer(const TcpServerConfig& config);
+
 class TcpServerImpl : public TcpServer {
 public:
-    TcpServerImpl();
+    explicit TcpServerImpl(const TcpServerConfig& config = TcpServerConfig());
     ~TcpServerImpl();
 
     // 启动服务器
@@ -52,31 +81,49 @@ public:
     // 获取服务器状态
     bool isRunning() const override;
 
+    // 获取当前连接数（所有 I/O 循环之和）
+    size_t getConnectionCount() const;
+
+    // 获取 I/O 循环数量
+    size_t getIoLoopCount() const;
+
+    // 获取各 I/O 循环的连接数
+    std::vector<size_t> getLoopConnectionCounts() const;
 
 private:
-    int listen_sockfd_; // 监听sockfd
-    int epoll_fd_;
+    TcpServerConfig config_; // 服务器配置
+    SocketAddress listen_addr_; // 监听地址（IPv4 或 unix:/path）
+    std::vector<int> listen_fds_; // 监听sockfd（SO_REUSEPORT 模式下每个 I/O 循环一个）
+    int epoll_fd_; // 主 reactor 的 epoll，只负责 accept（SO_REUSEPORT 模式下不使用）
     std::atomic<bool> running_; // 运行状态
-    std::thread server_thread_; // 服务器线程
-    std::vector<std::shared_ptr<TcpConnectionImpl>> connections_; // 连接列表
-    std::mutex connections_mutex_;
+    std::thread server_thread_; // 服务器线程（main reactor）
+    std::vector<std::unique_ptr<EventLoop>> io_loops_; // I/O 循环（sub reactor）
+    std::atomic<size_t> next_loop_; // 轮询分配下标
     ConnectionCallback connection_callback_;
-    size_t max_connections_;
 
     // 服务器线程主函数
     void serverThreadMain();
 
-    // 处理新连接
-    void handleNewConnection();
+    // 创建监听 socket（非阻塞）
+    int createListenSocket(const SocketAddress& address);
+
+    // 关闭所有监听 socket
+    void closeListenSockets();
+
+    // 处理新连接：accept4 循环直到 EAGAIN；owner 非空时连接留在该循环
+    void handleNewConnection(int listen_fd, EventLoop* owner = nullptr);
+
+    // 创建连接对象并交给 I/O 循环
+    void newConnection(int client_sockfd, EventLoop* owner);
 
-    // 处理客户端事件
-    void handleClientEvent(const struct epoll_event& event);
+    // 为新连接选择 I/O 循环
+    EventLoop* selectLoop();
 
-    // 处理读事件
-    void handleClientRead(TcpConnectionImpl* connection);
+    // 启动 I/O 循环
+    bool startIoLoops();
 
-    // 处理关闭事件
-    void handleClientClose(TcpConnectionImpl* connection);
+    // 停止 I/O 循环
+    void stopIoLoops();
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "slot_map.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace rpc {
+
+/**
+ * 分层时间轮
+ * 特点：
+ * 1. 四层：第 0 层 256 个槽，每槽 1 个 tick；上面三层各 64 个槽，每层槽宽是下一层一整圈
+ * 2. 添加、取消定时器 O(1)；每个 tick 只处理一个槽，上层槽在下层转满一圈时整体下放（cascade）
+ * 3. 定时器存放在 SlotMap 中，取消只删除节点，槽里残留的句柄在到期时因失效被跳过
+ * 4. 不依赖任何 I/O：由所属线程周期性调用 advance() 驱动（服务端 I/O 循环用 timerfd，
+ *    客户端等待调用截止时间的线程同样可以直接使用），非线程安全
+ */
+class TimerWheel {
+public:
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+
+    static constexpr TimerId kInvalidTimerId = 0;
+    static constexpr uint32_t kDefaultTickMs = 10;
+
+    // tick_ms：时间轮精度；start_ms：第 0 个 tick 对应的时刻（默认取当前时间）
+    explicit TimerWheel(uint32_t tick_ms = kDefaultTickMs, uint64_t start_ms = nowMs());
+
+    // 禁用拷贝
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // 添加定时器：从 now_ms 起 delay_ms 后执行 callback（至少一个 tick 之后），返回定时器 ID。
+    // 到期时刻按 now_ms 计算，不依赖上一次 advance 的时刻：时间轮空闲时 timerfd 不触发，内部 tick 可能已经落后很久
+    TimerId addTimer(uint64_t delay_ms, Callback callback, uint64_t now_ms = nowMs());
+
+    // 取消定时器，已到期或不存在返回 false
+    bool cancelTimer(TimerId timer_id);
+
+    // 推进到 now_ms，执行所有已到期的定时器，返回执行的个数
+    size_t advance(uint64_t now_ms = nowMs());
+
+    // 距离下一次需要 advance 的毫秒数（下一个非空槽或下一次下放），没有定时器返回 -1
+    int64_t nextTimeoutMs(uint64_t now_ms = nowMs()) const;
+
+    // 未到期的定时器个数
+    size_t size() const;
+
+    bool empty() const;
+
+    // 获取精度
+    uint32_t getTickMs() const;
+
+    // 单调时钟毫秒数
+    static uint64_t nowMs();
+
+private:
+    static constexpr int kLevelCount = 4;
+    static constexpr int kRootBits = 8;   // 第 0 层 256 槽
+    static constexpr int kLevelBits = 6;  // 上层 64 槽
+
+    struct TimerNode {
+        uint64_t expire_tick = 0;
+        Callback callback;
+    };
+
+    uint32_t tick_ms_;
+    uint64_t start_ms_;
+    uint64_t current_tick_; // 下一个待处理的 tick
+    SlotMap<TimerNode> timers_;
+    std::vector<std::vector<TimerId>> levels_[kLevelCount]; // 每层的槽，槽里存定时器句柄
+
+    // 按到期 tick 放入合适的层和槽
+    void place(TimerId timer_id, uint64_t expire_tick);
+
+    // 把某层某槽的定时器重新放置到更低的层
+    void cascade(int level, size_t index);
+
+    // 处理一个 tick，返回执行的定时器个数
+    size_t processTick();
+
+    // 某层槽位下标
+    static size_t slotIndex(int level, uint64_t tick);
+};
+
+} // namespace rpc
@@ -10,6 +10,7 @@ namespace rpc {
 
 // 前向声明
 class TcpConnection;
+class IoBuf;
 
 // 连接状态
 enum class ConnectionState {
@@ -21,9 +22,15 @@ enum class ConnectionState {
 
 // 回调函数
 using MessageCallback = std::function<void(std::shared_ptr<TcpConnection>, const std::vector<uint8_t>&)>;
+// 帧回调：帧体以 IoBuf 视图交出（与输入缓冲区共享块，不拷贝），回调可以把它移走交给其他线程
+using FrameCallback = std::function<void(std::shared_ptr<TcpConnection>, IoBuf&&)>;
 using ConnectionCallback = std::function<void(std::shared_ptr<TcpConnection>)>;
 using WriteCompleteCallback = std::function<void(std::shared_ptr<TcpConnection>)>;
 using ErrorCallback = std::function<void(std::shared_ptr<TcpConnection>, const std::string&)>;
+// 输出缓冲区积压超过高水位时回调（参数为当前积压字节数）
+using HighWaterMarkCallback = std::function<void(std::shared_ptr<TcpConnection>, size_t)>;
+// 输出缓冲区从高水位回落到低水位以下时回调
+using LowWaterMarkCallback = std::function<void(std::shared_ptr<TcpConnection>)>;
 
 // rpc 请求结构
 struct RpcRequest {
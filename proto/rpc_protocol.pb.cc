@@ -80,8 +80,33 @@ struct RpcResponseProtoDefaultTypeInternal {
   };
 };
 PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 RpcResponseProtoDefaultTypeInternal _RpcResponseProto_default_instance_;
+PROTOBUF_CONSTEXPR MethodDirectoryProto_MethodIdsEntry_DoNotUse::MethodDirectoryProto_MethodIdsEntry_DoNotUse(
+    ::_pbi::ConstantInitialized) {}
+struct MethodDirectoryProto_MethodIdsEntry_DoNotUseDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR MethodDirectoryProto_MethodIdsEntry_DoNotUseDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~MethodDirectoryProto_MethodIdsEntry_DoNotUseDefaultTypeInternal() {}
+  union {
+    MethodDirectoryProto_MethodIdsEntry_DoNotUse _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 MethodDirectoryProto_MethodIdsEntry_DoNotUseDefaultTypeInternal _MethodDirectoryProto_MethodIdsEntry_DoNotUse_default_instance_;
+PROTOBUF_CONSTEXPR MethodDirectoryProto::MethodDirectoryProto(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_.method_ids_)*/{::_pbi::ConstantInitialized()}
+  , /*decltype(_impl_.service_name_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
+  , /*decltype(_impl_._cached_size_)*/{}} {}
+struct MethodDirectoryProtoDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR MethodDirectoryProtoDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~MethodDirectoryProtoDefaultTypeInternal() {}
+  union {
+    MethodDirectoryProto _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 MethodDirectoryProtoDefaultTypeInternal _MethodDirectoryProto_default_instance_;
 }  // namespace rpc
-static ::_pb::Metadata file_level_metadata_rpc_5fprotocol_2eproto[4];
+static ::_pb::Metadata file_level_metadata_rpc_5fprotocol_2eproto[6];
 static const ::_pb::EnumDescriptor* file_level_enum_descriptors_rpc_5fprotocol_2eproto[1];
 static constexpr ::_pb::ServiceDescriptor const** file_level_service_descriptors_rpc_5fprotocol_2eproto = nullptr;
 
@@ -131,12 +156,32 @@ const uint32_t TableStruct_rpc_5fprotocol_2eproto::offsets[] PROTOBUF_SECTION_VA
   PROTOBUF_FIELD_OFFSET(::rpc::RpcResponseProto, _impl_.error_code_),
   PROTOBUF_FIELD_OFFSET(::rpc::RpcResponseProto, _impl_.error_message_),
   PROTOBUF_FIELD_OFFSET(::rpc::RpcResponseProto, _impl_.metadata_),
+  PROTOBUF_FIELD_OFFSET(::rpc::MethodDirectoryProto_MethodIdsEntry_DoNotUse, _has_bits_),
+  PROTOBUF_FIELD_OFFSET(::rpc::MethodDirectoryProto_MethodIdsEntry_DoNotUse, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::rpc::MethodDirectoryProto_MethodIdsEntry_DoNotUse, key_),
+  PROTOBUF_FIELD_OFFSET(::rpc::MethodDirectoryProto_MethodIdsEntry_DoNotUse, value_),
+  0,
+  1,
+  ~0u,  // no _has_bits_
+  PROTOBUF_FIELD_OFFSET(::rpc::MethodDirectoryProto, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::rpc::MethodDirectoryProto, _impl_.service_name_),
+  PROTOBUF_FIELD_OFFSET(::rpc::MethodDirectoryProto, _impl_.method_ids_),
 };
 static const ::_pbi::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
   { 0, 8, -1, sizeof(::rpc::RpcRequestProto_MetadataEntry_DoNotUse)},
   { 10, -1, -1, sizeof(::rpc::RpcRequestProto)},
   { 23, 31, -1, sizeof(::rpc::RpcResponseProto_MetadataEntry_DoNotUse)},
   { 33, -1, -1, sizeof(::rpc::RpcResponseProto)},
+  { 45, 53, -1, sizeof(::rpc::MethodDirectoryProto_MethodIdsEntry_DoNotUse)},
+  { 55, -1, -1, sizeof(::rpc::MethodDirectoryProto)},
 };
 
 static const ::_pb::Message* const file_default_instances[] = {
@@ -144,6 +189,8 @@ static const ::_pb::Message* const file_default_instances[] = {
   &::rpc::_RpcRequestProto_default_instance_._instance,
   &::rpc::_RpcResponseProto_MetadataEntry_DoNotUse_default_instance_._instance,
   &::rpc::_RpcResponseProto_default_instance_._instance,
+  &::rpc::_MethodDirectoryProto_MethodIdsEntry_DoNotUse_default_instance_._instance,
+  &::rpc::_MethodDirectoryProto_default_instance_._instance,
 };
 
 const char descriptor_table_protodef_rpc_5fprotocol_2eproto[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) =
@@ -159,19 +206,23 @@ const char descriptor_table_protodef_rpc_5fprotocol_2eproto[] PROTOBUF_SECTION_V
   "or_code\030\004 \001(\005\022\025\n\rerror_message\030\005 \001(\t\0225\n\010"
   "metadata\030\006 \003(\0132#.rpc.RpcResponseProto.Me"
   "tadataEntry\032/\n\rMetadataEntry\022\013\n\003key\030\001 \001("
-  "\t\022\r\n\005value\030\002 \001(\t:\0028\001*\326\001\n\014RpcErrorCode\022\013\n"
-  "\007SUCCESS\020\000\022\025\n\021SERVICE_NOT_FOUND\020\001\022\024\n\020MET"
-  "HOD_NOT_FOUND\020\002\022\023\n\017INVALID_REQUEST\020\003\022\027\n\023"
-  "SERIALIZATION_ERROR\020\004\022\031\n\025DESERIALIZATION"
-  "_ERROR\020\005\022\013\n\007TIMEOUT\020\006\022\021\n\rNETWORK_ERROR\020\007"
-  "\022\020\n\014SERVER_ERROR\020\010\022\021\n\rUNKNOWN_ERROR\020cb\006p"
-  "roto3"
+  "\t\022\r\n\005value\030\002 \001(\t:\0028\001\"\234\001\n\024MethodDirectory"
+  "Proto\022\024\n\014service_name\030\001 \001(\t\022<\n\nmethod_id"
+  "s\030\002 \003(\0132(.rpc.MethodDirectoryProto.Metho"
+  "dIdsEntry\0320\n\016MethodIdsEntry\022\013\n\003key\030\001 \001(\t"
+  "\022\r\n\005value\030\002 \001(\r:\0028\001*\326\001\n\014RpcErrorCode\022\013\n\007"
+  "SUCCESS\020\000\022\025\n\021SERVICE_NOT_FOUND\020\001\022\024\n\020METH"
+  "OD_NOT_FOUND\020\002\022\023\n\017INVALID_REQUEST\020\003\022\027\n\023S"
+  "ERIALIZATION_ERROR\020\004\022\031\n\025DESERIALIZATION_"
+  "ERROR\020\005\022\013\n\007TIMEOUT\020\006\022\021\n\rNETWORK_ERROR\020\007\022"
+  "\020\n\014SERVER_ERROR\020\010\022\021\n\rUNKNOWN_ERROR\020cb\006pr"
+  "oto3"
   ;
 static ::_pbi::once_flag descriptor_table_rpc_5fprotocol_2eproto_once;
 const ::_pbi::DescriptorTable descriptor_table_rpc_5fprotocol_2eproto = {
-    false, false, 725, descriptor_table_protodef_rpc_5fprotocol_2eproto,
+    false, false, 884, descriptor_table_protodef_rpc_5fprotocol_2eproto,
     "rpc_protocol.proto",
-    &descriptor_table_rpc_5fprotocol_2eproto_once, nullptr, 0, 4,
+    &descriptor_table_rpc_5fprotocol_2eproto_once, nullptr, 0, 6,
     schemas, file_default_instances, TableStruct_rpc_5fprotocol_2eproto::offsets,
     file_level_metadata_rpc_5fprotocol_2eproto, file_level_enum_descriptors_rpc_5fprotocol_2eproto,
     file_level_service_descriptors_rpc_5fprotocol_2eproto,
@@ -1110,6 +1161,287 @@ void RpcResponseProto::InternalSwap(RpcResponseProto* other) {
       file_level_metadata_rpc_5fprotocol_2eproto[3]);
 }
 
+// ===================================================================
+
+MethodDirectoryProto_MethodIdsEntry_DoNotUse::MethodDirectoryProto_MethodIdsEntry_DoNotUse() {}
+MethodDirectoryProto_MethodIdsEntry_DoNotUse::MethodDirectoryProto_MethodIdsEntry_DoNotUse(::PROTOBUF_NAMESPACE_ID::Arena* arena)
+    : SuperType(arena) {}
+void MethodDirectoryProto_MethodIdsEntry_DoNotUse::MergeFrom(const MethodDirectoryProto_MethodIdsEntry_DoNotUse& other) {
+  MergeFromInternal(other);
+}
+::PROTOBUF_NAMESPACE_ID::Metadata MethodDirectoryProto_MethodIdsEntry_DoNotUse::GetMetadata() const {
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_rpc_5fprotocol_2eproto_getter, &descriptor_table_rpc_5fprotocol_2eproto_once,
+      file_level_metadata_rpc_5fprotocol_2eproto[4]);
+}
+
+// ===================================================================
+
+class MethodDirectoryProto::_Internal {
+ public:
+};
+
+MethodDirectoryProto::MethodDirectoryProto(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
+  if (arena != nullptr && !is_message_owned) {
+    arena->OwnCustomDestructor(this, &MethodDirectoryProto::ArenaDtor);
+  }
+  // @@protoc_insertion_point(arena_constructor:rpc.MethodDirectoryProto)
+}
+MethodDirectoryProto::MethodDirectoryProto(const MethodDirectoryProto& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  MethodDirectoryProto* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      /*decltype(_impl_.method_ids_)*/{}
+    , decltype(_impl_.service_name_){}
+    , /*decltype(_impl_._cached_size_)*/{}};
+
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  _this->_impl_.method_ids_.MergeFrom(from._impl_.method_ids_);
+  _impl_.service_name_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.service_name_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (!from._internal_service_name().empty()) {
+    _this->_impl_.service_name_.Set(from._internal_service_name(), 
+      _this->GetArenaForAllocation());
+  }
+  // @@protoc_insertion_point(copy_constructor:rpc.MethodDirectoryProto)
+}
+
+inline void MethodDirectoryProto::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      /*decltype(_impl_.method_ids_)*/{::_pbi::ArenaInitialized(), arena}
+    , decltype(_impl_.service_name_){}
+    , /*decltype(_impl_._cached_size_)*/{}
+  };
+  _impl_.service_name_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.service_name_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+}
+
+MethodDirectoryProto::~MethodDirectoryProto() {
+  // @@protoc_insertion_point(destructor:rpc.MethodDirectoryProto)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    ArenaDtor(this);
+    return;
+  }
+  SharedDtor();
+}
+
+inline void MethodDirectoryProto::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  _impl_.method_ids_.Destruct();
+  _impl_.method_ids_.~MapField();
+  _impl_.service_name_.Destroy();
+}
+
+void MethodDirectoryProto::ArenaDtor(void* object) {
+  MethodDirectoryProto* _this = reinterpret_cast< MethodDirectoryProto* >(object);
+  _this->_impl_.method_ids_.Destruct();
+}
+void MethodDirectoryProto::SetCachedSize(int size) const {
+  _impl_._cached_size_.Set(size);
+}
+
+void MethodDirectoryProto::Clear() {
+// @@protoc_insertion_point(message_clear_start:rpc.MethodDirectoryProto)
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  _impl_.method_ids_.Clear();
+  _impl_.service_name_.ClearToEmpty();
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* MethodDirectoryProto::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  while (!ctx->Done(&ptr)) {
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // string service_name = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 10)) {
+          auto str = _internal_mutable_service_name();
+          ptr = ::_pbi::InlineGreedyStringParser(str, ptr, ctx);
+          CHK_(ptr);
+          CHK_(::_pbi::VerifyUTF8(str, "rpc.MethodDirectoryProto.service_name"));
+        } else
+          goto handle_unusual;
+        continue;
+      // map<string, uint32> method_ids = 2;
+      case 2:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 18)) {
+          ptr -= 1;
+          do {
+            ptr += 1;
+            ptr = ctx->ParseMessage(&_impl_.method_ids_, ptr);
+            CHK_(ptr);
+            if (!ctx->DataAvailable(ptr)) break;
+          } while (::PROTOBUF_NAMESPACE_ID::internal::ExpectTag<18>(ptr));
+        } else
+          goto handle_unusual;
+        continue;
+      default:
+        goto handle_unusual;
+    }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
+  }  // while
+message_done:
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto message_done;
+#undef CHK_
+}
+
+uint8_t* MethodDirectoryProto::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:rpc.MethodDirectoryProto)
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // string service_name = 1;
+  if (!this->_internal_service_name().empty()) {
+    ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::VerifyUtf8String(
+      this->_internal_service_name().data(), static_cast<int>(this->_internal_service_name().length()),
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::SERIALIZE,
+      "rpc.MethodDirectoryProto.service_name");
+    target = stream->WriteStringMaybeAliased(
+        1, this->_internal_service_name(), target);
+  }
+
+  // map<string, uint32> method_ids = 2;
+  if (!this->_internal_method_ids().empty()) {
+    using MapType = ::_pb::Map<std::string, uint32_t>;
+    using WireHelper = MethodDirectoryProto_MethodIdsEntry_DoNotUse::Funcs;
+    const auto& map_field = this->_internal_method_ids();
+    auto check_utf8 = [](const MapType::value_type& entry) {
+      (void)entry;
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::VerifyUtf8String(
+        entry.first.data(), static_cast<int>(entry.first.length()),
+        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::SERIALIZE,
+        "rpc.MethodDirectoryProto.MethodIdsEntry.key");
+    };
+
+    if (stream->IsSerializationDeterministic() && map_field.size() > 1) {
+      for (const auto& entry : ::_pbi::MapSorterPtr<MapType>(map_field)) {
+        target = WireHelper::InternalSerialize(2, entry.first, entry.second, target, stream);
+        check_utf8(entry);
+      }
+    } else {
+      for (const auto& entry : map_field) {
+        target = WireHelper::InternalSerialize(2, entry.first, entry.second, target, stream);
+        check_utf8(entry);
+      }
+    }
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:rpc.MethodDirectoryProto)
+  return target;
+}
+
+size_t MethodDirectoryProto::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:rpc.MethodDirectoryProto)
+  size_t total_size = 0;
+
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  // map<string, uint32> method_ids = 2;
+  total_size += 1 *
+      ::PROTOBUF_NAMESPACE_ID::internal::FromIntSize(this->_internal_method_ids_size());
+  for (::PROTOBUF_NAMESPACE_ID::Map< std::string, uint32_t >::const_iterator
+      it = this->_internal_method_ids().begin();
+      it != this->_internal_method_ids().end(); ++it) {
+    total_size += MethodDirectoryProto_MethodIdsEntry_DoNotUse::Funcs::ByteSizeLong(it->first, it->second);
+  }
+
+  // string service_name = 1;
+  if (!this->_internal_service_name().empty()) {
+    total_size += 1 +
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::StringSize(
+        this->_internal_service_name());
+  }
+
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData MethodDirectoryProto::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    MethodDirectoryProto::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*MethodDirectoryProto::GetClassData() const { return &_class_data_; }
+
+
+void MethodDirectoryProto::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<MethodDirectoryProto*>(&to_msg);
+  auto& from = static_cast<const MethodDirectoryProto&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:rpc.MethodDirectoryProto)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  _this->_impl_.method_ids_.MergeFrom(from._impl_.method_ids_);
+  if (!from._internal_service_name().empty()) {
+    _this->_internal_set_service_name(from._internal_service_name());
+  }
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void MethodDirectoryProto::CopyFrom(const MethodDirectoryProto& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:rpc.MethodDirectoryProto)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool MethodDirectoryProto::IsInitialized() const {
+  return true;
+}
+
+void MethodDirectoryProto::InternalSwap(MethodDirectoryProto* other) {
+  using std::swap;
+  auto* lhs_arena = GetArenaForAllocation();
+  auto* rhs_arena = other->GetArenaForAllocation();
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  _impl_.method_ids_.InternalSwap(&other->_impl_.method_ids_);
+  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
+      &_impl_.service_name_, lhs_arena,
+      &other->_impl_.service_name_, rhs_arena
+  );
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata MethodDirectoryProto::GetMetadata() const {
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_rpc_5fprotocol_2eproto_getter, &descriptor_table_rpc_5fprotocol_2eproto_once,
+      file_level_metadata_rpc_5fprotocol_2eproto[5]);
+}
+
 // @@protoc_insertion_point(namespace_scope)
 }  // namespace rpc
 PROTOBUF_NAMESPACE_OPEN
@@ -1129,6 +1461,14 @@ template<> PROTOBUF_NOINLINE ::rpc::RpcResponseProto*
 Arena::CreateMaybeMessage< ::rpc::RpcResponseProto >(Arena* arena) {
   return Arena::CreateMessageInternal< ::rpc::RpcResponseProto >(arena);
 }
+template<> PROTOBUF_NOINLINE ::rpc::MethodDirectoryProto_MethodIdsEntry_DoNotUse*
+Arena::CreateMaybeMessage< ::rpc::MethodDirectoryProto_MethodIdsEntry_DoNotUse >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::rpc::MethodDirectoryProto_MethodIdsEntry_DoNotUse >(arena);
+}
+template<> PROTOBUF_NOINLINE ::rpc::MethodDirectoryProto*
+Arena::CreateMaybeMessage< ::rpc::MethodDirectoryProto >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::rpc::MethodDirectoryProto >(arena);
+}
 PROTOBUF_NAMESPACE_CLOSE
 
 // @@protoc_insertion_point(global_scope)
@@ -13,7 +13,7 @@
 #error incompatible with your Protocol Buffer headers. Please update
 #error your headers.
 #endif
-#if 3021001 < PROTOBUF_MIN_PROTOC_VERSION
+#if 3021012 < PROTOBUF_MIN_PROTOC_VERSION
 #error This file was generated by an older version of protoc which is
 #error incompatible with your Protocol Buffer headers. Please
 #error regenerate this file with a newer version of protoc.
@@ -49,6 +49,12 @@ struct TableStruct_rpc_5fprotocol_2eproto {
 };
 extern const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable descriptor_table_rpc_5fprotocol_2eproto;
 namespace rpc {
+class MethodDirectoryProto;
+struct MethodDirectoryProtoDefaultTypeInternal;
+extern MethodDirectoryProtoDefaultTypeInternal _MethodDirectoryProto_default_instance_;
+class MethodDirectoryProto_MethodIdsEntry_DoNotUse;
+struct MethodDirectoryProto_MethodIdsEntry_DoNotUseDefaultTypeInternal;
+extern MethodDirectoryProto_MethodIdsEntry_DoNotUseDefaultTypeInternal _MethodDirectoryProto_MethodIdsEntry_DoNotUse_default_instance_;
 class RpcRequestProto;
 struct RpcRequestProtoDefaultTypeInternal;
 extern RpcRequestProtoDefaultTypeInternal _RpcRequestProto_default_instance_;
@@ -63,6 +69,8 @@ struct RpcResponseProto_MetadataEntry_DoNotUseDefaultTypeInternal;
 extern RpcResponseProto_MetadataEntry_DoNotUseDefaultTypeInternal _RpcResponseProto_MetadataEntry_DoNotUse_default_instance_;
 }  // namespace rpc
 PROTOBUF_NAMESPACE_OPEN
+template<> ::rpc::MethodDirectoryProto* Arena::CreateMaybeMessage<::rpc::MethodDirectoryProto>(Arena*);
+template<> ::rpc::MethodDirectoryProto_MethodIdsEntry_DoNotUse* Arena::CreateMaybeMessage<::rpc::MethodDirectoryProto_MethodIdsEntry_DoNotUse>(Arena*);
 template<> ::rpc::RpcRequestProto* Arena::CreateMaybeMessage<::rpc::RpcRequestProto>(Arena*);
 template<> ::rpc::RpcRequestProto_MetadataEntry_DoNotUse* Arena::CreateMaybeMessage<::rpc::RpcRequestProto_MetadataEntry_DoNotUse>(Arena*);
 template<> ::rpc::RpcResponseProto* Arena::CreateMaybeMessage<::rpc::RpcResponseProto>(Arena*);
@@ -636,6 +644,211 @@ class RpcResponseProto final :
   union { Impl_ _impl_; };
   friend struct ::TableStruct_rpc_5fprotocol_2eproto;
 };
+// -------------------------------------------------------------------
+
+class MethodDirectoryProto_MethodIdsEntry_DoNotUse : public ::PROTOBUF_NAMESPACE_ID::internal::MapEntry<MethodDirectoryProto_MethodIdsEntry_DoNotUse, 
+    std::string, uint32_t,
+    ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::TYPE_STRING,
+    ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::TYPE_UINT32> {
+public:
+  typedef ::PROTOBUF_NAMESPACE_ID::internal::MapEntry<MethodDirectoryProto_MethodIdsEntry_DoNotUse, 
+    std::string, uint32_t,
+    ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::TYPE_STRING,
+    ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::TYPE_UINT32> SuperType;
+  MethodDirectoryProto_MethodIdsEntry_DoNotUse();
+  explicit PROTOBUF_CONSTEXPR MethodDirectoryProto_MethodIdsEntry_DoNotUse(
+      ::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+  explicit MethodDirectoryProto_MethodIdsEntry_DoNotUse(::PROTOBUF_NAMESPACE_ID::Arena* arena);
+  void MergeFrom(const MethodDirectoryProto_MethodIdsEntry_DoNotUse& other);
+  static const MethodDirectoryProto_MethodIdsEntry_DoNotUse* internal_default_instance() { return reinterpret_cast<const MethodDirectoryProto_MethodIdsEntry_DoNotUse*>(&_MethodDirectoryProto_MethodIdsEntry_DoNotUse_default_instance_); }
+  static bool ValidateKey(std::string* s) {
+    return ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::VerifyUtf8String(s->data(), static_cast<int>(s->size()), ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::PARSE, "rpc.MethodDirectoryProto.MethodIdsEntry.key");
+ }
+  static bool ValidateValue(void*) { return true; }
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+  friend struct ::TableStruct_rpc_5fprotocol_2eproto;
+};
+
+// -------------------------------------------------------------------
+
+class MethodDirectoryProto final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:rpc.MethodDirectoryProto) */ {
+ public:
+  inline MethodDirectoryProto() : MethodDirectoryProto(nullptr) {}
+  ~MethodDirectoryProto() override;
+  explicit PROTOBUF_CONSTEXPR MethodDirectoryProto(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  MethodDirectoryProto(const MethodDirectoryProto& from);
+  MethodDirectoryProto(MethodDirectoryProto&& from) noexcept
+    : MethodDirectoryProto() {
+    *this = ::std::move(from);
+  }
+
+  inline MethodDirectoryProto& operator=(const MethodDirectoryProto& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline MethodDirectoryProto& operator=(MethodDirectoryProto&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const MethodDirectoryProto& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const MethodDirectoryProto* internal_default_instance() {
+    return reinterpret_cast<const MethodDirectoryProto*>(
+               &_MethodDirectoryProto_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    5;
+
+  friend void swap(MethodDirectoryProto& a, MethodDirectoryProto& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(MethodDirectoryProto* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(MethodDirectoryProto* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  MethodDirectoryProto* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<MethodDirectoryProto>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const MethodDirectoryProto& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const MethodDirectoryProto& from) {
+    MethodDirectoryProto::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
+
+  private:
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(MethodDirectoryProto* other);
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "rpc.MethodDirectoryProto";
+  }
+  protected:
+  explicit MethodDirectoryProto(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  private:
+  static void ArenaDtor(void* object);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kMethodIdsFieldNumber = 2,
+    kServiceNameFieldNumber = 1,
+  };
+  // map<string, uint32> method_ids = 2;
+  int method_ids_size() const;
+  private:
+  int _internal_method_ids_size() const;
+  public:
+  void clear_method_ids();
+  private:
+  const ::PROTOBUF_NAMESPACE_ID::Map< std::string, uint32_t >&
+      _internal_method_ids() const;
+  ::PROTOBUF_NAMESPACE_ID::Map< std::string, uint32_t >*
+      _internal_mutable_method_ids();
+  public:
+  const ::PROTOBUF_NAMESPACE_ID::Map< std::string, uint32_t >&
+      method_ids() const;
+  ::PROTOBUF_NAMESPACE_ID::Map< std::string, uint32_t >*
+      mutable_method_ids();
+
+  // string service_name = 1;
+  void clear_service_name();
+  const std::string& service_name() const;
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_service_name(ArgT0&& arg0, ArgT... args);
+  std::string* mutable_service_name();
+  PROTOBUF_NODISCARD std::string* release_service_name();
+  void set_allocated_service_name(std::string* service_name);
+  private:
+  const std::string& _internal_service_name() const;
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_service_name(const std::string& value);
+  std::string* _internal_mutable_service_name();
+  public:
+
+  // @@protoc_insertion_point(class_scope:rpc.MethodDirectoryProto)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::internal::MapField<
+        MethodDirectoryProto_MethodIdsEntry_DoNotUse,
+        std::string, uint32_t,
+        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::TYPE_STRING,
+        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::TYPE_UINT32> method_ids_;
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr service_name_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  };
+  union { Impl_ _impl_; };
+  friend struct ::TableStruct_rpc_5fprotocol_2eproto;
+};
 // ===================================================================
 
 
@@ -1113,6 +1326,91 @@ RpcResponseProto::mutable_metadata() {
   return _internal_mutable_metadata();
 }
 
+// -------------------------------------------------------------------
+
+// -------------------------------------------------------------------
+
+// MethodDirectoryProto
+
+// string service_name = 1;
+inline void MethodDirectoryProto::clear_service_name() {
+  _impl_.service_name_.ClearToEmpty();
+}
+inline const std::string& MethodDirectoryProto::service_name() const {
+  // @@protoc_insertion_point(field_get:rpc.MethodDirectoryProto.service_name)
+  return _internal_service_name();
+}
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void MethodDirectoryProto::set_service_name(ArgT0&& arg0, ArgT... args) {
+ 
+ _impl_.service_name_.Set(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  // @@protoc_insertion_point(field_set:rpc.MethodDirectoryProto.service_name)
+}
+inline std::string* MethodDirectoryProto::mutable_service_name() {
+  std::string* _s = _internal_mutable_service_name();
+  // @@protoc_insertion_point(field_mutable:rpc.MethodDirectoryProto.service_name)
+  return _s;
+}
+inline const std::string& MethodDirectoryProto::_internal_service_name() const {
+  return _impl_.service_name_.Get();
+}
+inline void MethodDirectoryProto::_internal_set_service_name(const std::string& value) {
+  
+  _impl_.service_name_.Set(value, GetArenaForAllocation());
+}
+inline std::string* MethodDirectoryProto::_internal_mutable_service_name() {
+  
+  return _impl_.service_name_.Mutable(GetArenaForAllocation());
+}
+inline std::string* MethodDirectoryProto::release_service_name() {
+  // @@protoc_insertion_point(field_release:rpc.MethodDirectoryProto.service_name)
+  return _impl_.service_name_.Release();
+}
+inline void MethodDirectoryProto::set_allocated_service_name(std::string* service_name) {
+  if (service_name != nullptr) {
+    
+  } else {
+    
+  }
+  _impl_.service_name_.SetAllocated(service_name, GetArenaForAllocation());
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.service_name_.IsDefault()) {
+    _impl_.service_name_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  // @@protoc_insertion_point(field_set_allocated:rpc.MethodDirectoryProto.service_name)
+}
+
+// map<string, uint32> method_ids = 2;
+inline int MethodDirectoryProto::_internal_method_ids_size() const {
+  return _impl_.method_ids_.size();
+}
+inline int MethodDirectoryProto::method_ids_size() const {
+  return _internal_method_ids_size();
+}
+inline void MethodDirectoryProto::clear_method_ids() {
+  _impl_.method_ids_.Clear();
+}
+inline const ::PROTOBUF_NAMESPACE_ID::Map< std::string, uint32_t >&
+MethodDirectoryProto::_internal_method_ids() const {
+  return _impl_.method_ids_.GetMap();
+}
+inline const ::PROTOBUF_NAMESPACE_ID::Map< std::string, uint32_t >&
+MethodDirectoryProto::method_ids() const {
+  // @@protoc_insertion_point(field_map:rpc.MethodDirectoryProto.method_ids)
+  return _internal_method_ids();
+}
+inline ::PROTOBUF_NAMESPACE_ID::Map< std::string, uint32_t >*
+MethodDirectoryProto::_internal_mutable_method_ids() {
+  return _impl_.method_ids_.MutableMap();
+}
+inline ::PROTOBUF_NAMESPACE_ID::Map< std::string, uint32_t >*
+MethodDirectoryProto::mutable_method_ids() {
+  // @@protoc_insertion_point(field_mutable_map:rpc.MethodDirectoryProto.method_ids)
+  return _internal_mutable_method_ids();
+}
+
 #ifdef __GNUC__
   #pragma GCC diagnostic pop
 #endif  // __GNUC__
@@ -1122,6 +1420,10 @@ RpcResponseProto::mutable_metadata() {
 
 // -------------------------------------------------------------------
 
+// -------------------------------------------------------------------
+
+// -------------------------------------------------------------------
+
 
 // @@protoc_insertion_point(namespace_scope)
 
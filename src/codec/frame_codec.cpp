@@ -27,40 +27,46 @@ std::vector<uint8_t> FrameCodec::encode(const std::vector<uint8_t> &message) {
     return frame;
 }
 
-// 解码：将buffer解码至message
-bool FrameCodec::decode(std::vector<uint8_t> &buffer, std::vector<uint8_t> &message) {
-    if (buffer.size() < getHeaderSize()) {
-        return false;
+// 原地编码：长度前缀写进预留头部
+void FrameCodec::encode(Buffer& message) {
+    if (message.readableBytes() == 0) {
+        return;
     }
+    message.prependInt<uint32_t>(static_cast<uint32_t>(message.readableBytes()));
+}
 
-    // 先读消息头
-    uint32_t network_length;
-    std::memcpy(&network_length, buffer.data(), getHeaderSize());
-    uint32_t message_length = networkToHost32(network_length);
-
-    // 检查消息长度
-    if (message_length > 1024 * 1024 * 100) { // 消息大于100M
-        std::cerr << "Message too large: " << message_length << " bytes" << std::endl;
-        return false;
+// 流式解码一帧：帧体以视图返回
+FrameStatus FrameCodec::decode(Buffer& buffer, const uint8_t*& body, size_t& body_length) const {
+    uint32_t length = 0;
+    FrameStatus status = inspect(buffer, length);
+    if (status == FrameStatus::kInvalid) {
+        std::cerr << "Invalid frame length: " << length << std::endl;
     }
-    size_t total_frame_size = getHeaderSize() + message_length;
-    if (buffer.size() < total_frame_size) { // 数据不完整
-        return false;
+    if (status != FrameStatus::kComplete) {
+        return status;
     }
 
-    // 读消息正文
-    message.clear();
-    message.reserve(message_length);
-    message.insert(message.end(), buffer.begin() + getHeaderSize(), buffer.begin() + total_frame_size);
-
-    buffer.erase(buffer.begin(), buffer.begin() + total_frame_size);
+    // 只前移读指针：视图指向的内存在下一次写入前不会被覆盖
+    body = buffer.peek() + kHeaderSize;
+    body_length = length;
+    buffer.retrieve(kHeaderSize + length);
+    return status;
+}
 
-    return true;
+// 流式解码一帧，帧体拷到message
+FrameStatus FrameCodec::decode(Buffer& buffer, std::vector<uint8_t>& message) const {
+    const uint8_t* body = nullptr;
+    size_t body_length = 0;
+    FrameStatus status = decode(buffer, body, body_length);
+    if (status == FrameStatus::kComplete) {
+        message.assign(body, body + body_length);
+    }
+    return status;
 }
 
 // 获取消息长度(4字节)
 size_t FrameCodec::getHeaderSize() const {
-    return sizeof(uint32_t);
+    return kHeaderSize;
 }
 
 // 32位主机序 -> 网络序
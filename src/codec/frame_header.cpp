@@ -0,0 +1,73 @@
+#include "frame_header.h"
+#include "io_buf.h"
+
+namespace rpc {
+
+namespace {
+
+// 按网络序写/读 bytes 字节的整数
+void putBigEndian(uint8_t* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * (bytes - 1 - i)));
+    }
+}
+
+uint64_t getBigEndian(const uint8_t* data, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+} // namespace
+
+bool FrameHeader::detect(const uint8_t* data, size_t len) {
+    return len >= 2 && getBigEndian(data, 2) == kMagic;
+}
+
+bool FrameHeader::detect(const IoBuf& body) {
+    uint8_t magic[2];
+    return body.copyOut(magic, sizeof(magic)) && detect(magic, sizeof(magic));
+}
+
+void FrameHeader::encode(uint8_t* out) const {
+    putBigEndian(out, kMagic, 2);
+    out[2] = version;
+    out[3] = flags;
+    putBigEndian(out + 4, header_length, 2);
+    out[6] = compression;
+    out[7] = 0;
+    putBigEndian(out + 8, request_id, 8);
+    putBigEndian(out + 16, method_id, 4);
+    putBigEndian(out + 20, deadline_ms, 4);
+}
+
+bool FrameHeader::decode(const uint8_t* data, size_t len) {
+    if (len < kSize || !detect(data, len)) {
+        return false;
+    }
+    decodeFixed(data);
+    return header_length >= kSize && header_length <= len;
+}
+
+bool FrameHeader::decode(const IoBuf& body) {
+    uint8_t bytes[kSize];
+    if (!body.copyOut(bytes, kSize) || !detect(bytes, kSize)) {
+        return false;
+    }
+    decodeFixed(bytes);
+    return header_length >= kSize && header_length <= body.readableBytes();
+}
+
+void FrameHeader::decodeFixed(const uint8_t* data) {
+    version = data[2];
+    flags = data[3];
+    header_length = static_cast<uint16_t>(getBigEndian(data + 4, 2));
+    compression = data[6];
+    request_id = getBigEndian(data + 8, 8);
+    method_id = static_cast<uint32_t>(getBigEndian(data + 16, 4));
+    deadline_ms = static_cast<uint32_t>(getBigEndian(data + 20, 4));
+}
+
+} // namespace rpc
@@ -15,17 +15,19 @@ void MessageHandler::handleData(std::shared_ptr<TcpConnection> connection, const
         return;
     }
 
-    receive_buffer_.insert(receive_buffer_.end(), data.begin(), data.end());
+    receive_buffer_.append(data);
 
     while (true) {
-        std::vector<uint8_t> message;
-
-        if (codec_->decode(receive_buffer_, message)) {
+        FrameStatus status = codec_->decode(receive_buffer_, message_);
+        if (status == FrameStatus::kComplete) {
             // 解码成功
             if (message_callback_) {
-                message_callback_(connection, message);
+                message_callback_(connection, message_);
             }
         } else {
+            if (status == FrameStatus::kInvalid) {
+                receive_buffer_.retrieveAll();  // 长度非法，后面的数据已无法定界
+            }
             break;
         }
     }
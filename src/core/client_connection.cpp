@@ -0,0 +1,336 @@
+#include "client_connection.h"
+#include "rpc_protocol_helper.h"
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace rpc {
+
+ClientConnection::ClientConnection(std::shared_ptr<TcpClient> tcp_client, const std::string& service_name)
+    :tcp_client_(std::move(tcp_client)),
+     service_name_(service_name),
+     open_(true),
+     closed_(false),
+     next_request_id_(kHandshakeRequestId + 1),
+     directory_ready_(false),
+     legacy_peer_(false),
+     reader_destroyed_(nullptr)
+{
+    // 读线程至少每 kSweepIntervalMs 从 receive 返回一次，取走新登记的截止时间
+    tcp_client_->setReceiveTimeout(kSweepIntervalMs);
+    reader_ = std::thread(&ClientConnection::readLoop, this);
+}
+
+ClientConnection::~ClientConnection() {
+    close();
+    if (reader_.joinable()) {
+        if (std::this_thread::get_id() == reader_.get_id()) {
+            // 最后一个引用在读线程的回调里释放：读线程从回调返回后看到标志直接退出
+            *reader_destroyed_ = true;
+            reader_.detach();
+        } else {
+            // close() 是在读线程里调用的，当时没有 join
+            reader_.join();
+        }
+    }
+}
+
+// 分配请求 ID
+uint64_t ClientConnection::nextRequestId() {
+    return next_request_id_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 登记在途调用并发出请求帧：先登记再发送，响应不可能比登记先到
+void ClientConnection::start(uint64_t request_id, const Buffer& frame, google::protobuf::Message* response,
+                             uint32_t timeout_ms, Completion complete) {
+    uint64_t expire_ms = TimerWheel::nowMs() + timeout_ms;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        if (!open_) {
+            throw std::runtime_error("Client_Connection.cpp::Connection closed");
+        }
+        pending_[request_id] = PendingCall{response, std::move(complete)};
+        unscheduled_.push_back(Deadline{request_id, expire_ms});
+    }
+    pending_cv_.notify_one();
+
+    bool sent = false;
+    {
+        // 对端读得慢、发送缓冲区满时最多等到本次调用的截止时间
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        tcp_client_->setSendTimeout(timeout_ms);
+        sent = tcp_client_->send(frame);
+    }
+    if (!sent) {
+        // 唤醒读线程，由它发现连接断开并让其余在途调用失败
+        tcp_client_->shutdown();
+        PendingCall call;
+        if (takePending(request_id, call)) {
+            throw std::runtime_error("Client_Connection.cpp::Failed to send request");
+        }
+        // 否则已由读线程以失败完成
+    }
+}
+
+// 同步调用：等待读线程完成它
+RpcResponse ClientConnection::call(uint64_t request_id, const Buffer& frame, google::protobuf::Message* response,
+                                   uint32_t timeout_ms, ReplyFormat* reply_format) {
+    std::promise<RpcResponse> promise;
+    std::future<RpcResponse> future = promise.get_future();
+    ReplyFormat format = ReplyFormat::kNone;
+    start(request_id, frame, response, timeout_ms, [&promise, &format](RpcResponse& result, ReplyFormat result_format) {
+        format = result_format;
+        promise.set_value(std::move(result));
+    });
+
+    if (future.wait_for(std::chrono::milliseconds(timeout_ms)) != std::future_status::ready) {
+        PendingCall call;
+        if (takePending(request_id, call)) {
+            throw std::runtime_error("Client_Connection.cpp::Timeout waiting for response to request " +
+                                     std::to_string(request_id));
+        }
+        // 读线程已经取走，正在解析，马上完成
+    }
+    RpcResponse result = future.get();
+    if (reply_format) {
+        *reply_format = format;
+    }
+    return result;
+}
+
+// 方法目录握手：把服务名发给服务端，取回它分配的方法 ID
+bool ClientConnection::lookupMethodId(const std::string& method_name, uint32_t& method_id) {
+    std::lock_guard<std::mutex> lock(directory_mutex_);
+    if (legacy_peer_) {
+        return false;
+    }
+    if (!directory_ready_) {
+        FrameHeader header;
+        header.flags = FrameHeader::kFlagHandshake;
+        header.request_id = kHandshakeRequestId;
+        MethodDirectoryProto directory;
+        directory.set_service_name(service_name_);
+        Buffer frame;
+        RpcProtocolHelper::serializeFramedRequest(header, directory, frame);
+        frame_codec_.encode(frame);
+
+        MethodDirectoryProto reply;
+        ReplyFormat format = ReplyFormat::kNone;
+        RpcResponse response = call(kHandshakeRequestId, frame, &reply, kDefaultCallTimeoutMs, &format);
+        if (format == ReplyFormat::kNone) {
+            // 超时或连接断开：不知道对端是什么版本，不降级，下次调用重新握手
+            throw std::runtime_error("Method directory handshake failed: " + response.error_message);
+        }
+        if (format == ReplyFormat::kLegacy) {
+            // 旧版本服务端把握手当成解析失败的旧格式请求回复
+            std::cerr << "Client_Connection.cpp::Server does not support frame header, falling back to legacy framing" << std::endl;
+            legacy_peer_ = true;
+            return false;
+        }
+        if (!response.success) {
+            throw std::runtime_error("Method directory handshake failed: " + response.error_message);
+        }
+        method_ids_.clear();
+        for (const auto& pair : reply.method_ids()) {
+            method_ids_[pair.first] = pair.second;
+        }
+        directory_ready_ = true;
+    }
+
+    auto method = method_ids_.find(method_name);
+    if (method == method_ids_.end()) {
+        throw std::runtime_error("Method not found: " + service_name_ + "." + method_name);
+    }
+    method_id = method->second;
+    return true;
+}
+
+// 关闭连接
+void ClientConnection::close() {
+    if (closed_.exchange(true)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        open_ = false;
+    }
+    pending_cv_.notify_all();
+    // 读线程可能正阻塞在 receive 里；在读线程自己的回调里关闭时不能 join 自己，留给析构函数
+    tcp_client_->shutdown();
+    if (reader_.joinable() && std::this_thread::get_id() != reader_.get_id()) {
+        reader_.join();
+    }
+    failAll("Client_Connection.cpp::Connection closed");
+    tcp_client_->disconnect();
+}
+
+bool ClientConnection::isDirectoryReady() const {
+    return directory_ready_.load() || legacy_peer_.load();
+}
+
+bool ClientConnection::isOpen() const {
+    return open_.load();
+}
+
+size_t ClientConnection::pendingCount() const {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    return pending_.size();
+}
+
+// 读线程
+void ClientConnection::readLoop() {
+    bool destroyed = false;
+    reader_destroyed_ = &destroyed;
+    std::vector<Deadline> deadlines;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(pending_mutex_);
+            pending_cv_.wait(lock, [this]() { return closed_ || !pending_.empty(); });
+            if (closed_) {
+                return;
+            }
+            deadlines.swap(unscheduled_);
+        }
+        scheduleDeadlines(deadlines);
+        deadlines.clear();
+        // 回调期间持有自身引用；取不到说明别的线程正在析构，它会 join 本线程
+        std::shared_ptr<ClientConnection> self = weak_from_this().lock();
+        if (!self) {
+            return;
+        }
+        bool keep_reading = readOnce();
+        self.reset(); // 可能是最后一个引用：析构在本线程完成后 destroyed 为 true，不能再访问成员
+        if (destroyed || !keep_reading) {
+            return;
+        }
+    }
+}
+
+// 收一帧并完成对应的调用
+bool ClientConnection::readOnce() {
+    // 最多等到下一个截止时间；没有更早的定时器时也要每 kSweepIntervalMs 回来取新登记的截止时间
+    int64_t wait_ms = deadline_wheel_.nextTimeoutMs();
+    if (wait_ms < 0 || wait_ms > kSweepIntervalMs) {
+        wait_ms = kSweepIntervalMs;
+    }
+    tcp_client_->setReceiveTimeout(static_cast<uint32_t>(std::max<int64_t>(wait_ms, 1)));
+
+    // 响应帧体以视图返回，下一次 receive 之前有效：在这之前解析完
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    bool received = tcp_client_->receive(data, length);
+    deadline_wheel_.advance();
+    if (!received) {
+        if (closed_) {
+            return false;
+        }
+        if (tcp_client_->getState() == ConnectionState::CONNECTED) {
+            return true; // 只是暂时没有数据（半帧留在接收缓冲区），在途调用各自超时
+        }
+        std::cerr << "Client_Connection.cpp::Connection lost, failing " << pendingCount() << " in-flight calls" << std::endl;
+        failAll("Client_Connection.cpp::Connection lost");
+        return false;
+    }
+
+    uint64_t request_id = 0;
+    if (!RpcProtocolHelper::peekResponseId(data, length, request_id)) {
+        std::cerr << "Client_Connection.cpp::Discarding malformed response frame" << std::endl;
+        return true;
+    }
+    PendingCall call;
+    if (!takePending(request_id, call) && !(request_id == 0 && takeSolePending(request_id, call))) {
+        // 调用已超时
+        std::cerr << "Client_Connection.cpp::Discarding response to unknown request " << request_id << std::endl;
+        return true;
+    }
+    auto timer = deadline_timers_.find(request_id);
+    if (timer != deadline_timers_.end()) {
+        deadline_wheel_.cancelTimer(timer->second);
+        deadline_timers_.erase(timer);
+    }
+
+    // 服务端按请求的格式回复，响应消息从接收缓冲区原地解析
+    bool framed = FrameHeader::detect(data, length);
+    RpcResponse response;
+    try {
+        if (framed) {
+            response = RpcProtocolHelper::parseFramedResponse(data, length, call.response);
+        } else {
+            response = RpcProtocolHelper::parseResponse(data, length, call.response);
+        }
+    } catch (std::exception& e) {
+        response = RpcResponse();
+        response.request_id = request_id;
+        response.error_message = "Client_Connection.cpp::Failed to parse response: " + std::string(e.what());
+    }
+    call.complete(response, framed ? ReplyFormat::kFramed : ReplyFormat::kLegacy);
+    return true;
+}
+
+bool ClientConnection::takePending(uint64_t request_id, PendingCall& call) {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    auto it = pending_.find(request_id);
+    if (it == pending_.end()) {
+        return false;
+    }
+    call = std::move(it->second);
+    pending_.erase(it);
+    return true;
+}
+
+// 把新登记的截止时间加到时间轮上
+void ClientConnection::scheduleDeadlines(const std::vector<Deadline>& deadlines) {
+    uint64_t now_ms = TimerWheel::nowMs();
+    for (const Deadline& deadline : deadlines) {
+        // 已经过期的至少等一个 tick，在下一次 advance 时失败
+        uint64_t delay_ms = deadline.expire_ms > now_ms ? deadline.expire_ms - now_ms : 0;
+        uint64_t request_id = deadline.request_id;
+        deadline_timers_[request_id] = deadline_wheel_.addTimer(delay_ms, [this, request_id]() { expire(request_id); }, now_ms);
+    }
+}
+
+// 截止时间到了：调用还在途就以超时失败
+void ClientConnection::expire(uint64_t request_id) {
+    deadline_timers_.erase(request_id);
+    PendingCall call;
+    if (!takePending(request_id, call)) {
+        return; // 已经完成，或被发起方撤回
+    }
+    RpcResponse response;
+    response.request_id = request_id;
+    response.error_message = "Client_Connection.cpp::Timeout waiting for response to request " + std::to_string(request_id);
+    call.complete(response, ReplyFormat::kNone);
+}
+
+// 旧版本服务端的错误响应请求 ID 一律是 0：只有一个在途调用时，它就是这个调用的
+bool ClientConnection::takeSolePending(uint64_t& request_id, PendingCall& call) {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    if (pending_.size() != 1) {
+        return false;
+    }
+    auto it = pending_.begin();
+    request_id = it->first;
+    call = std::move(it->second);
+    pending_.erase(it);
+    return true;
+}
+
+void ClientConnection::failAll(const std::string& error) {
+    std::unordered_map<uint64_t, PendingCall> pending;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        open_ = false;
+        pending.swap(pending_);
+    }
+    for (auto& pair : pending) {
+        RpcResponse response;
+        response.request_id = pair.first;
+        response.error_message = error;
+        pair.second.complete(response, ReplyFormat::kNone);
+    }
+}
+
+}
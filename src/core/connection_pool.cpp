@@ -0,0 +1,268 @@
+#include "connection_pool.h"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+namespace rpc {
+
+ClientConnectionPool::ClientConnectionPool(const ConnectionPoolConfig& config)
+    :config_(config),
+     next_reap_(Clock::now()),
+     total_connects_(0)
+{
+}
+
+ClientConnectionPool::~ClientConnectionPool() {
+    clear();
+}
+
+// 进程内共享的连接池
+ClientConnectionPool& ClientConnectionPool::instance() {
+    static ClientConnectionPool pool;
+    return pool;
+}
+
+// 端点键
+std::string ClientConnectionPool::makeKey(const std::string& service_name, const std::string& instance_id, const std::string& transport) {
+    return service_name + "@" + instance_id + "/" + transport;
+}
+
+// 取一条可用连接
+std::shared_ptr<ClientConnection> ClientConnectionPool::acquire(const std::string& key, const Connector& connect) {
+    std::vector<std::shared_ptr<ClientConnection>> retired; // 在池锁外关闭
+    std::shared_ptr<ClientConnection> reused;
+    bool need_connect = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Clock::time_point now = Clock::now();
+        if (config_.idle_timeout_ms > 0 && now >= next_reap_) {
+            reapLocked(now, retired);
+            next_reap_ = now + std::chrono::milliseconds(config_.idle_timeout_ms);
+        }
+        Endpoint& endpoint = endpoints_[key];
+        pruneLocked(endpoint, now, retired);
+
+        // 先用已有的连接：没有连接、或者都忙且还能再建时才建新连接
+        PooledConnection* best = leastLoaded(endpoint);
+        size_t total = endpoint.connections.size() + endpoint.connecting;
+        bool grow = !best ||
+            (total < config_.max_connections &&
+             (total < config_.min_connections || best->connection->pendingCount() >= config_.max_pending_per_connection));
+        // 不健康的端点在退避期内不建连，有连接就继续用
+        if (grow && !endpoint.healthy && now < endpoint.retry_after) {
+            grow = false;
+        }
+        if (best && !grow) {
+            best->last_used = now;
+            reused = best->connection;
+        }
+        if (grow) {
+            endpoint.connecting++;
+            need_connect = true;
+        }
+    }
+    // 可能就在被换下的连接的读线程里（完成回调中重新取连接）：close 此时不等读线程，由它自行退出
+    for (auto& connection : retired) {
+        connection->close();
+    }
+    if (!need_connect) {
+        return reused;
+    }
+
+    // 建连在池锁外进行，同一端点上的其他调用不受影响
+    std::shared_ptr<ClientConnection> connection;
+    try {
+        connection = connect();
+    } catch (const std::exception& e) {
+        std::cerr << "Connection_Pool.cpp::Failed to connect " << key << ": " << e.what() << std::endl;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+    Endpoint& endpoint = endpoints_[key];
+    endpoint.connecting--;
+    if (connection && connection->isOpen()) {
+        endpoint.healthy = true;
+        endpoint.connections.push_back({connection, now});
+        total_connects_++;
+        return connection;
+    }
+    endpoint.healthy = false;
+    endpoint.retry_after = now + std::chrono::milliseconds(config_.unhealthy_backoff_ms);
+    std::cerr << "Connection_Pool.cpp::Endpoint marked unhealthy: " << key << std::endl;
+    // 新建失败（例如想再分担一条）时，已有的连接仍然可用
+    PooledConnection* best = leastLoaded(endpoint);
+    if (!best) {
+        return nullptr;
+    }
+    best->last_used = now;
+    return best->connection;
+}
+
+// 不建连地取一条可用连接：与 acquire 的取舍相同，需要建连时返回 nullptr
+std::shared_ptr<ClientConnection> ClientConnectionPool::tryAcquire(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = endpoints_.find(key);
+    if (it == endpoints_.end()) {
+        return nullptr;
+    }
+    Endpoint& endpoint = it->second;
+    // 已断开的连接留给 acquire 移出并关闭（要等读线程退出）
+    PooledConnection* best = nullptr;
+    size_t best_pending = 0;
+    size_t open = 0;
+    for (auto& pooled : endpoint.connections) {
+        if (!pooled.connection->isOpen()) {
+            continue;
+        }
+        open++;
+        size_t pending = pooled.connection->pendingCount();
+        if (!best || pending < best_pending) {
+            best = &pooled;
+            best_pending = pending;
+        }
+    }
+    if (!best) {
+        return nullptr;
+    }
+    Clock::time_point now = Clock::now();
+    size_t total = open + endpoint.connecting;
+    bool grow = total < config_.max_connections &&
+        (total < config_.min_connections || best_pending >= config_.max_pending_per_connection);
+    if (grow && (endpoint.healthy || now >= endpoint.retry_after)) {
+        return nullptr;
+    }
+    best->last_used = now;
+    return best->connection;
+}
+
+// 端点是否可用
+bool ClientConnectionPool::isHealthy(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = endpoints_.find(key);
+    if (it == endpoints_.end()) {
+        return true;
+    }
+    return it->second.healthy || Clock::now() >= it->second.retry_after;
+}
+
+// 回收超时的空闲连接
+size_t ClientConnectionPool::reapIdle() {
+    std::vector<std::shared_ptr<ClientConnection>> retired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reapLocked(Clock::now(), retired);
+    }
+    for (auto& connection : retired) {
+        connection->close();
+    }
+    return retired.size();
+}
+
+// 关闭所有连接
+void ClientConnectionPool::clear() {
+    std::vector<std::shared_ptr<ClientConnection>> retired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = endpoints_.begin(); it != endpoints_.end();) {
+            for (auto& pooled : it->second.connections) {
+                retired.push_back(std::move(pooled.connection));
+            }
+            // 还有在建的连接时保留端点，建好后再放回来
+            if (it->second.connecting > 0) {
+                it->second.connections.clear();
+                ++it;
+            } else {
+                it = endpoints_.erase(it);
+            }
+        }
+    }
+    for (auto& connection : retired) {
+        connection->close();
+    }
+}
+
+// 修改配置
+void ClientConnectionPool::setConfig(const ConnectionPoolConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    next_reap_ = Clock::now();
+}
+
+// 端点当前的连接数
+size_t ClientConnectionPool::connectionCount(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = endpoints_.find(key);
+    return it == endpoints_.end() ? 0 : it->second.connections.size();
+}
+
+// 累计建立的连接数
+uint64_t ClientConnectionPool::totalConnects() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_connects_;
+}
+
+// 移出已断开的连接与超时的空闲连接
+void ClientConnectionPool::pruneLocked(Endpoint& endpoint, Clock::time_point now,
+                                       std::vector<std::shared_ptr<ClientConnection>>& retired) {
+    auto& connections = endpoint.connections;
+    auto broken = std::partition(connections.begin(), connections.end(), [](const PooledConnection& pooled) {
+        return pooled.connection->isOpen();
+    });
+    for (auto it = broken; it != connections.end(); ++it) {
+        retired.push_back(std::move(it->connection));
+    }
+    connections.erase(broken, connections.end());
+
+    // 有在途调用的连接不算空闲
+    for (auto& pooled : connections) {
+        if (pooled.connection->pendingCount() > 0) {
+            pooled.last_used = now;
+        }
+    }
+    if (config_.idle_timeout_ms == 0) {
+        return;
+    }
+    // 最久没用的先回收，保留 min_connections 条
+    std::sort(connections.begin(), connections.end(), [](const PooledConnection& a, const PooledConnection& b) {
+        return a.last_used < b.last_used;
+    });
+    auto idle_timeout = std::chrono::milliseconds(config_.idle_timeout_ms);
+    size_t reapable = connections.size() > config_.min_connections ? connections.size() - config_.min_connections : 0;
+    size_t reaped = 0;
+    while (reaped < reapable && now - connections[reaped].last_used >= idle_timeout) {
+        retired.push_back(std::move(connections[reaped].connection));
+        reaped++;
+    }
+    connections.erase(connections.begin(), connections.begin() + reaped);
+}
+
+// 回收所有端点
+void ClientConnectionPool::reapLocked(Clock::time_point now, std::vector<std::shared_ptr<ClientConnection>>& retired) {
+    for (auto it = endpoints_.begin(); it != endpoints_.end();) {
+        Endpoint& endpoint = it->second;
+        pruneLocked(endpoint, now, retired);
+        bool backing_off = !endpoint.healthy && now < endpoint.retry_after;
+        if (endpoint.connections.empty() && endpoint.connecting == 0 && !backing_off) {
+            it = endpoints_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// 在途调用最少的连接
+ClientConnectionPool::PooledConnection* ClientConnectionPool::leastLoaded(Endpoint& endpoint) {
+    PooledConnection* best = nullptr;
+    size_t best_pending = 0;
+    for (auto& pooled : endpoint.connections) {
+        size_t pending = pooled.connection->pendingCount();
+        if (!best || pending < best_pending) {
+            best = &pooled;
+            best_pending = pending;
+        }
+    }
+    return best;
+}
+
+}
@@ -1,4 +1,7 @@
 #include "rpc_client.h"
+#include <algorithm>
+#include <condition_variable>
+#include <iterator>
 
 
 
@@ -9,7 +12,10 @@ RpcClientStubImpl::RpcClientStubImpl(const std::string& service_name, const std:
     :service_name_(service_name),
      host_(host),
      port_(port),
-     connected_(false),
+     io_backend_("epoll"),
+     prefer_unix_socket_(true),
+     frame_header_(true),
+     request_timeout_ms_(0),
      use_service_discovery_(false)
     {
         frame_codec_ = std::make_unique<FrameCodec>();
@@ -20,7 +26,10 @@ RpcClientStubImpl::RpcClientStubImpl(const std::string& service_name, std::uniqu
     :service_name_(service_name),
      host_(""),
      port_(0),
-     connected_(false),
+     io_backend_("epoll"),
+     prefer_unix_socket_(true),
+     frame_header_(true),
+     request_timeout_ms_(0),
      use_service_discovery_(true),
      registry_(std::move(registry)),
      load_balancer_(std::move(load_balancer))
@@ -36,176 +45,375 @@ RpcClientStubImpl::~RpcClientStubImpl() {
     disconnect();
 }
 
+// 异步调用，结果以 future 返回
+std::future<bool> RpcClientStub::asyncCallMethod(const std::string& method_name,
+                                                 const google::protobuf::Message& request,
+                                                 google::protobuf::Message* response) {
+    auto promise = std::make_shared<std::promise<bool>>();
+    std::future<bool> future = promise->get_future();
+    asyncCallMethod(method_name, request, response, [promise](bool success, const std::string& error_message) {
+        if (!success) {
+            std::cerr << "Rpc_Client.cpp::RPC call failed: " << error_message << std::endl;
+        }
+        promise->set_value(success);
+    });
+    return future;
+}
+
+// 默认不支持不阻塞地发起调用
+bool RpcClientStub::tryAsyncCallMethod(const std::string&, const google::protobuf::Message&,
+                                       google::protobuf::Message*, CallCallback) {
+    return false;
+}
+
+// 扇出：全部发出后等最后一个完成
+size_t RpcClientStub::callMany(std::vector<RpcCall>& calls) {
+    std::mutex mutex;
+    std::condition_variable all_done;
+    size_t remaining = calls.size();
+    for (RpcCall& call : calls) {
+        asyncCallMethod(call.method_name, *call.request, call.response,
+                        [&call, &mutex, &all_done, &remaining](bool success, const std::string& error_message) {
+            call.success = success;
+            call.error_message = error_message;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--remaining == 0) {
+                all_done.notify_all();
+            }
+        });
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    all_done.wait(lock, [&remaining]() { return remaining == 0; });
+    return static_cast<size_t>(std::count_if(calls.begin(), calls.end(), [](const RpcCall& call) { return call.success; }));
+}
+
 // 调用RPC方法
 bool RpcClientStubImpl::callMethod(const std::string& method_name,
                 const google::protobuf::Message& request,
                 google::protobuf::Message& response) 
 {
-    // 如果使用服务发现模式，要先选择实例，再进行连接
-    if (use_service_discovery_) {
-        // 从注册中心发现服务，通过负载均衡器选择实例
-        ServiceInstance instance = selectServiceInstance();
-        // 检查是否需要重新连接：如果实例改变，需要重新连接
-        std::string new_instance_id = instance.getId();
-        if (!isConnected() || current_instance_id_ != new_instance_id) {
-            //先断开旧连接
-            disconnect();
-            // 连接到新服务器
-            if (!connectToInstance(instance)) {
-                std::cerr << "Rpc_Client.cpp::Failed to connect to service instance: " << new_instance_id << std::endl;
-                return false;
-            }
-            current_instance_id_ = new_instance_id;
-        }
-        // 如果使用的是最少连接数负载均衡器，要更新连接信息
-        if (load_balancer_->getName() == "LeastConnection") {
-            load_balancer_->updateStats(current_instance_id_, true);
-        }
-    } else { // 直连模式
-        if (!isConnected()) {
-            if (!connect()) {
-                std::cerr << "Rpc_Client.cpp::Not connected to server" << std::endl;
-                return false;
-            }
-        }
+    // 取连接：服务发现模式下先选实例，从连接池取它的连接；直连模式下没有连接或连接已失效时重连
+    std::string instance_id;
+    std::shared_ptr<ClientConnection> connection = acquireConnection(instance_id);
+    if (!connection) {
+        return false;
+    }
+    // 如果使用的是最少连接数负载均衡器，要更新连接信息
+    if (use_service_discovery_ && load_balancer_->getName() == "LeastConnection") {
+        load_balancer_->updateStats(instance_id, true);
     }
 
     bool result = false;
     try {
-        // 创建RPC请求
-        RpcRequest rpc_request;
-        rpc_request.service_name = service_name_;
-        rpc_request.method_name = method_name;
-        rpc_request.request_id = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
-    
-        // 序列化请求
-        std::string request_str;
-        if (!request.SerializeToString(&request_str)) {
-            std::cerr << "Rpc_Client.cpp::Failed to serialize request" << std::endl;
-            result = false;
-        }
-        rpc_request.request_data = std::vector<uint8_t>(request_str.begin(), request_str.end());
-    
-        // 发送请求，获取响应
-        RpcResponse rpc_response = sendRpcRequest(rpc_request);
+        // 发送请求，等待读线程交回响应（请求消息直接序列化进请求帧，响应消息直接从响应帧解析）
+        Buffer frame;
+        uint64_t request_id = encodeRequest(*connection, method_name, request, frame);
+        RpcResponse rpc_response = connection->call(request_id, frame, &response, callTimeoutMs());
         if (!rpc_response.success) {
             std::cerr << "Rpc_Client.cpp::RPC call failed: " << rpc_response.error_message << std::endl;
-            result = false;
-        }
-    
-        // 反序列化RPC响应
-        if (!response.ParseFromArray(rpc_response.response_data.data(), rpc_response.response_data.size())) {
-            std::cerr << "Rpc_Client.cpp::Failed to parse response" << std::endl;
-            result = false;
         }
-
-        result = true;
+        result = rpc_response.success;
     } catch (const std::exception& e) {
         std::cerr << "Rpc_Client.cpp::RPC call error: " << e.what() << std::endl;
-        return false;
+        result = false;
     }
 
-cleanup:
+    // 失败也要减掉最少连接数负载均衡器的在途计数
     if (use_service_discovery_ && load_balancer_ && 
         load_balancer_->getName() == "LeastConnection" && 
-        !current_instance_id_.empty()) 
+        !instance_id.empty()) 
         {
-            load_balancer_->updateStats(current_instance_id_, false);
+            load_balancer_->updateStats(instance_id, false);
         }
     return result;
 }
+
+// 异步调用RPC方法：请求发出即返回，done 由读线程在响应到达时执行
+void RpcClientStubImpl::asyncCallMethod(const std::string& method_name,
+                                        const google::protobuf::Message& request,
+                                        google::protobuf::Message* response,
+                                        CallCallback done)
+{
+    // 先不阻塞地取（服务发现模式下沿用最近的发现结果），取不到再查注册中心、建连、握手
+    std::string instance_id;
+    std::shared_ptr<ClientConnection> connection;
+    try {
+        connection = tryAcquireConnection(instance_id);
+        if (!connection) {
+            connection = acquireConnection(instance_id);
+        }
+    } catch (const std::exception& e) {
+        done(false, "Rpc_Client.cpp::RPC call error: " + std::string(e.what()));
+        return;
+    }
+    if (!connection) {
+        done(false, "Rpc_Client.cpp::Not connected to server");
+        return;
+    }
+    startCall(connection, instance_id, method_name, request, response, std::move(done));
+}
+
+// 不阻塞地发起异步调用
+bool RpcClientStubImpl::tryAsyncCallMethod(const std::string& method_name,
+                                           const google::protobuf::Message& request,
+                                           google::protobuf::Message* response,
+                                           CallCallback done)
+{
+    // 需要查注册中心、建连或握手时会阻塞，交给调用方换线程
+    std::string instance_id;
+    std::shared_ptr<ClientConnection> connection = tryAcquireConnection(instance_id);
+    if (!connection) {
+        return false;
+    }
+    startCall(connection, instance_id, method_name, request, response, std::move(done));
+    return true;
+}
+
+// 在已取得的连接上发出异步调用
+void RpcClientStubImpl::startCall(const std::shared_ptr<ClientConnection>& connection, const std::string& instance_id,
+                                  const std::string& method_name, const google::protobuf::Message& request,
+                                  google::protobuf::Message* response, CallCallback done)
+{
+    // 最少连接数负载均衡器：发出时计数，完成时在读线程里减掉
+    LoadBalancer* load_balancer = nullptr;
+    if (use_service_discovery_ && load_balancer_->getName() == "LeastConnection") {
+        load_balancer = load_balancer_.get();
+        load_balancer->updateStats(instance_id, true);
+    }
+
+    try {
+        Buffer frame;
+        uint64_t request_id = encodeRequest(*connection, method_name, request, frame);
+        connection->start(request_id, frame, response, callTimeoutMs(),
+                          [done, load_balancer, instance_id](RpcResponse& rpc_response, ClientConnection::ReplyFormat) {
+            if (load_balancer) {
+                load_balancer->updateStats(instance_id, false);
+            }
+            done(rpc_response.success, rpc_response.error_message);
+        });
+    } catch (const std::exception& e) {
+        if (load_balancer) {
+            load_balancer->updateStats(instance_id, false);
+        }
+        done(false, "Rpc_Client.cpp::RPC call error: " + std::string(e.what()));
+    }
+}
     
 // 连接服务器
 bool RpcClientStubImpl::connect() {
     std::lock_guard<std::mutex> lock(mutex_);
-
-    if (isConnected()) {
+    if (connection_ && connection_->isOpen()) {
         return true;
     }
+    return connectLocked();
+}
 
+// 建立直连
+bool RpcClientStubImpl::connectLocked() {
     // 创建TCP客户端
-    tcp_client_ = std::make_shared<TcpClientImpl>();
-    if (!tcp_client_) {
+    std::shared_ptr<TcpClient> tcp_client = createTcpClient(io_backend_, host_);
+    if (!tcp_client) {
         std::cerr << "Rpc_Client.cpp::Failed to create TCP client" << std::endl;
         return false;
     }
 
     // 连接服务器
-    if (!tcp_client_->connect(host_, port_)) {
+    if (!tcp_client->connect(host_, port_)) {
         std::cerr << "Rpc_Client.cpp::Failed to connect to server" << std::endl;
         return false;
     }
 
-    connected_ = true;
+    connection_ = std::make_shared<ClientConnection>(std::move(tcp_client), service_name_);
     std::cout << "Rpc_Client.cpp::Connected to RPC server: " << host_ << ":" << port_ << std::endl;
     return true;
 }
 
-// 断开连接
+// 断开连接：还在途的调用以失败返回
 void RpcClientStubImpl::disconnect() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (tcp_client_) {
-        tcp_client_->disconnect();
-        tcp_client_.reset();
+    std::vector<std::shared_ptr<ClientConnection>> connections;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections.swap(draining_);
+        std::shared_ptr<ClientConnection> current = std::move(connection_);
+        // 服务发现模式下的连接属于连接池，别的 stub 可能正在用，由连接池负责回收
+        if (current && !use_service_discovery_) {
+            connections.push_back(std::move(current));
+        }
+    }
+    for (auto& connection : connections) {
+        connection->close();
     }
-    
-    connected_ = false;
 }
 
 // 检查连接状态
 bool RpcClientStubImpl::isConnected() const {
-    return connected_.load();
+    std::lock_guard<std::mutex> lock(mutex_);
+    return connection_ && connection_->isOpen();
 }
 
-// 发送 RPC请求
-RpcResponse RpcClientStubImpl::sendRpcRequest(const RpcRequest& request) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!tcp_client_) {
-        throw std::runtime_error("Rpc_Client.cpp::Client not initialized");
+// 取连接
+std::shared_ptr<ClientConnection> RpcClientStubImpl::acquireConnection(std::string& instance_id) {
+    if (use_service_discovery_) {
+        std::string io_backend;
+        bool prefer_unix_socket;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            io_backend = io_backend_;
+            prefer_unix_socket = prefer_unix_socket_;
+        }
+        // 传输方式不同的连接不能互相替代，计入连接池的端点键
+        std::string transport = prefer_unix_socket ? io_backend + "+local" : io_backend;
+        // 从注册中心发现服务，通过负载均衡器选择实例，再从连接池取该实例的连接（没有时才建连）
+        ServiceInstance instance = selectServiceInstance(transport);
+        instance_id = instance.getId();
+        std::shared_ptr<ClientConnection> connection = ClientConnectionPool::instance().acquire(
+            ClientConnectionPool::makeKey(service_name_, instance_id, transport),
+            [this, &instance, &io_backend, prefer_unix_socket]() {
+                return connectToInstance(instance, io_backend, prefer_unix_socket);
+            });
+        if (!connection) {
+            std::cerr << "Rpc_Client.cpp::Failed to connect to service instance: " << instance_id << std::endl;
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        connection_ = connection;
+        current_instance_id_ = instance_id;
+        return connection;
     }
 
-    // 序列化请求
-    std::vector<uint8_t> request_data;
-    try {
-        request_data = RpcProtocolHelper::serializeRequest(request);
-    } catch (std::exception& e) {
-        throw std::runtime_error("Rpc_Client.cpp::Failed to serialize request: " + std::string(e.what()));
+    std::vector<std::shared_ptr<ClientConnection>> retired; // 在 mutex_ 外面释放：关闭连接要等它的读线程退出
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!connection_ || !connection_->isOpen()) {
+        retireConnectionLocked(retired);
+        if (!connectLocked()) {
+            std::cerr << "Rpc_Client.cpp::Not connected to server" << std::endl;
+            return nullptr;
+        }
     }
+    return connection_;
+}
 
-    // 编码+帧前缀
-    std::vector<uint8_t> request_encoded = frame_codec_->encode(request_data);
+// 不阻塞地取连接
+std::shared_ptr<ClientConnection> RpcClientStubImpl::tryAcquireConnection(std::string& instance_id) {
+    if (!use_service_discovery_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!connection_ || !connection_->isOpen() || (frame_header_ && !connection_->isDirectoryReady())) {
+            return nullptr;
+        }
+        return connection_;
+    }
 
-    // 发送请求
-    if (!tcp_client_->send(request_encoded)) {
-        throw std::runtime_error("Rpc_Client.cpp::Failed to send request");
+    std::shared_ptr<const std::vector<ServiceInstance>> instances;
+    std::string transport;
+    bool frame_header;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!discovered_instances_ || std::chrono::steady_clock::now() >= discovered_until_) {
+            return nullptr;
+        }
+        instances = discovered_instances_;
+        transport = prefer_unix_socket_ ? io_backend_ + "+local" : io_backend_;
+        frame_header = frame_header_;
     }
+    ServiceInstance instance;
+    try {
+        instance = chooseServiceInstance(*instances, transport);
+    } catch (const std::exception&) {
+        return nullptr; // 由阻塞的调用重新查注册中心，并报告错误
+    }
+    // 只用连接池里已有的连接：需要新建时 tryAcquire 返回 nullptr
+    std::shared_ptr<ClientConnection> connection = ClientConnectionPool::instance().tryAcquire(
+        ClientConnectionPool::makeKey(service_name_, instance.getId(), transport));
+    if (!connection || (frame_header && !connection->isDirectoryReady())) {
+        return nullptr;
+    }
+    instance_id = instance.getId();
+    std::lock_guard<std::mutex> lock(mutex_);
+    connection_ = connection;
+    current_instance_id_ = instance_id;
+    return connection;
+}
 
-    // 接收响应
-    std::vector<uint8_t> response_data;
-    if (!tcp_client_->receive(response_data)) {
-        throw std::runtime_error("Failed to receive response from server");
-    }; // receive里有解码
+// 换下当前连接：异步调用不持有连接，还有在途调用的旧连接留在 draining_ 里等它们完成
+void RpcClientStubImpl::retireConnectionLocked(std::vector<std::shared_ptr<ClientConnection>>& retired) {
+    if (connection_) {
+        draining_.push_back(std::move(connection_));
+    }
+    auto drained = std::partition(draining_.begin(), draining_.end(), [](const std::shared_ptr<ClientConnection>& connection) {
+        return connection->isOpen() && connection->pendingCount() > 0;
+    });
+    std::move(drained, draining_.end(), std::back_inserter(retired));
+    draining_.erase(drained, draining_.end());
+}
 
-    // 解析响应
+// 按连接的协议编码请求
+uint64_t RpcClientStubImpl::encodeRequest(ClientConnection& connection, const std::string& method_name,
+                                          const google::protobuf::Message& request, Buffer& frame) {
+    // 请求 ID 在连接内唯一，读线程靠它把乱序到达的响应交给对应的调用
+    uint64_t request_id = connection.nextRequestId();
+    uint32_t method_id = 0;
+    bool framed = frame_header_ && connection.lookupMethodId(method_name, method_id);
     try {
-        return RpcProtocolHelper::parseResponse(response_data);
+        if (framed) {
+            // 帧头：方法 ID 与截止时间，请求消息直接跟在后面
+            FrameHeader header;
+            header.request_id = request_id;
+            header.method_id = method_id;
+            header.deadline_ms = request_timeout_ms_;
+            RpcProtocolHelper::serializeFramedRequest(header, request, frame);
+        } else {
+            // 旧格式：信封 + 请求消息一次写进 Buffer
+            RpcRequest rpc_request;
+            rpc_request.service_name = service_name_;
+            rpc_request.method_name = method_name;
+            rpc_request.request_id = request_id;
+            RpcProtocolHelper::serializeRequest(rpc_request, &request, frame);
+        }
     } catch (std::exception& e) {
-        throw std::runtime_error("Rpc_Client.cpp::Failed to parse response: " + std::string(e.what()));
+        throw std::runtime_error("Rpc_Client.cpp::Failed to serialize request: " + std::string(e.what()));
     }
+    // 长度前缀写进预留头部
+    frame_codec_->encode(frame);
+    return request_id;
+}
+
+// 同步调用等待响应的时间上限
+uint32_t RpcClientStubImpl::callTimeoutMs() const {
+    return std::max(request_timeout_ms_, ClientConnection::kDefaultCallTimeoutMs);
 }
 
 // 从注册中心发现服务，选择实例
-ServiceInstance RpcClientStubImpl::selectServiceInstance() {
+ServiceInstance RpcClientStubImpl::selectServiceInstance(const std::string& transport) {
     if (!registry_) {
         throw std::runtime_error("Rpc_Client.cpp::Service registry not initialized");
     }
 
     // 从注册中心发现实例
-    std::vector<ServiceInstance> instances = registry_->discoverService(service_name_);
-    if (instances.empty()) {
+    auto discovered = std::make_shared<const std::vector<ServiceInstance>>(registry_->discoverService(service_name_));
+    if (discovered->empty()) {
         throw std::runtime_error("Rpc_Client.cpp::No available service instances for: " + service_name_);
     }
+    {
+        // 有效期内不阻塞的调用直接用这次的结果选实例
+        std::lock_guard<std::mutex> lock(mutex_);
+        discovered_instances_ = discovered;
+        discovered_until_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(kDiscoveryCacheMs);
+    }
+    return chooseServiceInstance(*discovered, transport);
+}
+
+// 选择实例
+ServiceInstance RpcClientStubImpl::chooseServiceInstance(const std::vector<ServiceInstance>& discovered,
+                                                         const std::string& transport) {
+    // 跳过刚建连失败、还在退避期的实例
+    ClientConnectionPool& pool = ClientConnectionPool::instance();
+    std::vector<ServiceInstance> reachable;
+    for (const auto& instance : discovered) {
+        if (pool.isHealthy(ClientConnectionPool::makeKey(service_name_, instance.getId(), transport))) {
+            reachable.push_back(instance);
+        }
+    }
+    const std::vector<ServiceInstance>& instances = reachable.empty() ? discovered : reachable;
 
     // 使用负载均衡器选择实例
     if (!load_balancer_) {
@@ -221,24 +429,33 @@ ServiceInstance RpcClientStubImpl::selectServiceInstance() {
 }
 
 // 连接到指定的服务实例
-bool RpcClientStubImpl::connectToInstance(const ServiceInstance& instance) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    // 更新连接信息
-    host_ = instance.host;
-    port_ = instance.port;
+std::shared_ptr<ClientConnection> RpcClientStubImpl::connectToInstance(const ServiceInstance& instance, const std::string& io_backend,
+                                                                       bool prefer_unix_socket) const {
+    // 同机实例依次尝试共享内存、Unix 域套接字，都连不上再退回 TCP
+    if (prefer_unix_socket && instance.getHostName() == SocketAddress::getLocalHostName()) {
+        for (const std::string& local_address : {instance.getSharedMemory(), instance.getUnixSocket()}) {
+            if (local_address.empty()) {
+                continue;
+            }
+            std::shared_ptr<TcpClient> tcp_client = createTcpClient(io_backend, local_address);
+            if (tcp_client->connect(local_address, 0)) {
+                return std::make_shared<ClientConnection>(std::move(tcp_client), service_name_);
+            }
+            std::cerr << "Rpc_Client.cpp::Failed to connect to " << local_address << ", trying next transport" << std::endl;
+        }
+    }
     // 创建TCP客户端
-    tcp_client_ = std::make_shared<TcpClientImpl>();
-    if (!tcp_client_) {
+    std::shared_ptr<TcpClient> tcp_client = createTcpClient(io_backend);
+    if (!tcp_client) {
         std::cerr << "Rpc_Client.cpp::Failed to create TCP client" << std::endl;
-        return false;
+        return nullptr;
     }
     // 连接服务器
-    if (!tcp_client_->connect(host_, port_)) {
+    if (!tcp_client->connect(instance.host, instance.port)) {
         std::cerr << "Rpc_Client.cpp::Failed to connect to " << instance.getId() << std::endl;
-        return false;
+        return nullptr;
     }
-    connected_ = true;
-    return true;
+    return std::make_shared<ClientConnection>(std::move(tcp_client), service_name_);
 }
 
 // 设置负载均衡器
@@ -252,4 +469,28 @@ LoadBalancer* RpcClientStubImpl::getLoadBalancer() const {
     return load_balancer_.get();
 }
 
+// 设置 I/O 后端
+void RpcClientStubImpl::setIoBackend(const std::string& io_backend) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    io_backend_ = io_backend;
+}
+
+// 设置是否优先使用同机 Unix 域套接字
+void RpcClientStubImpl::setPreferUnixSocket(bool prefer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    prefer_unix_socket_ = prefer;
+}
+
+// 设置请求是否带帧头
+void RpcClientStubImpl::setFrameHeader(bool enable) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame_header_ = enable;
+}
+
+// 设置每次调用的时间预算
+void RpcClientStubImpl::setRequestTimeout(uint32_t timeout_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    request_timeout_ms_ = timeout_ms;
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "rpc_controller.h"
+
+namespace rpc {
+
+RpcControllerImpl::RpcControllerImpl()
+    :failed_(false),
+     canceled_(false),
+     cancel_callback_(nullptr) {}
+
+RpcControllerImpl::~RpcControllerImpl() {
+    complete();
+}
+
+// 重置为初始状态（复用控制器前调用），未执行的取消回调先执行掉
+void RpcControllerImpl::Reset() {
+    complete();
+    std::lock_guard<std::mutex> lock(mutex_);
+    failed_ = false;
+    error_text_.clear();
+    canceled_.store(false, std::memory_order_relaxed);
+}
+
+bool RpcControllerImpl::Failed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+}
+
+std::string RpcControllerImpl::ErrorText() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_text_;
+}
+
+// 取消调用：登记过的取消回调立即执行
+void RpcControllerImpl::StartCancel() {
+    google::protobuf::Closure* callback = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        canceled_.store(true, std::memory_order_release);
+        std::swap(callback, cancel_callback_);
+    }
+    if (callback) {
+        callback->Run();
+    }
+}
+
+void RpcControllerImpl::SetFailed(const std::string& reason) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    failed_ = true;
+    error_text_ = reason;
+}
+
+bool RpcControllerImpl::IsCanceled() const {
+    return canceled_.load(std::memory_order_acquire);
+}
+
+// 已取消时立即执行，否则在取消或调用结束时执行
+void RpcControllerImpl::NotifyOnCancel(google::protobuf::Closure* callback) {
+    if (!callback) {
+        return;
+    }
+    if (IsCanceled()) {
+        callback->Run();
+        return;
+    }
+    google::protobuf::Closure* previous = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        previous = cancel_callback_;
+        cancel_callback_ = callback;
+    }
+    // 只保留最后一次登记的回调，被替换的照样执行一次
+    if (previous) {
+        previous->Run();
+    }
+}
+
+void RpcControllerImpl::post(std::function<void()> task) {
+    task();
+}
+
+void RpcControllerImpl::complete() {
+    google::protobuf::Closure* callback = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(callback, cancel_callback_);
+    }
+    if (callback) {
+        callback->Run();
+    }
+}
+
+}
@@ -1,13 +1,105 @@
 #include "rpc_serser.h"
 #include "rpc_protocol_helper.h"
+#include "rpc_controller.h"
+#include "shm_server.h"
+#include "object_pool.h"
 #include <exception>
+#include <optional>
 
 namespace rpc {
 
+namespace {
+
+const size_t kRequestArenaBlockSize = 64 * 1024; // 每个调用上下文的 arena 常驻的首块大小
+
+} // namespace
+
+// 在途请求状态：工作线程与 I/O 线程上的超时定时器通过 CAS 决定由谁回复，保证只回复一次
+struct RpcServer::InFlightRequest {
+    enum State {
+        kQueued,         // 在线程池中排队
+        kParsed,         // 已解析，正在执行
+        kDone,           // 服务方法已完成（done 已运行）并回复
+        kExpiredQueued,  // 排队期间超时：工作线程取到后不再执行，直接回复超时
+        kExpired         // 执行期间超时：定时器已回复超时，done 运行时丢弃结果
+    };
+
+    std::atomic<int> state{kQueued};
+    uint64_t request_id = 0; // 带帧头的请求创建时写入；旧格式解析后由工作线程写入，切到 kParsed 之前完成
+    uint32_t timeout_ms = 0; // 生效的超时（服务端配置与帧头截止时间中较小的）
+    bool framed = false;     // 请求带帧头，响应也带帧头
+    uint32_t method_id = 0;
+    uint64_t timer_id = 0;   // 超时定时器，I/O 线程在交给工作线程之前写入
+};
+
+// 一次服务方法调用的上下文，同时是传给服务方法的 done：请求/响应消息分配在它自带的 arena 上，
+// done->Run()（任意线程，可以晚于 CallMethod 返回）时回复，之后还给对象池复用（取和还可以在不同线程），
+// 稳定状态下每次调用不再向堆申请内存
+class RpcServer::CallContext : public google::protobuf::Closure {
+public:
+    // 服务端控制器：请求已超时或连接已断开也算取消
+    class Controller : public RpcControllerImpl {
+    public:
+        explicit Controller(const CallContext& call) : call_(call) {}
+
+        bool IsCanceled() const override {
+            if (RpcControllerImpl::IsCanceled()) {
+                return true;
+            }
+            if (call_.in_flight && call_.in_flight->state.load(std::memory_order_acquire) == InFlightRequest::kExpired) {
+                return true;
+            }
+            return call_.connection && call_.connection->getState() != ConnectionState::CONNECTED;
+        }
+
+        // 投递到请求连接所在的 I/O 循环
+        void post(std::function<void()> task) override {
+            if (!call_.connection) {
+                task();
+                return;
+            }
+            call_.connection->queueInLoop(std::move(task));
+        }
+
+    private:
+        const CallContext& call_;
+    };
+
+    CallContext()
+        :initial_block(new char[kRequestArenaBlockSize]),  // 不清零：arena 只在分配出去的范围内写
+         arena(arenaOptions(initial_block.get())),
+         controller(*this) {}
+
+    void Run() override {
+        server->completeCall(this);
+    }
+
+    std::unique_ptr<char[]> initial_block; // arena 常驻的首块，Reset 后保留（取出上下文时 Reset）
+    google::protobuf::Arena arena;   // 信封、请求和响应消息
+    Controller controller;
+    RpcServer* server = nullptr;
+    std::shared_ptr<TcpConnection> connection;
+    std::shared_ptr<InFlightRequest> in_flight;
+    FrameHeader header;
+    bool framed = false; // 请求带帧头，响应也带帧头
+    uint64_t request_id = 0;
+    google::protobuf::Message* response = nullptr;
+
+private:
+    static google::protobuf::ArenaOptions arenaOptions(char* block) {
+        google::protobuf::ArenaOptions options;
+        options.initial_block = block;
+        options.initial_block_size = kRequestArenaBlockSize;
+        return options;
+    }
+};
+
 RpcServer::RpcServer(const RpcServerConfig& config) 
     : config_(config)
+     ,dispatch_table_(nullptr)
      ,running_(false)
-     ,heartbeat_running_(false) {}
+     ,heartbeat_running_(false)
+     ,request_timers_(0) {}
 
 RpcServer::~RpcServer() {
     stop();
@@ -19,6 +111,8 @@ bool RpcServer::start() {
         return true;
     }
 
+    SlabPool::setMaxThreadCacheBytes(config_.slab_thread_cache_bytes);
+
     // 初始化组件
     if (!initializeComponents()) {
         std::cerr << "Failed to initialize components" << std::endl;
@@ -26,7 +120,17 @@ bool RpcServer::start() {
     }
     
     // 创建 TCP 服务器
-    tcp_server_ = std::make_unique<TcpServerImpl>();
+    TcpServerConfig tcp_config;
+    tcp_config.io_thread_count = config_.io_thread_count;
+    tcp_config.loop_balance_strategy = config_.io_balance_strategy;
+    tcp_config.max_connections = config_.max_connections;
+    tcp_config.reuse_port = config_.reuse_port;
+    tcp_config.listen_backlog = config_.listen_backlog;
+    tcp_config.read_budget_bytes = config_.read_budget_bytes;
+    tcp_config.read_budget_frames = config_.read_budget_frames;
+    tcp_config.idle_timeout_ms = config_.connection_timeout_ms > 0 ? config_.connection_timeout_ms : 0;
+    tcp_config.io_backend = config_.io_backend;
+    tcp_server_ = createTcpServer(tcp_config);
     if (!tcp_server_) {
         std::cerr << "Failed to create TCP server" << std::endl;
         return false;
@@ -43,6 +147,35 @@ bool RpcServer::start() {
         return false;
     }
 
+    // 同机调用走 Unix 域套接字：复用同一套连接处理
+    if (!config_.unix_address.empty()) {
+        unix_server_ = createTcpServer(tcp_config);
+        unix_server_->setConnectionCallback([this](std::shared_ptr<TcpConnection> connection) {
+            handleNewConnection(connection);
+        });
+        if (!unix_server_->start(0, config_.unix_address)) {
+            std::cerr << "Failed to start unix socket server on " << config_.unix_address << std::endl;
+            tcp_server_->stop();
+            return false;
+        }
+    }
+
+    // 同机调用走共享内存环：同样复用连接处理
+    if (!config_.shm_address.empty()) {
+        shm_server_ = std::make_unique<ShmTcpServer>(tcp_config);
+        shm_server_->setConnectionCallback([this](std::shared_ptr<TcpConnection> connection) {
+            handleNewConnection(connection);
+        });
+        if (!shm_server_->start(0, config_.shm_address)) {
+            std::cerr << "Failed to start shared memory server on " << config_.shm_address << std::endl;
+            if (unix_server_) {
+                unix_server_->stop();
+            }
+            tcp_server_->stop();
+            return false;
+        }
+    }
+
     running_ = true;
 
     // 如果启动了服务注册，初始化注册中心，注册所有服务
@@ -61,7 +194,9 @@ bool RpcServer::start() {
             heartbeat_thread_ = std::thread(&RpcServer::heartbeatLoop, this);
         }
     }
-    std::cout << "RPC Server started successfully on " << config_.host << ":" << config_.port << std::endl;
+    std::cout << "RPC Server started successfully on " << config_.host << ":" << config_.port
+              << (config_.unix_address.empty() ? "" : " and " + config_.unix_address)
+              << (config_.shm_address.empty() ? "" : " and " + config_.shm_address) << std::endl;
     return true;
 }
 
@@ -92,6 +227,12 @@ void RpcServer::stop() {
     if (tcp_server_) {
         tcp_server_->stop();
     }
+    if (unix_server_) {
+        unix_server_->stop();
+    }
+    if (shm_server_) {
+        shm_server_->stop();
+    }
 
     // 清理连接
     {
@@ -109,11 +250,13 @@ bool RpcServer::registerService(google::protobuf::Service* service) {
     }
 
     // 注册服务
-    std::string service_name = service->GetDescriptor()->name();
+    const google::protobuf::ServiceDescriptor* descriptor = service->GetDescriptor();
+    std::string service_name = descriptor->name();
     {
-        // 注册到本地
+        // 注册到本地，并重建方法 ID 分发表
         std::unique_lock<std::shared_mutex> lock(services_mutex_);
         services_[service_name] = service;
+        publishDispatchTable();
     }
     // 注册到 zookeeper
     if (running_.load() && config_.enable_registry && registry_) {
@@ -134,6 +277,7 @@ bool RpcServer::unregisterService(const std::string& service_name) {
     auto it = services_.find(service_name);
     if (it != services_.end()) {
         services_.erase(it);
+        publishDispatchTable();
         std::cout << "Unregistered service: " << service_name << std::endl;
         return true;
     }
@@ -166,6 +310,11 @@ size_t RpcServer::getConnectionCount() const {
     return connections_.size();
 }
 
+// 时间轮上的请求超时定时器个数
+size_t RpcServer::getPendingRequestTimers() const {
+    return request_timers_.load();
+}
+
 // 获取线程池大小
 size_t RpcServer::getThreadPoolSize() const {
     if (!thread_pool_) {
@@ -205,57 +354,280 @@ void RpcServer::handleNewConnection(std::shared_ptr<TcpConnection> connection) {
         connections_[connection] = connection_id;
     }
 
-    // 设置消息回调
-    connection->setMessageCallback([this](std::shared_ptr<TcpConnection> conn, const std::vector<uint8_t>& data) {
-        handleMessage(conn, data);
+    // 设置帧回调（帧以 IoBuf 视图交出）
+    connection->setFrameCallback([this](std::shared_ptr<TcpConnection> conn, IoBuf&& frame) {
+        handleMessage(conn, std::move(frame));
+    });
+    // 连接断开（包括空闲超时被关闭）时清理连接表
+    connection->setConnectionCallback([this](std::shared_ptr<TcpConnection> conn) {
+        if (conn->getState() == ConnectionState::DISCONNECTED) {
+            handleConnectionClosed(conn);
+        }
     });
     // 设置错误回调
     connection->setErrorCallback([this](std::shared_ptr<TcpConnection> conn, const std::string& error) {
         handleError(conn, error);
     });
+    // 背压：客户端不读响应导致输出积压时，暂停读取它的新请求，积压回落后再恢复
+    connection->setHighWaterMarkCallback([](std::shared_ptr<TcpConnection> conn, size_t pending) {
+        std::cerr << "Output buffer of " << conn->getRemoteAddress() << " reached " << pending
+                  << " bytes, pause reading" << std::endl;
+        conn->stopReading();
+    }, config_.output_high_water_mark);
+    connection->setLowWaterMarkCallback([](std::shared_ptr<TcpConnection> conn) {
+        conn->startReading();
+    }, config_.output_low_water_mark);
 
     std::cout << "New connection established: " << connection_id << std::endl;
 }
 
 // 处理消息
-void RpcServer::handleMessage(std::shared_ptr<TcpConnection> connection, const std::vector<uint8_t>& data) {
+void RpcServer::handleMessage(std::shared_ptr<TcpConnection> connection, IoBuf&& frame) {
+    // 带帧头的请求：解析 protobuf 之前先完成路由、过载保护和截止时间设置
+    std::optional<FrameHeader> header;
+    uint32_t timeout_ms = config_.request_timeout_ms > 0 ? static_cast<uint32_t>(config_.request_timeout_ms) : 0;
+    if (FrameHeader::detect(frame)) {
+        header.emplace();
+        if (!header->decode(frame)) {
+            std::cerr << "Invalid frame header from " << connection->getRemoteAddress() << std::endl;
+            connection->close();
+            return;
+        }
+        if (header->flags & FrameHeader::kFlagHandshake) {
+            frame.retrieve(header->header_length);
+            handleHandshake(connection, *header, frame);
+            return;
+        }
+        std::string error = admitRequest(*header);
+        if (!error.empty()) {
+            RpcResponse response;
+            response.request_id = header->request_id;
+            response.success = false;
+            response.error_message = error;
+            sendResponse(connection, response, nullptr, &*header);
+            return;
+        }
+        frame.retrieve(header->header_length);
+        if (header->deadline_ms > 0 && (timeout_ms == 0 || header->deadline_ms < timeout_ms)) {
+            timeout_ms = header->deadline_ms;
+        }
+    }
+
+    // 在连接所属 I/O 线程的时间轮上为请求计时（消息回调就在该线程）
+    std::shared_ptr<InFlightRequest> in_flight;
+    if (timeout_ms > 0) {
+        in_flight = std::make_shared<InFlightRequest>();
+        in_flight->timeout_ms = timeout_ms;
+        if (header) {
+            in_flight->framed = true;
+            in_flight->request_id = header->request_id;
+            in_flight->method_id = header->method_id;
+        }
+        std::weak_ptr<TcpConnection> weak_connection = connection;
+        in_flight->timer_id = connection->runAfter(timeout_ms, [this, weak_connection, in_flight]() {
+            request_timers_--;
+            handleRequestTimeout(weak_connection.lock(), in_flight);
+        });
+        if (in_flight->timer_id != 0) {
+            request_timers_++;
+        }
+    }
+
     if (thread_pool_) {
-        thread_pool_->submit([this, connection, data]() {
-            handleRpcRequest(connection, data);
+        thread_pool_->submit([this, connection, frame = std::move(frame), header, in_flight]() {
+            handleRpcRequest(connection, frame, header ? &*header : nullptr, in_flight);
         });
     } else {
-        handleRpcRequest(connection, data);
+        handleRpcRequest(connection, frame, header ? &*header : nullptr, in_flight);
     }
 }
 
-// 处理rpc请求
-void RpcServer::handleRpcRequest(std::shared_ptr<TcpConnection> connection, const std::vector<uint8_t>& request_data) {
+// 解析前的准入检查：版本、压缩算法、方法路由、过载保护，通过返回空串
+std::string RpcServer::admitRequest(const FrameHeader& header) {
+    if (header.version != FrameHeader::kVersion) {
+        return "Unsupported frame version: " + std::to_string(header.version);
+    }
+    if (header.compression != FrameHeader::kCompressionNone) {
+        return "Unsupported compression codec: " + std::to_string(header.compression);
+    }
+    if (!findMethod(header.method_id)) {
+        return "Method not found: id " + std::to_string(header.method_id);
+    }
+    if (config_.max_pending_requests > 0 && thread_pool_ &&
+        thread_pool_->getQueueSize() >= config_.max_pending_requests) {
+        return "Server overloaded";
+    }
+    return "";
+}
 
+// 处理rpc请求：解析后交给服务方法，回复在 done（调用上下文）运行时发出
+void RpcServer::handleRpcRequest(std::shared_ptr<TcpConnection> connection, const IoBuf& request_data,
+                                 const FrameHeader* header, const std::shared_ptr<InFlightRequest>& in_flight) {
+    std::unique_ptr<CallContext> call = acquireCallContext();
+    call->server = this;
+    call->connection = connection;
+    call->in_flight = in_flight;
+    if (header) {
+        call->framed = true;
+        call->header = *header;
+        call->request_id = header->request_id;
+    }
+    google::protobuf::Arena* arena = &call->arena;
+
+    const MethodEntry* entry = nullptr;
+    google::protobuf::Message* request = nullptr;
     try {
-        // 解析RPC请求
-        RpcRequest request = parseRpcRequest(request_data);
-    
-        // 调用服务方法
-        std::vector<uint8_t> response_data = callServiceMethod(request.service_name, request.method_name, request.request_data);
-    
-        // 创建RPC响应
-        RpcResponse response;
-        response.request_id = request.request_id;
-        response.response_data = response_data;
-        response.success = true;
+        // 带帧头时请求 ID 已知，旧格式要先解析 RpcRequestProto
+        RpcRequestProto* envelope = nullptr;
+        IoBuf payload;
+        if (!header) {
+            envelope = parseRpcRequest(request_data, payload, arena);
+            call->request_id = envelope->request_id();
+        }
+
+        if (in_flight) {
+            in_flight->request_id = call->request_id;
+            int expected = InFlightRequest::kQueued;
+            if (!in_flight->state.compare_exchange_strong(expected, InFlightRequest::kParsed)) {
+                // 排队期间已超时，不再执行
+                sendTimeoutResponse(connection, *in_flight);
+                releaseCallContext(std::move(call));
+                return;
+            }
+        }
     
-        // 发送响应
-        sendResponse(connection, response);
+        // 定位方法：带帧头的按方法 ID，旧格式按服务名和方法名；请求消息直接从帧内解析
+        entry = header ? &resolveMethod(header->method_id) : &resolveMethod(*envelope);
+        request = entry->request_prototype->New(arena);
+        if (!RpcProtocolHelper::parseMessage(header ? request_data : payload, *request)) {
+            throw std::runtime_error("Failed to parse request");
+        }
+        call->response = entry->response_prototype->New(arena);
     } catch (const std::exception& e) {
         std::cerr << "Error handling RPC request: " << e.what() << std::endl;
 
-        // 发送错误响应
+        if (!in_flight || in_flight->state.exchange(InFlightRequest::kDone) != InFlightRequest::kExpired) {
+            if (in_flight) {
+                cancelRequestTimer(connection, *in_flight);
+            }
+            // 发送错误响应（已超时的，超时响应已发出）
+            RpcResponse response;
+            response.request_id = call->request_id;
+            response.success = false;
+            response.error_message = e.what();
+            sendResponse(connection, response, nullptr, header);
+        }
+        releaseCallContext(std::move(call));
+        return;
+    }
+
+    // 调用服务方法：done 由服务方法在任意线程运行，此后 call 归 completeCall 回收，这里不能再访问
+    CallContext* done = call.release();
+    try {
+        entry->service->CallMethod(entry->method, &done->controller, request, done->response, done);
+    } catch (const std::exception& e) {
+        // 服务方法抛出异常视为没有运行 done
+        done->controller.SetFailed(e.what());
+        done->Run();
+    }
+}
+
+// 服务方法完成（done->Run()）：按控制器状态回复，回收调用上下文
+void RpcServer::completeCall(CallContext* call) {
+    std::unique_ptr<CallContext> owned(call);
+
+    // 执行期间已超时，超时响应已由定时器发出，丢弃结果
+    bool expired = false;
+    if (call->in_flight) {
+        int expected = InFlightRequest::kParsed;
+        expired = !call->in_flight->state.compare_exchange_strong(expected, InFlightRequest::kDone);
+        if (!expired) {
+            cancelRequestTimer(call->connection, *call->in_flight);
+        }
+    }
+
+    if (!expired) {
         RpcResponse response;
-        response.request_id = 0;
-        response.success = false;
-        response.error_message = e.what();
-        sendResponse(connection, response);
+        response.request_id = call->request_id;
+        response.success = true;
+        if (call->controller.Failed()) {
+            response.success = false;
+            response.error_message = call->controller.ErrorText();
+        } else if (!call->response->IsInitialized()) {
+            response.success = false;
+            response.error_message = "Failed to serialize response";
+        }
+        if (!response.success) {
+            std::cerr << "Error handling RPC request: " << response.error_message << std::endl;
+        }
+        // 发送响应（响应消息直接序列化进发送缓冲区）
+        sendResponse(call->connection, response, response.success ? call->response : nullptr,
+                     call->framed ? &call->header : nullptr);
+    }
+
+    call->controller.complete();
+    releaseCallContext(std::move(owned));
+}
+
+// 从对象池取调用上下文，池空时新建
+// arena 在这里（将要在它上面分配的线程）Reset：protobuf 把首块交给执行 Reset 的线程，
+// 在 done 的线程里 Reset 的话，工作线程下次分配会另向堆申请新块
+std::unique_ptr<RpcServer::CallContext> RpcServer::acquireCallContext() {
+    std::unique_ptr<CallContext> call = ObjectPool<CallContext>::acquire();
+    call->arena.Reset();
+    return call;
+}
+
+// 重置调用上下文（arena 除外）还给对象池：异步服务方法在别的线程运行 done 时，上下文经全局空闲链表流回工作线程
+void RpcServer::releaseCallContext(std::unique_ptr<CallContext> call) {
+    call->connection.reset();
+    call->in_flight.reset();
+    call->framed = false;
+    call->request_id = 0;
+    call->response = nullptr;
+    call->controller.Reset();
+    ObjectPool<CallContext>::release(std::move(call));
+}
+
+// 请求超时：还在排队的交给工作线程回复，正在执行的由这里回复
+void RpcServer::handleRequestTimeout(std::shared_ptr<TcpConnection> connection, const std::shared_ptr<InFlightRequest>& in_flight) {
+    int expected = InFlightRequest::kQueued;
+    if (in_flight->state.compare_exchange_strong(expected, InFlightRequest::kExpiredQueued)) {
+        return;
+    }
+    if (expected == InFlightRequest::kParsed &&
+        in_flight->state.compare_exchange_strong(expected, InFlightRequest::kExpired)) {
+        if (connection && connection->getState() == ConnectionState::CONNECTED) {
+            sendTimeoutResponse(connection, *in_flight);
+        }
+    }
+}
+
+// 取消已回复请求的超时定时器：时间轮只在 I/O 线程访问，取消投递过去执行
+void RpcServer::cancelRequestTimer(const std::shared_ptr<TcpConnection>& connection, const InFlightRequest& in_flight) {
+    if (!connection || in_flight.timer_id == 0) {
+        return;
     }
+    uint64_t timer_id = in_flight.timer_id;
+    connection->queueInLoop([this, connection, timer_id]() {
+        if (connection->cancelTimer(timer_id)) {
+            request_timers_--;
+        }
+    });
+}
+
+// 发送超时错误响应
+void RpcServer::sendTimeoutResponse(std::shared_ptr<TcpConnection> connection, const InFlightRequest& in_flight) {
+    std::cerr << "Request " << in_flight.request_id << " from " << connection->getRemoteAddress()
+              << " timed out after " << in_flight.timeout_ms << "ms" << std::endl;
+    RpcResponse response;
+    response.request_id = in_flight.request_id;
+    response.success = false;
+    response.error_message = "Request timeout after " + std::to_string(in_flight.timeout_ms) + "ms";
+    FrameHeader header;
+    header.request_id = in_flight.request_id;
+    header.method_id = in_flight.method_id;
+    sendResponse(connection, response, nullptr, in_flight.framed ? &header : nullptr);
 }
 
 // 处理连接断开
@@ -275,38 +647,45 @@ void RpcServer::handleError(std::shared_ptr<TcpConnection> connection, const std
 }
 
 // 发送响应
-void RpcServer::sendResponse(std::shared_ptr<TcpConnection> connection, const RpcResponse& response) {
+void RpcServer::sendResponse(std::shared_ptr<TcpConnection> connection, const RpcResponse& response,
+                             const google::protobuf::Message* payload, const FrameHeader* request_header) {
     if (!connection) {
         std::cerr << "[DEBUG SERVER] sendResponse: connection is null!" << std::endl;
         return;
     }
 
-    // 序列化响应
-    auto response_proto_data = serializeRpcResponse(response);
+    // 序列化响应：直接写进 Buffer，前面留着帧头的空间
+    Buffer frame;
+    serializeRpcResponse(response, payload, request_header, frame);
 
-    // 编码+帧前缀
-    auto response_proto_encode = frame_codec_->encode(response_proto_data);
+    // 帧前缀写进预留头部
+    frame_codec_->encode(frame);
 
-    // 发送
-    if (!connection->send(response_proto_encode)) {
+    // 发送：整个 Buffer 交给连接，由 I/O 线程聚集写出
+    if (!connection->send(std::move(frame))) {
         std::cerr << "Failed to send response to " << connection->getRemoteAddress() << std::endl;
     }
 }
 
 // 解析rpc请求
-RpcRequest RpcServer::parseRpcRequest(const std::vector<uint8_t>& data) {
-    try {
-        return RpcProtocolHelper::parseRequest(data);
-    } catch (const std::exception& e) {
-        std::cerr << "Failed to parse RPC request: " << e.what() << std::endl;
-        throw std::runtime_error("Invalid RPC request format: " + std::string(e.what()));
+RpcRequestProto* RpcServer::parseRpcRequest(const IoBuf& data, IoBuf& payload, google::protobuf::Arena* arena) {
+    RpcRequestProto* envelope = google::protobuf::Arena::CreateMessage<RpcRequestProto>(arena);
+    if (data.empty() || !RpcProtocolHelper::parseRequestEnvelope(data, *envelope, payload)) {
+        std::cerr << "Failed to parse RPC request" << std::endl;
+        throw std::runtime_error("Invalid RPC request format: Failed to parse RpcRequestProto");
     }
+    return envelope;
 }
 
 // 序列化rpc响应
-std::vector<uint8_t> RpcServer::serializeRpcResponse(const RpcResponse& response) {
+void RpcServer::serializeRpcResponse(const RpcResponse& response, const google::protobuf::Message* payload,
+                                     const FrameHeader* request_header, Buffer& out) {
     try {
-        return RpcProtocolHelper::serializeResponse(response);
+        if (request_header) {
+            RpcProtocolHelper::serializeFramedResponse(response, payload, request_header->method_id, out);
+        } else {
+            RpcProtocolHelper::serializeResponse(response, payload, out);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Failed to serialize RPC response: " << e.what() << std::endl;
         // 返回错误响应
@@ -315,48 +694,105 @@ std::vector<uint8_t> RpcServer::serializeRpcResponse(const RpcResponse& response
         error_response.success = false;
         error_response.error_message = "Serialization error: " + std::string(e.what());
         // 尝试再次序列化（这次不会有数据）
-        return RpcProtocolHelper::serializeResponse(error_response);
+        out.retrieveAll();
+        if (request_header) {
+            RpcProtocolHelper::serializeFramedResponse(error_response, nullptr, request_header->method_id, out);
+        } else {
+            RpcProtocolHelper::serializeResponse(error_response, nullptr, out);
+        }
     }
 }
 
-// 调用服务方法
-std::vector<uint8_t> RpcServer::callServiceMethod(const std::string& service_name, const std::string& method_name, const std::vector<uint8_t>& request_data) {
-    std::shared_lock<std::shared_mutex> lock(services_mutex_);
-
-    // 查找服务
-    auto it = services_.find(service_name);
-    if (it == services_.end()) {
-        throw std::runtime_error("Service not found: " + service_name);
+// 按方法 ID 定位方法
+const RpcServer::MethodEntry& RpcServer::resolveMethod(uint32_t method_id) const {
+    const MethodEntry* entry = findMethod(method_id);
+    if (!entry) {
+        throw std::runtime_error("Method not found: id " + std::to_string(method_id));
     }
+    return *entry;
+}
 
-    google::protobuf::Service* service = it->second;
-    const google::protobuf::ServiceDescriptor* descriptor = service->GetDescriptor();
-
-    // 查找方法
-    const google::protobuf::MethodDescriptor* method = descriptor->FindMethodByName(method_name);
-    if (!method) {
-        throw std::runtime_error("Method not found: " + method_name);
+// 旧格式请求按 "服务名.方法名" 查分发表
+const RpcServer::MethodEntry& RpcServer::resolveMethod(const RpcRequestProto& envelope) const {
+    const std::string full_name = envelope.service_name() + "." + envelope.method_name();
+    const DispatchTable* table = dispatch_table_.load(std::memory_order_acquire);
+    if (table) {
+        auto it = table->method_ids.find(full_name);
+        if (it != table->method_ids.end() && findMethod(it->second)) {
+            return *findMethod(it->second);
+        }
     }
+    throw std::runtime_error("Method not found: " + full_name);
+}
 
-    // 创建请求和响应消息
-    std::unique_ptr<google::protobuf::Message> request(service->GetRequestPrototype(method).New());
-    std::unique_ptr<google::protobuf::Message> response(service->GetResponsePrototype(method).New());
+// 按方法 ID 查分发表
+const RpcServer::MethodEntry* RpcServer::findMethod(uint32_t method_id) const {
+    const DispatchTable* table = dispatch_table_.load(std::memory_order_acquire);
+    if (!table || method_id >= table->methods.size() || !table->methods[method_id].service) {
+        return nullptr;
+    }
+    return &table->methods[method_id];
+}
 
-    // 反序列化请求参数
-    if (!request->ParseFromArray(request_data.data(), request_data.size())) {
-        throw std::runtime_error("Failed to parse request");
+// 重建分发表：已分配过的方法沿用原 ID，新方法追加 ID，注销的服务只清空表项
+void RpcServer::publishDispatchTable() {
+    std::unique_ptr<DispatchTable> table(new DispatchTable());
+    for (const auto& pair : services_) {
+        google::protobuf::Service* service = pair.second;
+        const google::protobuf::ServiceDescriptor* descriptor = service->GetDescriptor();
+        for (int i = 0; i < descriptor->method_count(); ++i) {
+            const google::protobuf::MethodDescriptor* method = descriptor->method(i);
+            std::string full_name = pair.first + "." + method->name();
+            auto interned = interned_ids_.emplace(full_name, static_cast<uint32_t>(interned_ids_.size())).first;
+            table->method_ids[full_name] = interned->second;
+        }
     }
-    
-    // 调用服务方法
-    service->CallMethod(method, nullptr, request.get(), response.get(), nullptr);
+    table->methods.resize(interned_ids_.size());
+    for (const auto& pair : services_) {
+        google::protobuf::Service* service = pair.second;
+        const google::protobuf::ServiceDescriptor* descriptor = service->GetDescriptor();
+        for (int i = 0; i < descriptor->method_count(); ++i) {
+            const google::protobuf::MethodDescriptor* method = descriptor->method(i);
+            MethodEntry& entry = table->methods[table->method_ids[pair.first + "." + method->name()]];
+            entry.service = service;
+            entry.method = method;
+            entry.request_prototype = &service->GetRequestPrototype(method);
+            entry.response_prototype = &service->GetResponsePrototype(method);
+        }
+    }
+    dispatch_table_.store(table.get(), std::memory_order_release);
+    dispatch_tables_.push_back(std::move(table));
+}
 
-    // 序列化响应
-    std::string response_data;
-    if (!response->SerializeToString(&response_data)) {
-        throw std::runtime_error("Failed to serialize response");
+// 方法目录握手：客户端连上后先取回服务的方法 ID，之后的请求帧头里只带整数
+void RpcServer::handleHandshake(std::shared_ptr<TcpConnection> connection, const FrameHeader& header, const IoBuf& body) {
+    RpcResponse response;
+    response.request_id = header.request_id;
+    MethodDirectoryProto directory;
+    if (!RpcProtocolHelper::parseMessage(body, directory)) {
+        response.success = false;
+        response.error_message = "Invalid method directory request";
+        sendResponse(connection, response, nullptr, &header);
+        return;
     }
 
-    return std::vector<uint8_t>(response_data.begin(), response_data.end());
+    const std::string prefix = directory.service_name() + ".";
+    const DispatchTable* table = dispatch_table_.load(std::memory_order_acquire);
+    if (table) {
+        for (const auto& pair : table->method_ids) {
+            if (pair.first.compare(0, prefix.size(), prefix) == 0) {
+                (*directory.mutable_method_ids())[pair.first.substr(prefix.size())] = pair.second;
+            }
+        }
+    }
+    if (directory.method_ids().empty()) {
+        response.success = false;
+        response.error_message = "Service not found: " + directory.service_name();
+        sendResponse(connection, response, nullptr, &header);
+        return;
+    }
+    response.success = true;
+    sendResponse(connection, response, &directory, &header);
 }
 
 // 设置服务注册中心
@@ -378,10 +814,16 @@ bool RpcServer::registerToRegistry(const std::string& service_name) {
     try {
         ServiceInstance instance(
             service_name,
-            config_.host = "0.0.0.0" ? "127.0.0.1" : config_.host,
+            config_.host == "0.0.0.0" ? "127.0.0.1" : config_.host,
             config_.port,
             config_.service_weight
         );
+        if (!config_.unix_address.empty()) {
+            instance.setUnixSocket(config_.unix_address, SocketAddress::getLocalHostName());
+        }
+        if (!config_.shm_address.empty()) {
+            instance.setSharedMemory(config_.shm_address, SocketAddress::getLocalHostName());
+        }
     
         // 注册到注册中心
         if (registry_->registerService(instance)) {
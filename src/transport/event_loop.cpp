@@ -0,0 +1,609 @@
+#include "event_loop.h"
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+namespace rpc {
+
+    EventLoop::EventLoop(size_t index)
+        :index_(index),
+         epoll_fd_(-1),
+         wakeup_fd_(-1),
+         timer_fd_(-1),
+         listen_fd_(-1),
+         running_(false),
+         connection_count_(0),
+         write_wakeup_pending_(false),
+         read_budget_bytes_(kDefaultReadBudgetBytes),
+         read_budget_frames_(kDefaultReadBudgetFrames),
+         timer_deadline_ms_(0),
+         idle_timeout_ms_(0)
+    {}
+
+    EventLoop::~EventLoop() {
+        stop();
+    }
+
+    // 启动事件循环线程
+    bool EventLoop::start() {
+        if (running_) {
+            return true;
+        }
+
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ == -1) {
+            std::cerr << "Failed to create epoll for loop " << index_ << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeup_fd_ == -1) {
+            std::cerr << "Failed to create eventfd for loop " << index_ << ": " << strerror(errno) << std::endl;
+            ::close(epoll_fd_);
+            epoll_fd_ = -1;
+            return false;
+        }
+
+        timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (timer_fd_ == -1) {
+            std::cerr << "Failed to create timerfd for loop " << index_ << ": " << strerror(errno) << std::endl;
+            ::close(wakeup_fd_);
+            ::close(epoll_fd_);
+            wakeup_fd_ = -1;
+            epoll_fd_ = -1;
+            return false;
+        }
+
+        // 唤醒 fd、timerfd 与监听 socket 使用保留句柄，与连接句柄区分
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = kWakeupHandle;
+        bool registered = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &event) == 0;
+        event.data.u64 = kTimerHandle;
+        registered = registered && epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &event) == 0;
+        if (!registered) {
+            std::cerr << "Failed to add eventfd/timerfd to epoll: " << strerror(errno) << std::endl;
+            ::close(timer_fd_);
+            ::close(wakeup_fd_);
+            ::close(epoll_fd_);
+            timer_fd_ = -1;
+            wakeup_fd_ = -1;
+            epoll_fd_ = -1;
+            return false;
+        }
+
+        if (listen_fd_ != -1) {
+            event.events = EPOLLIN;
+            event.data.u64 = kListenHandle;
+            if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event) == -1) {
+                std::cerr << "Failed to add listen socket to loop " << index_ << ": " << strerror(errno) << std::endl;
+                ::close(timer_fd_);
+                ::close(wakeup_fd_);
+                ::close(epoll_fd_);
+                timer_fd_ = -1;
+                wakeup_fd_ = -1;
+                epoll_fd_ = -1;
+                return false;
+            }
+        }
+
+        running_ = true;
+        thread_ = std::thread(&EventLoop::loopMain, this);
+        return true;
+    }
+
+    // 停止事件循环线程，并关闭所有连接
+    void EventLoop::stop() {
+        if (!running_) {
+            return;
+        }
+
+        running_ = false;
+        wakeup();
+
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+
+        // 循环线程已退出，剩余任务和连接由当前线程收尾
+        thread_id_ = std::this_thread::get_id();
+        doPendingFunctors();
+        flushPendingWrites();
+        pending_reads_.clear();
+        closeAllConnections();
+        thread_id_ = std::thread::id();
+
+        if (epoll_fd_ != -1 && listen_fd_ != -1) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, listen_fd_, nullptr);
+        }
+        listen_fd_ = -1;
+
+        if (timer_fd_ != -1) {
+            ::close(timer_fd_);
+            timer_fd_ = -1;
+        }
+        timer_deadline_ms_ = 0;
+        if (wakeup_fd_ != -1) {
+            ::close(wakeup_fd_);
+            wakeup_fd_ = -1;
+        }
+        if (epoll_fd_ != -1) {
+            ::close(epoll_fd_);
+            epoll_fd_ = -1;
+        }
+    }
+
+    // 在循环线程中执行任务
+    void EventLoop::runInLoop(Functor task) {
+        if (isInLoopThread()) {
+            task();
+        } else {
+            queueInLoop(std::move(task));
+        }
+    }
+
+    // 将任务放入队列，唤醒循环线程后执行
+    void EventLoop::queueInLoop(Functor task) {
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            pending_functors_.push_back(std::move(task));
+        }
+        wakeup();
+    }
+
+    // 当前线程是否为循环线程
+    bool EventLoop::isInLoopThread() const {
+        return thread_id_.load() == std::this_thread::get_id();
+    }
+
+    // 设置本循环自己的监听 socket
+    void EventLoop::setAcceptor(int listen_fd, Functor accept_callback) {
+        listen_fd_ = listen_fd;
+        accept_callback_ = std::move(accept_callback);
+    }
+
+    // 设置每个连接每轮的读取预算
+    void EventLoop::setReadBudget(size_t budget_bytes, size_t budget_frames) {
+        read_budget_bytes_ = budget_bytes > 0 ? budget_bytes : kDefaultReadBudgetBytes;
+        read_budget_frames_ = budget_frames > 0 ? budget_frames : kDefaultReadBudgetFrames;
+    }
+
+    // 设置空闲连接超时
+    void EventLoop::setIdleTimeout(uint64_t idle_timeout_ms) {
+        idle_timeout_ms_ = idle_timeout_ms;
+    }
+
+    // delay_ms 后在循环线程执行 callback
+    TimerWheel::TimerId EventLoop::runAfter(uint64_t delay_ms, Functor callback) {
+        TimerWheel::TimerId timer_id = timer_wheel_.addTimer(delay_ms, std::move(callback));
+        // 比 timerfd 当前的到期时刻晚就不用重新设置，避免每个定时器一次系统调用
+        if (timer_deadline_ms_ == 0 || TimerWheel::nowMs() + delay_ms < timer_deadline_ms_) {
+            scheduleTimerFd();
+        }
+        return timer_id;
+    }
+
+    // 取消定时器
+    bool EventLoop::cancelTimer(TimerWheel::TimerId timer_id) {
+        return timer_wheel_.cancelTimer(timer_id);
+    }
+
+    // 接管一个新连接
+    void EventLoop::addConnection(std::shared_ptr<TcpConnectionImpl> connection) {
+        connection_count_++;
+        runInLoop([this, connection]() {
+            registerConnection(connection);
+        });
+    }
+
+    // 投递一帧待发送数据
+    void EventLoop::queueWrite(std::shared_ptr<TcpConnectionImpl> connection, OutputFrame&& frame) {
+        write_queue_.push(PendingWrite{std::move(connection), std::move(frame)});
+        // 循环线程清空队列前只需要唤醒一次
+        if (!write_wakeup_pending_.exchange(true)) {
+            wakeup();
+        }
+    }
+
+    // 按连接当前关注的事件更新 epoll
+    void EventLoop::updateConnection(TcpConnectionImpl* connection) {
+        struct epoll_event event;
+        event.events = connection->getEvents();
+        event.data.u64 = connection->getLoopHandle();
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection->getSocketFd(), &event) == -1) {
+            std::cerr << "Failed to modify client socket in epoll: " << strerror(errno) << std::endl;
+        }
+        // 恢复读取时，之前预算用完留在输入缓冲区里的帧不会再有可读事件通知，放进待读列表
+        if ((event.events & EPOLLIN) && connection->isReading() && !connection->getInputBuffer()->empty()) {
+            schedulePendingRead(connection);
+        }
+    }
+
+    // 关闭并移除连接
+    void EventLoop::closeConnection(std::shared_ptr<TcpConnectionImpl> connection) {
+        runInLoop([this, connection]() {
+            handleClientClose(connection.get());
+        });
+    }
+
+    // 获取当前连接数
+    size_t EventLoop::getConnectionCount() const {
+        return connection_count_.load();
+    }
+
+    // 获取循环编号
+    size_t EventLoop::getIndex() const {
+        return index_;
+    }
+
+    // 获取运行状态
+    bool EventLoop::isRunning() const {
+        return running_;
+    }
+
+    // 循环线程主函数
+    void EventLoop::loopMain() {
+        thread_id_ = std::this_thread::get_id();
+
+        const int max_events = 100;
+        struct epoll_event events[max_events];
+
+        while (running_) {
+            // 有预算用完、尚未读完的连接时不阻塞
+            int timeout_ms = pending_reads_.empty() ? 1000 : 0;
+            int nfds = epoll_wait(epoll_fd_, events, max_events, timeout_ms);
+            if (nfds == -1) {
+                if (errno == EINTR) {
+                    continue;
+                } else {
+                    std::cerr << "epoll_wait failed in loop " << index_ << ": " << strerror(errno) << std::endl;
+                    break;
+                }
+            }
+
+            for (int i = 0; i < nfds; ++i) {
+                if (events[i].data.u64 == kWakeupHandle) {  // 唤醒事件
+                    handleWakeup();
+                } else if (events[i].data.u64 == kTimerHandle) {  // 时间轮 tick
+                    handleTimer();
+                } else if (events[i].data.u64 == kListenHandle) {  // 监听 socket 可读
+                    if (accept_callback_) {
+                        accept_callback_();
+                    }
+                } else {  // 客户端连接事件
+                    handleClientEvent(events[i]);
+                }
+            }
+
+            // 继续读上一轮预算用完的连接
+            processPendingReads();
+
+            // 处理其他线程投递的任务（新连接等）
+            doPendingFunctors();
+
+            // 写出工作线程投递的响应
+            flushPendingWrites();
+        }
+
+        thread_id_ = std::thread::id();
+    }
+
+    // 唤醒循环线程
+    void EventLoop::wakeup() {
+        uint64_t one = 1;
+        ssize_t n = ::write(wakeup_fd_, &one, sizeof(one));
+        (void)n;
+    }
+
+    // 处理唤醒事件
+    void EventLoop::handleWakeup() {
+        uint64_t value = 0;
+        ssize_t n = ::read(wakeup_fd_, &value, sizeof(value));
+        (void)n;
+    }
+
+    // 处理 timerfd 事件：推进时间轮，执行到期定时器
+    void EventLoop::handleTimer() {
+        uint64_t expirations = 0;
+        ssize_t n = ::read(timer_fd_, &expirations, sizeof(expirations));
+        (void)n;
+        timer_deadline_ms_ = 0;
+        timer_wheel_.advance(TimerWheel::nowMs());
+        scheduleTimerFd();
+    }
+
+    // 按时间轮最近的到期时刻设置 timerfd（一次性触发，没有定时器时不再唤醒）
+    void EventLoop::scheduleTimerFd() {
+        if (timer_fd_ == -1) {
+            return;
+        }
+        uint64_t now_ms = TimerWheel::nowMs();
+        int64_t timeout_ms = timer_wheel_.nextTimeoutMs(now_ms);
+        if (timeout_ms < 0) {
+            return;
+        }
+        if (timeout_ms == 0) {
+            timeout_ms = 1;  // it_value 全 0 表示关闭定时器
+        }
+        uint64_t deadline_ms = now_ms + static_cast<uint64_t>(timeout_ms);
+        if (timer_deadline_ms_ != 0 && timer_deadline_ms_ <= deadline_ms) {
+            return;
+        }
+
+        struct itimerspec spec;
+        std::memset(&spec, 0, sizeof(spec));
+        spec.it_value.tv_sec = timeout_ms / 1000;
+        spec.it_value.tv_nsec = (timeout_ms % 1000) * 1000000;
+        if (timerfd_settime(timer_fd_, 0, &spec, nullptr) == -1) {
+            std::cerr << "Failed to arm timerfd in loop " << index_ << ": " << strerror(errno) << std::endl;
+            return;
+        }
+        timer_deadline_ms_ = deadline_ms;
+    }
+
+    // 为连接启动空闲检测定时器：定时器只记连接句柄，连接关闭后句柄失效，回调自然成为空操作
+    void EventLoop::startIdleTimer(uint64_t handle, uint64_t delay_ms) {
+        std::shared_ptr<TcpConnectionImpl>* entry = connections_.get(handle);
+        if (entry == nullptr) {
+            return;
+        }
+        (*entry)->setIdleTimerId(runAfter(delay_ms, [this, handle]() {
+            handleIdleTimeout(handle);
+        }));
+    }
+
+    // 空闲检测：活跃时间不在每次读时重置定时器，而是到期时检查，仍在活跃就按剩余时间再等一次
+    void EventLoop::handleIdleTimeout(uint64_t handle) {
+        std::shared_ptr<TcpConnectionImpl>* entry = connections_.get(handle);
+        if (entry == nullptr) {
+            return;
+        }
+        std::shared_ptr<TcpConnectionImpl> connection = *entry;
+        connection->setIdleTimerId(TimerWheel::kInvalidTimerId);
+
+        uint64_t idle_ms = TimerWheel::nowMs() - connection->getLastActiveMs();
+        if (idle_ms >= idle_timeout_ms_) {
+            std::cout << "Idle connection timeout: " << connection->getRemoteAddress()
+                      << " (" << idle_ms << "ms)" << std::endl;
+            handleClientClose(connection.get());
+        } else {
+            startIdleTimer(handle, idle_timeout_ms_ - idle_ms);
+        }
+    }
+
+    // 执行待处理任务：交换出来再执行，避免持锁回调
+    void EventLoop::doPendingFunctors() {
+        std::vector<Functor> functors;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            functors.swap(pending_functors_);
+        }
+        for (auto& functor : functors) {
+            functor();
+        }
+    }
+
+    // 取出发送队列中的所有帧，按连接分组后各用一次 sendmsg 写出
+    void EventLoop::flushPendingWrites() {
+        // 先清除唤醒标记再取队列，保证之后入队的生产者会再次唤醒
+        write_wakeup_pending_.store(false);
+
+        // 按连接分组，保持同一连接内的入队顺序
+        std::vector<std::pair<std::shared_ptr<TcpConnectionImpl>, std::vector<OutputFrame>>> batches;
+        std::unordered_map<TcpConnectionImpl*, size_t> batch_index;
+        PendingWrite pending;
+        while (write_queue_.pop(pending)) {
+            auto it = batch_index.find(pending.connection.get());
+            if (it == batch_index.end()) {
+                it = batch_index.emplace(pending.connection.get(), batches.size()).first;
+                batches.emplace_back(std::move(pending.connection), std::vector<OutputFrame>());
+            }
+            batches[it->second].second.push_back(std::move(pending.frame));
+        }
+
+        for (auto& batch : batches) {
+            TcpConnectionImpl* connection = batch.first.get();
+            if (connection->getSocketFd() == -1) {
+                continue;  // 连接已关闭，丢弃
+            }
+            if (!connection->writeFrames(batch.second)) {
+                handleClientClose(connection);
+            }
+        }
+    }
+
+    // 将连接注册到 epoll
+    void EventLoop::registerConnection(const std::shared_ptr<TcpConnectionImpl>& connection) {
+        if (!running_) {
+            // 循环已停止，直接关闭
+            connection_count_--;
+            connection->close();
+            return;
+        }
+
+        // 先入表拿到句柄，再以句柄注册 epoll
+        uint64_t handle = connections_.insert(connection);
+        connection->setLoopHandle(handle);
+
+        struct epoll_event event;
+        event.events = connection->getEvents();  // 默认 EPOLLIN | EPOLLET，边沿触发
+        event.data.u64 = handle;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, connection->getSocketFd(), &event) == -1) {
+            std::cerr << "Failed to add client socket to epoll: " << strerror(errno) << std::endl;
+            connections_.remove(handle);
+            connection->setLoopHandle(SlotMap<std::shared_ptr<TcpConnectionImpl>>::kInvalidHandle);
+            connection_count_--;
+            connection->close();
+            return;
+        }
+
+        if (idle_timeout_ms_ > 0) {
+            connection->setLastActiveMs(TimerWheel::nowMs());
+            startIdleTimer(handle, idle_timeout_ms_);
+        }
+    }
+
+    // 处理客户端事件
+    void EventLoop::handleClientEvent(const struct epoll_event& event) {
+        // 句柄已失效说明连接在本批次前面的事件中被关闭，丢弃残留事件
+        std::shared_ptr<TcpConnectionImpl>* entry = connections_.get(event.data.u64);
+        if (entry == nullptr) {
+            return;
+        }
+        // 处理期间持有引用，防止读/写出错关闭后连接被提前析构
+        std::shared_ptr<TcpConnectionImpl> guard = *entry;
+        TcpConnectionImpl* connection = guard.get();
+
+        // 已在待读列表中的连接由 processPendingReads 统一处理，避免一轮拿到两份预算
+        if ((event.events & EPOLLIN) && !connection->isReadPending()) {
+            if (handleClientRead(connection)) {
+                schedulePendingRead(connection);
+            }
+        }
+
+        // 输出缓冲区还有积压，继续写
+        if ((event.events & EPOLLOUT) && connection->getSocketFd() != -1) {
+            if (!connection->handleWrite()) {
+                handleClientClose(connection);
+            }
+        }
+
+        if ((event.events & (EPOLLERR | EPOLLHUP)) && connection->getSocketFd() != -1) {
+            handleClientClose(connection);
+        }
+    }
+
+    // 处理读事件：边沿触发下一直读到 EAGAIN，但每个连接每轮最多消耗 read_budget_bytes_ 字节 / read_budget_frames_ 帧
+    // 帧数用完时剩下的完整帧留在输入缓冲区里，下一轮先解码它们再读 socket
+    // 返回 true 表示预算用完而缓冲区或 socket 里可能还有数据，需要下一轮继续读
+    bool EventLoop::handleClientRead(TcpConnectionImpl* connection) {
+        if (connection->getState() != ConnectionState::CONNECTED || !connection->isReading()) {
+            return false;
+        }
+
+        IoBuf* input_buffer = connection->getInputBuffer();
+        size_t bytes_read = 0;   // 本轮已读字节数
+        size_t frames_read = 0;  // 本轮已解码帧数
+
+        while (true) {
+            // 解码缓冲区里完整的帧（包括上一轮留下的）
+            IoBuf frame;
+            // 使用while循环，解决粘包问题（一次接收到多个请求）
+            while (frames_read < read_budget_frames_ && connection->decodeFrame(frame)) {
+                ++frames_read;
+                // 触发 FrameCallback -> 调用 rpc_server 里的parseRequest（帧以视图交出，不拷贝）
+                if (connection->getFrameCallback()) {
+                    connection->getFrameCallback()(connection->shared_from_this(), std::move(frame));
+                } else if (connection->getMessageCallback()) {
+                    connection->getMessageCallback()(connection->shared_from_this(), frame.toVector());
+                }
+            }
+
+            // 回调里可能关闭连接或暂停读取
+            if (connection->getSocketFd() == -1 || !connection->isReading()) {
+                return false;
+            }
+            // 预算用完，让出给其他连接
+            if (bytes_read >= read_budget_bytes_ || frames_read >= read_budget_frames_) {
+                return true;
+            }
+
+            int saved_errno = 0;
+            // readv 直接读进输入缓冲区的块中，预留大小随连接最近的读取量调整
+            ssize_t n = input_buffer->readFromFd(connection->getSocketFd(), &saved_errno, connection->nextReadSize());
+
+            if (n > 0) {
+                connection->recordRead(static_cast<size_t>(n));
+                bytes_read += static_cast<size_t>(n);
+                if (idle_timeout_ms_ > 0) {
+                    connection->setLastActiveMs(TimerWheel::nowMs());
+                }
+                // 接收到数据，回到循环开头解码
+            } else if (n == 0) {
+                // 对端关闭连接
+                handleClientClose(connection);
+                return false;
+            } else {
+                if (saved_errno == EINTR) {
+                    continue;
+                }
+                // 读取错误
+                if (saved_errno != EAGAIN && saved_errno != EWOULDBLOCK) {
+                    std::cerr << "Failed to receive data: " << strerror(saved_errno) << std::endl;
+                    handleClientClose(connection);
+                }
+                return false;  // 已读到 EAGAIN
+            }
+        }
+    }
+
+    // 预算用完的连接放入待读列表，下一轮继续读（边沿触发不会再次通知）
+    void EventLoop::schedulePendingRead(TcpConnectionImpl* connection) {
+        if (!connection->isReadPending()) {
+            connection->setReadPending(true);
+            pending_reads_.push_back(std::static_pointer_cast<TcpConnectionImpl>(connection->shared_from_this()));
+        }
+    }
+
+    // 处理待读列表：每个连接再给一份预算
+    void EventLoop::processPendingReads() {
+        std::vector<std::shared_ptr<TcpConnectionImpl>> connections;
+        connections.swap(pending_reads_);
+        for (auto& connection : connections) {
+            connection->setReadPending(false);
+            if (connection->getSocketFd() == -1) {
+                continue;  // 已关闭
+            }
+            if (handleClientRead(connection.get())) {
+                schedulePendingRead(connection.get());
+            }
+        }
+    }
+
+    // 处理关闭事件
+    void EventLoop::handleClientClose(TcpConnectionImpl* connection) {
+        // 从epoll中移除
+        int sockfd = connection->getSocketFd();
+        if (sockfd == -1) {
+            return;  // 已经关闭过
+        }
+        std::string peer_addr = connection->getRemoteAddress();
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, sockfd, nullptr);
+
+        // 按句柄 O(1) 移除，先持有引用，防止移除后连接对象被析构
+        std::shared_ptr<TcpConnectionImpl> guard;
+        if (connections_.remove(connection->getLoopHandle(), &guard)) {
+            connection_count_--;
+        }
+        connection->setLoopHandle(SlotMap<std::shared_ptr<TcpConnectionImpl>>::kInvalidHandle);
+        if (connection->getIdleTimerId() != TimerWheel::kInvalidTimerId) {
+            timer_wheel_.cancelTimer(connection->getIdleTimerId());
+            connection->setIdleTimerId(TimerWheel::kInvalidTimerId);
+        }
+
+        connection->close();
+        std::cout << "Connection closed: " << peer_addr << std::endl;
+
+        // 通知上层连接已断开（状态为 DISCONNECTED）
+        if (connection->getConnectionCallback()) {
+            connection->getConnectionCallback()(connection->shared_from_this());
+        }
+    }
+
+    // 关闭所有连接
+    void EventLoop::closeAllConnections() {
+        connections_.forEach([this](uint64_t, std::shared_ptr<TcpConnectionImpl>& connection) {
+            if (epoll_fd_ != -1 && connection->getSocketFd() != -1) {
+                epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connection->getSocketFd(), nullptr);
+            }
+            connection->setLoopHandle(SlotMap<std::shared_ptr<TcpConnectionImpl>>::kInvalidHandle);
+            connection->close();
+        });
+        connections_.clear();
+        connection_count_ = 0;
+    }
+
+}
@@ -0,0 +1,265 @@
+#include "io_uring_client.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+#include <iostream>
+
+namespace rpc {
+
+    namespace {
+        const uint64_t kUserDataOp = 1;
+        const uint64_t kUserDataTimeout = 2;
+        const size_t kRecvChunkSize = 64 * 1024;
+    }
+
+    IoUringTcpClient::IoUringTcpClient()
+        :sockfd_(-1),
+         state_(ConnectionState::DISCONNECTED),
+         receive_timeout_ms_(kIoTimeoutMs),
+         send_timeout_ms_(kIoTimeoutMs),
+         ring_ready_(false)
+    {}
+
+    IoUringTcpClient::~IoUringTcpClient() {
+        disconnect();
+    }
+
+    // 连接服务器：CONNECT + LINK_TIMEOUT
+    bool IoUringTcpClient::connect(const std::string& host, uint16_t port) {
+        if (state_ == ConnectionState::CONNECTED) {
+            return true;
+        }
+        std::lock(send_mutex_, receive_mutex_);
+        std::lock_guard<std::mutex> send_lock(send_mutex_, std::adopt_lock);
+        std::lock_guard<std::mutex> receive_lock(receive_mutex_, std::adopt_lock);
+
+        if (!ring_ready_) {
+            if (!send_ring_.init(8) || !receive_ring_.init(8)) {
+                return false;
+            }
+            ring_ready_ = true;
+        }
+
+        SocketAddress address;
+        if (!address.parse(host, port)) {
+            return false;
+        }
+
+        if (sockfd_ != -1) {  // 出错断开后留下的 socket
+            ::close(sockfd_);
+            sockfd_ = -1;
+        }
+        state_ = ConnectionState::CONNECTING;
+        // socket 保持阻塞模式：等待由 io_uring 完成，不占用调用线程去轮询
+        sockfd_ = socket(address.getFamily(), SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (sockfd_ == -1) {
+            std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+            state_ = ConnectionState::DISCONNECTED;
+            return false;
+        }
+
+        struct io_uring_sqe* sqe = send_ring_.getSqe();
+        sqe->opcode = IORING_OP_CONNECT;
+        sqe->fd = sockfd_;
+        sqe->addr = reinterpret_cast<uint64_t>(address.getSockAddr());
+        sqe->off = address.getLength();
+        int result = runWithTimeout(send_ring_, sqe, kConnectTimeoutMs);
+        if (result < 0) {
+            if (result == -ETIMEDOUT) {
+                std::cerr << "Connection timeout" << std::endl;
+            } else {
+                std::cerr << "Failed to connect: " << strerror(-result) << std::endl;
+            }
+            ::close(sockfd_);
+            sockfd_ = -1;
+            state_ = ConnectionState::DISCONNECTED;
+            return false;
+        }
+
+        // 多个调用的请求帧会背靠背写出，关闭 Nagle
+        if (!address.isUnix()) {
+            int one = 1;
+            setsockopt(sockfd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+
+        input_buffer_.retrieveAll();
+        state_ = ConnectionState::CONNECTED;
+        server_addr_ = address.toString();
+        std::cout << "Connected to " << server_addr_ << " (io_uring)" << std::endl;
+        return true;
+    }
+
+    // 断开连接
+    void IoUringTcpClient::disconnect() {
+        std::lock(send_mutex_, receive_mutex_);
+        std::lock_guard<std::mutex> send_lock(send_mutex_, std::adopt_lock);
+        std::lock_guard<std::mutex> receive_lock(receive_mutex_, std::adopt_lock);
+        if (state_ != ConnectionState::DISCONNECTED || sockfd_ != -1) {
+            state_ = ConnectionState::DISCONNECTING;
+            if (sockfd_ != -1) {
+                ::close(sockfd_);
+                sockfd_ = -1;
+            }
+            input_buffer_.retrieveAll();
+            state_ = ConnectionState::DISCONNECTED;
+            server_addr_.clear();
+        }
+    }
+
+    // 关闭读写两个方向：在途的 IORING_OP_RECV 以 0 完成（不拿锁，持锁的可能正是阻塞的那个线程）
+    void IoUringTcpClient::shutdown() {
+        int fd = sockfd_;
+        if (fd != -1) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+    }
+
+    bool IoUringTcpClient::send(const std::vector<uint8_t>& data) {
+        return sendBytes(data.data(), data.size());
+    }
+
+    bool IoUringTcpClient::send(const Buffer& frame) {
+        return sendBytes(frame.peek(), frame.readableBytes());
+    }
+
+    // 发送消息：MSG_WAITALL 让内核处理短写
+    bool IoUringTcpClient::sendBytes(const uint8_t* data, size_t length) {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (state_ != ConnectionState::CONNECTED) {
+            return false;
+        }
+        if (length == 0) {
+            return true;
+        }
+
+        struct io_uring_sqe* sqe = send_ring_.getSqe();
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = sockfd_;
+        sqe->addr = reinterpret_cast<uint64_t>(data);
+        sqe->len = static_cast<uint32_t>(length);
+        sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        int result = runWithTimeout(send_ring_, sqe, send_timeout_ms_);
+        if (result < 0 || static_cast<size_t>(result) != length) {
+            handleError("Send failed: " + std::string(result < 0 ? strerror(-result) : "short send"));
+            return false;
+        }
+        return true;
+    }
+
+    // 接收一帧消息
+    bool IoUringTcpClient::receive(std::vector<uint8_t>& data) {
+        std::lock_guard<std::mutex> lock(receive_mutex_);
+        if (state_ != ConnectionState::CONNECTED) {
+            std::cerr << "Cannot receive: not connected" << std::endl;
+            return false;
+        }
+
+        return frame_codec_.readFrame(input_buffer_, [this](size_t length) { return fill(length); }, data);
+    }
+
+    // 接收一帧消息（帧体视图）
+    bool IoUringTcpClient::receive(const uint8_t*& data, size_t& length) {
+        std::lock_guard<std::mutex> lock(receive_mutex_);
+        if (state_ != ConnectionState::CONNECTED) {
+            std::cerr << "Cannot receive: not connected" << std::endl;
+            return false;
+        }
+
+        return frame_codec_.readFrame(input_buffer_, [this](size_t bytes) { return fill(bytes); }, data, length);
+    }
+
+    void IoUringTcpClient::setReceiveTimeout(uint32_t timeout_ms) {
+        receive_timeout_ms_ = timeout_ms;
+    }
+
+    void IoUringTcpClient::setSendTimeout(uint32_t timeout_ms) {
+        send_timeout_ms_ = timeout_ms;
+    }
+
+    ConnectionState IoUringTcpClient::getState() const {
+        return state_;
+    }
+
+    void IoUringTcpClient::setMessageCallback(MessageCallback callback) {
+        message_callback_ = std::move(callback);
+    }
+    void IoUringTcpClient::setConnectionCallback(ConnectionCallback callback) {
+        connection_callback_ = std::move(callback);
+    }
+    void IoUringTcpClient::setErrorCallback(ErrorCallback callback) {
+        error_callback_ = std::move(callback);
+    }
+
+    std::string IoUringTcpClient::getServerAddress() const {
+        return server_addr_;
+    }
+
+    // 提交并等待：操作与 LINK_TIMEOUT 各产生一个完成事件
+    int IoUringTcpClient::runWithTimeout(IoUringRing& ring, struct io_uring_sqe* op_sqe, int64_t timeout_ms) {
+        struct __kernel_timespec ts;
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (timeout_ms % 1000) * 1000000;
+
+        struct io_uring_sqe* timeout_sqe = ring.getSqe();
+        op_sqe->flags |= IOSQE_IO_LINK;
+        op_sqe->user_data = kUserDataOp;
+        timeout_sqe->opcode = IORING_OP_LINK_TIMEOUT;
+        timeout_sqe->fd = -1;
+        timeout_sqe->addr = reinterpret_cast<uint64_t>(&ts);
+        timeout_sqe->len = 1;
+        timeout_sqe->user_data = kUserDataTimeout;
+
+        int result = -ETIMEDOUT;
+        int completed = 0;
+        while (completed < 2) {
+            int ret = ring.submitAndWait(static_cast<unsigned>(2 - completed), -1);
+            if (ret < 0 && ret != -EINTR) {
+                return ret;
+            }
+            ring.forEachCqe([&](const struct io_uring_cqe& cqe) {
+                if (cqe.user_data == kUserDataOp) {
+                    // 被链接超时取消的操作以 ECANCELED 完成
+                    result = cqe.res == -ECANCELED ? -ETIMEDOUT : cqe.res;
+                }
+                ++completed;
+            });
+        }
+        return result;
+    }
+
+    // 读到输入缓冲区至少有 length 字节
+    FillStatus IoUringTcpClient::fill(size_t length) {
+        while (input_buffer_.readableBytes() < length) {
+            input_buffer_.ensureWritableBytes(kRecvChunkSize);
+            struct io_uring_sqe* sqe = receive_ring_.getSqe();
+            sqe->opcode = IORING_OP_RECV;
+            sqe->fd = sockfd_;
+            sqe->addr = reinterpret_cast<uint64_t>(input_buffer_.beginWrite());
+            sqe->len = static_cast<uint32_t>(input_buffer_.writableBytes());
+            int result = runWithTimeout(receive_ring_, sqe, receive_timeout_ms_);
+            if (result > 0) {
+                input_buffer_.hasWritten(static_cast<size_t>(result));
+            } else if (result == 0) {
+                handleError("Connection closed by peer");
+                return FillStatus::kFailed;
+            } else if (result == -ETIMEDOUT) {
+                return FillStatus::kTimeout;
+            } else {
+                handleError("Failed to receive data: " + std::string(strerror(-result)));
+                return FillStatus::kFailed;
+            }
+        }
+        return FillStatus::kFilled;
+    }
+
+    // 处理错误
+    void IoUringTcpClient::handleError(const std::string& error_msg) {
+        state_ = ConnectionState::DISCONNECTED;
+        std::cerr << "TcpClient error: " << error_msg << std::endl;
+    }
+
+}
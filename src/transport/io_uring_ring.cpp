@@ -0,0 +1,329 @@
+#include "io_uring_ring.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace rpc {
+
+IoUringRing::IoUringRing()
+    : ring_fd_(-1),
+      features_(0),
+      sq_ring_ptr_(nullptr),
+      sq_ring_size_(0),
+      sq_khead_(nullptr),
+      sq_ktail_(nullptr),
+      sq_kring_mask_(nullptr),
+      sq_kring_entries_(nullptr),
+      sq_array_(nullptr),
+      sqes_(nullptr),
+      sqes_size_(0),
+      sqe_head_(0),
+      sqe_tail_(0),
+      cq_ring_ptr_(nullptr),
+      cq_ring_size_(0),
+      cq_khead_(nullptr),
+      cq_ktail_(nullptr),
+      cq_kring_mask_(nullptr),
+      cqes_(nullptr),
+      buf_ring_(nullptr),
+      buf_ring_size_(0),
+      buffers_(nullptr),
+      buffers_size_(0),
+      buffer_size_(0),
+      buf_entries_(0),
+      buf_group_id_(0),
+      buf_tail_(0) {}
+
+IoUringRing::~IoUringRing() {
+    exit();
+}
+
+// 创建 ring
+bool IoUringRing::init(unsigned entries) {
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    // 完成事件在下一次进入内核时再处理，减少打断（5.19+），不支持时退回默认
+    params.flags = IORING_SETUP_COOP_TASKRUN;
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd_ < 0 && errno == EINVAL) {
+        std::memset(&params, 0, sizeof(params));
+        ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    }
+    if (ring_fd_ < 0) {
+        std::cerr << "io_uring_setup failed: " << strerror(errno) << std::endl;
+        ring_fd_ = -1;
+        return false;
+    }
+    features_ = params.features;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (features_ & IORING_FEAT_SINGLE_MMAP) {
+        if (cq_ring_size_ > sq_ring_size_) {
+            sq_ring_size_ = cq_ring_size_;
+        }
+        cq_ring_size_ = sq_ring_size_;
+    }
+
+    sq_ring_ptr_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ptr_ == MAP_FAILED) {
+        sq_ring_ptr_ = nullptr;
+        std::cerr << "mmap io_uring sq ring failed: " << strerror(errno) << std::endl;
+        exit();
+        return false;
+    }
+    if (features_ & IORING_FEAT_SINGLE_MMAP) {
+        cq_ring_ptr_ = sq_ring_ptr_;
+    } else {
+        cq_ring_ptr_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ptr_ == MAP_FAILED) {
+            cq_ring_ptr_ = nullptr;
+            std::cerr << "mmap io_uring cq ring failed: " << strerror(errno) << std::endl;
+            exit();
+            return false;
+        }
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        std::cerr << "mmap io_uring sqes failed: " << strerror(errno) << std::endl;
+        exit();
+        return false;
+    }
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+    uint8_t* sq = static_cast<uint8_t*>(sq_ring_ptr_);
+    sq_khead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_ktail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_kring_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_kring_entries_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+    uint8_t* cq = static_cast<uint8_t*>(cq_ring_ptr_);
+    cq_khead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_ktail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_kring_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    sqe_head_ = sqe_tail_ = *sq_ktail_;
+    return true;
+}
+
+// 释放 ring 与 buffer ring
+void IoUringRing::exit() {
+    if (buf_ring_) {
+        munmap(buf_ring_, buf_ring_size_);
+        buf_ring_ = nullptr;
+    }
+    if (buffers_) {
+        munmap(buffers_, buffers_size_);
+        buffers_ = nullptr;
+    }
+    if (sqes_) {
+        munmap(sqes_, sqes_size_);
+        sqes_ = nullptr;
+    }
+    if (cq_ring_ptr_ && cq_ring_ptr_ != sq_ring_ptr_) {
+        munmap(cq_ring_ptr_, cq_ring_size_);
+    }
+    cq_ring_ptr_ = nullptr;
+    if (sq_ring_ptr_) {
+        munmap(sq_ring_ptr_, sq_ring_size_);
+        sq_ring_ptr_ = nullptr;
+    }
+    if (ring_fd_ != -1) {
+        ::close(ring_fd_);
+        ring_fd_ = -1;
+    }
+}
+
+// 探测内核支持：需要 6.0+（多发 recv）、provided buffer ring 以及 EXT_ARG 带超时等待
+bool IoUringRing::isSupported() {
+    struct utsname name;
+    int major = 0;
+    int minor = 0;
+    if (uname(&name) != 0 || std::sscanf(name.release, "%d.%d", &major, &minor) != 2) {
+        return false;
+    }
+    if (major < 6) {
+        return false;
+    }
+
+    IoUringRing ring;
+    if (!ring.init(8)) {
+        return false;
+    }
+    if (!(ring.features_ & IORING_FEAT_EXT_ARG) || !(ring.features_ & IORING_FEAT_NODROP)) {
+        return false;
+    }
+
+    // 检查用到的操作码
+    const size_t probe_size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    std::vector<uint8_t> probe_storage(probe_size, 0);
+    auto* probe = reinterpret_cast<struct io_uring_probe*>(probe_storage.data());
+    if (syscall(__NR_io_uring_register, ring.ring_fd_, IORING_REGISTER_PROBE, probe, 256) < 0) {
+        return false;
+    }
+    const int required_ops[] = {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND, IORING_OP_SENDMSG, IORING_OP_READ,
+                                IORING_OP_CONNECT, IORING_OP_ASYNC_CANCEL, IORING_OP_LINK_TIMEOUT};
+    for (int op : required_ops) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            return false;
+        }
+    }
+
+    // provided buffer ring（5.19+）
+    return ring.setupBufferRing(0, 8, 4096);
+}
+
+// 取一个空闲 SQE
+struct io_uring_sqe* IoUringRing::getSqe() {
+    unsigned head = __atomic_load_n(sq_khead_, __ATOMIC_ACQUIRE);
+    if (sqe_tail_ - head >= *sq_kring_entries_) {
+        // 提交队列满，先提交已填写的
+        submit();
+        head = __atomic_load_n(sq_khead_, __ATOMIC_ACQUIRE);
+        if (sqe_tail_ - head >= *sq_kring_entries_) {
+            return nullptr;
+        }
+    }
+    unsigned index = sqe_tail_ & *sq_kring_mask_;
+    struct io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    ++sqe_tail_;
+    return sqe;
+}
+
+// 提交队列剩余空位
+unsigned IoUringRing::sqSpaceLeft() const {
+    unsigned head = __atomic_load_n(sq_khead_, __ATOMIC_ACQUIRE);
+    return *sq_kring_entries_ - (sqe_tail_ - head);
+}
+
+// 把已填写的 SQE 发布给内核
+unsigned IoUringRing::flushSq() {
+    unsigned to_submit = sqe_tail_ - sqe_head_;
+    if (to_submit > 0) {
+        __atomic_store_n(sq_ktail_, sqe_tail_, __ATOMIC_RELEASE);
+        sqe_head_ = sqe_tail_;
+    }
+    return to_submit;
+}
+
+// 提交所有已填写的 SQE
+int IoUringRing::submit() {
+    unsigned to_submit = flushSq();
+    if (to_submit == 0) {
+        return 0;
+    }
+    return enter(to_submit, 0, 0, nullptr, 0);
+}
+
+// 提交并等待
+int IoUringRing::submitAndWait(unsigned wait_nr, int64_t timeout_ms) {
+    unsigned to_submit = flushSq();
+    unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    if (timeout_ms < 0) {
+        return enter(to_submit, wait_nr, flags, nullptr, 0);
+    }
+
+    struct __kernel_timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000;
+    struct io_uring_getevents_arg arg;
+    std::memset(&arg, 0, sizeof(arg));
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+    return enter(to_submit, wait_nr, flags | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+}
+
+// 调用 io_uring_enter
+int IoUringRing::enter(unsigned to_submit, unsigned min_complete, unsigned flags, const void* arg, size_t arg_size) {
+    int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, arg, arg_size));
+    return ret < 0 ? -errno : ret;
+}
+
+// 注册 provided buffer ring
+bool IoUringRing::setupBufferRing(uint16_t group_id, unsigned entries, size_t buffer_size) {
+    if (entries == 0 || (entries & (entries - 1)) != 0 || entries > 32768) {
+        std::cerr << "io_uring buffer ring entries must be a power of 2 (<= 32768)" << std::endl;
+        return false;
+    }
+
+    buf_ring_size_ = entries * sizeof(struct io_uring_buf);
+    void* ring = mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ring == MAP_FAILED) {
+        return false;
+    }
+    buffers_size_ = entries * buffer_size;
+    void* buffers = mmap(nullptr, buffers_size_, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (buffers == MAP_FAILED) {
+        munmap(ring, buf_ring_size_);
+        return false;
+    }
+    // 注册前清零，tail 从 0 开始
+    std::memset(ring, 0, buf_ring_size_);
+    buf_ring_ = static_cast<struct io_uring_buf_ring*>(ring);
+    buffers_ = static_cast<uint8_t*>(buffers);
+    buffer_size_ = buffer_size;
+    buf_entries_ = entries;
+    buf_group_id_ = group_id;
+    buf_tail_ = 0;
+
+    struct io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+    reg.ring_entries = entries;
+    reg.bgid = group_id;
+    if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        munmap(buf_ring_, buf_ring_size_);
+        munmap(buffers_, buffers_size_);
+        buf_ring_ = nullptr;
+        buffers_ = nullptr;
+        return false;
+    }
+
+    // 初始时所有缓冲区都交给内核
+    for (unsigned i = 0; i < entries; ++i) {
+        recycleBuffer(static_cast<uint16_t>(i));
+    }
+    return true;
+}
+
+// 按缓冲区编号取地址
+uint8_t* IoUringRing::getBuffer(uint16_t buffer_id) const {
+    return buffers_ + static_cast<size_t>(buffer_id) * buffer_size_;
+}
+
+// 归还缓冲区
+void IoUringRing::recycleBuffer(uint16_t buffer_id) {
+    // 不用 buf_ring_->bufs：旧版内核头文件的 __DECLARE_FLEX_ARRAY 在 C++ 下会让 bufs 偏移 8 字节
+    struct io_uring_buf* bufs = reinterpret_cast<struct io_uring_buf*>(buf_ring_);
+    struct io_uring_buf* buf = &bufs[buf_tail_ & (buf_entries_ - 1)];
+    buf->addr = reinterpret_cast<uint64_t>(getBuffer(buffer_id));
+    buf->len = static_cast<uint32_t>(buffer_size_);
+    buf->bid = buffer_id;
+    ++buf_tail_;
+    __atomic_store_n(&buf_ring_->tail, buf_tail_, __ATOMIC_RELEASE);
+}
+
+size_t IoUringRing::getBufferSize() const {
+    return buffer_size_;
+}
+
+int IoUringRing::getFd() const {
+    return ring_fd_;
+}
+
+}
@@ -0,0 +1,876 @@
+#include "io_uring_server.h"
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+namespace rpc {
+
+    // ==================== IoUringConnection ====================
+
+    IoUringConnection::IoUringConnection(int sockfd, const std::string& peer_addr, IoUringLoop* loop)
+        :sockfd_(sockfd),
+         peer_addr_(peer_addr),
+         state_(ConnectionState::CONNECTED),
+         loop_(loop),
+         reading_(true),
+         pending_output_bytes_(0),
+         handle_(0),
+         recv_armed_(false),
+         closing_(false),
+         pending_ops_(0),
+         above_high_water_(false),
+         high_water_mark_(kDefaultHighWaterMark),
+         low_water_mark_(0),
+         last_active_ms_(0),
+         idle_timer_id_(0)
+    {}
+
+    IoUringConnection::~IoUringConnection() {
+        if (sockfd_ != -1) {
+            ::close(sockfd_);
+            sockfd_ = -1;
+        }
+    }
+
+    // 发送数据
+    bool IoUringConnection::send(const std::vector<uint8_t>& data) {
+        return send(std::vector<uint8_t>(data));
+    }
+
+    bool IoUringConnection::send(std::vector<uint8_t>&& data) {
+        if (state_ != ConnectionState::CONNECTED) {
+            return false;
+        }
+        if (data.empty()) {
+            return true;
+        }
+        pending_output_bytes_ += data.size();
+        loop_->queueWrite(std::static_pointer_cast<IoUringConnection>(shared_from_this()), std::move(data));
+        return true;
+    }
+
+    // 关闭连接
+    void IoUringConnection::close() {
+        if (state_ != ConnectionState::CONNECTED) {
+            return;
+        }
+        loop_->closeConnection(std::static_pointer_cast<IoUringConnection>(shared_from_this()));
+    }
+
+    ConnectionState IoUringConnection::getState() const {
+        return state_;
+    }
+
+    std::string IoUringConnection::getRemoteAddress() const {
+        return peer_addr_;
+    }
+
+    void IoUringConnection::setMessageCallback(MessageCallback callback) {
+        message_callback_ = std::move(callback);
+    }
+    void IoUringConnection::setConnectionCallback(ConnectionCallback callback) {
+        connection_callback_ = std::move(callback);
+    }
+    void IoUringConnection::setWriteCompleteCallback(WriteCompleteCallback callback) {
+        write_complete_callback_ = std::move(callback);
+    }
+    void IoUringConnection::setErrorCallback(ErrorCallback callback) {
+        error_callback_ = std::move(callback);
+    }
+    void IoUringConnection::setHighWaterMarkCallback(HighWaterMarkCallback callback, size_t high_water_mark) {
+        high_water_mark_callback_ = std::move(callback);
+        high_water_mark_ = high_water_mark;
+    }
+    void IoUringConnection::setLowWaterMarkCallback(LowWaterMarkCallback callback, size_t low_water_mark) {
+        low_water_mark_callback_ = std::move(callback);
+        low_water_mark_ = low_water_mark;
+    }
+
+    // 恢复读取
+    void IoUringConnection::startReading() {
+        reading_ = true;
+        auto self = std::static_pointer_cast<IoUringConnection>(shared_from_this());
+        loop_->runInLoop([self]() {
+            self->loop_->updateReading(self.get());
+        });
+    }
+
+    // 暂停读取
+    void IoUringConnection::stopReading() {
+        reading_ = false;
+        auto self = std::static_pointer_cast<IoUringConnection>(shared_from_this());
+        loop_->runInLoop([self]() {
+            self->loop_->updateReading(self.get());
+        });
+    }
+
+    // 注册定时器
+    uint64_t IoUringConnection::runAfter(uint64_t delay_ms, std::function<void()> callback) {
+        return loop_->runAfter(delay_ms, std::move(callback));
+    }
+
+    // 取消定时器
+    bool IoUringConnection::cancelTimer(uint64_t timer_id) {
+        return loop_->cancelTimer(timer_id);
+    }
+
+    // 投递任务到所属循环
+    void IoUringConnection::queueInLoop(std::function<void()> task) {
+        loop_->queueInLoop(std::move(task));
+    }
+
+    MessageCallback& IoUringConnection::getMessageCallback() {
+        return message_callback_;
+    }
+    ConnectionCallback& IoUringConnection::getConnectionCallback() {
+        return connection_callback_;
+    }
+    WriteCompleteCallback& IoUringConnection::getWriteCompleteCallback() {
+        return write_complete_callback_;
+    }
+    ErrorCallback& IoUringConnection::getErrorCallback() {
+        return error_callback_;
+    }
+
+    int IoUringConnection::getSocketFd() const {
+        return sockfd_;
+    }
+
+    size_t IoUringConnection::getPendingOutputBytes() const {
+        return pending_output_bytes_.load();
+    }
+
+    // ==================== IoUringLoop ====================
+
+    IoUringLoop::IoUringLoop(size_t index)
+        :index_(index),
+         listen_fd_(-1),
+         wakeup_fd_(-1),
+         wakeup_value_(0),
+         running_(false),
+         connection_count_(0),
+         write_wakeup_pending_(false),
+         idle_timeout_ms_(0)
+    {}
+
+    IoUringLoop::~IoUringLoop() {
+        stop();
+    }
+
+    void IoUringLoop::setAcceptor(int listen_fd, NewConnectionCallback callback) {
+        listen_fd_ = listen_fd;
+        new_connection_callback_ = std::move(callback);
+    }
+
+    void IoUringLoop::setIdleTimeout(uint64_t idle_timeout_ms) {
+        idle_timeout_ms_ = idle_timeout_ms;
+    }
+
+    void IoUringLoop::setConnectionCallback(ConnectionCallback callback) {
+        connection_callback_ = std::move(callback);
+    }
+
+    // 启动循环线程
+    bool IoUringLoop::start() {
+        if (running_) {
+            return true;
+        }
+        if (!ring_.init(kRingEntries)) {
+            return false;
+        }
+        if (!ring_.setupBufferRing(kBufferGroupId, kBufferCount, kBufferSize)) {
+            std::cerr << "Failed to register io_uring buffer ring for loop " << index_ << std::endl;
+            ring_.exit();
+            return false;
+        }
+        wakeup_fd_ = eventfd(0, EFD_CLOEXEC);
+        if (wakeup_fd_ == -1) {
+            std::cerr << "Failed to create eventfd for loop " << index_ << ": " << strerror(errno) << std::endl;
+            ring_.exit();
+            return false;
+        }
+
+        running_ = true;
+        thread_ = std::thread(&IoUringLoop::loopMain, this);
+        return true;
+    }
+
+    // 停止循环线程，关闭所有连接
+    void IoUringLoop::stop() {
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        wakeup();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+
+        // 循环线程已退出，由当前线程收尾
+        thread_id_ = std::this_thread::get_id();
+        doPendingFunctors();
+        closeAllConnections();
+        thread_id_ = std::thread::id();
+
+        ring_.exit();
+        if (wakeup_fd_ != -1) {
+            ::close(wakeup_fd_);
+            wakeup_fd_ = -1;
+        }
+        listen_fd_ = -1;
+    }
+
+    void IoUringLoop::runInLoop(Functor task) {
+        if (isInLoopThread()) {
+            task();
+        } else {
+            queueInLoop(std::move(task));
+        }
+    }
+
+    void IoUringLoop::queueInLoop(Functor task) {
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            pending_functors_.push_back(std::move(task));
+        }
+        wakeup();
+    }
+
+    bool IoUringLoop::isInLoopThread() const {
+        return thread_id_.load() == std::this_thread::get_id();
+    }
+
+    // 投递一帧待发送数据
+    void IoUringLoop::queueWrite(std::shared_ptr<IoUringConnection> connection, std::vector<uint8_t>&& frame) {
+        write_queue_.push(PendingWrite{std::move(connection), std::move(frame)});
+        if (!write_wakeup_pending_.exchange(true)) {
+            wakeup();
+        }
+    }
+
+    // 关闭连接
+    void IoUringLoop::closeConnection(std::shared_ptr<IoUringConnection> connection) {
+        runInLoop([this, connection]() {
+            beginClose(connection.get());
+        });
+    }
+
+    // 按 reading_ 提交或取消多发 recv
+    void IoUringLoop::updateReading(IoUringConnection* connection) {
+        if (connection->closing_) {
+            return;
+        }
+        if (connection->reading_ && !connection->recv_armed_) {
+            armRecv(connection);
+        } else if (!connection->reading_ && connection->recv_armed_) {
+            cancelRecv(connection);
+        }
+    }
+
+    TimerWheel::TimerId IoUringLoop::runAfter(uint64_t delay_ms, Functor callback) {
+        return timer_wheel_.addTimer(delay_ms, std::move(callback));
+    }
+
+    bool IoUringLoop::cancelTimer(TimerWheel::TimerId timer_id) {
+        return timer_wheel_.cancelTimer(timer_id);
+    }
+
+    size_t IoUringLoop::getConnectionCount() const {
+        return connection_count_.load();
+    }
+
+    size_t IoUringLoop::getIndex() const {
+        return index_;
+    }
+
+    // 循环线程主函数：一次 io_uring_enter 同时提交本轮所有请求并等待完成事件
+    void IoUringLoop::loopMain() {
+        thread_id_ = std::this_thread::get_id();
+
+        armWakeup();
+        if (listen_fd_ != -1) {
+            armAccept();
+        }
+
+        while (running_) {
+            int ret = ring_.submitAndWait(1, timer_wheel_.nextTimeoutMs());
+            if (ret < 0 && ret != -EINTR && ret != -ETIME && ret != -EAGAIN && ret != -EBUSY) {
+                std::cerr << "io_uring_enter failed in loop " << index_ << ": " << strerror(-ret) << std::endl;
+                break;
+            }
+
+            ring_.forEachCqe([this](const struct io_uring_cqe& cqe) {
+                handleCqe(cqe);
+            });
+
+            timer_wheel_.advance();
+            doPendingFunctors();
+            flushPendingWrites();
+        }
+
+        thread_id_ = std::thread::id();
+    }
+
+    void IoUringLoop::wakeup() {
+        uint64_t one = 1;
+        ssize_t n = ::write(wakeup_fd_, &one, sizeof(one));
+        (void)n;
+    }
+
+    // 取 SQE，提交队列满时先提交
+    struct io_uring_sqe* IoUringLoop::getSqe() {
+        struct io_uring_sqe* sqe = ring_.getSqe();
+        while (sqe == nullptr) {
+            ring_.submitAndWait(0, -1);
+            sqe = ring_.getSqe();
+        }
+        return sqe;
+    }
+
+    // 多发 accept：一次提交，每个新连接一个完成事件
+    void IoUringLoop::armAccept() {
+        struct io_uring_sqe* sqe = getSqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = listen_fd_;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        sqe->user_data = makeUserData(kOpAccept, 0);
+    }
+
+    // 读 eventfd，用于跨线程唤醒
+    void IoUringLoop::armWakeup() {
+        struct io_uring_sqe* sqe = getSqe();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = wakeup_fd_;
+        sqe->addr = reinterpret_cast<uint64_t>(&wakeup_value_);
+        sqe->len = sizeof(wakeup_value_);
+        sqe->user_data = makeUserData(kOpWakeup, 0);
+    }
+
+    // 多发 recv：数据到达时内核从 provided buffer ring 取缓冲区，每次到达一个完成事件
+    void IoUringLoop::armRecv(IoUringConnection* connection) {
+        struct io_uring_sqe* sqe = getSqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = connection->sockfd_;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufferGroupId;
+        sqe->user_data = makeUserData(kOpRecv, connection->handle_);
+        connection->recv_armed_ = true;
+        connection->pending_ops_++;
+    }
+
+    // 取消多发 recv（暂停读取）
+    void IoUringLoop::cancelRecv(IoUringConnection* connection) {
+        struct io_uring_sqe* sqe = getSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = makeUserData(kOpRecv, connection->handle_);
+        sqe->user_data = makeUserData(kOpCancel, connection->handle_);
+        connection->pending_ops_++;
+    }
+
+    // 把等待中的帧按 kMaxSendIovecs 分批聚集成 SENDMSG，多批用 IOSQE_IO_LINK 串成一条链，内核按顺序执行；
+    // 同一连接同时只有一条链在途，保证字节序
+    void IoUringLoop::submitSends(IoUringConnection* connection) {
+        if (connection->closing_ || !connection->sending_.empty() || connection->waiting_.empty()) {
+            return;
+        }
+        size_t frame_count = std::min(connection->waiting_.size(), kMaxSendIovecs * kMaxLinkedSends);
+        size_t batch_count = (frame_count + kMaxSendIovecs - 1) / kMaxSendIovecs;
+        // 一条链必须在同一次提交里，否则内核会把它拆开
+        if (ring_.sqSpaceLeft() < batch_count) {
+            ring_.submit();
+        }
+
+        size_t next = 0;
+        for (size_t i = 0; i < batch_count; ++i) {
+            connection->sending_.emplace_back();
+            IoUringConnection::SendBatch& batch = connection->sending_.back();
+            size_t end = std::min(next + kMaxSendIovecs, frame_count);
+            batch.frames.reserve(end - next);
+            batch.iov.reserve(end - next);
+            batch.bytes = 0;
+            for (; next < end; ++next) {
+                batch.frames.push_back(std::move(connection->waiting_[next]));
+                std::vector<uint8_t>& frame = batch.frames.back();
+                batch.iov.push_back({frame.data(), frame.size()});
+                batch.bytes += frame.size();
+            }
+            std::memset(&batch.msg, 0, sizeof(batch.msg));
+            batch.msg.msg_iov = batch.iov.data();
+            batch.msg.msg_iovlen = batch.iov.size();
+
+            struct io_uring_sqe* sqe = getSqe();
+            sqe->opcode = IORING_OP_SENDMSG;
+            sqe->fd = connection->sockfd_;
+            sqe->addr = reinterpret_cast<uint64_t>(&batch.msg);
+            sqe->len = 1;
+            sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;  // 流式 socket 上短写由内核重试
+            if (i + 1 < batch_count) {
+                sqe->flags = IOSQE_IO_LINK;
+            }
+            sqe->user_data = makeUserData(kOpSend, connection->handle_);
+            connection->pending_ops_++;
+        }
+        connection->waiting_.erase(connection->waiting_.begin(), connection->waiting_.begin() + frame_count);
+    }
+
+    // 分发完成事件
+    void IoUringLoop::handleCqe(const struct io_uring_cqe& cqe) {
+        Op op = static_cast<Op>(cqe.user_data >> kOpShift);
+        if (op == kOpWakeup) {
+            if (running_) {
+                armWakeup();
+            }
+            return;
+        }
+        if (op == kOpAccept) {
+            handleAccept(cqe);
+            return;
+        }
+
+        std::shared_ptr<IoUringConnection>* entry = connections_.getMasked(cqe.user_data & kHandleMask, kGenerationMask);
+        if (entry == nullptr) {
+            return;  // 连接已释放
+        }
+        // 处理期间持有引用
+        std::shared_ptr<IoUringConnection> connection = *entry;
+        switch (op) {
+            case kOpRecv:
+                handleRecv(connection.get(), cqe);
+                break;
+            case kOpSend:
+                handleSend(connection.get(), cqe);
+                break;
+            case kOpCancel:
+                connection->pending_ops_--;
+                break;
+            default:
+                break;
+        }
+        maybeFinishClose(connection.get());
+    }
+
+    // 新连接
+    void IoUringLoop::handleAccept(const struct io_uring_cqe& cqe) {
+        if (cqe.res >= 0) {
+            // 响应帧各自独立写出，关闭 Nagle（Unix 域套接字上设置失败，忽略即可）
+            int one = 1;
+            setsockopt(cqe.res, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            addConnection(cqe.res);
+        } else if (cqe.res != -EINTR && cqe.res != -ECONNABORTED && cqe.res != -EAGAIN) {
+            std::cerr << "Failed to accept connection in loop " << index_ << ": " << strerror(-cqe.res) << std::endl;
+        }
+        // 多发 accept 被内核终止时重新提交
+        if (!(cqe.flags & IORING_CQE_F_MORE) && running_) {
+            armAccept();
+        }
+    }
+
+    // 收到数据
+    void IoUringLoop::handleRecv(IoUringConnection* connection, const struct io_uring_cqe& cqe) {
+        bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+        if (!more) {
+            connection->recv_armed_ = false;
+            connection->pending_ops_--;
+        }
+
+        if (cqe.res > 0) {
+            // 数据在内核挑选的 provided buffer 中，拷到连接的输入缓冲区后立即归还
+            uint16_t buffer_id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            connection->input_buffer_.append(ring_.getBuffer(buffer_id), static_cast<size_t>(cqe.res));
+            ring_.recycleBuffer(buffer_id);
+            if (idle_timeout_ms_ > 0) {
+                connection->last_active_ms_ = TimerWheel::nowMs();
+            }
+
+            // 解码完整的帧：4 字节长度 + 消息体
+            Buffer& input = connection->input_buffer_;
+            std::vector<uint8_t> frame;
+            while (!connection->closing_) {
+                FrameStatus status = frame_codec_.decode(input, frame);
+                if (status == FrameStatus::kInvalid) {
+                    input.retrieveAll();
+                    beginClose(connection);
+                    return;
+                }
+                if (status == FrameStatus::kIncomplete) {
+                    break;  // 半包
+                }
+                if (connection->message_callback_) {
+                    connection->message_callback_(connection->shared_from_this(), frame);
+                }
+            }
+        } else if (cqe.res == 0) {
+            beginClose(connection);  // 对端关闭
+            return;
+        } else if (cqe.res != -ENOBUFS && cqe.res != -ECANCELED) {
+            // ENOBUFS：provided buffer 暂时用完，下面重新提交即可
+            if (!connection->closing_) {
+                std::cerr << "Failed to receive data: " << strerror(-cqe.res) << std::endl;
+                beginClose(connection);
+            }
+            return;
+        }
+
+        if (!connection->recv_armed_ && !connection->closing_ && connection->reading_) {
+            armRecv(connection);
+        }
+    }
+
+    // 发送完成：链中的批次按提交顺序完成
+    void IoUringLoop::handleSend(IoUringConnection* connection, const struct io_uring_cqe& cqe) {
+        connection->pending_ops_--;
+        if (connection->sending_.empty()) {
+            return;
+        }
+        size_t batch_size = connection->sending_.front().bytes;
+        connection->sending_.pop_front();
+
+        if (cqe.res < 0 || static_cast<size_t>(cqe.res) != batch_size) {
+            // 链中某一批失败，后面的批次会以 ECANCELED 完成
+            if (!connection->closing_) {
+                std::string error = cqe.res < 0 ? strerror(-cqe.res) : "short send";
+                std::cerr << "Failed to send data to " << connection->peer_addr_ << ": " << error << std::endl;
+                if (connection->error_callback_) {
+                    connection->error_callback_(connection->shared_from_this(), "Send failed: " + error);
+                }
+                beginClose(connection);
+            }
+            return;
+        }
+
+        size_t pending = connection->pending_output_bytes_.fetch_sub(batch_size) - batch_size;
+        if (!connection->sending_.empty()) {
+            return;
+        }
+
+        // 当前链全部完成
+        if (!connection->waiting_.empty()) {
+            submitSends(connection);
+        } else if (connection->write_complete_callback_) {
+            connection->write_complete_callback_(connection->shared_from_this());
+        }
+        if (connection->above_high_water_ && pending <= connection->low_water_mark_) {
+            connection->above_high_water_ = false;
+            if (connection->low_water_mark_callback_) {
+                connection->low_water_mark_callback_(connection->shared_from_this());
+            }
+        }
+    }
+
+    // 注册新连接
+    void IoUringLoop::addConnection(int sockfd) {
+        if (new_connection_callback_ && !new_connection_callback_(sockfd)) {
+            ::close(sockfd);
+            std::cerr << "Connection limit exceeded" << std::endl;
+            return;
+        }
+
+        std::string peer_addr = SocketAddress::getPeerName(sockfd);
+
+        auto connection = std::make_shared<IoUringConnection>(sockfd, peer_addr, this);
+        connection->handle_ = connections_.insert(connection);
+        connection_count_++;
+
+        // 先调用连接回调（设置消息回调等），再开始读
+        if (connection_callback_) {
+            connection_callback_(connection);
+        }
+        if (connection->reading_ && !connection->closing_) {
+            armRecv(connection.get());
+        }
+        if (idle_timeout_ms_ > 0) {
+            connection->last_active_ms_ = TimerWheel::nowMs();
+            startIdleTimer(connection->handle_, idle_timeout_ms_);
+        }
+
+        std::cout << "New connection from " << peer_addr << " -> io_uring loop " << index_ << std::endl;
+    }
+
+    // 开始关闭：shutdown 让内核中的 recv/send 尽快完成，等它们全部返回后再释放 fd 与缓冲区
+    void IoUringLoop::beginClose(IoUringConnection* connection) {
+        if (connection->closing_) {
+            return;
+        }
+        connection->closing_ = true;
+        connection->state_ = ConnectionState::DISCONNECTING;
+        if (connection->idle_timer_id_ != TimerWheel::kInvalidTimerId) {
+            timer_wheel_.cancelTimer(connection->idle_timer_id_);
+            connection->idle_timer_id_ = TimerWheel::kInvalidTimerId;
+        }
+        connection->waiting_.clear();
+        ::shutdown(connection->sockfd_, SHUT_RDWR);
+        maybeFinishClose(connection);
+    }
+
+    // 内核中没有该连接的操作后真正释放
+    void IoUringLoop::maybeFinishClose(IoUringConnection* connection) {
+        if (!connection->closing_ || connection->pending_ops_ > 0 || connection->sockfd_ == -1) {
+            return;
+        }
+        std::shared_ptr<IoUringConnection> guard;
+        if (connections_.remove(connection->handle_, &guard)) {
+            connection_count_--;
+        }
+        ::close(connection->sockfd_);
+        connection->sockfd_ = -1;
+        connection->sending_.clear();
+        connection->pending_output_bytes_ = 0;
+        connection->state_ = ConnectionState::DISCONNECTED;
+        std::cout << "Connection closed: " << connection->peer_addr_ << std::endl;
+
+        if (connection->connection_callback_) {
+            connection->connection_callback_(connection->shared_from_this());
+        }
+    }
+
+    // 执行待处理任务
+    void IoUringLoop::doPendingFunctors() {
+        std::vector<Functor> functors;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            functors.swap(pending_functors_);
+        }
+        for (auto& functor : functors) {
+            functor();
+        }
+    }
+
+    // 取出发送队列中的所有帧，追加到各连接的等待列表，再为空闲的连接提交发送链
+    void IoUringLoop::flushPendingWrites() {
+        write_wakeup_pending_.store(false);
+
+        std::vector<std::shared_ptr<IoUringConnection>> touched;
+        std::unordered_map<IoUringConnection*, size_t> touched_index;
+        PendingWrite pending;
+        while (write_queue_.pop(pending)) {
+            IoUringConnection* connection = pending.connection.get();
+            if (connection->closing_) {
+                continue;  // 连接正在关闭，丢弃
+            }
+            connection->waiting_.push_back(std::move(pending.frame));
+            if (touched_index.emplace(connection, touched.size()).second) {
+                touched.push_back(std::move(pending.connection));
+            }
+        }
+
+        for (auto& connection : touched) {
+            size_t output = connection->pending_output_bytes_.load();
+            if (!connection->above_high_water_ && output >= connection->high_water_mark_) {
+                connection->above_high_water_ = true;
+                if (connection->high_water_mark_callback_) {
+                    connection->high_water_mark_callback_(connection, output);
+                }
+            }
+            submitSends(connection.get());
+        }
+    }
+
+    // 空闲检测（与 EventLoop 相同：到期时检查最近活跃时间）
+    void IoUringLoop::startIdleTimer(uint64_t handle, uint64_t delay_ms) {
+        std::shared_ptr<IoUringConnection>* entry = connections_.get(handle);
+        if (entry == nullptr) {
+            return;
+        }
+        (*entry)->idle_timer_id_ = runAfter(delay_ms, [this, handle]() {
+            handleIdleTimeout(handle);
+        });
+    }
+
+    void IoUringLoop::handleIdleTimeout(uint64_t handle) {
+        std::shared_ptr<IoUringConnection>* entry = connections_.get(handle);
+        if (entry == nullptr) {
+            return;
+        }
+        std::shared_ptr<IoUringConnection> connection = *entry;
+        connection->idle_timer_id_ = TimerWheel::kInvalidTimerId;
+        if (connection->closing_) {
+            return;
+        }
+        uint64_t idle_ms = TimerWheel::nowMs() - connection->last_active_ms_;
+        if (idle_ms >= idle_timeout_ms_) {
+            std::cout << "Idle connection timeout: " << connection->peer_addr_ << " (" << idle_ms << "ms)" << std::endl;
+            beginClose(connection.get());
+        } else {
+            startIdleTimer(handle, idle_timeout_ms_ - idle_ms);
+        }
+    }
+
+    // 关闭所有连接：shutdown 后继续收割完成事件，直到内核不再引用任何连接的缓冲区
+    void IoUringLoop::closeAllConnections() {
+        std::vector<std::shared_ptr<IoUringConnection>> connections;
+        connections_.forEach([&connections](uint64_t, std::shared_ptr<IoUringConnection>& connection) {
+            connections.push_back(connection);
+        });
+        for (auto& connection : connections) {
+            beginClose(connection.get());
+        }
+
+        uint64_t deadline = TimerWheel::nowMs() + 1000;
+        while (!connections_.empty() && TimerWheel::nowMs() < deadline) {
+            ring_.submitAndWait(1, 50);
+            ring_.forEachCqe([this](const struct io_uring_cqe& cqe) {
+                handleCqe(cqe);
+            });
+        }
+        if (!connections_.empty()) {
+            std::cerr << "io_uring loop " << index_ << ": " << connections_.size()
+                      << " connections still have in-flight operations at shutdown" << std::endl;
+        }
+        connections_.clear();
+        connection_count_ = 0;
+    }
+
+    uint64_t IoUringLoop::makeUserData(Op op, uint64_t handle) {
+        return (static_cast<uint64_t>(op) << kOpShift) | (handle & kHandleMask);
+    }
+
+    // ==================== IoUringTcpServer ====================
+
+    IoUringTcpServer::IoUringTcpServer(const TcpServerConfig& config)
+        :config_(config),
+         running_(false)
+    {}
+
+    IoUringTcpServer::~IoUringTcpServer() {
+        stop();
+    }
+
+    // 启动：每个循环一个监听 socket（多个循环时使用 SO_REUSEPORT 由内核分摊），各自提交多发 accept；
+    // Unix 域套接字不支持 SO_REUSEPORT，所有循环在同一个监听 socket 上提交多发 accept
+    bool IoUringTcpServer::start(uint16_t port, const std::string& host) {
+        if (running_) {
+            return true;
+        }
+        if (!listen_addr_.parse(host, port)) {
+            return false;
+        }
+        size_t loop_count = config_.io_thread_count > 0 ? config_.io_thread_count : 1;
+        bool reuse_port = !listen_addr_.isUnix() && (loop_count > 1 || config_.reuse_port);
+
+        for (size_t i = 0; i < loop_count; ++i) {
+            int listen_fd = -1;
+            if (reuse_port || listen_fds_.empty()) {
+                listen_fd = createListenSocket(listen_addr_, reuse_port);
+                if (listen_fd == -1) {
+                    loops_.clear();
+                    closeListenSockets();
+                    return false;
+                }
+                listen_fds_.push_back(listen_fd);
+            } else {
+                listen_fd = listen_fds_.front();
+            }
+
+            auto loop = std::make_unique<IoUringLoop>(i);
+            loop->setAcceptor(listen_fd, [this](int) {
+                return getConnectionCount() < config_.max_connections;
+            });
+            loop->setIdleTimeout(config_.idle_timeout_ms);
+            loop->setConnectionCallback([this](std::shared_ptr<TcpConnection> connection) {
+                if (connection_callback_) {
+                    connection_callback_(connection);
+                }
+            });
+            if (!loop->start()) {
+                std::cerr << "Failed to start io_uring loop " << i << std::endl;
+                loops_.clear();
+                closeListenSockets();
+                return false;
+            }
+            loops_.push_back(std::move(loop));
+        }
+
+        running_ = true;
+        std::cout << "TCP Server (io_uring) started on " << listen_addr_.toString()
+                  << " with " << loops_.size() << " I/O loops" << std::endl;
+        return true;
+    }
+
+    void IoUringTcpServer::stop() {
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        for (auto& loop : loops_) {
+            loop->stop();
+        }
+        loops_.clear();
+        closeListenSockets();
+        std::cout << "TCP Server (io_uring) stopped" << std::endl;
+    }
+
+    void IoUringTcpServer::setConnectionCallback(ConnectionCallback callback) {
+        connection_callback_ = std::move(callback);
+    }
+
+    bool IoUringTcpServer::isRunning() const {
+        return running_;
+    }
+
+    size_t IoUringTcpServer::getConnectionCount() const {
+        size_t count = 0;
+        for (const auto& loop : loops_) {
+            count += loop->getConnectionCount();
+        }
+        return count;
+    }
+
+    size_t IoUringTcpServer::getIoLoopCount() const {
+        return loops_.size();
+    }
+
+    int IoUringTcpServer::createListenSocket(const SocketAddress& address, bool reuse_port) {
+        int listen_fd = socket(address.getFamily(), SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listen_fd == -1) {
+            std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+            return -1;
+        }
+
+        if (address.isUnix()) {
+            if (address.getPath()[0] != '@') {
+                ::unlink(address.getPath().c_str());
+            }
+        } else {
+            int opt = 1;
+            if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1 ||
+                (reuse_port && setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == -1)) {
+                std::cerr << "Failed to set socket option: " << strerror(errno) << std::endl;
+                ::close(listen_fd);
+                return -1;
+            }
+        }
+
+        if (bind(listen_fd, address.getSockAddr(), address.getLength()) == -1) {
+            std::cerr << "Failed to bind address: " << strerror(errno) << std::endl;
+            ::close(listen_fd);
+            return -1;
+        }
+        if (listen(listen_fd, config_.listen_backlog) == -1) {
+            std::cerr << "Failed to listen: " << strerror(errno) << std::endl;
+            ::close(listen_fd);
+            return -1;
+        }
+        return listen_fd;
+    }
+
+    void IoUringTcpServer::closeListenSockets() {
+        for (int listen_fd : listen_fds_) {
+            ::close(listen_fd);
+        }
+        if (!listen_fds_.empty() && listen_addr_.isUnix() && listen_addr_.getPath()[0] != '@') {
+            ::unlink(listen_addr_.getPath().c_str());
+        }
+        listen_fds_.clear();
+    }
+
+}
@@ -0,0 +1,256 @@
+#include "shm_client.h"
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+#include <iostream>
+
+namespace rpc {
+
+    ShmTcpClient::ShmTcpClient(size_t ring_capacity)
+        :ring_capacity_(ring_capacity),
+         control_fd_(-1),
+         state_(ConnectionState::DISCONNECTED),
+         receive_timeout_ms_(kIoTimeoutMs),
+         send_timeout_ms_(kIoTimeoutMs)
+    {}
+
+    ShmTcpClient::~ShmTcpClient() {
+        disconnect();
+    }
+
+    // 连接服务器：连上握手套接字，创建区域并发送 fd，等待服务端确认
+    bool ShmTcpClient::connect(const std::string& host, uint16_t port) {
+        (void)port;
+        if (state_ == ConnectionState::CONNECTED) {
+            return true;
+        }
+        std::lock(send_mutex_, receive_mutex_);
+        std::lock_guard<std::mutex> send_lock(send_mutex_, std::adopt_lock);
+        std::lock_guard<std::mutex> receive_lock(receive_mutex_, std::adopt_lock);
+        closeLocked();
+
+        if (!ShmRegion::isShmAddress(host)) {
+            std::cerr << "Shared memory client needs a shm: address, got " << host << std::endl;
+            return false;
+        }
+        SocketAddress address;
+        if (!address.parse(ShmRegion::toControlAddress(host), 0)) {
+            return false;
+        }
+
+        state_ = ConnectionState::CONNECTING;
+        control_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (control_fd_ == -1) {
+            std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+            state_ = ConnectionState::DISCONNECTED;
+            return false;
+        }
+        struct timeval timeout;
+        timeout.tv_sec = kConnectTimeoutMs / 1000;
+        timeout.tv_usec = (kConnectTimeoutMs % 1000) * 1000;
+        setsockopt(control_fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(control_fd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        char ack = 0;
+        if (::connect(control_fd_, address.getSockAddr(), address.getLength()) == -1) {
+            std::cerr << "Failed to connect to " << host << ": " << strerror(errno) << std::endl;
+        } else if (!region_.create(ring_capacity_) || !region_.sendFds(control_fd_)) {
+            std::cerr << "Failed to set up shared memory region for " << host << std::endl;
+        } else if (::recv(control_fd_, &ack, 1, 0) != 1) {
+            std::cerr << "Shared memory handshake with " << host << " failed" << std::endl;
+        } else {
+            input_buffer_.retrieveAll();
+            server_addr_ = host;
+            state_ = ConnectionState::CONNECTED;
+            std::cout << "Connected to " << server_addr_ << " (shared memory)" << std::endl;
+            return true;
+        }
+        closeLocked();
+        state_ = ConnectionState::DISCONNECTED;
+        return false;
+    }
+
+    // 断开连接
+    void ShmTcpClient::disconnect() {
+        std::lock(send_mutex_, receive_mutex_);
+        std::lock_guard<std::mutex> send_lock(send_mutex_, std::adopt_lock);
+        std::lock_guard<std::mutex> receive_lock(receive_mutex_, std::adopt_lock);
+        if (state_ != ConnectionState::DISCONNECTED || control_fd_ != -1) {
+            closeLocked();
+            state_ = ConnectionState::DISCONNECTED;
+            server_addr_.clear();
+        }
+    }
+
+    void ShmTcpClient::closeLocked() {
+        region_.release();
+        if (control_fd_ != -1) {
+            ::close(control_fd_);  // 服务端据此感知断开
+            control_fd_ = -1;
+        }
+        input_buffer_.retrieveAll();
+    }
+
+    // 关闭控制套接字的两个方向：等待中的 poll 看到挂断，收发返回失败（不拿锁，映射在 disconnect() 中释放）
+    void ShmTcpClient::shutdown() {
+        int fd = control_fd_;
+        if (fd != -1) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+    }
+
+    bool ShmTcpClient::send(const std::vector<uint8_t>& data) {
+        return sendBytes(data.data(), data.size());
+    }
+
+    bool ShmTcpClient::send(const Buffer& frame) {
+        return sendBytes(frame.peek(), frame.readableBytes());
+    }
+
+    // 发送消息：写入 c2s 环，环满时先自旋再等服务端腾出空间
+    bool ShmTcpClient::sendBytes(const uint8_t* data, size_t length) {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (state_ != ConnectionState::CONNECTED) {
+            return false;
+        }
+        ShmRing& ring = region_.getClientToServer();
+        const uint8_t* remaining = data;
+        while (length > 0) {
+            size_t written = ring.write(remaining, length);
+            if (written > 0) {
+                ring.notifyConsumer(region_.getFd(ShmRegion::kServerDataFd));
+                remaining += written;
+                length -= written;
+                continue;
+            }
+            if (send_spinner_.spin([&ring]() { return ring.writableBytes() > 0; })) {
+                continue;
+            }
+            if (!ring.prepareProducerWait()) {
+                continue;
+            }
+            int ret = waitFor(region_.getFd(ShmRegion::kClientSpaceFd), static_cast<int>(send_timeout_ms_.load()));
+            ring.cancelProducerWait();
+            if (ret == 0) {
+                handleError("Send timeout");
+                return false;
+            }
+            if (ret < 0) {
+                handleError("Connection closed by peer");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 接收一帧消息
+    bool ShmTcpClient::receive(std::vector<uint8_t>& data) {
+        std::lock_guard<std::mutex> lock(receive_mutex_);
+        if (state_ != ConnectionState::CONNECTED) {
+            std::cerr << "Cannot receive: not connected" << std::endl;
+            return false;
+        }
+
+        return frame_codec_.readFrame(input_buffer_, [this](size_t length) { return fill(length); }, data);
+    }
+
+    // 接收一帧消息（帧体视图）
+    bool ShmTcpClient::receive(const uint8_t*& data, size_t& length) {
+        std::lock_guard<std::mutex> lock(receive_mutex_);
+        if (state_ != ConnectionState::CONNECTED) {
+            std::cerr << "Cannot receive: not connected" << std::endl;
+            return false;
+        }
+
+        return frame_codec_.readFrame(input_buffer_, [this](size_t bytes) { return fill(bytes); }, data, length);
+    }
+
+    void ShmTcpClient::setReceiveTimeout(uint32_t timeout_ms) {
+        receive_timeout_ms_ = timeout_ms;
+    }
+
+    void ShmTcpClient::setSendTimeout(uint32_t timeout_ms) {
+        send_timeout_ms_ = timeout_ms;
+    }
+
+    ConnectionState ShmTcpClient::getState() const {
+        return state_;
+    }
+
+    void ShmTcpClient::setMessageCallback(MessageCallback callback) {
+        message_callback_ = std::move(callback);
+    }
+    void ShmTcpClient::setConnectionCallback(ConnectionCallback callback) {
+        connection_callback_ = std::move(callback);
+    }
+    void ShmTcpClient::setErrorCallback(ErrorCallback callback) {
+        error_callback_ = std::move(callback);
+    }
+
+    std::string ShmTcpClient::getServerAddress() const {
+        return server_addr_;
+    }
+
+    int ShmTcpClient::waitFor(int event_fd, int timeout_ms) {
+        struct pollfd pfds[2];
+        pfds[0].fd = event_fd;
+        pfds[0].events = POLLIN;
+        pfds[1].fd = control_fd_;
+        pfds[1].events = POLLIN | POLLRDHUP;
+        int ret;
+        do {
+            ret = poll(pfds, 2, timeout_ms);
+        } while (ret == -1 && errno == EINTR);
+        if (ret <= 0) {
+            return 0;
+        }
+        if (pfds[0].revents & POLLIN) {
+            uint64_t value = 0;
+            ssize_t n = ::read(event_fd, &value, sizeof(value));
+            (void)n;
+            return 1;
+        }
+        return -1;  // 握手之后服务端不再在控制套接字上发送数据，可读即已关闭
+    }
+
+    // 读到输入缓冲区至少有 length 字节
+    FillStatus ShmTcpClient::fill(size_t length) {
+        ShmRing& ring = region_.getServerToClient();
+        while (input_buffer_.readableBytes() < length) {
+            ssize_t n = ring.readInto(input_buffer_);
+            if (n < 0) {
+                handleError("Corrupted shared memory ring");
+                return FillStatus::kFailed;
+            }
+            if (n > 0) {
+                ring.notifyProducer(region_.getFd(ShmRegion::kServerSpaceFd));
+                continue;
+            }
+            if (receive_spinner_.spin([&ring]() { return ring.readableBytes() > 0; })) {
+                continue;
+            }
+            if (!ring.prepareConsumerWait()) {
+                continue;
+            }
+            int ret = waitFor(region_.getFd(ShmRegion::kClientDataFd), static_cast<int>(receive_timeout_ms_.load()));
+            ring.cancelConsumerWait();
+            if (ret == 0) {
+                return FillStatus::kTimeout;
+            }
+            if (ret < 0 && ring.readableBytes() == 0) {
+                handleError("Connection closed by peer");
+                return FillStatus::kFailed;
+            }
+        }
+        return FillStatus::kFilled;
+    }
+
+    // 处理错误
+    void ShmTcpClient::handleError(const std::string& error_msg) {
+        state_ = ConnectionState::DISCONNECTED;
+        std::cerr << "TcpClient error: " << error_msg << std::endl;
+    }
+
+}
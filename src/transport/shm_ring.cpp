@@ -0,0 +1,370 @@
+#include "shm_ring.h"
+#include "socket_address.h"
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace rpc {
+
+    namespace {
+        // 区域大小封死后不能再改：否则对端 ftruncate 缩小 memfd，服务端下次访问环就 SIGBUS
+        const int kRequiredSeals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+
+        void signalEventFd(int event_fd) {
+            uint64_t one = 1;
+            ssize_t n = ::write(event_fd, &one, sizeof(one));
+            (void)n;
+        }
+    }
+
+    // ==================== ShmRing ====================
+
+    ShmRing::ShmRing()
+        :header_(nullptr),
+         data_(nullptr),
+         capacity_(0)
+    {}
+
+    ShmRing::ShmRing(ShmRingHeader* header, uint8_t* data, size_t capacity)
+        :header_(header),
+         data_(data),
+         capacity_(capacity)
+    {}
+
+    // 生产者写入
+    size_t ShmRing::write(const uint8_t* data, size_t len) {
+        uint64_t head = header_->head.load(std::memory_order_acquire);
+        uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+        uint64_t used = tail - head;
+        if (used > capacity_) {
+            return 0;  // 对端写坏了位置，由读端发现并断开
+        }
+        size_t n = std::min(len, static_cast<size_t>(capacity_ - used));
+        if (n == 0) {
+            return 0;
+        }
+        size_t index = static_cast<size_t>(tail & (capacity_ - 1));
+        size_t first = std::min(n, capacity_ - index);
+        std::memcpy(data_ + index, data, first);
+        std::memcpy(data_, data + first, n - first);
+        header_->tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // 消费者读出
+    ssize_t ShmRing::readInto(Buffer& buffer) {
+        uint64_t tail = header_->tail.load(std::memory_order_acquire);
+        uint64_t head = header_->head.load(std::memory_order_relaxed);
+        uint64_t available = tail - head;
+        if (available > capacity_) {
+            return -1;
+        }
+        if (available == 0) {
+            return 0;
+        }
+        size_t n = static_cast<size_t>(available);
+        size_t index = static_cast<size_t>(head & (capacity_ - 1));
+        size_t first = std::min(n, capacity_ - index);
+        buffer.append(data_ + index, first);
+        buffer.append(data_, n - first);
+        header_->head.store(head + n, std::memory_order_release);
+        return static_cast<ssize_t>(n);
+    }
+
+    size_t ShmRing::readableBytes() const {
+        uint64_t available = header_->tail.load(std::memory_order_acquire) - header_->head.load(std::memory_order_relaxed);
+        return available > capacity_ ? 0 : static_cast<size_t>(available);
+    }
+
+    size_t ShmRing::writableBytes() const {
+        uint64_t used = header_->tail.load(std::memory_order_relaxed) - header_->head.load(std::memory_order_acquire);
+        return used > capacity_ ? 0 : static_cast<size_t>(capacity_ - used);
+    }
+
+    // 发布数据后：消费者已置等待标志才写 eventfd（与 prepareConsumerWait 的 store + fence 配对）
+    void ShmRing::notifyConsumer(int event_fd) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (header_->consumer_waiting.load(std::memory_order_relaxed)) {
+            signalEventFd(event_fd);
+        }
+    }
+
+    void ShmRing::notifyProducer(int event_fd) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (header_->producer_waiting.load(std::memory_order_relaxed)) {
+            signalEventFd(event_fd);
+        }
+    }
+
+    bool ShmRing::prepareConsumerWait() {
+        header_->consumer_waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (readableBytes() > 0) {
+            header_->consumer_waiting.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    bool ShmRing::prepareProducerWait() {
+        header_->producer_waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (writableBytes() > 0) {
+            header_->producer_waiting.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    void ShmRing::cancelConsumerWait() {
+        header_->consumer_waiting.store(0, std::memory_order_relaxed);
+    }
+
+    void ShmRing::cancelProducerWait() {
+        header_->producer_waiting.store(0, std::memory_order_relaxed);
+    }
+
+    size_t ShmRing::getCapacity() const {
+        return capacity_;
+    }
+
+    // ==================== AdaptiveSpinner ====================
+
+    AdaptiveSpinner::AdaptiveSpinner()
+        :limit_(kMinSpins * 16)
+    {}
+
+    uint32_t AdaptiveSpinner::getLimit() const {
+        return limit_;
+    }
+
+    void AdaptiveSpinner::cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield" ::: "memory");
+#else
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+
+    // ==================== ShmRegion ====================
+
+    ShmRegion::ShmRegion()
+        :base_(nullptr),
+         size_(0)
+    {
+        std::fill(fds_, fds_ + kFdCount, -1);
+    }
+
+    ShmRegion::~ShmRegion() {
+        release();
+    }
+
+    bool ShmRegion::isShmAddress(const std::string& host) {
+        return host.compare(0, strlen(kShmScheme), kShmScheme) == 0;
+    }
+
+    std::string ShmRegion::toControlAddress(const std::string& host) {
+        return std::string(SocketAddress::kUnixScheme) + host.substr(strlen(kShmScheme));
+    }
+
+    // 数据区从第二页开始，区域头和两个环头放在第一页
+    size_t ShmRegion::dataOffset() {
+        static_assert(sizeof(RegionHeader) <= 64 && 64 + 2 * sizeof(ShmRingHeader) <= 4096, "shm header page overflow");
+        return 4096;
+    }
+
+    size_t ShmRegion::regionSize(size_t ring_capacity) {
+        return dataOffset() + 2 * ring_capacity;
+    }
+
+    // 客户端创建
+    bool ShmRegion::create(size_t ring_capacity) {
+        if (ring_capacity < 4096 || (ring_capacity & (ring_capacity - 1)) != 0) {
+            std::cerr << "shm ring capacity must be a power of 2 (>= 4096)" << std::endl;
+            return false;
+        }
+        fds_[kMemFd] = memfd_create("myrpc-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fds_[kMemFd] == -1) {
+            std::cerr << "memfd_create failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        if (ftruncate(fds_[kMemFd], static_cast<off_t>(regionSize(ring_capacity))) == -1) {
+            std::cerr << "ftruncate shm region failed: " << strerror(errno) << std::endl;
+            release();
+            return false;
+        }
+        if (fcntl(fds_[kMemFd], F_ADD_SEALS, kRequiredSeals) == -1) {
+            std::cerr << "Failed to seal shm region: " << strerror(errno) << std::endl;
+            release();
+            return false;
+        }
+        for (int i = kClientDataFd; i < kFdCount; ++i) {
+            fds_[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (fds_[i] == -1) {
+                std::cerr << "Failed to create eventfd: " << strerror(errno) << std::endl;
+                release();
+                return false;
+            }
+        }
+        if (!map(ring_capacity, true)) {
+            release();
+            return false;
+        }
+        return true;
+    }
+
+    // 服务端接管
+    bool ShmRegion::attach(const int fds[kFdCount]) {
+        std::copy(fds, fds + kFdCount, fds_);
+
+        // 只接受大小已封死的 memfd：映射之后对端不能再缩小它
+        int seals = fcntl(fds_[kMemFd], F_GET_SEALS);
+        if (seals == -1 || (seals & kRequiredSeals) != kRequiredSeals) {
+            std::cerr << "shm region is not sealed against resizing" << std::endl;
+            release();
+            return false;
+        }
+        struct stat st;
+        if (fstat(fds_[kMemFd], &st) == -1 || static_cast<size_t>(st.st_size) < dataOffset()) {
+            std::cerr << "Invalid shm region" << std::endl;
+            release();
+            return false;
+        }
+        size_t ring_capacity = (static_cast<size_t>(st.st_size) - dataOffset()) / 2;
+        if (ring_capacity < 4096 || (ring_capacity & (ring_capacity - 1)) != 0 ||
+            regionSize(ring_capacity) != static_cast<size_t>(st.st_size)) {
+            std::cerr << "Invalid shm region size: " << st.st_size << std::endl;
+            release();
+            return false;
+        }
+        if (!map(ring_capacity, false)) {
+            release();
+            return false;
+        }
+        const RegionHeader* header = static_cast<const RegionHeader*>(base_);
+        if (header->magic != kMagic || header->version != kVersion || header->ring_capacity != ring_capacity) {
+            std::cerr << "shm region header mismatch" << std::endl;
+            release();
+            return false;
+        }
+        return true;
+    }
+
+    bool ShmRegion::map(size_t ring_capacity, bool initialize) {
+        size_ = regionSize(ring_capacity);
+        void* base = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fds_[kMemFd], 0);
+        if (base == MAP_FAILED) {
+            std::cerr << "mmap shm region failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        base_ = base;
+
+        uint8_t* bytes = static_cast<uint8_t*>(base_);
+        ShmRingHeader* c2s_header = reinterpret_cast<ShmRingHeader*>(bytes + 64);
+        ShmRingHeader* s2c_header = c2s_header + 1;
+        if (initialize) {
+            RegionHeader* header = static_cast<RegionHeader*>(base_);
+            header->magic = kMagic;
+            header->version = kVersion;
+            header->ring_capacity = ring_capacity;
+            // memfd 初始全零，环位置与等待标志从 0 开始
+        }
+        c2s_ = ShmRing(c2s_header, bytes + dataOffset(), ring_capacity);
+        s2c_ = ShmRing(s2c_header, bytes + dataOffset() + ring_capacity, ring_capacity);
+        return true;
+    }
+
+    void ShmRegion::release() {
+        if (base_) {
+            munmap(base_, size_);
+            base_ = nullptr;
+        }
+        for (int& fd : fds_) {
+            if (fd != -1) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+    }
+
+    ShmRing& ShmRegion::getClientToServer() {
+        return c2s_;
+    }
+
+    ShmRing& ShmRegion::getServerToClient() {
+        return s2c_;
+    }
+
+    int ShmRegion::getFd(FdIndex index) const {
+        return fds_[index];
+    }
+
+    // 发送全部 fd
+    bool ShmRegion::sendFds(int sockfd) const {
+        char payload = 'M';
+        struct iovec iov = {&payload, 1};
+        alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * kFdCount)];
+        std::memset(control, 0, sizeof(control));
+
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * kFdCount);
+        std::memcpy(CMSG_DATA(cmsg), fds_, sizeof(int) * kFdCount);
+
+        if (sendmsg(sockfd, &msg, MSG_NOSIGNAL) != 1) {
+            std::cerr << "Failed to send shm fds: " << strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // 接收全部 fd
+    bool ShmRegion::receiveFds(int sockfd, int fds[kFdCount]) {
+        char payload = 0;
+        struct iovec iov = {&payload, 1};
+        alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * kFdCount)];
+        std::memset(control, 0, sizeof(control));
+
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(sockfd, &msg, MSG_CMSG_CLOEXEC) != 1) {
+            return false;
+        }
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        if (cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            return false;
+        }
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        int received[kFdCount];
+        std::memcpy(received, CMSG_DATA(cmsg), sizeof(int) * std::min<size_t>(count, kFdCount));
+        if (count != kFdCount || (msg.msg_flags & MSG_CTRUNC)) {
+            for (size_t i = 0; i < std::min<size_t>(count, kFdCount); ++i) {
+                ::close(received[i]);
+            }
+            return false;
+        }
+        std::copy(received, received + kFdCount, fds);
+        return true;
+    }
+
+}
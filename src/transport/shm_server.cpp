@@ -0,0 +1,790 @@
+#include "shm_server.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+#include <iostream>
+
+namespace rpc {
+
+    namespace {
+        // 清空 eventfd 计数
+        void drainEventFd(int event_fd) {
+            uint64_t value = 0;
+            ssize_t n = ::read(event_fd, &value, sizeof(value));
+            (void)n;
+        }
+    }
+
+    // ==================== ShmConnection ====================
+
+    ShmConnection::ShmConnection(int control_fd, std::unique_ptr<ShmRegion> region, const std::string& peer_addr, ShmLoop* loop)
+        :control_fd_(control_fd),
+         region_(std::move(region)),
+         peer_addr_(peer_addr),
+         state_(ConnectionState::CONNECTED),
+         loop_(loop),
+         reading_(true),
+         above_high_water_(false),
+         high_water_mark_(kDefaultHighWaterMark),
+         low_water_mark_(0),
+         handle_(0),
+         closing_(false),
+         last_active_ms_(0),
+         idle_timer_id_(0)
+    {}
+
+    ShmConnection::~ShmConnection() {
+        if (control_fd_ != -1) {
+            ::close(control_fd_);
+            control_fd_ = -1;
+        }
+    }
+
+    // 发送数据：多个业务线程通过 output_mutex_ 串行成 s2c 环的唯一生产者
+    bool ShmConnection::send(const std::vector<uint8_t>& data) {
+        if (data.empty()) {
+            return state_ == ConnectionState::CONNECTED;
+        }
+        bool write_complete = false;
+        bool high_water = false;
+        size_t pending = 0;
+        {
+            std::lock_guard<std::mutex> lock(output_mutex_);
+            if (state_ != ConnectionState::CONNECTED) {
+                return false;
+            }
+            const uint8_t* remaining = data.data();
+            size_t length = data.size();
+            if (output_buffer_.readableBytes() == 0) {
+                ShmRing& ring = region_->getServerToClient();
+                size_t written = ring.write(remaining, length);
+                if (written > 0) {
+                    ring.notifyConsumer(region_->getFd(ShmRegion::kClientDataFd));
+                }
+                remaining += written;
+                length -= written;
+            }
+            if (length > 0) {
+                if (output_buffer_.readableBytes() + length > Buffer::kMaxBufferSize) {
+                    std::cerr << "Output buffer overflow for " << peer_addr_ << std::endl;
+                    return false;
+                }
+                output_buffer_.append(remaining, length);
+                flushOutputLocked();
+            }
+            pending = output_buffer_.readableBytes();
+            if (pending == 0) {
+                write_complete = true;
+            } else if (!above_high_water_ && pending >= high_water_mark_) {
+                above_high_water_ = true;
+                high_water = true;
+            }
+        }
+        if (write_complete && write_complete_callback_) {
+            write_complete_callback_(shared_from_this());
+        }
+        if (high_water && high_water_mark_callback_) {
+            high_water_mark_callback_(shared_from_this(), pending);
+        }
+        return true;
+    }
+
+    // 输出缓冲区写入 s2c 环：写不下时置生产者等待标志，客户端读走数据后写 kServerSpaceFd 唤醒循环续写
+    void ShmConnection::flushOutputLocked() {
+        ShmRing& ring = region_->getServerToClient();
+        while (output_buffer_.readableBytes() > 0) {
+            size_t written = ring.write(output_buffer_.peek(), output_buffer_.readableBytes());
+            if (written > 0) {
+                output_buffer_.retrieve(written);
+                ring.notifyConsumer(region_->getFd(ShmRegion::kClientDataFd));
+                continue;
+            }
+            if (ring.prepareProducerWait()) {
+                break;
+            }
+        }
+    }
+
+    // 关闭连接
+    void ShmConnection::close() {
+        if (state_ != ConnectionState::CONNECTED) {
+            return;
+        }
+        loop_->closeConnection(std::static_pointer_cast<ShmConnection>(shared_from_this()));
+    }
+
+    ConnectionState ShmConnection::getState() const {
+        return state_;
+    }
+
+    std::string ShmConnection::getRemoteAddress() const {
+        return peer_addr_;
+    }
+
+    void ShmConnection::setMessageCallback(MessageCallback callback) {
+        message_callback_ = std::move(callback);
+    }
+    void ShmConnection::setConnectionCallback(ConnectionCallback callback) {
+        connection_callback_ = std::move(callback);
+    }
+    void ShmConnection::setWriteCompleteCallback(WriteCompleteCallback callback) {
+        write_complete_callback_ = std::move(callback);
+    }
+    void ShmConnection::setErrorCallback(ErrorCallback callback) {
+        error_callback_ = std::move(callback);
+    }
+    void ShmConnection::setHighWaterMarkCallback(HighWaterMarkCallback callback, size_t high_water_mark) {
+        high_water_mark_callback_ = std::move(callback);
+        high_water_mark_ = high_water_mark;
+    }
+    void ShmConnection::setLowWaterMarkCallback(LowWaterMarkCallback callback, size_t low_water_mark) {
+        low_water_mark_callback_ = std::move(callback);
+        low_water_mark_ = low_water_mark;
+    }
+
+    // 恢复读取
+    void ShmConnection::startReading() {
+        reading_ = true;
+        auto self = std::static_pointer_cast<ShmConnection>(shared_from_this());
+        loop_->runInLoop([self]() {
+            self->loop_->updateReading(self.get());
+        });
+    }
+
+    // 暂停读取：循环不再消费 c2s 环，也不再为它置等待标志，环满后客户端自然阻塞
+    void ShmConnection::stopReading() {
+        reading_ = false;
+    }
+
+    // 注册定时器
+    uint64_t ShmConnection::runAfter(uint64_t delay_ms, std::function<void()> callback) {
+        return loop_->runAfter(delay_ms, std::move(callback));
+    }
+
+    // 取消定时器
+    bool ShmConnection::cancelTimer(uint64_t timer_id) {
+        return loop_->cancelTimer(timer_id);
+    }
+
+    // 投递任务到所属循环
+    void ShmConnection::queueInLoop(std::function<void()> task) {
+        loop_->queueInLoop(std::move(task));
+    }
+
+    MessageCallback& ShmConnection::getMessageCallback() {
+        return message_callback_;
+    }
+    ConnectionCallback& ShmConnection::getConnectionCallback() {
+        return connection_callback_;
+    }
+    WriteCompleteCallback& ShmConnection::getWriteCompleteCallback() {
+        return write_complete_callback_;
+    }
+    ErrorCallback& ShmConnection::getErrorCallback() {
+        return error_callback_;
+    }
+
+    size_t ShmConnection::getPendingOutputBytes() const {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        return output_buffer_.readableBytes();
+    }
+
+    // ==================== ShmLoop ====================
+
+    ShmLoop::ShmLoop(size_t index)
+        :index_(index),
+         epoll_fd_(-1),
+         wakeup_fd_(-1),
+         running_(false),
+         connection_count_(0),
+         functors_pending_(false),
+         idle_timeout_ms_(0)
+    {}
+
+    ShmLoop::~ShmLoop() {
+        stop();
+    }
+
+    void ShmLoop::setIdleTimeout(uint64_t idle_timeout_ms) {
+        idle_timeout_ms_ = idle_timeout_ms;
+    }
+
+    void ShmLoop::setConnectionCallback(ConnectionCallback callback) {
+        connection_callback_ = std::move(callback);
+    }
+
+    // 启动循环线程
+    bool ShmLoop::start() {
+        if (running_) {
+            return true;
+        }
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ == -1) {
+            std::cerr << "Failed to create epoll for shm loop " << index_ << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeup_fd_ == -1) {
+            std::cerr << "Failed to create eventfd for shm loop " << index_ << ": " << strerror(errno) << std::endl;
+            ::close(epoll_fd_);
+            epoll_fd_ = -1;
+            return false;
+        }
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = makeEventData(kSourceWakeup, 0);
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &event);
+
+        running_ = true;
+        thread_ = std::thread(&ShmLoop::loopMain, this);
+        return true;
+    }
+
+    // 停止循环线程，关闭所有连接
+    void ShmLoop::stop() {
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        wakeup();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+
+        // 循环线程已退出，由当前线程收尾
+        thread_id_ = std::this_thread::get_id();
+        doPendingFunctors();
+        closeAllConnections();
+        thread_id_ = std::thread::id();
+
+        ::close(wakeup_fd_);
+        wakeup_fd_ = -1;
+        ::close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+
+    void ShmLoop::runInLoop(Functor task) {
+        if (isInLoopThread()) {
+            task();
+        } else {
+            queueInLoop(std::move(task));
+        }
+    }
+
+    void ShmLoop::queueInLoop(Functor task) {
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            pending_functors_.push_back(std::move(task));
+        }
+        functors_pending_ = true;
+        wakeup();
+    }
+
+    bool ShmLoop::isInLoopThread() const {
+        return thread_id_.load() == std::this_thread::get_id();
+    }
+
+    // 接管连接
+    void ShmLoop::addConnection(int control_fd, std::unique_ptr<ShmRegion> region, const std::string& peer_addr) {
+        auto connection = std::make_shared<ShmConnection>(control_fd, std::move(region), peer_addr, this);
+        runInLoop([this, connection]() {
+            registerConnection(connection);
+        });
+    }
+
+    void ShmLoop::closeConnection(std::shared_ptr<ShmConnection> connection) {
+        runInLoop([this, connection]() {
+            removeConnection(connection.get());
+        });
+    }
+
+    void ShmLoop::updateReading(ShmConnection* connection) {
+        if (!connection->closing_ && connection->reading_) {
+            handleRead(connection);
+        }
+    }
+
+    TimerWheel::TimerId ShmLoop::runAfter(uint64_t delay_ms, Functor callback) {
+        return timer_wheel_.addTimer(delay_ms, std::move(callback));
+    }
+
+    bool ShmLoop::cancelTimer(TimerWheel::TimerId timer_id) {
+        return timer_wheel_.cancelTimer(timer_id);
+    }
+
+    size_t ShmLoop::getConnectionCount() const {
+        return connection_count_.load();
+    }
+
+    size_t ShmLoop::getIndex() const {
+        return index_;
+    }
+
+    // 循环线程主函数
+    void ShmLoop::loopMain() {
+        thread_id_ = std::this_thread::get_id();
+        struct epoll_event events[kMaxEvents];
+
+        while (running_) {
+            int timeout = static_cast<int>(timer_wheel_.nextTimeoutMs());
+            // 先自旋等一小段，对端持续发送时不进入 epoll_wait
+            bool ready = !connections_.empty() && spinner_.spin([this]() {
+                return functors_pending_.load(std::memory_order_relaxed) || anyReadable();
+            });
+            if (ready || !prepareSleep()) {
+                timeout = 0;
+            }
+            int nfds = epoll_wait(epoll_fd_, events, kMaxEvents, timeout);
+            cancelSleep();
+            if (nfds == -1 && errno != EINTR) {
+                std::cerr << "epoll_wait failed in shm loop " << index_ << ": " << strerror(errno) << std::endl;
+                break;
+            }
+            for (int i = 0; i < nfds; ++i) {
+                handleEvent(events[i].data.u64, events[i].events);
+            }
+
+            // 自旋期间到达的数据没有 eventfd 事件，逐个检查
+            std::vector<std::shared_ptr<ShmConnection>> readable;
+            connections_.forEach([&readable](uint64_t, std::shared_ptr<ShmConnection>& connection) {
+                if (connection->reading_ && connection->region_->getClientToServer().readableBytes() > 0) {
+                    readable.push_back(connection);
+                }
+            });
+            for (auto& connection : readable) {
+                if (!connection->closing_) {
+                    handleRead(connection.get());
+                }
+            }
+
+            timer_wheel_.advance();
+            doPendingFunctors();
+        }
+
+        thread_id_ = std::thread::id();
+    }
+
+    void ShmLoop::wakeup() {
+        uint64_t one = 1;
+        ssize_t n = ::write(wakeup_fd_, &one, sizeof(one));
+        (void)n;
+    }
+
+    bool ShmLoop::anyReadable() {
+        bool readable = false;
+        connections_.forEach([&readable](uint64_t, std::shared_ptr<ShmConnection>& connection) {
+            if (!readable && connection->reading_ && connection->region_->getClientToServer().readableBytes() > 0) {
+                readable = true;
+            }
+        });
+        return readable;
+    }
+
+    bool ShmLoop::prepareSleep() {
+        bool can_sleep = true;
+        connections_.forEach([&can_sleep](uint64_t, std::shared_ptr<ShmConnection>& connection) {
+            if (can_sleep && connection->reading_ && !connection->region_->getClientToServer().prepareConsumerWait()) {
+                can_sleep = false;
+            }
+        });
+        return can_sleep;
+    }
+
+    void ShmLoop::cancelSleep() {
+        connections_.forEach([](uint64_t, std::shared_ptr<ShmConnection>& connection) {
+            connection->region_->getClientToServer().cancelConsumerWait();
+        });
+    }
+
+    // 分发 epoll 事件
+    void ShmLoop::handleEvent(uint64_t data, uint32_t events) {
+        Source source = static_cast<Source>(data >> kSourceShift);
+        if (source == kSourceWakeup) {
+            drainEventFd(wakeup_fd_);
+            return;
+        }
+        std::shared_ptr<ShmConnection>* entry = connections_.getMasked(data & kHandleMask, kGenerationMask);
+        if (entry == nullptr) {
+            return;  // 连接已释放
+        }
+        std::shared_ptr<ShmConnection> connection = *entry;
+        if (connection->closing_) {
+            return;
+        }
+        switch (source) {
+            case kSourceControl:
+                // 握手之后客户端不再在控制套接字上发送任何数据，可读即对端关闭
+                (void)events;
+                removeConnection(connection.get());
+                break;
+            case kSourceData:
+                drainEventFd(connection->region_->getFd(ShmRegion::kServerDataFd));
+                break;  // 数据在本轮统一读取
+            case kSourceSpace:
+                drainEventFd(connection->region_->getFd(ShmRegion::kServerSpaceFd));
+                handleSpace(connection.get());
+                break;
+            default:
+                break;
+        }
+    }
+
+    // 读出 c2s 环中的全部数据并分帧
+    void ShmLoop::handleRead(ShmConnection* connection) {
+        ShmRing& ring = connection->region_->getClientToServer();
+        ssize_t n = ring.readInto(connection->input_buffer_);
+        if (n < 0) {
+            std::cerr << "Corrupted shm ring from " << connection->peer_addr_ << std::endl;
+            removeConnection(connection);
+            return;
+        }
+        if (n == 0) {
+            return;
+        }
+        ring.notifyProducer(connection->region_->getFd(ShmRegion::kClientSpaceFd));
+        if (idle_timeout_ms_ > 0) {
+            connection->last_active_ms_ = TimerWheel::nowMs();
+        }
+        // 解码完整的帧：4 字节长度 + 消息体
+        Buffer& input = connection->input_buffer_;
+        std::vector<uint8_t> frame;
+        while (!connection->closing_) {
+            FrameStatus status = frame_codec_.decode(input, frame);
+            if (status == FrameStatus::kInvalid) {
+                input.retrieveAll();
+                removeConnection(connection);
+                return;
+            }
+            if (status == FrameStatus::kIncomplete) {
+                break;  // 半包
+            }
+            if (connection->message_callback_) {
+                connection->message_callback_(connection->shared_from_this(), frame);
+            }
+        }
+    }
+
+    // s2c 环有空间：续写输出缓冲区
+    void ShmLoop::handleSpace(ShmConnection* connection) {
+        bool write_complete = false;
+        bool low_water = false;
+        {
+            std::lock_guard<std::mutex> lock(connection->output_mutex_);
+            if (connection->state_ != ConnectionState::CONNECTED) {
+                return;
+            }
+            connection->region_->getServerToClient().cancelProducerWait();
+            if (connection->output_buffer_.readableBytes() == 0) {
+                return;
+            }
+            connection->flushOutputLocked();
+            size_t pending = connection->output_buffer_.readableBytes();
+            write_complete = pending == 0;
+            if (connection->above_high_water_ && pending <= connection->low_water_mark_) {
+                connection->above_high_water_ = false;
+                low_water = true;
+            }
+        }
+        if (write_complete && connection->write_complete_callback_) {
+            connection->write_complete_callback_(connection->shared_from_this());
+        }
+        if (low_water && connection->low_water_mark_callback_) {
+            connection->low_water_mark_callback_(connection->shared_from_this());
+        }
+    }
+
+    // 注册新连接：控制套接字、c2s 数据 eventfd、s2c 空间 eventfd 三个 fd 加入 epoll
+    void ShmLoop::registerConnection(std::shared_ptr<ShmConnection> connection) {
+        connection->handle_ = connections_.insert(connection);
+        connection_count_++;
+
+        struct { int fd; Source source; } watches[] = {
+            {connection->control_fd_, kSourceControl},
+            {connection->region_->getFd(ShmRegion::kServerDataFd), kSourceData},
+            {connection->region_->getFd(ShmRegion::kServerSpaceFd), kSourceSpace},
+        };
+        for (const auto& watch : watches) {
+            struct epoll_event event;
+            event.events = EPOLLIN;
+            if (watch.source == kSourceControl) {
+                event.events |= EPOLLRDHUP;
+            }
+            event.data.u64 = makeEventData(watch.source, connection->handle_);
+            if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, watch.fd, &event) == -1) {
+                std::cerr << "Failed to add shm connection to epoll: " << strerror(errno) << std::endl;
+                removeConnection(connection.get());
+                return;
+            }
+        }
+
+        // 先调用连接回调（设置消息回调等），再开始读
+        if (connection_callback_) {
+            connection_callback_(connection);
+        }
+        if (idle_timeout_ms_ > 0) {
+            connection->last_active_ms_ = TimerWheel::nowMs();
+            startIdleTimer(connection->handle_, idle_timeout_ms_);
+        }
+        std::cout << "New shm connection from " << connection->peer_addr_ << " -> shm loop " << index_ << std::endl;
+        if (connection->reading_ && !connection->closing_) {
+            handleRead(connection.get());
+        }
+    }
+
+    // 释放连接：持输出锁解除映射，此后其他线程的 send 看到 DISCONNECTED 直接返回
+    void ShmLoop::removeConnection(ShmConnection* connection) {
+        if (connection->closing_) {
+            return;
+        }
+        connection->closing_ = true;
+        if (connection->idle_timer_id_ != TimerWheel::kInvalidTimerId) {
+            timer_wheel_.cancelTimer(connection->idle_timer_id_);
+            connection->idle_timer_id_ = TimerWheel::kInvalidTimerId;
+        }
+        std::shared_ptr<ShmConnection> guard;
+        if (connections_.remove(connection->handle_, &guard)) {
+            connection_count_--;
+        }
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connection->control_fd_, nullptr);
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connection->region_->getFd(ShmRegion::kServerDataFd), nullptr);
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connection->region_->getFd(ShmRegion::kServerSpaceFd), nullptr);
+        {
+            std::lock_guard<std::mutex> lock(connection->output_mutex_);
+            connection->state_ = ConnectionState::DISCONNECTED;
+            connection->output_buffer_.retrieveAll();
+            connection->region_->release();
+        }
+        ::close(connection->control_fd_);
+        connection->control_fd_ = -1;
+        connection->input_buffer_.retrieveAll();
+        std::cout << "Connection closed: " << connection->peer_addr_ << std::endl;
+        if (connection->connection_callback_) {
+            connection->connection_callback_(connection->shared_from_this());
+        }
+    }
+
+    // 执行待处理任务
+    void ShmLoop::doPendingFunctors() {
+        std::vector<Functor> functors;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            functors.swap(pending_functors_);
+            functors_pending_ = false;
+        }
+        for (auto& functor : functors) {
+            functor();
+        }
+    }
+
+    // 空闲检测（与 EventLoop 相同：到期时检查最近活跃时间）
+    void ShmLoop::startIdleTimer(uint64_t handle, uint64_t delay_ms) {
+        std::shared_ptr<ShmConnection>* entry = connections_.get(handle);
+        if (entry == nullptr) {
+            return;
+        }
+        (*entry)->idle_timer_id_ = runAfter(delay_ms, [this, handle]() {
+            handleIdleTimeout(handle);
+        });
+    }
+
+    void ShmLoop::handleIdleTimeout(uint64_t handle) {
+        std::shared_ptr<ShmConnection>* entry = connections_.get(handle);
+        if (entry == nullptr) {
+            return;
+        }
+        std::shared_ptr<ShmConnection> connection = *entry;
+        connection->idle_timer_id_ = TimerWheel::kInvalidTimerId;
+        uint64_t idle_ms = TimerWheel::nowMs() - connection->last_active_ms_;
+        if (idle_ms >= idle_timeout_ms_) {
+            std::cout << "Idle connection timeout: " << connection->peer_addr_ << " (" << idle_ms << "ms)" << std::endl;
+            removeConnection(connection.get());
+        } else {
+            startIdleTimer(handle, idle_timeout_ms_ - idle_ms);
+        }
+    }
+
+    void ShmLoop::closeAllConnections() {
+        std::vector<std::shared_ptr<ShmConnection>> connections;
+        connections_.forEach([&connections](uint64_t, std::shared_ptr<ShmConnection>& connection) {
+            connections.push_back(connection);
+        });
+        for (auto& connection : connections) {
+            removeConnection(connection.get());
+        }
+        connection_count_ = 0;
+    }
+
+    uint64_t ShmLoop::makeEventData(Source source, uint64_t handle) {
+        return (static_cast<uint64_t>(source) << kSourceShift) | (handle & kHandleMask);
+    }
+
+    // ==================== ShmTcpServer ====================
+
+    ShmTcpServer::ShmTcpServer(const TcpServerConfig& config)
+        :config_(config),
+         listen_fd_(-1),
+         running_(false),
+         next_loop_(0)
+    {}
+
+    ShmTcpServer::~ShmTcpServer() {
+        stop();
+    }
+
+    // 启动：监听握手用的 Unix 域套接字，另起 accept 线程完成握手
+    bool ShmTcpServer::start(uint16_t port, const std::string& host) {
+        (void)port;
+        if (running_) {
+            return true;
+        }
+        if (!ShmRegion::isShmAddress(host)) {
+            std::cerr << "Shared memory server needs a shm: address, got " << host << std::endl;
+            return false;
+        }
+        if (!listen_addr_.parse(ShmRegion::toControlAddress(host), 0)) {
+            return false;
+        }
+
+        listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd_ == -1) {
+            std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+            return false;
+        }
+        if (listen_addr_.getPath()[0] != '@') {
+            ::unlink(listen_addr_.getPath().c_str());
+        }
+        if (bind(listen_fd_, listen_addr_.getSockAddr(), listen_addr_.getLength()) == -1 ||
+            listen(listen_fd_, config_.listen_backlog) == -1) {
+            std::cerr << "Failed to listen on " << host << ": " << strerror(errno) << std::endl;
+            closeListenSocket();
+            return false;
+        }
+
+        size_t loop_count = config_.io_thread_count > 0 ? config_.io_thread_count : 1;
+        for (size_t i = 0; i < loop_count; ++i) {
+            auto loop = std::make_unique<ShmLoop>(i);
+            loop->setIdleTimeout(config_.idle_timeout_ms);
+            loop->setConnectionCallback([this](std::shared_ptr<TcpConnection> connection) {
+                if (connection_callback_) {
+                    connection_callback_(connection);
+                }
+            });
+            if (!loop->start()) {
+                loops_.clear();
+                closeListenSocket();
+                return false;
+            }
+            loops_.push_back(std::move(loop));
+        }
+
+        running_ = true;
+        acceptor_thread_ = std::thread(&ShmTcpServer::acceptorMain, this);
+        std::cout << "Shared memory server started on " << host << " with " << loops_.size() << " I/O loops" << std::endl;
+        return true;
+    }
+
+    void ShmTcpServer::stop() {
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        if (acceptor_thread_.joinable()) {
+            acceptor_thread_.join();
+        }
+        for (auto& loop : loops_) {
+            loop->stop();
+        }
+        loops_.clear();
+        closeListenSocket();
+        std::cout << "Shared memory server stopped" << std::endl;
+    }
+
+    void ShmTcpServer::setConnectionCallback(ConnectionCallback callback) {
+        connection_callback_ = std::move(callback);
+    }
+
+    bool ShmTcpServer::isRunning() const {
+        return running_;
+    }
+
+    size_t ShmTcpServer::getConnectionCount() const {
+        size_t count = 0;
+        for (const auto& loop : loops_) {
+            count += loop->getConnectionCount();
+        }
+        return count;
+    }
+
+    // accept 线程：握手带超时，不会卡住 I/O 循环
+    void ShmTcpServer::acceptorMain() {
+        struct pollfd pfd;
+        pfd.fd = listen_fd_;
+        pfd.events = POLLIN;
+        while (running_) {
+            int ret = poll(&pfd, 1, 100);
+            if (ret <= 0) {
+                continue;
+            }
+            while (running_) {
+                int control_fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+                if (control_fd == -1) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED) {
+                        std::cerr << "Failed to accept shm connection: " << strerror(errno) << std::endl;
+                    }
+                    break;
+                }
+                if (getConnectionCount() >= config_.max_connections) {
+                    std::cerr << "Connection limit exceeded" << std::endl;
+                    ::close(control_fd);
+                    continue;
+                }
+                handshake(control_fd);
+            }
+        }
+    }
+
+    // 握手：客户端发来 memfd 与 4 个 eventfd，服务端映射校验后回复 1 字节确认
+    void ShmTcpServer::handshake(int control_fd) {
+        struct timeval timeout;
+        timeout.tv_sec = kHandshakeTimeoutMs / 1000;
+        timeout.tv_usec = (kHandshakeTimeoutMs % 1000) * 1000;
+        setsockopt(control_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(control_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        int fds[ShmRegion::kFdCount];
+        auto region = std::make_unique<ShmRegion>();
+        if (!ShmRegion::receiveFds(control_fd, fds)) {
+            std::cerr << "Shared memory handshake failed: no fds received" << std::endl;
+            ::close(control_fd);
+            return;
+        }
+        if (!region->attach(fds)) {
+            ::close(control_fd);
+            return;
+        }
+        char ack = 'K';
+        if (::send(control_fd, &ack, 1, MSG_NOSIGNAL) != 1) {
+            std::cerr << "Shared memory handshake failed: " << strerror(errno) << std::endl;
+            ::close(control_fd);
+            return;
+        }
+        std::string peer_addr = std::string(ShmRegion::kShmScheme) + listen_addr_.getPath();
+        ShmLoop* loop = loops_[next_loop_++ % loops_.size()].get();
+        loop->addConnection(control_fd, std::move(region), peer_addr);
+    }
+
+    void ShmTcpServer::closeListenSocket() {
+        if (listen_fd_ != -1) {
+            ::close(listen_fd_);
+            listen_fd_ = -1;
+            if (listen_addr_.getPath()[0] != '@') {
+                ::unlink(listen_addr_.getPath().c_str());
+            }
+        }
+    }
+
+}
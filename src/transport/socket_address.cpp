@@ -0,0 +1,138 @@
+#include "socket_address.h"
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+namespace rpc {
+
+    namespace {
+        // sockaddr_un -> "unix:/path" / "unix:@name"，未绑定返回空
+        std::string unixName(const struct sockaddr_un& addr, socklen_t length) {
+            size_t path_length = length > offsetof(struct sockaddr_un, sun_path)
+                ? length - offsetof(struct sockaddr_un, sun_path) : 0;
+            if (path_length == 0) {
+                return "";
+            }
+            if (addr.sun_path[0] == '\0') {
+                return std::string(SocketAddress::kUnixScheme) + "@" + std::string(addr.sun_path + 1, path_length - 1);
+            }
+            return std::string(SocketAddress::kUnixScheme) + std::string(addr.sun_path, strnlen(addr.sun_path, path_length));
+        }
+    }
+
+    SocketAddress::SocketAddress()
+        :length_(0),
+         port_(0)
+    {
+        memset(&storage_, 0, sizeof(storage_));
+    }
+
+    // 解析地址
+    bool SocketAddress::parse(const std::string& host, uint16_t port) {
+        memset(&storage_, 0, sizeof(storage_));
+        path_.clear();
+        port_ = port;
+
+        if (isUnix(host)) {
+            path_ = host.substr(strlen(kUnixScheme));
+            struct sockaddr_un* addr = reinterpret_cast<struct sockaddr_un*>(&storage_);
+            if (path_.empty() || path_.size() >= sizeof(addr->sun_path)) {
+                std::cerr << "Invalid unix socket path: " << host << std::endl;
+                return false;
+            }
+            addr->sun_family = AF_UNIX;
+            memcpy(addr->sun_path, path_.data(), path_.size());
+            if (path_[0] == '@') {
+                addr->sun_path[0] = '\0';  // 抽象命名空间，不在文件系统中留下文件
+            }
+            length_ = static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + path_.size());
+            return true;
+        }
+
+        struct sockaddr_in* addr = reinterpret_cast<struct sockaddr_in*>(&storage_);
+        addr->sin_family = AF_INET;
+        addr->sin_port = htons(port);
+        if (inet_pton(AF_INET, host.c_str(), &addr->sin_addr) <= 0) {
+            std::cerr << "Invalid server address: " << host << std::endl;
+            return false;
+        }
+        length_ = sizeof(struct sockaddr_in);
+        return true;
+    }
+
+    bool SocketAddress::isUnix(const std::string& host) {
+        return host.compare(0, strlen(kUnixScheme), kUnixScheme) == 0;
+    }
+
+    bool SocketAddress::isUnix() const {
+        return storage_.ss_family == AF_UNIX;
+    }
+
+    int SocketAddress::getFamily() const {
+        return storage_.ss_family;
+    }
+
+    const struct sockaddr* SocketAddress::getSockAddr() const {
+        return reinterpret_cast<const struct sockaddr*>(&storage_);
+    }
+
+    socklen_t SocketAddress::getLength() const {
+        return length_;
+    }
+
+    const std::string& SocketAddress::getPath() const {
+        return path_;
+    }
+
+    std::string SocketAddress::toString() const {
+        if (isUnix()) {
+            return kUnixScheme + path_;
+        }
+        const struct sockaddr_in* addr = reinterpret_cast<const struct sockaddr_in*>(&storage_);
+        char ip[INET_ADDRSTRLEN] = {0};
+        inet_ntop(AF_INET, &addr->sin_addr, ip, sizeof(ip));
+        return std::string(ip) + ":" + std::to_string(port_);
+    }
+
+    // 已连接 socket 的对端地址
+    std::string SocketAddress::getPeerName(int sockfd) {
+        struct sockaddr_storage storage;
+        socklen_t length = sizeof(storage);
+        memset(&storage, 0, sizeof(storage));
+        if (getpeername(sockfd, reinterpret_cast<struct sockaddr*>(&storage), &length) == -1) {
+            return "";
+        }
+        if (storage.ss_family == AF_UNIX) {
+            std::string name = unixName(reinterpret_cast<const struct sockaddr_un&>(storage), length);
+            if (!name.empty()) {
+                return name;
+            }
+            // 客户端一般不 bind，用服务端这一侧的路径标识连接
+            length = sizeof(storage);
+            memset(&storage, 0, sizeof(storage));
+            if (getsockname(sockfd, reinterpret_cast<struct sockaddr*>(&storage), &length) == -1) {
+                return kUnixScheme;
+            }
+            name = unixName(reinterpret_cast<const struct sockaddr_un&>(storage), length);
+            return name.empty() ? kUnixScheme : name;
+        }
+        const struct sockaddr_in& addr = reinterpret_cast<const struct sockaddr_in&>(storage);
+        char ip[INET_ADDRSTRLEN] = {0};
+        inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+        return std::string(ip) + ":" + std::to_string(ntohs(addr.sin_port));
+    }
+
+    // 本机主机名
+    std::string SocketAddress::getLocalHostName() {
+        char name[256] = {0};
+        if (gethostname(name, sizeof(name) - 1) != 0) {
+            return "";
+        }
+        return name;
+    }
+
+}
@@ -1,23 +1,33 @@
 #include "tcp_client.h"
 #include <sys/socket.h>      // 系统socket相关头文件
 #include <netinet/in.h>      // 网络地址结构头文件
+#include <netinet/tcp.h>     // TCP_NODELAY
 #include <arpa/inet.h>       // 网络地址转换头文件
 #include <unistd.h>          // Unix标准定义头文件
 #include <fcntl.h>           // 文件控制头文件
 #include <sys/epoll.h>       // epoll相关头文件
 #include <sys/select.h>      // select相关头文件
+#include <poll.h>            // poll相关头文件
 #include <errno.h>           // 错误号定义头文件
 #include <cstring>           // 字符串操作头文件
 #include <iostream>          // 输入输出流头文件
 #include <stdexcept>         // 异常处理头文件
+#include <algorithm>
+#include <chrono>
 
 namespace rpc {
 
+    namespace {
+        const size_t kRecvChunkSize = 16 * 1024; // 一次 recv 至少预留的字节数
+    }
+
     TcpClientImpl::TcpClientImpl()
         :sockfd_(-1),
          state_(ConnectionState::DISCONNECTED),
          epoll_fd_(-1),
-         running_(false)
+         running_(false),
+         receive_timeout_ms_(kDefaultReceiveTimeoutMs),
+         send_timeout_ms_(kDefaultSendTimeoutMs)
     {}
 
     TcpClientImpl::~TcpClientImpl() {
@@ -32,8 +42,15 @@ namespace rpc {
 
         state_ = ConnectionState::CONNECTING;
 
+        // 解析地址：IPv4 或 unix:/path
+        SocketAddress address;
+        if (!address.parse(host, port)) {
+            state_ = ConnectionState::DISCONNECTED;
+            return false;
+        }
+
         // 创建socket
-        sockfd_ = socket(AF_INET, SOCK_STREAM, 0);  // 创建TCP socket
+        sockfd_ = socket(address.getFamily(), SOCK_STREAM, 0);  // 创建 TCP / Unix 域 socket
         if (sockfd_ == -1) {
             std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
             state_ = ConnectionState::DISCONNECTED; 
@@ -50,21 +67,8 @@ namespace rpc {
             return false;
         }
 
-        // 准备服务器地址
-        struct sockaddr_in server_addr;  // 服务器地址结构
-        memset(&server_addr, 0, sizeof(server_addr));
-        server_addr.sin_family = AF_INET;
-        server_addr.sin_port = htons(port);
-        if (inet_pton(AF_INET, host.c_str(), &server_addr.sin_addr) <= 0) {  // 转换IP地址失败
-            std::cerr << "Invalid server address: " << host << std::endl;
-            close(sockfd_);
-            sockfd_ = -1;
-            state_ = ConnectionState::DISCONNECTED;
-            return false;
-        }
-
         // 尝试连接
-        int result = ::connect(sockfd_, (struct sockaddr*)&server_addr, sizeof(server_addr));
+        int result = ::connect(sockfd_, address.getSockAddr(), address.getLength());
         if (result == -1) {  // 连接失败
             if (errno == EINPROGRESS) {  // 如果连接正在进行中（非阻塞socket的正常情况）
                 // 使用select等待连接完成
@@ -120,8 +124,14 @@ namespace rpc {
             }
         }
         
+        // 多个调用的请求帧会背靠背写出，关闭 Nagle，免得后面的小帧等前一帧的（延迟）ACK
+        if (!address.isUnix()) {
+            int one = 1;
+            setsockopt(sockfd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+
         state_ = ConnectionState::CONNECTED;
-        server_addr_ = host + ":" + std::to_string(port);
+        server_addr_ = address.toString();
 
         // // 创建 epoll - 异步模式
         // epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
@@ -159,7 +169,7 @@ namespace rpc {
 
     // 断开连接
     void TcpClientImpl::disconnect() {
-        if (state_ != ConnectionState::DISCONNECTED) {
+        if (state_ != ConnectionState::DISCONNECTED || sockfd_ != -1) {
             state_ = ConnectionState::DISCONNECTING;
             running_ = false;
             if (sockfd_ != -1) {
@@ -177,12 +187,25 @@ namespace rpc {
             }
             state_ = ConnectionState::DISCONNECTED;
             server_addr_.clear(); // 清空服务器地址
+            input_buffer_.retrieveAll();
+        }
+    }
+
+    // 关闭读写两个方向：阻塞在 fill 里的读线程读到 EOF 返回
+    void TcpClientImpl::shutdown() {
+        if (sockfd_ != -1) {
+            ::shutdown(sockfd_, SHUT_RDWR);
         }
     }
 
     // 发送消息
     bool TcpClientImpl::send(const std::vector<uint8_t>& data) {
-        return handleWrite(data);
+        return handleWrite(data.data(), data.size());
+    }
+
+    // 发送已编码好的帧
+    bool TcpClientImpl::send(const Buffer& frame) {
+        return handleWrite(frame.peek(), frame.readableBytes());
     }
 
     // 接收消息
@@ -191,45 +214,28 @@ namespace rpc {
             std::cerr << "Cannot receive: not connected" << std::endl;
             return false;
         }
-        std::cout << "[DEBUG] Starting to receive response..." << std::endl;
 
-        // 先读4字节的长度前缀
-        std::vector<uint8_t> length_bytes;
-        if (!readExactly(4, length_bytes)) {
-            std::cerr << "Failed to read length prefix" << std::endl;
-            return false;
-        }
-        std::cout << "[DEBUG] Read 4 bytes length prefix" << std::endl;
-
-        // 解析长度 网络序->主机序
-        uint32_t message_length_net;
-        std::memcpy(&message_length_net, length_bytes.data(), 4);
-        uint32_t message_length_host = ntohl(message_length_net);
-        std::cout << "[DEBUG] Message length: " << message_length_host << " bytes" << std::endl;
-
-        // 验证长度合理性
-        const uint32_t MAX_MESSAGE_SIZE = 10 * 1024 * 1024; // 10M
-        if (message_length_host == 0 || message_length_host > MAX_MESSAGE_SIZE) {
-            std::cerr << "Invalid message length: " << message_length_host << std::endl;
-            return false;
-        }
-
-        // 读取完整消息
-        std::cout << "[DEBUG receive()] Before readExactly, data.size() = " << data.size() 
-                  << ", data.data() = " << (void*)data.data() << std::endl;
-        bool result = readExactly(message_length_host, data);
-        std::cout << "[DEBUG receive()] IMMEDIATELY After readExactly, result = " << result 
-                  << ", data.size() = " << data.size() 
-                  << ", data.data() = " << (void*)data.data() << std::endl;
+        return frame_codec_.readFrame(input_buffer_, [this](size_t length) { return fill(length); }, data);
+    }
 
-        if (!result) {
-            std::cerr << "Failed to read message data" << std::endl;
+    // 接收消息（帧体视图）
+    bool TcpClientImpl::receive(const uint8_t*& data, size_t& length) {
+        if (state_ != ConnectionState::CONNECTED) {
+            std::cerr << "Cannot receive: not connected" << std::endl;
             return false;
         }
 
-        std::cout << "[DEBUG] Successfully received " << data.size() << " bytes" << std::endl;
+        return frame_codec_.readFrame(input_buffer_, [this](size_t bytes) { return fill(bytes); }, data, length);
+    }
+
+    // 设置接收超时
+    void TcpClientImpl::setReceiveTimeout(uint32_t timeout_ms) {
+        receive_timeout_ms_ = timeout_ms;
+    }
 
-        return true;
+    // 设置发送超时
+    void TcpClientImpl::setSendTimeout(uint32_t timeout_ms) {
+        send_timeout_ms_ = timeout_ms;
     }
 
     // 获取连接状态
@@ -286,7 +292,7 @@ namespace rpc {
                         handleRead(buffer_);
                     }
                     if (events[i].events & EPOLLOUT) {
-                        handleWrite(buffer_);
+                        handleWrite(buffer_.data(), buffer_.size());
                     }
                     if (events[i].events & (EPOLLERR | EPOLLHUP)) {
                         handleError();
@@ -319,19 +325,26 @@ namespace rpc {
     }
     
     // 处理写事件
-    bool TcpClientImpl::handleWrite(const std::vector<uint8_t>& data) {
+    bool TcpClientImpl::handleWrite(const uint8_t* data, size_t length) {
         if (state_ != ConnectionState::CONNECTED) {  // 检查连接状态
             return false;  // 连接未建立，发送失败
         }
 
         size_t total_sent = 0;  // 已发送字节数
-        size_t total_size = data.size();  // 总数据大小
+        size_t total_size = length;  // 总数据大小
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(send_timeout_ms_.load());
 
         while (total_sent < total_size) {  // 循环发送直到所有数据发送完成
-            ssize_t sent = ::send(sockfd_, data.data() + total_sent, total_size - total_sent, MSG_NOSIGNAL);  // 发送数据
+            ssize_t sent = ::send(sockfd_, data + total_sent, total_size - total_sent, MSG_NOSIGNAL);  // 发送数据
             if (sent == -1) {  // 发送失败
-                if (errno == EAGAIN || errno == EWOULDBLOCK) {  // 发送缓冲区满，稍后重试
-                    continue;  // 继续尝试发送
+                if (errno == EINTR) {  // 被信号中断，继续发送
+                    continue;
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {  // 发送缓冲区满，等它可写，最多等到发送截止时间
+                    if (!waitReady(POLLOUT, deadline)) {
+                        handleError("Send timeout");  // 帧可能只写出了一部分，连接不能再用
+                        return false;
+                    }
+                    continue;
                 } else {  // 其他错误
                     handleError("Send failed: " + std::string(strerror(errno)));  // 处理错误
                     return false;  // 发送失败
@@ -357,51 +370,67 @@ namespace rpc {
         }
     }
 
-    // 读取指定长度的数据
-    bool TcpClientImpl::readExactly(size_t length, std::vector<uint8_t>& data) {
-        data.clear();
-        data.resize(length);
-
-        size_t total_read = 0;
-        int retry_count = 0;
-        const int MAX_RETRIES = 5000;  // 5秒超时（5000 * 1ms）
-
-        while (total_read < length) {
-            size_t remaining = length - total_read;
+    // 读到输入缓冲区至少有 length 字节：socket 暂时没有数据时 poll 等它可读，最多等到接收截止时间
+    FillStatus TcpClientImpl::fill(size_t length) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(receive_timeout_ms_.load());
 
-            ssize_t n = recv(sockfd_, data.data() + total_read, remaining, 0);
+        while (input_buffer_.readableBytes() < length) {
+            // 至少把这一帧剩下的部分一次预留出来，多读到的后续帧留在缓冲区
+            size_t read_size = std::max(length - input_buffer_.readableBytes(), kRecvChunkSize);
+            int saved_errno = 0;
+            ssize_t n = input_buffer_.readFromFd(sockfd_, &saved_errno, read_size);
 
             if (n > 0) {
-                total_read += n;
-                retry_count = 0;  // 重置重试计数
+                continue;
             } else if (n == 0) {
-                std::cerr << "[DEBUG readExactly] Connection closed by peer while reading" << std::endl;
+                std::cerr << "Connection closed by peer while reading" << std::endl;
                 state_ = ConnectionState::DISCONNECTED;
-                data.clear();
-                return false;
+                input_buffer_.retrieveAll();
+                return FillStatus::kFailed;
             } else {
-                if (errno == EINTR) {
+                if (saved_errno == EINTR) {
                     // 被信号中断，继续接收
-                    std::cout << "[DEBUG readExactly] EINTR, retrying..." << std::endl;
                     continue;
-                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                    // 非阻塞socket，数据暂时不可用，继续等待
-                    retry_count++;
-                    if (retry_count > MAX_RETRIES) {
-                        std::cerr << "[DEBUG readExactly] Timeout waiting for data" << std::endl;
-                        data.clear();
-                        return false;
+                } else if (saved_errno == EAGAIN || saved_errno == EWOULDBLOCK) {
+                    // 非阻塞socket，数据暂时不可用，等它可读
+                    if (!waitReady(POLLIN, deadline)) {
+                        return FillStatus::kTimeout;
                     }
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
                     continue;
                 } else {
-                    std::cerr << "[DEBUG readExactly] recv error: " << strerror(errno) << std::endl;
+                    std::cerr << "recv error: " << strerror(saved_errno) << std::endl;
                     state_ = ConnectionState::DISCONNECTED;
-                    data.clear();
-                    return false;
+                    input_buffer_.retrieveAll();
+                    return FillStatus::kFailed;
                 }
             }
         }
-        return true;
+        return FillStatus::kFilled;
+    }
+
+    // 等 socket 可读 / 可写（或出错、被 shutdown），截止时间已到返回 false
+    bool TcpClientImpl::waitReady(short events, std::chrono::steady_clock::time_point deadline) {
+        while (true) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                return false;
+            }
+            // 向上取整到毫秒，避免剩余不足 1ms 时 poll(0) 空转
+            auto remaining_us = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count();
+            int timeout_ms = static_cast<int>((remaining_us + 999) / 1000);
+
+            struct pollfd pfd;
+            pfd.fd = sockfd_;
+            pfd.events = events;
+            pfd.revents = 0;
+            int ret = poll(&pfd, 1, timeout_ms);
+            if (ret > 0) {
+                return true;  // 就绪、对端关闭或出错，都交给 recv / send 判断
+            }
+            if (ret < 0 && errno != EINTR) {
+                std::cerr << "poll error: " << strerror(errno) << std::endl;
+                return true;  // 让 recv / send 报告具体错误
+            }
+        }
     }
-}
\ No newline at end of file
+}
@@ -1,18 +1,33 @@
 #include "tcp_connection.h"
+#include "event_loop.h"
 #include "transport.h"
 #include <sys/socket.h>      // 系统socket相关头文件
+#include <sys/uio.h>         // iovec
 #include <unistd.h>          // Unix标准定义头文件 close
 #include <fcntl.h>           // 文件控制头文件
 #include <errno.h>           // 错误号定义头文件
 #include <cstring>           // 字符串操作头文件 strerror
 #include <arpa/inet.h>       // 网络地址转换头文件
+#include <algorithm>
 #include <iostream>
 
 namespace rpc {
 
     // 构造函数
     TcpConnectionImpl::TcpConnectionImpl(int sockfd, const std::string& peer_addr)
-        :sockfd_(sockfd), peer_addr_(peer_addr), state_(ConnectionState::CONNECTED)
+        :sockfd_(sockfd),
+         peer_addr_(peer_addr),
+         state_(ConnectionState::CONNECTED),
+         loop_(nullptr),
+         events_(EPOLLIN | EPOLLET),
+         reading_(true),
+         read_pending_(false),
+         loop_handle_(0),
+         last_active_ms_(0),
+         idle_timer_id_(0),
+         above_high_water_(false),
+         high_water_mark_(kDefaultHighWaterMark),
+         low_water_mark_(0)
     {
         // 设置 sockfd 为非阻塞
         int flags = fcntl(sockfd_, F_GETFL, 0);  // 获取当前socket标志
@@ -24,43 +39,235 @@ namespace rpc {
         close();
     }
 
-    // 发送数据
+    // 发送数据：只把帧投递到所属 I/O 循环的无锁队列，真正的写由循环线程完成
     bool TcpConnectionImpl::send(const std::vector<uint8_t>& data) {
+        return send(std::vector<uint8_t>(data));
+    }
+
+    bool TcpConnectionImpl::send(std::vector<uint8_t>&& data) {
         if (state_ != ConnectionState::CONNECTED) {  // 检查连接状态
             return false;  // 连接未建立，发送失败
         }
+        if (!loop_) {
+            handleError("Connection is not attached to an I/O loop");
+            return false;
+        }
+        if (data.empty()) {
+            return true;
+        }
+
+        loop_->queueWrite(std::static_pointer_cast<TcpConnectionImpl>(shared_from_this()), OutputFrame(std::move(data)));
+        return true;  // 已进入发送队列
+    }
 
-        size_t total_sent = 0;  // 已发送字节数
-        size_t total_size = data.size();  // 总数据大小
+    // 发送已编码好的 Buffer：整个 Buffer 进入发送队列，由循环线程与其他帧一起聚集写出
+    bool TcpConnectionImpl::send(Buffer&& frame) {
+        if (state_ != ConnectionState::CONNECTED) {
+            return false;
+        }
+        if (!loop_) {
+            handleError("Connection is not attached to an I/O loop");
+            return false;
+        }
+        if (frame.readableBytes() == 0) {
+            return true;
+        }
 
-        while (total_sent < total_size) {  // 循环发送直到所有数据发送完成
-            ssize_t sent = ::send(sockfd_, data.data() + total_sent, total_size - total_sent, MSG_NOSIGNAL);  // 发送数据
-            if (sent == -1) {  // 发送失败
-                if (errno == EAGAIN || errno == EWOULDBLOCK) {  // 发送缓冲区满，稍后重试
-                    continue;  // 继续尝试发送
-                } else {  // 其他错误
-                    handleError("Send failed: " + std::string(strerror(errno)));  // 处理错误
-                    return false;  // 发送失败
+        loop_->queueWrite(std::static_pointer_cast<TcpConnectionImpl>(shared_from_this()), OutputFrame(std::move(frame)));
+        return true;
+    }
+
+    // 写入一批帧（循环线程）：输出缓冲区为空时用一次 sendmsg 聚集写出，写不完的部分进入输出缓冲区
+    bool TcpConnectionImpl::writeFrames(std::vector<OutputFrame>& frames) {
+        WriteResult result;
+        {
+            std::lock_guard<std::mutex> lock(output_mutex_);
+            if (sockfd_ == -1) {
+                return false;
+            }
+
+            size_t old_len = output_buffer_.readableBytes();
+            size_t frame_index = 0;   // 第一个未写完的帧
+            size_t frame_offset = 0;  // 该帧中已写出的字节数
+
+            // 输出缓冲区为空时直接写，否则追加到末尾，保证字节顺序
+            while (old_len == 0 && frame_index < frames.size()) {
+                struct iovec vec[kMaxIovecCount];
+                int iovcnt = 0;
+                for (size_t i = frame_index; i < frames.size() && iovcnt < kMaxIovecCount; ++i) {
+                    size_t offset = (i == frame_index) ? frame_offset : 0;
+                    vec[iovcnt].iov_base = const_cast<uint8_t*>(frames[i].data()) + offset;
+                    vec[iovcnt].iov_len = frames[i].size() - offset;
+                    ++iovcnt;
+                }
+
+                // writev 不支持 MSG_NOSIGNAL，使用 sendmsg 避免对端关闭时触发 SIGPIPE
+                struct msghdr msg;
+                memset(&msg, 0, sizeof(msg));
+                msg.msg_iov = vec;
+                msg.msg_iovlen = iovcnt;
+                ssize_t sent = ::sendmsg(sockfd_, &msg, MSG_NOSIGNAL);
+                if (sent == -1) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) {  // 其他错误
+                        result.error_msg = "Send failed: " + std::string(strerror(errno));
+                    }
+                    break;  // 内核缓冲区满，剩余数据进入输出缓冲区
+                }
+
+                // 根据写出的字节数前移 (frame_index, frame_offset)
+                size_t remaining = static_cast<size_t>(sent);
+                while (remaining > 0 && frame_index < frames.size()) {
+                    size_t left = frames[frame_index].size() - frame_offset;
+                    if (remaining >= left) {
+                        remaining -= left;
+                        ++frame_index;
+                        frame_offset = 0;
+                    } else {
+                        frame_offset += remaining;
+                        remaining = 0;
+                    }
+                }
+                if (frame_index < frames.size()) {
+                    break;  // 部分写入，内核缓冲区已满
+                }
+            }
+
+            if (result.error_msg.empty()) {
+                for (size_t i = frame_index; i < frames.size(); ++i) {
+                    size_t offset = (i == frame_index) ? frame_offset : 0;
+                    output_buffer_.append(frames[i].data() + offset, frames[i].size() - offset);
+                }
+                size_t pending = output_buffer_.readableBytes();
+                if (!above_high_water_ && old_len < high_water_mark_ && pending >= high_water_mark_) {
+                    above_high_water_ = true;
+                    result.high_water = true;
+                    result.pending = pending;
                 }
-            } else if (sent == 0) {  // 连接被对端关闭
-                handleError("Connection closed by peer");  // 处理连接关闭
-                return false;  // 发送失败
+                if (old_len > 0) {
+                    // 之前已有积压，从输出缓冲区继续写
+                    drainOutputBufferLocked(result);
+                } else {
+                    updateWriteInterestLocked(result);
+                }
+            }
+        }
+        return finishWrite(result);
+    }
+
+    // 处理可写事件：把输出缓冲区中的数据写入 socket（循环线程调用）
+    bool TcpConnectionImpl::handleWrite() {
+        WriteResult result;
+        {
+            std::lock_guard<std::mutex> lock(output_mutex_);
+            if (sockfd_ == -1) {
+                return false;
+            }
+            drainOutputBufferLocked(result);
+        }
+        return finishWrite(result);
+    }
+
+    // 写出输出缓冲区中的数据，直到写完或内核缓冲区满（调用方持有 output_mutex_）
+    void TcpConnectionImpl::drainOutputBufferLocked(WriteResult& result) {
+        while (output_buffer_.readableBytes() > 0) {
+            ssize_t sent = ::send(sockfd_, output_buffer_.peek(), output_buffer_.readableBytes(), MSG_NOSIGNAL);
+            if (sent > 0) {
+                output_buffer_.retrieve(static_cast<size_t>(sent));
+            } else if (sent == -1 && errno == EINTR) {
+                continue;
+            } else if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;  // 内核缓冲区满，等待下一次 EPOLLOUT
+            } else {
+                result.error_msg = "Send failed: " + std::string(sent == -1 ? strerror(errno) : "connection closed by peer");
+                return;
             }
-            total_sent += sent;  // 更新已发送字节数
         }
+        updateWriteInterestLocked(result);
+    }
 
-        // 调用写入完成回调
-        if (write_complete_callback_) {  // 如果设置了写入完成回调
+    // 根据输出缓冲区是否清空，调整 EPOLLOUT 与低水位状态（调用方持有 output_mutex_）
+    void TcpConnectionImpl::updateWriteInterestLocked(WriteResult& result) {
+        size_t remaining = output_buffer_.readableBytes();
+        if (remaining == 0) {
+            // 写完了，取消关注 EPOLLOUT，避免 busy loop
+            if (events_ & EPOLLOUT) {
+                updateEvents(events_ & ~EPOLLOUT);
+            }
+            result.write_complete = true;
+        } else if (!(events_ & EPOLLOUT)) {
+            updateEvents(events_ | EPOLLOUT);
+        }
+        if (above_high_water_ && remaining <= low_water_mark_) {
+            above_high_water_ = false;
+            result.low_water = true;
+        }
+    }
+
+    // 在锁外触发写相关回调
+    bool TcpConnectionImpl::finishWrite(const WriteResult& result) {
+        if (!result.error_msg.empty()) {
+            handleError(result.error_msg);
+            return false;
+        }
+        if (result.high_water && high_water_mark_callback_) {
+            high_water_mark_callback_(shared_from_this(), result.pending);
+        }
+        if (result.low_water && low_water_mark_callback_) {
+            low_water_mark_callback_(shared_from_this());
+        }
+        if (result.write_complete && write_complete_callback_) {  // 如果设置了写入完成回调
             write_complete_callback_(shared_from_this());  // 调用回调函数
         }
+        return true;
+    }
 
-        return true;  // 发送成功
+    // 暂停读取
+    void TcpConnectionImpl::stopReading() {
+        reading_ = false;
+        if (!loop_) {
+            events_ &= ~EPOLLIN;
+            return;
+        }
+        auto self = std::static_pointer_cast<TcpConnectionImpl>(shared_from_this());
+        loop_->runInLoop([self]() {
+            std::lock_guard<std::mutex> lock(self->output_mutex_);
+            if (!self->reading_ && (self->events_ & EPOLLIN)) {
+                self->updateEvents(self->events_ & ~EPOLLIN);
+            }
+        });
+    }
+
+    // 恢复读取：重新关注 EPOLLIN，边沿触发下 EPOLL_CTL_MOD 会立即报告已积压的数据
+    void TcpConnectionImpl::startReading() {
+        reading_ = true;
+        if (!loop_) {
+            events_ |= EPOLLIN;
+            return;
+        }
+        auto self = std::static_pointer_cast<TcpConnectionImpl>(shared_from_this());
+        loop_->runInLoop([self]() {
+            std::lock_guard<std::mutex> lock(self->output_mutex_);
+            if (self->reading_ && !(self->events_ & EPOLLIN)) {
+                self->updateEvents(self->events_ | EPOLLIN);
+            }
+        });
     }
 
+    // 修改关注的事件（循环线程，调用方持有 output_mutex_）
+    void TcpConnectionImpl::updateEvents(uint32_t events) {
+        events_ = events;
+        if (loop_ && sockfd_ != -1) {
+            loop_->updateConnection(this);
+        }
+    }
 
     // 关闭连接
     void TcpConnectionImpl::close() {
-        if (state_ != ConnectionState::DISCONNECTED) {  // 如果连接未断开
+        std::lock_guard<std::mutex> lock(output_mutex_);  // 避免与 send/handleWrite 并发使用已关闭的 fd
+        if (state_ != ConnectionState::DISCONNECTED || sockfd_ != -1) {  // 如果连接未断开
             state_ = ConnectionState::DISCONNECTING;  // 设置状态为正在断开
             if (sockfd_ != -1) {  // 如果socket有效
                 ::close(sockfd_);  // 关闭socket
@@ -93,6 +300,17 @@ namespace rpc {
     void TcpConnectionImpl::setErrorCallback(ErrorCallback callback) {
         error_callback_ = std::move(callback);
     }
+    void TcpConnectionImpl::setHighWaterMarkCallback(HighWaterMarkCallback callback, size_t high_water_mark) {
+        high_water_mark_callback_ = std::move(callback);
+        high_water_mark_ = high_water_mark;
+    }
+    void TcpConnectionImpl::setLowWaterMarkCallback(LowWaterMarkCallback callback, size_t low_water_mark) {
+        low_water_mark_callback_ = std::move(callback);
+        low_water_mark_ = low_water_mark;
+    }
+    void TcpConnectionImpl::setFrameCallback(FrameCallback callback) {
+        frame_callback_ = std::move(callback);
+    }
     MessageCallback& TcpConnectionImpl::getMessageCallback() {
         return message_callback_;
     }
@@ -105,14 +323,104 @@ namespace rpc {
     ErrorCallback& TcpConnectionImpl::getErrorCallback() {
         return error_callback_;
     }
+    FrameCallback& TcpConnectionImpl::getFrameCallback() {
+        return frame_callback_;
+    }
 
     // 获取 sockfd
     int TcpConnectionImpl::getSocketFd() const {
         return sockfd_;
     }
 
+    // 设置所属 I/O 循环
+    void TcpConnectionImpl::setLoop(EventLoop* loop) {
+        loop_ = loop;
+    }
+
+    // 获取所属 I/O 循环
+    EventLoop* TcpConnectionImpl::getLoop() const {
+        return loop_;
+    }
+
+    // 当前关注的 epoll 事件
+    uint32_t TcpConnectionImpl::getEvents() const {
+        return events_;
+    }
+
+    // 是否正在读取
+    bool TcpConnectionImpl::isReading() const {
+        return reading_;
+    }
+
+    // 所属循环连接表中的句柄
+    uint64_t TcpConnectionImpl::getLoopHandle() const {
+        return loop_handle_;
+    }
+
+    void TcpConnectionImpl::setLoopHandle(uint64_t handle) {
+        loop_handle_ = handle;
+    }
+
+    // 在所属 I/O 循环的时间轮上注册定时器
+    uint64_t TcpConnectionImpl::runAfter(uint64_t delay_ms, std::function<void()> callback) {
+        if (!loop_) {
+            return 0;
+        }
+        return loop_->runAfter(delay_ms, std::move(callback));
+    }
+
+    // 取消定时器
+    bool TcpConnectionImpl::cancelTimer(uint64_t timer_id) {
+        if (!loop_) {
+            return false;
+        }
+        return loop_->cancelTimer(timer_id);
+    }
+
+    // 投递任务到所属 I/O 循环
+    void TcpConnectionImpl::queueInLoop(std::function<void()> task) {
+        if (!loop_) {
+            task();
+            return;
+        }
+        loop_->queueInLoop(std::move(task));
+    }
+
+    // 最近一次收到数据的时刻
+    uint64_t TcpConnectionImpl::getLastActiveMs() const {
+        return last_active_ms_;
+    }
+
+    void TcpConnectionImpl::setLastActiveMs(uint64_t now_ms) {
+        last_active_ms_ = now_ms;
+    }
+
+    // 空闲检测定时器
+    uint64_t TcpConnectionImpl::getIdleTimerId() const {
+        return idle_timer_id_;
+    }
+
+    void TcpConnectionImpl::setIdleTimerId(uint64_t timer_id) {
+        idle_timer_id_ = timer_id;
+    }
+
+    // 是否在所属循环的待读列表中
+    bool TcpConnectionImpl::isReadPending() const {
+        return read_pending_;
+    }
+
+    void TcpConnectionImpl::setReadPending(bool pending) {
+        read_pending_ = pending;
+    }
+
+    // 获取输出缓冲区积压字节数
+    size_t TcpConnectionImpl::getPendingOutputBytes() const {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        return output_buffer_.readableBytes();
+    }
+
     // 获取输入缓冲区
-    Buffer* TcpConnectionImpl::getInputBuffer() {
+    IoBuf* TcpConnectionImpl::getInputBuffer() {
         return &input_buffer_;
     }
 
@@ -121,6 +429,24 @@ namespace rpc {
         return &output_buffer_;
     }
 
+    // 下一次读取预留的字节数
+    size_t TcpConnectionImpl::nextReadSize() const {
+        size_t read_size = read_sizer_.next();
+        size_t readable = input_buffer_.readableBytes();
+        if (readable >= FrameCodec::kHeaderSize) {
+            // 已知帧长：按剩余部分预留，预留随已到达的字节增长，不按声明的帧长一次占满
+            uint32_t length = input_buffer_.peekInt<uint32_t>();
+            if (length <= FrameCodec::kMaxFrameSize) {
+                read_size = read_sizer_.nextForFrame(FrameCodec::kHeaderSize + static_cast<size_t>(length), readable);
+            }
+        }
+        return read_size;
+    }
+
+    void TcpConnectionImpl::recordRead(size_t bytes_read) {
+        read_sizer_.record(bytes_read);
+    }
+
     // 处理错误
     void TcpConnectionImpl::handleError(const std::string& error_msg) {
         state_ = ConnectionState::DISCONNECTED;
@@ -130,37 +456,25 @@ namespace rpc {
         }
     }
 
-    // 解码一个完整的帧（使用新的Buffer）
-    bool TcpConnectionImpl::decodeFrame(std::vector<uint8_t>& frame_data) {
+    // 解码一个完整的帧（帧体与输入缓冲区共享块）
+    bool TcpConnectionImpl::decodeFrame(IoBuf& frame) {
         std::lock_guard<std::mutex> lock(buffer_mutex_);
         
-        // 检查是否有足够的数据读取长度字段
-        if (input_buffer_.readableBytes() < 4) {
-            return false;
-        }
-        
-        // 读取长度字段（不移除）
-        uint32_t length_host = input_buffer_.peekInt<uint32_t>();
-        
-        // 验证长度
-        const uint32_t MAX_FRAME_SIZE = 10 * 1024 * 1024;
-        if (length_host == 0 || length_host > MAX_FRAME_SIZE) {
-            std::cerr << "Invalid frame length: " << length_host << std::endl;
+        uint32_t length = 0;
+        FrameStatus status = FrameCodec::inspect(input_buffer_, length);
+        if (status == FrameStatus::kInvalid) {
+            std::cerr << "Invalid frame length: " << length << std::endl;
             input_buffer_.retrieveAll();  // 清空缓冲区，防止一直出错
             return false;
         }
-        
-        // 检查是否有完整帧（4字节长度 + 消息体）
-        if (input_buffer_.readableBytes() < length_host + 4) {
+        if (status == FrameStatus::kIncomplete) {
             // 半包，等待更多数据
             return false;
         }
 
-        // 移除长度字段
-        input_buffer_.retrieve(4);
-        
-        // 提取完整帧数据
-        frame_data = input_buffer_.retrieveAsVector(length_host);
+        // 移除长度字段，切出完整帧数据（不拷贝）
+        input_buffer_.retrieve(FrameCodec::kHeaderSize);
+        frame = input_buffer_.cutFront(length);
         
         return true;
     }
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <sys/epoll.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include <mutex>
@@ -13,12 +14,16 @@
 
 namespace rpc {
 
-    TcpServerImpl::TcpServerImpl()
-        :listen_sockfd_(-1),
+    TcpServerImpl::TcpServerImpl(const TcpServerConfig& config)
+        :config_(config),
          epoll_fd_(-1),
          running_(false),
-         max_connections_(1000)
-    {}
+         next_loop_(0)
+    {
+        if (config_.io_thread_count == 0) {
+            config_.io_thread_count = 1;
+        }
+    }
 
     TcpServerImpl::~TcpServerImpl() {
         stop();
@@ -30,69 +35,65 @@ namespace rpc {
             return true;
         }
 
-        // 创建 socket
-        listen_sockfd_ = socket(AF_INET, SOCK_STREAM, 0);
-        if (listen_sockfd_ == -1) {
-            std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+        if (!listen_addr_.parse(host, port)) {
             return false;
         }
-
-        // 设置 socket
-        int opt = 1;
-        if (setsockopt(listen_sockfd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1) {
-            std::cerr << "Failed to set socket option: " << strerror(errno) << std::endl;  // 输出错误信息
-            close(listen_sockfd_);  // 关闭socket
-            listen_sockfd_ = -1;  // 重置socket文件描述符
-            return false;
+        // Unix 域套接字不支持 SO_REUSEPORT 分摊，只用主 reactor accept
+        if (listen_addr_.isUnix() && config_.reuse_port) {
+            std::cerr << "SO_REUSEPORT is not supported for " << host << ", accepting in the main reactor" << std::endl;
+            config_.reuse_port = false;
         }
 
-        // 绑定IP和端口
-        struct sockaddr_in server_addr;
-        memset(&server_addr, 0, sizeof(server_addr));
-        server_addr.sin_family = AF_INET;
-        server_addr.sin_port = htons(port);
-        server_addr.sin_addr.s_addr = inet_addr(host.c_str());
-
-        if (bind(listen_sockfd_, (struct sockaddr*)&server_addr, sizeof(server_addr)) == -1) {
-            std::cerr << "Failed to bind address: " << strerror(errno) << std::endl;  // 输出错误信息
-            close(listen_sockfd_);  // 关闭socket
-            listen_sockfd_ = -1;  // 重置socket文件描述符
-            return false;
+        // 创建监听 socket：SO_REUSEPORT 模式下每个 I/O 循环一个，否则只有一个
+        size_t listener_count = config_.reuse_port ? config_.io_thread_count : 1;
+        for (size_t i = 0; i < listener_count; ++i) {
+            int listen_fd = createListenSocket(listen_addr_);
+            if (listen_fd == -1) {
+                closeListenSockets();
+                return false;
+            }
+            listen_fds_.push_back(listen_fd);
         }
 
-        // 开始监听
-        if (listen(listen_sockfd_, 128) == -1) {  // 开始监听连接请求
-            std::cerr << "Failed to listen: " << strerror(errno) << std::endl;
-            ::close(listen_sockfd_);
-            listen_sockfd_ = -1;
-            return false;
-        }
+        if (!config_.reuse_port) {
+            // 创建 epoll（主 reactor 只负责 accept）
+            epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+            if (epoll_fd_ == -1) {  // 创建epoll失败
+                std::cerr << "Failed to create epoll: " << strerror(errno) << std::endl;  // 输出错误信息
+                closeListenSockets();
+                return false;  // 返回失败
+            }
 
-        // 创建 epoll
-        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
-        if (epoll_fd_ == -1) {  // 创建epoll失败
-            std::cerr << "Failed to create epoll: " << strerror(errno) << std::endl;  // 输出错误信息
-            ::close(listen_sockfd_);  // 关闭socket
-            listen_sockfd_ = -1;  // 重置socket文件描述符
-            return false;  // 返回失败
+            struct epoll_event event;
+            event.events = EPOLLIN;
+            event.data.fd = listen_fds_[0];
+            if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fds_[0], &event) == -1) {
+                std::cerr << "Failed to add listen socket to epoll: " << strerror(errno) << std::endl;  // 输出错误信息
+                close(epoll_fd_); 
+                epoll_fd_ = -1; 
+                closeListenSockets();
+                return false;
+            }
         }
 
-        struct epoll_event event;
-        event.events = EPOLLIN;
-        event.data.fd = listen_sockfd_;
-        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_sockfd_, &event) == -1) {
-            std::cerr << "Failed to add listen socket to epoll: " << strerror(errno) << std::endl;  // 输出错误信息
-            close(epoll_fd_); 
-            close(listen_sockfd_);
-            epoll_fd_ = -1; 
-            listen_sockfd_ = -1; 
+        // 启动 I/O 循环
+        if (!startIoLoops()) {
+            if (epoll_fd_ != -1) {
+                close(epoll_fd_);
+                epoll_fd_ = -1;
+            }
+            closeListenSockets();
             return false;
         }
 
         running_ = true;
-        server_thread_ = std::thread(&TcpServerImpl::serverThreadMain, this);
+        if (!config_.reuse_port) {
+            server_thread_ = std::thread(&TcpServerImpl::serverThreadMain, this);
+        }
 
-        std::cout << "TCP Server started on " << host << ":" << port << std::endl;
+        std::cout << "TCP Server started on " << listen_addr_.toString()
+                  << " with " << io_loops_.size() << " I/O loops"
+                  << (config_.reuse_port ? " (SO_REUSEPORT)" : "") << std::endl;
         return true;
     }
 
@@ -104,19 +105,9 @@ namespace rpc {
 
         running_ = false;
 
-        // 关闭监听socket
-        if (listen_sockfd_ != -1) {  // 如果监听socket有效
-            ::close(listen_sockfd_);
-            listen_sockfd_ = -1;
-        }
-
-        // 关闭所有连接
-        {
-            std::lock_guard<std::mutex> lock(connections_mutex_);
-            for (auto& connection : connections_) {  // 遍历所有连接
-                connection->close();  // 关闭连接
-            }
-            connections_.clear();  // 清空连接列表
+        // 先等待 accept 线程结束，不再产生新连接
+        if (server_thread_.joinable()) {
+            server_thread_.join();  // 等待线程结束
         }
 
         // 关闭epoll
@@ -125,10 +116,11 @@ namespace rpc {
             epoll_fd_ = -1;
         }
 
-        // 等待服务器线程结束
-        if (server_thread_.joinable()) {
-            server_thread_.join();  // 等待线程结束
-        }
+        // 停止 I/O 循环，关闭所有连接（SO_REUSEPORT 模式下循环里还挂着监听 socket）
+        stopIoLoops();
+
+        // 关闭监听socket
+        closeListenSockets();
 
         std::cout << "TCP Server stopped" << std::endl;
     }
@@ -143,6 +135,29 @@ namespace rpc {
         return running_;
     }
 
+    // 获取当前连接数（所有 I/O 循环之和）
+    size_t TcpServerImpl::getConnectionCount() const {
+        size_t total = 0;
+        for (const auto& loop : io_loops_) {
+            total += loop->getConnectionCount();
+        }
+        return total;
+    }
+
+    // 获取 I/O 循环数量
+    size_t TcpServerImpl::getIoLoopCount() const {
+        return io_loops_.size();
+    }
+
+    // 获取各 I/O 循环的连接数
+    std::vector<size_t> TcpServerImpl::getLoopConnectionCounts() const {
+        std::vector<size_t> counts;
+        for (const auto& loop : io_loops_) {
+            counts.push_back(loop->getConnectionCount());
+        }
+        return counts;
+    }
+
     // 服务器线程主函数
     void TcpServerImpl::serverThreadMain() {
         const int max_events = 100;
@@ -159,134 +174,168 @@ namespace rpc {
                 }
             }
 
+            // 主 reactor 只监听 listen socket，客户端事件由各 I/O 循环处理
             for (int i = 0; i < nfds; ++i) {  // 处理每个事件
-                if (events[i].data.fd == listen_sockfd_) {  // 如果是监听socket事件
-                    handleNewConnection();  // 处理新连接
-                } else {  // 如果是客户端连接事件
-                    handleClientEvent(events[i]);  // 处理客户端事件
+                if (events[i].data.fd == listen_fds_[0]) {  // 如果是监听socket事件
+                    handleNewConnection(listen_fds_[0]);  // 处理新连接
                 }
             }
         }
     }
 
-    // 处理新连接
-    void TcpServerImpl::handleNewConnection() {
-        struct sockaddr_in client_addr;
-        socklen_t client_addr_len = sizeof(client_addr); 
-        int client_sockfd = accept(listen_sockfd_, (struct sockaddr*)&client_addr, &client_addr_len);
-        if (client_sockfd == -1) {  // 接受连接失败
-            if (errno != EAGAIN && errno != EWOULDBLOCK) {  // 如果不是资源暂时不可用
-                std::cerr << "Failed to accept connection: " << strerror(errno) << std::endl;
-            }
-            return;  // 返回
+    // 创建监听 socket（非阻塞）
+    int TcpServerImpl::createListenSocket(const SocketAddress& address) {
+        // 创建 socket
+        int listen_fd = socket(address.getFamily(), SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd == -1) {
+            std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+            return -1;
         }
 
-        // 检查连接数限制
-        {
-            std::lock_guard<std::mutex> lock(connections_mutex_);  // 获取连接锁
-            if (connections_.size() >= max_connections_) {  // 如果连接数超过限制
-                close(client_sockfd);  // 关闭新连接
-                std::cerr << "Connection limit exceeded" << std::endl;  // 输出错误信息
-                return;  // 返回
+        if (address.isUnix()) {
+            // 上次进程异常退出可能留下旧的 socket 文件
+            if (address.getPath()[0] != '@') {
+                ::unlink(address.getPath().c_str());
+            }
+        } else {
+            // 设置 socket
+            int opt = 1;
+            if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1) {
+                std::cerr << "Failed to set socket option: " << strerror(errno) << std::endl;  // 输出错误信息
+                ::close(listen_fd);  // 关闭socket
+                return -1;
+            }
+            if (config_.reuse_port && setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == -1) {
+                std::cerr << "Failed to set SO_REUSEPORT: " << strerror(errno) << std::endl;
+                ::close(listen_fd);
+                return -1;
             }
         }
 
-        // 创建连接对象
-        std::string peer_addr = inet_ntoa(client_addr.sin_addr);
-        peer_addr += ":" + std::to_string(ntohs(client_addr.sin_port)); 
-        auto connection = std::make_shared<TcpConnectionImpl>(client_sockfd, peer_addr); 
-
-        // 将客户端socket添加到epoll
-        struct epoll_event event; 
-        event.events = EPOLLIN | EPOLLET;  // 边沿触发
-        event.data.ptr = connection.get();  // 设置数据指针为连接对象
-        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client_sockfd, &event) == -1) {
-            std::cerr << "Failed to add client socket to epoll: " << strerror(errno) << std::endl;
-            connection->close();
-            return;
+        // 绑定地址
+        if (bind(listen_fd, address.getSockAddr(), address.getLength()) == -1) {
+            std::cerr << "Failed to bind address: " << strerror(errno) << std::endl;  // 输出错误信息
+            ::close(listen_fd);  // 关闭socket
+            return -1;
         }
 
-        // 添加到连接列表
-        {
-            std::lock_guard<std::mutex> lock(connections_mutex_);
-            connections_.push_back(connection);
+        // 开始监听
+        if (listen(listen_fd, config_.listen_backlog) == -1) {  // 开始监听连接请求
+            std::cerr << "Failed to listen: " << strerror(errno) << std::endl;
+            ::close(listen_fd);
+            return -1;
         }
+        return listen_fd;
+    }
 
-        // 调用连接回调
-        if (connection_callback_) { 
-            connection_callback_(connection); 
+    // 关闭所有监听 socket
+    void TcpServerImpl::closeListenSockets() {
+        for (int listen_fd : listen_fds_) {
+            ::close(listen_fd);
         }
-
-        std::cout << "New connection from " << peer_addr << std::endl;
+        // 删除 Unix 域套接字文件
+        if (!listen_fds_.empty() && listen_addr_.isUnix() && listen_addr_.getPath()[0] != '@') {
+            ::unlink(listen_addr_.getPath().c_str());
+        }
+        listen_fds_.clear();
     }
 
-    // 处理客户端事件（写事件-发送响应，在TcpConnection里处理-send）
-    void TcpServerImpl::handleClientEvent(const struct epoll_event& event) {
-        auto* connection = static_cast<TcpConnectionImpl*>(event.data.ptr);
-        if (!connection) {
-            return;
+    // 处理新连接：一次唤醒内循环 accept4，直到队列被取空（EAGAIN）
+    void TcpServerImpl::handleNewConnection(int listen_fd, EventLoop* owner) {
+        while (true) {
+            int client_sockfd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (client_sockfd == -1) {  // 接受连接失败
+                if (errno == EINTR || errno == ECONNABORTED) {  // 被信号中断或对端已放弃，继续取下一个
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {  // 如果不是队列已空
+                    std::cerr << "Failed to accept connection: " << strerror(errno) << std::endl;
+                }
+                return;  // 返回
+            }
+            // 响应帧各自独立写出，关闭 Nagle，免得后一个小响应等前一个的（延迟）ACK
+            if (!listen_addr_.isUnix()) {
+                int one = 1;
+                setsockopt(client_sockfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            newConnection(client_sockfd, owner);
         }
+    }
 
-        if (event.events & EPOLLIN) {
-            handleClientRead(connection);
+    // 创建连接对象并交给 I/O 循环
+    void TcpServerImpl::newConnection(int client_sockfd, EventLoop* owner) {
+        // 检查连接数限制
+        if (getConnectionCount() >= config_.max_connections) {  // 如果连接数超过限制
+            close(client_sockfd);  // 关闭新连接
+            std::cerr << "Connection limit exceeded" << std::endl;  // 输出错误信息
+            return;  // 返回
         }
 
-        if (event.events & (EPOLLERR | EPOLLHUP)) {
-            handleClientClose(connection);
+        // 创建连接对象
+        std::string peer_addr = SocketAddress::getPeerName(client_sockfd);
+        auto connection = std::make_shared<TcpConnectionImpl>(client_sockfd, peer_addr); 
+
+        // 选择 I/O 循环：SO_REUSEPORT 模式下留在接受它的循环，否则按策略选择
+        EventLoop* loop = owner ? owner : selectLoop();
+        connection->setLoop(loop);
+
+        // 先调用连接回调（设置消息回调等），再交给 I/O 循环，保证第一次读事件前回调已就绪
+        if (connection_callback_) { 
+            connection_callback_(connection); 
         }
+
+        loop->addConnection(connection);
+
+        std::cout << "New connection from " << peer_addr << " -> loop " << loop->getIndex() << std::endl;
     }
 
-    // 处理读事件
-    void TcpServerImpl::handleClientRead(TcpConnectionImpl* connection) {
-        int saved_errno = 0;
-        Buffer* input_buffer = connection->getInputBuffer();
-        
-        // 使用Buffer的readFromFd高效读取数据
-        ssize_t n = input_buffer->readFromFd(connection->getSocketFd(), &saved_errno);
-
-        if (n > 0) {
-            // 接收到数据，尝试解码完整的帧
-            std::vector<uint8_t> frame_data;
-            // 使用while循环，解决粘包问题（一次接收到多个请求）
-            while (connection->decodeFrame(frame_data)) {
-                // 触发 MessageCallback -> 调用 rpc_server 里的parseRequest
-                if (connection->getMessageCallback()) {
-                    connection->getMessageCallback()(connection->shared_from_this(), frame_data);
+    // 为新连接选择 I/O 循环
+    EventLoop* TcpServerImpl::selectLoop() {
+        if (config_.loop_balance_strategy == "LeastConnection") {
+            // 最少连接：选择当前连接数最少的循环
+            EventLoop* best = io_loops_.front().get();
+            for (const auto& loop : io_loops_) {
+                if (loop->getConnectionCount() < best->getConnectionCount()) {
+                    best = loop.get();
                 }
             }
-        } else if (n == 0) {
-            // 对端关闭连接
-            handleClientClose(connection);
-        } else {
-            // 读取错误
-            if (saved_errno != EAGAIN && saved_errno != EWOULDBLOCK) {
-                std::cerr << "Failed to receive data: " << strerror(saved_errno) << std::endl;
-                handleClientClose(connection);
-            }
+            return best;
         }
+        // 默认轮询
+        size_t index = next_loop_.fetch_add(1) % io_loops_.size();
+        return io_loops_[index].get();
     }
 
-    // 处理关闭事件
-    void TcpServerImpl::handleClientClose(TcpConnectionImpl* connection) {
-        // 从epoll中移除
-        int sockfd = connection->getSocketFd();
-        std::string peer_addr = connection->getRemoteAddress();
-        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, sockfd, nullptr);
-
-        // 从连接列表中移除
-        {
-            std::lock_guard<std::mutex> lock(connections_mutex_);  // 获取连接锁
-            auto it = std::find_if(connections_.begin(), connections_.end(),  // 查找连接
-                [connection](const std::shared_ptr<TcpConnectionImpl>& conn) {
-                    return conn.get() == connection;
+    // 启动 I/O 循环
+    bool TcpServerImpl::startIoLoops() {
+        for (size_t i = 0; i < config_.io_thread_count; ++i) {
+            auto loop = std::make_unique<EventLoop>(i);
+            loop->setReadBudget(config_.read_budget_bytes, config_.read_budget_frames);
+            loop->setIdleTimeout(config_.idle_timeout_ms);
+            if (config_.reuse_port) {
+                // 每个循环自己 accept 自己监听 socket 上的连接
+                int listen_fd = listen_fds_[i];
+                EventLoop* owner = loop.get();
+                loop->setAcceptor(listen_fd, [this, listen_fd, owner]() {
+                    handleNewConnection(listen_fd, owner);
                 });
-            if (it != connections_.end()) { 
-                connections_.erase(it); 
             }
+            if (!loop->start()) {
+                std::cerr << "Failed to start I/O loop " << i << std::endl;
+                stopIoLoops();
+                return false;
+            }
+            io_loops_.push_back(std::move(loop));
         }
+        return true;
+    }
 
-        connection->close(); 
-        std::cout << "Connection closed: " << peer_addr << std::endl;
+    // 停止 I/O 循环
+    void TcpServerImpl::stopIoLoops() {
+        for (auto& loop : io_loops_) {
+            loop->stop();
+        }
+        io_loops_.clear();
     }
 
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "tcp_server.h"
+#include "tcp_client.h"
+#include "io_uring_server.h"
+#include "io_uring_client.h"
+#include "shm_client.h"
+#include <iostream>
+
+namespace rpc {
+
+    namespace {
+        // 是否选择 io_uring：配置为 io_uring 且内核支持（探测结果缓存，只做一次）
+        bool useIoUring(const std::string& io_backend) {
+            if (io_backend == "epoll" || io_backend.empty()) {
+                return false;
+            }
+            if (io_backend != "io_uring") {
+                std::cerr << "Unknown io_backend: " << io_backend << ", using epoll" << std::endl;
+                return false;
+            }
+            static const bool supported = IoUringRing::isSupported();
+            if (!supported) {
+                std::cerr << "io_uring is not supported by this kernel, falling back to epoll" << std::endl;
+            }
+            return supported;
+        }
+    }
+
+    // 按配置创建 TCP 服务器
+    std::unique_ptr<TcpServer> createTcpServer(const TcpServerConfig& config) {
+        if (useIoUring(config.io_backend)) {
+            return std::make_unique<IoUringTcpServer>(config);
+        }
+        return std::make_unique<TcpServerImpl>(config);
+    }
+
+    // 按配置创建 TCP 客户端
+    std::shared_ptr<TcpClient> createTcpClient(const std::string& io_backend, const std::string& host) {
+        if (ShmRegion::isShmAddress(host)) {
+            return std::make_shared<ShmTcpClient>();
+        }
+        if (useIoUring(io_backend)) {
+            return std::make_shared<IoUringTcpClient>();
+        }
+        return std::make_shared<TcpClientImpl>();
+    }
+
+}
@@ -0,0 +1,384 @@
+#include "io_buf.h"
+#include "slab_pool.h"
+#include <sys/uio.h>
+#include <errno.h>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace rpc {
+
+// ==================== IoBufBlockPool ====================
+
+// 分配块：定长块取 SlabPool 的 16KB 规格，更大的块取能装下的规格，超过最大规格的按需向系统分配
+IoBufBlock* IoBufBlockPool::allocate(size_t min_capacity) {
+    size_t alloc_size = SlabPool::roundUp(sizeof(IoBufBlock) + std::max(min_capacity, kBlockSize));
+    size_t capacity = alloc_size - sizeof(IoBufBlock);
+    IoBufBlock* block = new (SlabPool::allocate(alloc_size)) IoBufBlock();
+    block->refs.store(1, std::memory_order_relaxed);
+    block->capacity = static_cast<uint32_t>(capacity);
+    block->used = 0;
+    return block;
+}
+
+void IoBufBlockPool::retain(IoBufBlock* block) {
+    block->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 引用归零：还给 SlabPool（释放线程的缓存，可能不是分配它的线程）
+void IoBufBlockPool::release(IoBufBlock* block) {
+    if (block->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    size_t size = sizeof(IoBufBlock) + block->capacity;
+    block->~IoBufBlock();
+    SlabPool::deallocate(block, size);
+}
+
+// ==================== IoBuf::SliceQueue ====================
+
+IoBuf::SliceQueue& IoBuf::SliceQueue::operator=(SliceQueue&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    releaseStorage();
+    if (other.data_ == other.inline_) {
+        // 内部存储只能逐段拷过来
+        data_ = inline_;
+        capacity_ = kInlineSlices;
+        head_ = 0;
+        tail_ = 0;
+        for (const Slice& slice : other) {
+            data_[tail_++] = slice;
+        }
+    } else {
+        data_ = other.data_;
+        capacity_ = other.capacity_;
+        head_ = other.head_;
+        tail_ = other.tail_;
+        other.data_ = other.inline_;
+        other.capacity_ = kInlineSlices;
+    }
+    other.clear();
+    return *this;
+}
+
+void IoBuf::SliceQueue::makeRoom() {
+    uint32_t count = tail_ - head_;
+    if (head_ > 0 && count <= capacity_ / 2) {
+        std::memmove(data_, data_ + head_, count * sizeof(Slice));
+    } else {
+        uint32_t new_capacity = capacity_ * 2;
+        Slice* storage = static_cast<Slice*>(SlabPool::allocate(new_capacity * sizeof(Slice)));
+        std::memcpy(storage, data_ + head_, count * sizeof(Slice));
+        releaseStorage();
+        data_ = storage;
+        capacity_ = new_capacity;
+    }
+    head_ = 0;
+    tail_ = count;
+}
+
+void IoBuf::SliceQueue::releaseStorage() {
+    if (data_ != inline_) {
+        SlabPool::deallocate(data_, capacity_ * sizeof(Slice));
+        data_ = inline_;
+        capacity_ = kInlineSlices;
+    }
+}
+
+// ==================== IoBuf ====================
+
+IoBuf::IoBuf()
+    :readable_(0),
+     write_block_(nullptr)
+{}
+
+IoBuf::~IoBuf() {
+    clear();
+    releaseWriteBlock();
+}
+
+IoBuf::IoBuf(const IoBuf& other)
+    :slices_(other.slices_),
+     readable_(other.readable_),
+     write_block_(nullptr)
+{
+    for (const Slice& slice : slices_) {
+        IoBufBlockPool::retain(slice.block);
+    }
+}
+
+IoBuf& IoBuf::operator=(const IoBuf& other) {
+    if (this != &other) {
+        IoBuf copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+IoBuf::IoBuf(IoBuf&& other) noexcept
+    :slices_(std::move(other.slices_)),
+     readable_(other.readable_),
+     write_block_(other.write_block_)
+{
+    other.slices_.clear();
+    other.readable_ = 0;
+    other.write_block_ = nullptr;
+}
+
+IoBuf& IoBuf::operator=(IoBuf&& other) noexcept {
+    if (this != &other) {
+        clear();
+        releaseWriteBlock();
+        slices_ = std::move(other.slices_);
+        readable_ = other.readable_;
+        write_block_ = other.write_block_;
+        other.slices_.clear();
+        other.readable_ = 0;
+        other.write_block_ = nullptr;
+    }
+    return *this;
+}
+
+const uint8_t* IoBuf::peek() const {
+    return slices_.empty() ? nullptr : slices_.front().data();
+}
+
+size_t IoBuf::contiguousBytes() const {
+    return slices_.empty() ? 0 : slices_.front().length;
+}
+
+// 跨段拷贝
+bool IoBuf::copyOut(void* dest, size_t len, size_t offset) const {
+    if (offset + len > readable_) {
+        return false;
+    }
+    uint8_t* out = static_cast<uint8_t*>(dest);
+    for (const Slice& slice : slices_) {
+        if (len == 0) {
+            break;
+        }
+        if (offset >= slice.length) {
+            offset -= slice.length;
+            continue;
+        }
+        size_t n = std::min(len, static_cast<size_t>(slice.length) - offset);
+        std::memcpy(out, slice.data() + offset, n);
+        out += n;
+        len -= n;
+        offset = 0;
+    }
+    return true;
+}
+
+// 移除前 len 字节：整段移除时释放块引用
+void IoBuf::retrieve(size_t len) {
+    while (len > 0 && !slices_.empty()) {
+        Slice& front = slices_.front();
+        if (len >= front.length) {
+            len -= front.length;
+            readable_ -= front.length;
+            IoBufBlockPool::release(front.block);
+            slices_.pop_front();
+        } else {
+            front.offset += static_cast<uint32_t>(len);
+            front.length -= static_cast<uint32_t>(len);
+            readable_ -= len;
+            len = 0;
+        }
+    }
+}
+
+// 移除全部数据（写块保留，后续读取继续填充它的剩余空间）
+void IoBuf::retrieveAll() {
+    clear();
+}
+
+// 切出前 len 字节：整段直接转移，边界所在的段一分为二并各持一份引用
+IoBuf IoBuf::cutFront(size_t len) {
+    IoBuf front_part;
+    len = std::min(len, readable_);
+    readable_ -= len;
+    front_part.readable_ = len;
+    while (len > 0) {
+        Slice& front = slices_.front();
+        if (front.length <= len) {
+            len -= front.length;
+            front_part.slices_.push_back(front);
+            slices_.pop_front();
+        } else {
+            IoBufBlockPool::retain(front.block);
+            front_part.slices_.push_back(Slice{front.block, front.offset, static_cast<uint32_t>(len)});
+            front.offset += static_cast<uint32_t>(len);
+            front.length -= static_cast<uint32_t>(len);
+            len = 0;
+        }
+    }
+    return front_part;
+}
+
+std::vector<uint8_t> IoBuf::retrieveAsVector(size_t len) {
+    len = std::min(len, readable_);
+    std::vector<uint8_t> result(len);
+    copyOut(result.data(), len);
+    retrieve(len);
+    return result;
+}
+
+std::vector<uint8_t> IoBuf::retrieveAllAsVector() {
+    return retrieveAsVector(readable_);
+}
+
+std::vector<uint8_t> IoBuf::toVector() const {
+    std::vector<uint8_t> result(readable_);
+    copyOut(result.data(), readable_);
+    return result;
+}
+
+std::string IoBuf::toString() const {
+    std::string result(readable_, '\0');
+    copyOut(&result[0], readable_);
+    return result;
+}
+
+// 合并成一段
+const uint8_t* IoBuf::coalesce() {
+    if (slices_.size() <= 1) {
+        return peek();
+    }
+    IoBufBlock* block = IoBufBlockPool::allocate(readable_);
+    copyOut(block->data(), readable_);
+    block->used = static_cast<uint32_t>(readable_);
+    size_t total = readable_;
+    clear();
+    slices_.push_back(Slice{block, 0, static_cast<uint32_t>(total)});  // 沿用 allocate 的那份引用
+    readable_ = total;
+    return block->data();
+}
+
+// 追加数据
+void IoBuf::append(const void* data, size_t len) {
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+    while (len > 0) {
+        if (write_block_ == nullptr || write_block_->used == write_block_->capacity) {
+            releaseWriteBlock();
+            write_block_ = IoBufBlockPool::allocate(std::max(len, IoBufBlockPool::kBlockSize));
+        }
+        size_t n = std::min(len, static_cast<size_t>(write_block_->capacity - write_block_->used));
+        std::memcpy(write_block_->data() + write_block_->used, source, n);
+        commitWrite(n);
+        source += n;
+        len -= n;
+    }
+}
+
+// 追加另一个缓冲区的全部段
+void IoBuf::append(IoBuf&& other) {
+    for (const Slice& slice : other.slices_) {
+        slices_.push_back(slice);
+    }
+    readable_ += other.readable_;
+    other.slices_.clear();
+    other.readable_ = 0;
+}
+
+// 从 fd 读取
+ssize_t IoBuf::readFromFd(int fd, int* saved_errno, size_t read_size) {
+    struct iovec vec[kMaxReadBlocks + 1];
+    IoBufBlock* fresh[kMaxReadBlocks];
+    int iovcnt = 0;
+
+    // 写块剩余空间
+    size_t tail_room = write_block_ ? write_block_->capacity - write_block_->used : 0;
+    if (tail_room > 0) {
+        vec[iovcnt].iov_base = write_block_->data() + write_block_->used;
+        vec[iovcnt].iov_len = tail_room;
+        ++iovcnt;
+    }
+    // 剩余空间不够时挂新块，读不满的稍后还给块池
+    int fresh_count = 0;
+    size_t wanted = read_size > tail_room ? read_size - tail_room : 0;
+    if (iovcnt == 0 && wanted == 0) {
+        wanted = 1;
+    }
+    if (wanted > IoBufBlockPool::kBlockSize * kMaxReadBlocks) {
+        // 挂一个连续大块；只是自适应预留（而非大帧）时不超过 SlabPool 的最大规格，免得每次读都向系统要内存
+        if (wanted <= SlabPool::kMaxClassSize) {
+            wanted = std::min(wanted, IoBufBlockPool::kMaxPooledCapacity);
+        }
+        fresh[fresh_count++] = IoBufBlockPool::allocate(wanted);
+    } else {
+        while (wanted > 0) {
+            fresh[fresh_count++] = IoBufBlockPool::allocate();
+            wanted -= std::min(wanted, IoBufBlockPool::kBlockSize);
+        }
+    }
+    for (int i = 0; i < fresh_count; ++i) {
+        vec[iovcnt].iov_base = fresh[i]->data();
+        vec[iovcnt].iov_len = fresh[i]->capacity;
+        ++iovcnt;
+    }
+
+    ssize_t n = ::readv(fd, vec, iovcnt);
+    if (n < 0) {
+        *saved_errno = errno;
+        for (int i = 0; i < fresh_count; ++i) {
+            IoBufBlockPool::release(fresh[i]);
+        }
+        return n;
+    }
+
+    size_t remaining = static_cast<size_t>(n);
+    if (tail_room > 0 && remaining > 0) {
+        size_t taken = std::min(remaining, tail_room);
+        commitWrite(taken);
+        remaining -= taken;
+    }
+    for (int i = 0; i < fresh_count; ++i) {
+        if (remaining == 0) {
+            IoBufBlockPool::release(fresh[i]);
+            continue;
+        }
+        size_t taken = std::min(remaining, static_cast<size_t>(fresh[i]->capacity));
+        releaseWriteBlock();
+        write_block_ = fresh[i];  // 接管分配时的那份引用
+        commitWrite(taken);
+        remaining -= taken;
+    }
+    return n;
+}
+
+// 写块上新写入的 len 字节
+void IoBuf::commitWrite(size_t len) {
+    if (!slices_.empty()) {
+        Slice& back = slices_.back();
+        if (back.block == write_block_ && back.offset + back.length == write_block_->used) {
+            back.length += static_cast<uint32_t>(len);
+            write_block_->used += static_cast<uint32_t>(len);
+            readable_ += len;
+            return;
+        }
+    }
+    IoBufBlockPool::retain(write_block_);
+    slices_.push_back(Slice{write_block_, write_block_->used, static_cast<uint32_t>(len)});
+    write_block_->used += static_cast<uint32_t>(len);
+    readable_ += len;
+}
+
+void IoBuf::releaseWriteBlock() {
+    if (write_block_ != nullptr) {
+        IoBufBlockPool::release(write_block_);
+        write_block_ = nullptr;
+    }
+}
+
+void IoBuf::clear() {
+    for (const Slice& slice : slices_) {
+        IoBufBlockPool::release(slice.block);
+    }
+    slices_.clear();
+    readable_ = 0;
+}
+
+} // namespace rpc
@@ -1,10 +1,130 @@
 #include "rpc_protocol_helper.h"
 #include "transport.h"
+#include "io_buf.h"
+#include "buffer.h"
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <deque>
+#include <climits>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 
 namespace rpc {
 
+namespace {
+
+// 响应信封：除 response_data 以外的字段
+RpcResponseProto createResponseEnvelope(const RpcResponse& response) {
+    RpcResponseProto proto;
+
+    proto.set_request_id(response.request_id);
+    proto.set_success(response.success);
+
+    // 设置错误细腻
+    if (!response.success) {
+        proto.set_error_code(static_cast<int32_t>(RpcErrorCode::SERVER_ERROR));
+        proto.set_error_message(response.error_message);
+    } else {
+        proto.set_error_code(static_cast<int32_t>(RpcErrorCode::SUCCESS));
+    }
+
+    return proto;
+}
+
+// 信封 + 原地序列化的数据字段追加到 out：一次算好总长，payload 为空时写 fallback
+void appendEnvelope(const google::protobuf::Message& envelope, int data_field, const google::protobuf::Message* payload,
+                    const std::vector<uint8_t>& fallback, Buffer& out) {
+    using google::protobuf::internal::WireFormatLite;
+    using google::protobuf::io::CodedOutputStream;
+
+    size_t envelope_size = envelope.ByteSizeLong();
+    size_t data_size = payload ? payload->ByteSizeLong() : fallback.size();
+    size_t data_field_size = 0;
+    if (data_size > 0) {
+        data_field_size = CodedOutputStream::VarintSize32(static_cast<uint32_t>(data_field << 3))
+                        + CodedOutputStream::VarintSize32(static_cast<uint32_t>(data_size)) + data_size;
+    }
+    if (envelope_size + data_field_size > static_cast<size_t>(INT_MAX)) {
+        throw std::runtime_error(envelope.GetTypeName() + " too large");
+    }
+
+    out.ensureWritableBytes(envelope_size + data_field_size);
+    uint8_t* start = out.beginWrite();
+    uint8_t* target = envelope.SerializeWithCachedSizesToArray(start);
+    if (data_size > 0) {
+        target = WireFormatLite::WriteTagToArray(data_field, WireFormatLite::WIRETYPE_LENGTH_DELIMITED, target);
+        target = CodedOutputStream::WriteVarint32ToArray(static_cast<uint32_t>(data_size), target);
+        if (payload) {
+            target = payload->SerializeWithCachedSizesToArray(target);
+        } else {
+            std::memcpy(target, fallback.data(), data_size);
+            target += data_size;
+        }
+    }
+    out.hasWritten(static_cast<size_t>(target - start));
+}
+
+// 在链式缓冲区上构造 CodedInputStream 交给 fn：多段时每段一个 ArrayInputStream 串起来，不拼成连续内存
+template<typename Fn>
+bool withCodedInput(const IoBuf& data, Fn&& fn) {
+    if (data.isContiguous()) {
+        google::protobuf::io::CodedInputStream input(data.peek(), static_cast<int>(data.readableBytes()));
+        return fn(input);
+    }
+    std::deque<google::protobuf::io::ArrayInputStream> segments;
+    data.forEachSlice([&segments](const uint8_t* slice, size_t length) {
+        segments.emplace_back(slice, static_cast<int>(length));
+    });
+    std::vector<google::protobuf::io::ZeroCopyInputStream*> streams;
+    streams.reserve(segments.size());
+    for (auto& segment : segments) {
+        streams.push_back(&segment);
+    }
+    google::protobuf::io::ConcatenatingInputStream stream(streams.data(), static_cast<int>(streams.size()));
+    google::protobuf::io::CodedInputStream input(&stream);
+    return fn(input);
+}
+
+// 解析信封：data_field 以外的字段原样转写后交给 envelope 解析，data_field 只记下位置（相对输入开头）和长度，字节不拷出
+bool parseEnvelope(google::protobuf::io::CodedInputStream& input, int data_field, google::protobuf::Message& envelope,
+                   int& data_offset, int& data_length) {
+    using google::protobuf::internal::WireFormatLite;
+
+    data_offset = 0;
+    data_length = 0;
+    std::string fields;
+    {
+        google::protobuf::io::StringOutputStream fields_stream(&fields);
+        google::protobuf::io::CodedOutputStream fields_output(&fields_stream);
+        while (uint32_t tag = input.ReadTag()) {
+            if (WireFormatLite::GetTagFieldNumber(tag) == data_field &&
+                WireFormatLite::GetTagWireType(tag) == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+                uint32_t length = 0;
+                if (!input.ReadVarint32(&length)) {
+                    return false;
+                }
+                data_offset = input.CurrentPosition();
+                data_length = static_cast<int>(length);
+                if (!input.Skip(data_length)) {
+                    return false;
+                }
+                continue;
+            }
+            if (!WireFormatLite::SkipField(&input, tag, &fields_output)) {
+                return false;
+            }
+        }
+        if (!input.ConsumedEntireMessage()) {
+            return false;
+        }
+    }
+    return envelope.ParseFromString(fields);
+}
+
+} // namespace
+
 // 将RpcRequest序列化为字节数组
 std::vector<uint8_t> RpcProtocolHelper::serializeRequest(const RpcRequest& request) {
     // 创建RpcRequestProto消息，序列化为字符串
@@ -20,6 +140,15 @@ std::vector<uint8_t> RpcProtocolHelper::serializeRequest(const RpcRequest& reque
     return std::vector<uint8_t>(serialized.begin(), serialized.end());
 }
 
+// 将RpcRequest直接序列化到out末尾：请求消息原地写成 request_data 字段
+void RpcProtocolHelper::serializeRequest(const RpcRequest& request, const google::protobuf::Message* payload, Buffer& out) {
+    RpcRequestProto envelope;
+    envelope.set_request_id(request.request_id);
+    envelope.set_service_name(request.service_name);
+    envelope.set_method_name(request.method_name);
+    appendEnvelope(envelope, RpcRequestProto::kRequestDataFieldNumber, payload, request.request_data, out);
+}
+
 // 将字节数组反序列化为RpcRequest
 RpcRequest RpcProtocolHelper::parseRequest(const std::vector<uint8_t>& data) {
     if (data.empty()) {
@@ -36,6 +165,46 @@ RpcRequest RpcProtocolHelper::parseRequest(const std::vector<uint8_t>& data) {
     return fromRequestProto(proto);
 }
 
+// 将链式缓冲区反序列化为RpcRequest
+RpcRequest RpcProtocolHelper::parseRequest(const IoBuf& data) {
+    if (data.empty()) {
+        throw std::runtime_error("Empty data for request parsing");
+    }
+
+    RpcRequestProto proto;
+    if (!parseMessage(data, proto)) {
+        throw std::runtime_error("Failed to parse RpcRequestProto");
+    }
+
+    return fromRequestProto(proto);
+}
+
+// 解析请求信封，request_data 以切片交出
+bool RpcProtocolHelper::parseRequestEnvelope(const IoBuf& data, RpcRequestProto& envelope, IoBuf& payload) {
+    int data_offset = 0;
+    int data_length = 0;
+    bool parsed = withCodedInput(data, [&](google::protobuf::io::CodedInputStream& input) {
+        return parseEnvelope(input, RpcRequestProto::kRequestDataFieldNumber, envelope, data_offset, data_length);
+    });
+    if (!parsed) {
+        return false;
+    }
+    payload = data;
+    payload.retrieve(static_cast<size_t>(data_offset));
+    payload = payload.cutFront(static_cast<size_t>(data_length));
+    return true;
+}
+
+// 从链式缓冲区解析消息
+bool RpcProtocolHelper::parseMessage(const IoBuf& data, google::protobuf::Message& message) {
+    if (data.isContiguous()) {
+        return message.ParseFromArray(data.peek(), static_cast<int>(data.readableBytes()));
+    }
+    return withCodedInput(data, [&message](google::protobuf::io::CodedInputStream& input) {
+        return message.ParseFromCodedStream(&input);
+    });
+}
+
 // 将RpcResponse序列化为字节数组
 std::vector<uint8_t> RpcProtocolHelper::serializeResponse(const RpcResponse& response) {
     // 创建RpcResponseProto消息，序列化为字符串
@@ -51,6 +220,159 @@ std::vector<uint8_t> RpcProtocolHelper::serializeResponse(const RpcResponse& res
     return std::vector<uint8_t>(serialized.begin(), serialized.end());
 }
 
+// 直接序列化到Buffer：先写不含 response_data 的信封，再手写 response_data 字段（tag + 长度 + 内容），
+// protobuf 解析时字段顺序无关，结果与 SerializeToString 的输出等价
+void RpcProtocolHelper::serializeResponse(const RpcResponse& response, const google::protobuf::Message* payload, Buffer& out) {
+    appendEnvelope(createResponseEnvelope(response), RpcResponseProto::kResponseDataFieldNumber,
+                   payload, response.response_data, out);
+}
+
+// 带帧头的请求：帧头 + 请求消息
+void RpcProtocolHelper::serializeFramedRequest(const FrameHeader& header, const google::protobuf::Message& request, Buffer& out) {
+    size_t size = request.ByteSizeLong();
+    if (size > static_cast<size_t>(INT_MAX)) {
+        throw std::runtime_error("Request message too large");
+    }
+    out.ensureWritableBytes(header.header_length + size);
+    uint8_t* start = out.beginWrite();
+    header.encode(start);
+    std::memset(start + FrameHeader::kSize, 0, header.header_length - FrameHeader::kSize);
+    uint8_t* end = request.SerializeWithCachedSizesToArray(start + header.header_length);
+    out.hasWritten(static_cast<size_t>(end - start));
+}
+
+// 带帧头的响应：帧头 + 响应消息 / 错误信息
+void RpcProtocolHelper::serializeFramedResponse(const RpcResponse& response, const google::protobuf::Message* payload,
+                                                uint32_t method_id, Buffer& out) {
+    FrameHeader header;
+    header.flags = FrameHeader::kFlagResponse | (response.success ? 0 : FrameHeader::kFlagError);
+    header.request_id = response.request_id;
+    header.method_id = method_id;
+
+    if (!response.success) {
+        out.ensureWritableBytes(FrameHeader::kSize + response.error_message.size());
+        header.encode(out.beginWrite());
+        out.hasWritten(FrameHeader::kSize);
+        out.append(response.error_message);
+        return;
+    }
+
+    size_t size = payload ? payload->ByteSizeLong() : response.response_data.size();
+    if (size > static_cast<size_t>(INT_MAX)) {
+        throw std::runtime_error("Response message too large");
+    }
+    out.ensureWritableBytes(FrameHeader::kSize + size);
+    uint8_t* start = out.beginWrite();
+    header.encode(start);
+    uint8_t* target = start + FrameHeader::kSize;
+    if (payload) {
+        target = payload->SerializeWithCachedSizesToArray(target);
+    } else {
+        std::memcpy(target, response.response_data.data(), size);
+        target += size;
+    }
+    out.hasWritten(static_cast<size_t>(target - start));
+}
+
+// 解析带帧头的响应帧体
+RpcResponse RpcProtocolHelper::parseFramedResponse(const std::vector<uint8_t>& data) {
+    FrameHeader header;
+    if (!header.decode(data.data(), data.size())) {
+        throw std::runtime_error("Invalid frame header");
+    }
+    if (header.version != FrameHeader::kVersion || !(header.flags & FrameHeader::kFlagResponse)) {
+        throw std::runtime_error("Unexpected frame version or type");
+    }
+
+    RpcResponse response;
+    response.request_id = header.request_id;
+    response.success = !(header.flags & FrameHeader::kFlagError);
+    const uint8_t* body = data.data() + header.header_length;
+    size_t body_length = data.size() - header.header_length;
+    if (response.success) {
+        response.response_data.assign(body, body + body_length);
+    } else {
+        response.error_message.assign(reinterpret_cast<const char*>(body), body_length);
+    }
+    return response;
+}
+
+// 解析带帧头的响应帧体，响应消息直接从帧内解析
+RpcResponse RpcProtocolHelper::parseFramedResponse(const uint8_t* data, size_t length, google::protobuf::Message* payload) {
+    FrameHeader header;
+    if (!header.decode(data, length)) {
+        throw std::runtime_error("Invalid frame header");
+    }
+    if (header.version != FrameHeader::kVersion || !(header.flags & FrameHeader::kFlagResponse)) {
+        throw std::runtime_error("Unexpected frame version or type");
+    }
+
+    RpcResponse response;
+    response.request_id = header.request_id;
+    response.success = !(header.flags & FrameHeader::kFlagError);
+    const uint8_t* body = data + header.header_length;
+    size_t body_length = length - header.header_length;
+    if (!response.success) {
+        response.error_message.assign(reinterpret_cast<const char*>(body), body_length);
+    } else if (payload && !payload->ParseFromArray(body, static_cast<int>(body_length))) {
+        throw std::runtime_error("Failed to parse response message");
+    }
+    return response;
+}
+
+// 解析响应信封，响应消息直接从帧内解析
+RpcResponse RpcProtocolHelper::parseResponse(const uint8_t* data, size_t length, google::protobuf::Message* payload) {
+    if (length == 0 || length > static_cast<size_t>(INT_MAX)) {
+        throw std::runtime_error("Invalid data for response parsing");
+    }
+
+    RpcResponseProto envelope;
+    int data_offset = 0;
+    int data_length = 0;
+    google::protobuf::io::CodedInputStream input(data, static_cast<int>(length));
+    if (!parseEnvelope(input, RpcResponseProto::kResponseDataFieldNumber, envelope, data_offset, data_length)) {
+        throw std::runtime_error("Failed to parse RpcResponseProto");
+    }
+
+    RpcResponse response;
+    response.request_id = envelope.request_id();
+    response.success = envelope.success();
+    response.error_message = envelope.error_message();
+    if (response.success && payload && !payload->ParseFromArray(data + data_offset, data_length)) {
+        throw std::runtime_error("Failed to parse response message");
+    }
+    return response;
+}
+
+// 只取响应的请求 ID：request_id 缺省（proto3 不写 0）时为 0
+bool RpcProtocolHelper::peekResponseId(const uint8_t* data, size_t length, uint64_t& request_id) {
+    using google::protobuf::internal::WireFormatLite;
+
+    request_id = 0;
+    if (FrameHeader::detect(data, length)) {
+        FrameHeader header;
+        if (!header.decode(data, length)) {
+            return false;
+        }
+        request_id = header.request_id;
+        return true;
+    }
+    if (length > static_cast<size_t>(INT_MAX)) {
+        return false;
+    }
+    google::protobuf::io::CodedInputStream input(data, static_cast<int>(length));
+    while (uint32_t tag = input.ReadTag()) {
+        if (WireFormatLite::GetTagFieldNumber(tag) == RpcResponseProto::kRequestIdFieldNumber &&
+            WireFormatLite::GetTagWireType(tag) == WireFormatLite::WIRETYPE_VARINT) {
+            return input.ReadVarint64(&request_id);
+        }
+        if (!WireFormatLite::SkipField(&input, tag)) {
+            return false;
+        }
+    }
+    return input.ConsumedEntireMessage();
+}
+
 // 将字节数组反序列化为RpcResponse
 RpcResponse RpcProtocolHelper::parseResponse(const std::vector<uint8_t>& data) {
     if (data.empty()) {
@@ -96,20 +418,8 @@ RpcRequest RpcProtocolHelper::fromRequestProto(const RpcRequestProto& proto) {
 
 // 创建 RpcResponseProto 消息
 RpcResponseProto RpcProtocolHelper::createResponseProto(const RpcResponse& response) {
-    RpcResponseProto proto;
-
-    proto.set_request_id(response.request_id);
-    proto.set_success(response.success);
+    RpcResponseProto proto = createResponseEnvelope(response);
     proto.set_response_data(response.response_data.data(), response.response_data.size());
-
-    // 设置错误细腻
-    if (!response.success) {
-        proto.set_error_code(static_cast<int32_t>(RpcErrorCode::SERVER_ERROR));
-        proto.set_error_message(response.error_message);
-    } else {
-        proto.set_error_code(static_cast<int32_t>(RpcErrorCode::SUCCESS));
-    }
-
     return proto;
 }
 
@@ -0,0 +1,317 @@
+#include "slab_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace rpc {
+
+namespace {
+
+// 空闲块里直接存放下一个空闲块的地址
+struct FreeNode {
+    FreeNode* next;
+};
+
+struct FreeList {
+    FreeNode* head = nullptr;
+    size_t length = 0;
+
+    void push(void* ptr) {
+        FreeNode* node = static_cast<FreeNode*>(ptr);
+        node->next = head;
+        head = node;
+        ++length;
+    }
+
+    void* pop() {
+        FreeNode* node = head;
+        head = node->next;
+        --length;
+        return node;
+    }
+};
+
+constexpr size_t kMaxBatchCount = 32; // 一次搬运的最大块数
+
+std::atomic<size_t> g_max_thread_cache_bytes(SlabPool::kDefaultMaxThreadCacheBytes);
+
+// size 所在的规格
+int classIndex(size_t size) {
+    if (size <= SlabPool::kMinClassSize) {
+        return 0;
+    }
+    int bits = 64 - __builtin_clzll(static_cast<unsigned long long>(size - 1));
+    return bits - 6;
+}
+
+size_t classSize(int index) {
+    return SlabPool::kMinClassSize << index;
+}
+
+// 一次搬运的块数
+size_t batchCount(int index) {
+    size_t count = SlabPool::kBatchBytes / classSize(index);
+    return std::max<size_t>(1, std::min(count, kMaxBatchCount));
+}
+
+class ThreadCache;
+
+// 全局空闲链表：线程缓存之间的中转站
+class CentralCache {
+public:
+    // 故意不析构：其他线程或静态对象可能在退出阶段还在释放内存
+    static CentralCache& instance() {
+        static CentralCache* central = new CentralCache();
+        return *central;
+    }
+
+    // 取最多 count 块放进 list，返回实际取到的块数
+    size_t fetch(int index, size_t count, FreeList& list) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t moved = 0;
+        while (moved < count && lists_[index].length > 0) {
+            list.push(lists_[index].pop());
+            ++moved;
+        }
+        bytes_ -= moved * classSize(index);
+        return moved;
+    }
+
+    // 从 list 还回 count 块，全局链表放不下的还给系统
+    void put(int index, FreeList& list, size_t count) {
+        size_t size = classSize(index);
+        std::vector<void*> overflow;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < count; ++i) {
+                void* ptr = list.pop();
+                if (bytes_ + size <= SlabPool::kMaxCentralBytes) {
+                    lists_[index].push(ptr);
+                    bytes_ += size;
+                } else {
+                    overflow.push_back(ptr);
+                }
+            }
+        }
+        for (void* ptr : overflow) {
+            ::operator delete(ptr);
+        }
+    }
+
+    void registerCache(ThreadCache* cache) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        caches_.push_back(cache);
+    }
+
+    void unregisterCache(ThreadCache* cache, uint64_t hits, uint64_t misses) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        caches_.erase(std::remove(caches_.begin(), caches_.end(), cache), caches_.end());
+        retired_hits_ += hits;
+        retired_misses_ += misses;
+    }
+
+    // 没有线程缓存可用时（线程正在退出）的计数
+    void count(bool hit) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (hit) {
+            ++retired_hits_;
+        } else {
+            ++retired_misses_;
+        }
+    }
+
+    SlabPoolStats stats();
+
+private:
+    std::mutex mutex_;
+    FreeList lists_[SlabPool::kClassCount];
+    size_t bytes_ = 0;
+    std::vector<ThreadCache*> caches_;
+    uint64_t retired_hits_ = 0;   // 已退出线程及无缓存路径的命中数
+    uint64_t retired_misses_ = 0;
+
+    CentralCache() = default;
+};
+
+// 线程缓存：只有所属线程读写空闲链表，计数器供其他线程读统计
+class ThreadCache {
+public:
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<size_t> held_bytes;
+
+    ThreadCache() : hits(0), misses(0), held_bytes(0), held_(0) {
+        CentralCache::instance().registerCache(this);
+    }
+
+    ~ThreadCache() {
+        flushAll();
+        CentralCache::instance().unregisterCache(this, hits.load(std::memory_order_relaxed),
+                                                 misses.load(std::memory_order_relaxed));
+    }
+
+    void* allocate(int index) {
+        FreeList& list = lists_[index];
+        if (list.length == 0) {
+            size_t batch = g_max_thread_cache_bytes.load(std::memory_order_relaxed) > 0 ? batchCount(index) : 1;
+            size_t moved = CentralCache::instance().fetch(index, batch, list);
+            if (moved == 0) {
+                countMiss();
+                return ::operator new(classSize(index));
+            }
+            setHeld(held_ + moved * classSize(index));
+        }
+        countHit();
+        setHeld(held_ - classSize(index));
+        return list.pop();
+    }
+
+    void deallocate(void* ptr, int index) {
+        FreeList& list = lists_[index];
+        list.push(ptr);
+        setHeld(held_ + classSize(index));
+
+        size_t limit = g_max_thread_cache_bytes.load(std::memory_order_relaxed);
+        if (held_ <= limit) {
+            return;
+        }
+        // 超过上限：先把这一级还回一半（至少一批），仍然超出就全部交回
+        size_t count = std::min(list.length, std::max(list.length / 2, batchCount(index)));
+        release(index, count);
+        if (held_ > limit) {
+            flushAll();
+        }
+    }
+
+    void flushAll() {
+        for (int i = 0; i < SlabPool::kClassCount; ++i) {
+            if (lists_[i].length > 0) {
+                release(i, lists_[i].length);
+            }
+        }
+    }
+
+    void countHit() {
+        hits.store(hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void countMiss() {
+        misses.store(misses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+private:
+    FreeList lists_[SlabPool::kClassCount];
+    size_t held_; // 空闲链表上的总字节数
+
+    void release(int index, size_t count) {
+        CentralCache::instance().put(index, lists_[index], count);
+        setHeld(held_ - count * classSize(index));
+    }
+
+    void setHeld(size_t bytes) {
+        held_ = bytes;
+        held_bytes.store(bytes, std::memory_order_relaxed);
+    }
+};
+
+SlabPoolStats CentralCache::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SlabPoolStats stats;
+    stats.hits = retired_hits_;
+    stats.misses = retired_misses_;
+    stats.central_bytes = bytes_;
+    stats.thread_caches = caches_.size();
+    for (ThreadCache* cache : caches_) {
+        stats.hits += cache->hits.load(std::memory_order_relaxed);
+        stats.misses += cache->misses.load(std::memory_order_relaxed);
+        stats.thread_cache_bytes += cache->held_bytes.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+// 线程退出时析构的缓存在这之后置位，之后的分配/释放直接走全局链表
+thread_local bool tls_cache_destroyed = false;
+
+struct ThreadCacheHolder {
+    ThreadCache cache;
+
+    ~ThreadCacheHolder() {
+        tls_cache_destroyed = true;
+    }
+};
+
+ThreadCache* localCache() {
+    if (tls_cache_destroyed) {
+        return nullptr;
+    }
+    static thread_local ThreadCacheHolder holder;
+    return &holder.cache;
+}
+
+} // namespace
+
+void* SlabPool::allocate(size_t size) {
+    ThreadCache* cache = localCache();
+    if (size > kMaxClassSize) {
+        if (cache) {
+            cache->countMiss();
+        } else {
+            CentralCache::instance().count(false);
+        }
+        return ::operator new(size);
+    }
+    int index = classIndex(size);
+    if (cache) {
+        return cache->allocate(index);
+    }
+    FreeList list;
+    bool hit = CentralCache::instance().fetch(index, 1, list) == 1;
+    CentralCache::instance().count(hit);
+    return hit ? list.pop() : ::operator new(classSize(index));
+}
+
+void SlabPool::deallocate(void* ptr, size_t size) {
+    if (ptr == nullptr) {
+        return;
+    }
+    if (size > kMaxClassSize) {
+        ::operator delete(ptr);
+        return;
+    }
+    int index = classIndex(size);
+    ThreadCache* cache = localCache();
+    if (cache) {
+        cache->deallocate(ptr, index);
+        return;
+    }
+    FreeList list;
+    list.push(ptr);
+    CentralCache::instance().put(index, list, 1);
+}
+
+void SlabPool::setMaxThreadCacheBytes(size_t bytes) {
+    g_max_thread_cache_bytes.store(bytes, std::memory_order_relaxed);
+}
+
+size_t SlabPool::getMaxThreadCacheBytes() {
+    return g_max_thread_cache_bytes.load(std::memory_order_relaxed);
+}
+
+void SlabPool::flushThreadCache() {
+    ThreadCache* cache = localCache();
+    if (cache) {
+        cache->flushAll();
+    }
+}
+
+SlabPoolStats SlabPool::getStats() {
+    return CentralCache::instance().stats();
+}
+
+size_t SlabPool::roundUp(size_t size) {
+    return size > kMaxClassSize ? size : classSize(classIndex(size));
+}
+
+} // namespace rpc
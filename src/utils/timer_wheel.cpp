@@ -0,0 +1,176 @@
+#include "timer_wheel.h"
+#include <chrono>
+
+namespace rpc {
+
+TimerWheel::TimerWheel(uint32_t tick_ms, uint64_t start_ms)
+    : tick_ms_(tick_ms > 0 ? tick_ms : kDefaultTickMs),
+      start_ms_(start_ms),
+      current_tick_(0) {
+    levels_[0].resize(size_t(1) << kRootBits);
+    for (int level = 1; level < kLevelCount; ++level) {
+        levels_[level].resize(size_t(1) << kLevelBits);
+    }
+}
+
+// 添加定时器
+TimerWheel::TimerId TimerWheel::addTimer(uint64_t delay_ms, Callback callback, uint64_t now_ms) {
+    uint64_t elapsed_ms = now_ms > start_ms_ ? now_ms - start_ms_ : 0;
+    // 回调里添加时以正在处理的 tick 为起点（时钟不会早于已经处理过的 tick）
+    if (current_tick_ > 0 && elapsed_ms < (current_tick_ - 1) * tick_ms_) {
+        elapsed_ms = (current_tick_ - 1) * tick_ms_;
+    }
+    uint64_t now_tick = elapsed_ms / tick_ms_;
+    // 没有定时器时直接把时间轮拨到现在，之后的 advance 不用逐个处理空闲期间的 tick
+    if (timers_.empty() && now_tick > current_tick_) {
+        current_tick_ = now_tick;
+    }
+    uint64_t expire_tick = (elapsed_ms + delay_ms + tick_ms_ - 1) / tick_ms_;  // 向上取整，保证不早于 delay_ms 到期
+    if (expire_tick <= now_tick) {
+        expire_tick = now_tick + 1;
+    }
+    TimerNode node;
+    node.expire_tick = expire_tick;
+    node.callback = std::move(callback);
+    TimerId timer_id = timers_.insert(std::move(node));
+    place(timer_id, expire_tick);
+    return timer_id;
+}
+
+// 取消定时器：只删除节点，槽里的句柄到期时自然失效
+bool TimerWheel::cancelTimer(TimerId timer_id) {
+    return timers_.remove(timer_id);
+}
+
+// 推进时间轮
+size_t TimerWheel::advance(uint64_t now_ms) {
+    if (now_ms < start_ms_) {
+        return 0;
+    }
+    uint64_t target_tick = (now_ms - start_ms_) / tick_ms_;
+    size_t fired = 0;
+    while (current_tick_ <= target_tick) {
+        fired += processTick();
+    }
+    return fired;
+}
+
+// 距离下一次需要 advance 的毫秒数
+int64_t TimerWheel::nextTimeoutMs(uint64_t now_ms) const {
+    if (timers_.empty()) {
+        return -1;
+    }
+    // 在第 0 层本圈剩余的槽里找第一个非空槽，找不到就等到下一次下放
+    const size_t root_size = levels_[0].size();
+    uint64_t ticks = root_size - slotIndex(0, current_tick_);
+    for (uint64_t i = 0; i < ticks; ++i) {
+        if (!levels_[0][slotIndex(0, current_tick_ + i)].empty()) {
+            ticks = i;
+            break;
+        }
+    }
+    uint64_t due_ms = start_ms_ + (current_tick_ + ticks) * tick_ms_;
+    return due_ms > now_ms ? static_cast<int64_t>(due_ms - now_ms) : 0;
+}
+
+// 未到期的定时器个数
+size_t TimerWheel::size() const {
+    return timers_.size();
+}
+
+bool TimerWheel::empty() const {
+    return timers_.empty();
+}
+
+// 获取精度
+uint32_t TimerWheel::getTickMs() const {
+    return tick_ms_;
+}
+
+// 单调时钟毫秒数
+uint64_t TimerWheel::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 按到期 tick 放入合适的层和槽
+void TimerWheel::place(TimerId timer_id, uint64_t expire_tick) {
+    if (expire_tick < current_tick_) {
+        expire_tick = current_tick_;
+    }
+    uint64_t delta = expire_tick - current_tick_;
+    int shift = kRootBits;
+    for (int level = 0; level < kLevelCount; ++level) {
+        if (delta < (uint64_t(1) << shift)) {
+            levels_[level][slotIndex(level, expire_tick)].push_back(timer_id);
+            return;
+        }
+        shift += kLevelBits;
+    }
+    // 超出时间轮范围：先放到最高层最远的槽，下放时会按真实到期时间重新放置
+    uint64_t farthest = current_tick_ + (uint64_t(1) << (shift - kLevelBits)) - 1;
+    levels_[kLevelCount - 1][slotIndex(kLevelCount - 1, farthest)].push_back(timer_id);
+}
+
+// 把某层某槽的定时器重新放置到更低的层
+void TimerWheel::cascade(int level, size_t index) {
+    std::vector<TimerId> bucket;
+    bucket.swap(levels_[level][index]);
+    for (TimerId timer_id : bucket) {
+        TimerNode* node = timers_.get(timer_id);
+        if (node != nullptr) {  // 已取消的直接丢弃
+            place(timer_id, node->expire_tick);
+        }
+    }
+}
+
+// 处理一个 tick
+size_t TimerWheel::processTick() {
+    uint64_t tick = current_tick_;
+
+    // 第 0 层转满一圈，逐层下放
+    if (slotIndex(0, tick) == 0) {
+        for (int level = 1; level < kLevelCount; ++level) {
+            size_t index = slotIndex(level, tick);
+            cascade(level, index);
+            if (index != 0) {
+                break;
+            }
+        }
+    }
+
+    // 回调里可能添加新定时器，先把当前槽取出来
+    std::vector<TimerId> bucket;
+    bucket.swap(levels_[0][slotIndex(0, tick)]);
+    current_tick_ = tick + 1;
+
+    size_t fired = 0;
+    for (TimerId timer_id : bucket) {
+        TimerNode* node = timers_.get(timer_id);
+        if (node == nullptr) {
+            continue;  // 已取消
+        }
+        if (node->expire_tick > tick) {
+            place(timer_id, node->expire_tick);  // 超出范围被提前放入的定时器
+            continue;
+        }
+        TimerNode expired;
+        timers_.remove(timer_id, &expired);
+        if (expired.callback) {
+            expired.callback();
+        }
+        ++fired;
+    }
+    return fired;
+}
+
+// 某层槽位下标
+size_t TimerWheel::slotIndex(int level, uint64_t tick) {
+    if (level == 0) {
+        return static_cast<size_t>(tick & ((uint64_t(1) << kRootBits) - 1));
+    }
+    int shift = kRootBits + (level - 1) * kLevelBits;
+    return static_cast<size_t>((tick >> shift) & ((uint64_t(1) << kLevelBits) - 1));
+}
+
+} // namespace rpc
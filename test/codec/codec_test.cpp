@@ -1,6 +1,18 @@
 #include "../../include/frame_codec.h"
 #include "../../include/message_handler.h"
+#include "../../include/io_buf.h"
+#include "../../include/slab_pool.h"
+#include "../../include/buffer.h"
+#include "../../include/read_sizer.h"
+#include "../../include/rpc_protocol_helper.h"
+#include "../../include/transport.h"
+#include "../../include/frame_header.h"
+#include <unistd.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <iostream>
+#include <thread>
 
 using namespace rpc;
 
@@ -41,7 +53,448 @@ void testFramCodecAndMessageHandle(){
 
 }
 
+// 链式缓冲区：跨块追加、跨段读整数、零拷贝切帧、块回收、从 fd 读取
+void testIoBuf() {
+    std::cout << "\n=== 测试链式缓冲区 IoBuf ===" << std::endl;
+    const size_t block_size = IoBufBlockPool::kBlockSize;
+
+    {
+        // 跨块追加：已有数据不搬移，多出的部分挂到新块上
+        IoBuf buf;
+        std::vector<uint8_t> first(block_size - 2, 'a');
+        buf.append(first);
+        const uint8_t* head = buf.peek();
+        uint8_t header[4] = {0x00, 0x00, 0x01, 0x02};
+        buf.append(header, sizeof(header));
+        assert(buf.peek() == head);
+        assert(buf.sliceCount() == 2);
+        assert(buf.readableBytes() == block_size + 2);
+
+        // 长度字段横跨两块也能读出
+        buf.retrieve(block_size - 2);
+        assert(buf.peekInt<uint32_t>() == 0x0102);
+        assert(!buf.isContiguous());
+        assert(buf.coalesce() != nullptr && buf.isContiguous());
+        assert(buf.peekInt<uint32_t>() == 0x0102);
+    }
+
+    {
+        // 切出的帧与原缓冲区共享块，原缓冲区继续读写不影响帧内容
+        IoBuf buf;
+        buf.append(std::string("hello world"));
+        const uint8_t* head = buf.peek();
+        IoBuf frame = buf.cutFront(5);
+        assert(frame.peek() == head);
+        assert(frame.toString() == "hello");
+        assert(buf.toString() == " world");
+        buf.append(std::string("!!"));
+        buf.retrieveAll();
+        assert(frame.toString() == "hello");
+
+        IoBuf copy = frame;
+        assert(copy.peek() == frame.peek());
+        frame.retrieveAll();
+        assert(copy.toString() == "hello");
+    }
+    // 上面的块（及段队列的存储）全部释放后留在本线程缓存里，再分配直接命中
+    SlabPoolStats before = SlabPool::getStats();
+    assert(before.thread_cache_bytes >= IoBufBlockPool::kBlockAllocSize);
+    {
+        IoBuf buf;
+        buf.append(std::string("reuse"));
+        SlabPoolStats during = SlabPool::getStats();
+        assert(during.hits > before.hits && during.misses == before.misses);
+        assert(during.thread_cache_bytes <= before.thread_cache_bytes - IoBufBlockPool::kBlockAllocSize);
+    }
+    assert(SlabPool::getStats().thread_cache_bytes == before.thread_cache_bytes);
+
+    {
+        // 超过定长的数据用一个大块装下
+        IoBuf buf;
+        std::vector<uint8_t> large(block_size * 3 + 7, 'z');
+        buf.append(large);
+        assert(buf.isContiguous());
+        assert(buf.toVector() == large);
+        assert(buf.retrieveAsVector(block_size).size() == block_size);
+        assert(buf.readableBytes() == block_size * 2 + 7);
+    }
+
+    {
+        // readFromFd 一次读入多块
+        int fds[2];
+        assert(pipe(fds) == 0);
+        std::vector<uint8_t> payload(block_size + 100);
+        for (size_t i = 0; i < payload.size(); ++i) {
+            payload[i] = static_cast<uint8_t>(i);
+        }
+        assert(write(fds[1], payload.data(), payload.size()) == static_cast<ssize_t>(payload.size()));
+        IoBuf buf;
+        buf.append(std::string("x"));
+        int saved_errno = 0;
+        size_t total = 0;
+        while (total < payload.size()) {
+            ssize_t n = buf.readFromFd(fds[0], &saved_errno);
+            assert(n > 0);
+            total += static_cast<size_t>(n);
+        }
+        buf.retrieve(1);
+        assert(buf.toVector() == payload);
+        close(fds[0]);
+        close(fds[1]);
+    }
+    std::cout << "✓ IoBuf 测试通过" << std::endl;
+}
+
+// 线程本地块池：规格取整、命中计数、跨线程释放、线程缓存上限
+void testSlabPool() {
+    std::cout << "\n=== 测试线程本地块池 SlabPool ===" << std::endl;
+    assert(SlabPool::roundUp(1) == 64);
+    assert(SlabPool::roundUp(65) == 128);
+    assert(SlabPool::roundUp(16 * 1024) == 16 * 1024);
+    assert(SlabPool::roundUp(SlabPool::kMaxClassSize + 1) == SlabPool::kMaxClassSize + 1);
+
+    SlabPool::flushThreadCache();
+    void* first = SlabPool::allocate(1000);
+    SlabPool::deallocate(first, 1000);
+    SlabPoolStats before = SlabPool::getStats();
+    void* second = SlabPool::allocate(900);  // 同一规格，从线程缓存拿回同一块
+    assert(second == first);
+    assert(SlabPool::getStats().hits == before.hits + 1);
+    SlabPool::deallocate(second, 900);
+
+    // 其他线程分配、本线程释放：进本线程的缓存，超过上限后交回全局链表
+    const int count = 64;
+    std::vector<void*> blocks(count);
+    std::thread producer([&blocks]() {
+        for (auto& block : blocks) {
+            block = SlabPool::allocate(4096);
+        }
+    });
+    producer.join();
+    size_t old_limit = SlabPool::getMaxThreadCacheBytes();
+    SlabPool::setMaxThreadCacheBytes(16 * 4096);
+    for (void* block : blocks) {
+        SlabPool::deallocate(block, 4096);
+    }
+    SlabPoolStats after = SlabPool::getStats();
+    assert(after.thread_cache_bytes <= 16 * 4096 + 4096);
+    assert(after.central_bytes >= (count - 17) * 4096);
+    SlabPool::setMaxThreadCacheBytes(old_limit);
+
+    // Buffer 的存储同样走块池
+    {
+        Buffer buffer;
+        buffer.append(std::string(5000, 'b'));
+        assert(buffer.readableBytes() == 5000);
+    }
+    std::cout << "hits=" << after.hits << " misses=" << after.misses
+              << " thread_cache_bytes=" << after.thread_cache_bytes
+              << " central_bytes=" << after.central_bytes << std::endl;
+    std::cout << "✓ SlabPool 测试通过" << std::endl;
+}
+
+// 自适应读取大小：读满翻倍，连续两次不到一半才减半，半帧的预留随已到达的字节增长；Buffer 按给定大小直接读入
+void testAdaptiveReadSizer() {
+    std::cout << "\n=== 测试自适应读取大小 ===" << std::endl;
+    AdaptiveReadSizer sizer;
+    size_t initial = sizer.next();
+    sizer.record(initial);
+    assert(sizer.next() == initial * 2);
+    for (int i = 0; i < 20; ++i) {
+        sizer.record(sizer.next());
+    }
+    assert(sizer.next() == AdaptiveReadSizer::kMaxReadSize);
+
+    sizer.record(100);
+    assert(sizer.next() == AdaptiveReadSizer::kMaxReadSize);  // 一次偏小不收缩
+    sizer.record(100);
+    assert(sizer.next() == AdaptiveReadSizer::kMaxReadSize / 2);
+    for (int i = 0; i < 40; ++i) {
+        sizer.record(1);
+    }
+    assert(sizer.next() == AdaptiveReadSizer::kMinReadSize);
+
+    // 不完整的帧：小帧预留剩余部分；10MB 的帧只到了帧长时预留不超过 kMaxReadSize，之后随已到达的字节翻倍
+    const size_t max_read = AdaptiveReadSizer::kMaxReadSize;
+    assert(sizer.nextForFrame(4 + 1000, 4) == 1000);
+    assert(sizer.nextForFrame(4 + 100, 4 + 100) == AdaptiveReadSizer::kMinReadSize);
+    const size_t huge = 4 + 10 * 1024 * 1024;
+    assert(sizer.nextForFrame(huge, 4) == max_read);
+    assert(sizer.nextForFrame(huge, max_read) == max_read);
+    assert(sizer.nextForFrame(huge, 2 * max_read) == 2 * max_read);
+    assert(sizer.nextForFrame(huge, huge - 1000) == 1000);
+
+    int fds[2];
+    assert(pipe(fds) == 0);
+    std::vector<uint8_t> payload(100 * 1024, 'r');
+    std::thread writer([&]() {
+        assert(write(fds[1], payload.data(), payload.size()) == static_cast<ssize_t>(payload.size()));
+    });
+    Buffer buffer;
+    int saved_errno = 0;
+    while (buffer.readableBytes() < payload.size()) {
+        assert(buffer.readFromFd(fds[0], &saved_errno, 64 * 1024) > 0);
+    }
+    writer.join();
+    assert(buffer.retrieveAllAsVector() == payload);
+    close(fds[0]);
+    close(fds[1]);
+    std::cout << "✓ 自适应读取大小测试通过" << std::endl;
+}
+
+// 响应直接序列化进 Buffer：字节与原 serializeResponse 一致，帧头写进预留空间
+void testResponseEncode() {
+    std::cout << "\n=== 测试响应原地编码 ===" << std::endl;
+    RpcRequestProto payload;
+    payload.set_request_id(42);
+    payload.set_service_name("UserService");
+    payload.set_request_data(std::string(3000, 'x'));
+
+    RpcResponse response;
+    response.request_id = 7;
+    response.success = true;
+    std::string payload_bytes = payload.SerializeAsString();
+    response.response_data.assign(payload_bytes.begin(), payload_bytes.end());
+    std::vector<uint8_t> legacy = RpcProtocolHelper::serializeResponse(response);
+
+    // payload 原地序列化 / 使用 response_data，两条路径都与原实现逐字节相同
+    RpcResponse envelope = response;
+    envelope.response_data.clear();
+    Buffer direct;
+    RpcProtocolHelper::serializeResponse(envelope, &payload, direct);
+    assert(direct.readableBytes() == legacy.size());
+    assert(std::memcmp(direct.peek(), legacy.data(), legacy.size()) == 0);
+
+    Buffer copied;
+    RpcProtocolHelper::serializeResponse(response, nullptr, copied);
+    assert(copied.readableBytes() == legacy.size());
+    assert(std::memcmp(copied.peek(), legacy.data(), legacy.size()) == 0);
+
+    // 长度前缀写进预留头部，正文不动
+    const uint8_t* body = direct.peek();
+    FrameCodec codec;
+    codec.encode(direct);
+    assert(direct.peek() + 4 == body);
+    assert(direct.readableBytes() == legacy.size() + 4);
+    assert(direct.peekInt<uint32_t>() == legacy.size());
+    direct.retrieve(4);
+    RpcResponse parsed = RpcProtocolHelper::parseResponse(direct.retrieveAllAsVector());
+    assert(parsed.request_id == 7 && parsed.success);
+    assert(parsed.response_data == response.response_data);
+
+    // 错误响应没有 response_data
+    RpcResponse error;
+    error.request_id = 9;
+    error.success = false;
+    error.error_message = "boom";
+    Buffer error_frame;
+    RpcProtocolHelper::serializeResponse(error, nullptr, error_frame);
+    assert(error_frame.retrieveAllAsVector() == RpcProtocolHelper::serializeResponse(error));
+    std::cout << "✓ 响应原地编码测试通过" << std::endl;
+}
+
+// 流式解码：一批流水线帧逐帧以视图取出，半包、逐字节到达与非法长度
+void testStreamingDecode() {
+    std::cout << "\n=== 测试流式解码 ===" << std::endl;
+    FrameCodec codec;
+    Buffer stream;
+    const int kFrames = 1000;
+    for (int i = 0; i < kFrames; ++i) {
+        std::vector<uint8_t> body(1 + i % 100, static_cast<uint8_t>(i));
+        std::vector<uint8_t> frame = codec.encode(body);
+        stream.append(frame);
+    }
+    const uint8_t* begin = stream.peek();
+    for (int i = 0; i < kFrames; ++i) {
+        const uint8_t* body = nullptr;
+        size_t length = 0;
+        assert(codec.decode(stream, body, length) == FrameStatus::kComplete);
+        assert(length == static_cast<size_t>(1 + i % 100));
+        assert(body[0] == static_cast<uint8_t>(i) && body[length - 1] == static_cast<uint8_t>(i));
+        assert(body > begin);  // 视图指向原缓冲区，没有搬动数据
+    }
+    assert(stream.readableBytes() == 0);
+
+    // 逐字节到达：MessageHandler 只在帧完整时回调
+    std::vector<std::vector<uint8_t>> messages;
+    MessageHandler handler(std::make_unique<FrameCodec>(),
+        [&messages](std::shared_ptr<TcpConnection>, const std::vector<uint8_t>& message) {
+            messages.push_back(message);
+        });
+    std::vector<uint8_t> wire;
+    for (int i = 0; i < 3; ++i) {
+        std::vector<uint8_t> frame = codec.encode(std::vector<uint8_t>(10 + i, 'a' + i));
+        wire.insert(wire.end(), frame.begin(), frame.end());
+    }
+    for (uint8_t byte : wire) {
+        handler.handleData(nullptr, std::vector<uint8_t>(1, byte));
+    }
+    assert(messages.size() == 3);
+    assert(messages[2] == std::vector<uint8_t>(12, 'c'));
+
+    // 非法长度与半包
+    Buffer bad;
+    bad.appendInt<uint32_t>(0);
+    uint32_t length = 0;
+    assert(FrameCodec::inspect(bad, length) == FrameStatus::kInvalid);
+    Buffer partial;
+    partial.appendInt<uint32_t>(8);
+    partial.append("abc", 3);
+    std::vector<uint8_t> message;
+    assert(codec.decode(partial, message) == FrameStatus::kIncomplete);
+    assert(partial.readableBytes() == 7);
+    std::cout << "✓ 流式解码测试通过" << std::endl;
+}
+
+// 定长帧头：编解码、与旧格式区分、带帧头的请求/响应
+void testFrameHeader() {
+    std::cout << "\n=== 测试定长帧头 ===" << std::endl;
+    FrameHeader header;
+    header.flags = FrameHeader::kFlagResponse;
+    header.request_id = 0x0102030405060708ULL;
+    header.method_id = 3;
+    header.deadline_ms = 250;
+    uint8_t bytes[FrameHeader::kSize];
+    header.encode(bytes);
+    assert(bytes[0] == 0xF7 && bytes[1] == 0x52);
+
+    FrameHeader decoded;
+    assert(decoded.decode(bytes, sizeof(bytes)));
+    assert(decoded.version == FrameHeader::kVersion && decoded.flags == FrameHeader::kFlagResponse);
+    assert(decoded.request_id == header.request_id && decoded.method_id == header.method_id);
+    assert(decoded.deadline_ms == 250 && decoded.header_length == FrameHeader::kSize);
+    assert(!decoded.decode(bytes, FrameHeader::kSize - 1));
+
+    // 旧格式的帧体（RpcRequestProto）不会被当成帧头
+    RpcRequest legacy;
+    legacy.request_id = 0xF752;
+    legacy.service_name = "CalculatorService";
+    legacy.method_name = "Add";
+    std::vector<uint8_t> legacy_body = RpcProtocolHelper::serializeRequest(legacy);
+    assert(!FrameHeader::detect(legacy_body.data(), legacy_body.size()));
+
+    // 带帧头的请求：链式缓冲区里取出帧头后，剩下的就是请求消息
+    RpcRequestProto message;
+    message.set_service_name("payload");
+    Buffer request_frame;
+    RpcProtocolHelper::serializeFramedRequest(header, message, request_frame);
+    IoBuf body;
+    body.append(request_frame.peek(), request_frame.readableBytes());
+    assert(FrameHeader::detect(body));
+    FrameHeader request_header;
+    assert(request_header.decode(body));
+    body.retrieve(request_header.header_length);
+    RpcRequestProto parsed_message;
+    assert(RpcProtocolHelper::parseMessage(body, parsed_message));
+    assert(parsed_message.service_name() == "payload");
+
+    // 带帧头的响应：成功带响应消息，失败带错误信息
+    RpcResponse ok;
+    ok.request_id = 11;
+    ok.success = true;
+    Buffer ok_frame;
+    RpcProtocolHelper::serializeFramedResponse(ok, &message, header.method_id, ok_frame);
+    RpcResponse ok_parsed = RpcProtocolHelper::parseFramedResponse(ok_frame.retrieveAllAsVector());
+    assert(ok_parsed.success && ok_parsed.request_id == 11);
+    assert(ok_parsed.response_data.size() == message.ByteSizeLong());
+
+    RpcResponse failed;
+    failed.request_id = 12;
+    failed.error_message = "Method not found";
+    Buffer failed_frame;
+    RpcProtocolHelper::serializeFramedResponse(failed, nullptr, header.method_id, failed_frame);
+    RpcResponse failed_parsed = RpcProtocolHelper::parseFramedResponse(failed_frame.retrieveAllAsVector());
+    assert(!failed_parsed.success && failed_parsed.request_id == 12);
+    assert(failed_parsed.error_message == "Method not found");
+
+    // 方法目录握手：响应消息体是带方法 ID 的 MethodDirectoryProto
+    MethodDirectoryProto directory;
+    directory.set_service_name("CalculatorService");
+    (*directory.mutable_method_ids())["Add"] = 0;
+    (*directory.mutable_method_ids())["Sub"] = 1;
+    Buffer directory_frame;
+    RpcProtocolHelper::serializeFramedResponse(ok, &directory, 0, directory_frame);
+    RpcResponse directory_response = RpcProtocolHelper::parseFramedResponse(directory_frame.retrieveAllAsVector());
+    MethodDirectoryProto parsed_directory;
+    assert(parsed_directory.ParseFromArray(directory_response.response_data.data(), directory_response.response_data.size()));
+    assert(parsed_directory.method_ids().at("Sub") == 1 && parsed_directory.method_ids().size() == 2);
+    std::cout << "✓ 定长帧头测试通过" << std::endl;
+}
+
+// 信封单次解析：请求/响应消息原地写进信封，解析时 request_data / response_data 不拷出
+void testInPlaceEnvelope() {
+    std::cout << "\n=== 测试信封原地编解码 ===" << std::endl;
+    RpcRequestProto payload;
+    payload.set_service_name("payload");
+    payload.set_request_data(std::string(3000, 'x'));
+
+    RpcRequest request;
+    request.request_id = 21;
+    request.service_name = "CalculatorService";
+    request.method_name = "Add";
+    Buffer request_frame;
+    RpcProtocolHelper::serializeRequest(request, &payload, request_frame);
+
+    // 与旧的序列化结果逐字节一致，旧版本服务端照常解析
+    request.request_data.resize(payload.ByteSizeLong());
+    payload.SerializeToArray(request.request_data.data(), static_cast<int>(request.request_data.size()));
+    std::vector<uint8_t> legacy_frame = RpcProtocolHelper::serializeRequest(request);
+    assert(legacy_frame == std::vector<uint8_t>(request_frame.peek(), request_frame.peek() + request_frame.readableBytes()));
+
+    // 帧体跨多个块：信封照常解析，request_data 以切片交出
+    IoBuf body;
+    for (size_t offset = 0; offset < legacy_frame.size(); offset += 1000) {
+        IoBuf piece;
+        piece.append(legacy_frame.data() + offset, std::min<size_t>(1000, legacy_frame.size() - offset));
+        body.append(std::move(piece));
+    }
+    assert(!body.isContiguous());
+    RpcRequestProto envelope;
+    IoBuf request_data;
+    assert(RpcProtocolHelper::parseRequestEnvelope(body, envelope, request_data));
+    assert(envelope.request_id() == 21 && envelope.method_name() == "Add" && envelope.request_data().empty());
+    assert(request_data.readableBytes() == payload.ByteSizeLong());
+    RpcRequestProto parsed_payload;
+    assert(RpcProtocolHelper::parseMessage(request_data, parsed_payload));
+    assert(parsed_payload.request_data() == payload.request_data());
+
+    // 响应：响应消息从帧体原地解析
+    RpcResponse response;
+    response.request_id = 22;
+    response.success = true;
+    Buffer response_frame;
+    RpcProtocolHelper::serializeResponse(response, &payload, response_frame);
+    RpcRequestProto parsed_response;
+    RpcResponse parsed = RpcProtocolHelper::parseResponse(response_frame.peek(), response_frame.readableBytes(), &parsed_response);
+    assert(parsed.success && parsed.request_id == 22 && parsed.response_data.empty());
+    assert(parsed_response.request_data() == payload.request_data());
+
+    // 只取请求 ID（客户端先据此找到在途调用）：旧格式扫信封，带帧头读帧头；请求 ID 为 0 时信封不写该字段
+    uint64_t request_id = 0;
+    assert(RpcProtocolHelper::peekResponseId(response_frame.peek(), response_frame.readableBytes(), request_id));
+    assert(request_id == 22);
+    RpcResponse failure;
+    failure.error_message = "Failed to parse request";
+    Buffer failure_frame;
+    RpcProtocolHelper::serializeResponse(failure, nullptr, failure_frame);
+    assert(RpcProtocolHelper::peekResponseId(failure_frame.peek(), failure_frame.readableBytes(), request_id));
+    assert(request_id == 0);
+    response.request_id = 23;
+    Buffer framed_frame;
+    RpcProtocolHelper::serializeFramedResponse(response, &payload, 5, framed_frame);
+    assert(RpcProtocolHelper::peekResponseId(framed_frame.peek(), framed_frame.readableBytes(), request_id));
+    assert(request_id == 23);
+    std::cout << "✓ 信封原地编解码测试通过" << std::endl;
+}
+
 int main() {
     testFramCodecAndMessageHandle();
+    testIoBuf();
+    testSlabPool();
+    testAdaptiveReadSizer();
+    testResponseEncode();
+    testStreamingDecode();
+    testFrameHeader();
+    testInPlaceEnvelope();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,254 @@
+// 协程接口测试：需要 C++20（cmake -DENABLE_COROUTINES=ON 时编译为 coroutine_test）
+#include "../../include/rpc_coroutine.h"
+#include "../../include/rpc_client.h"
+#include "../../include/rpc_serser.h"
+#include "../../proto/calculator.pb.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using namespace rpc;
+
+// 不走网络的 stub：ready 时 tryAsyncCallMethod 在调用线程里直接完成；否则只能经 asyncCallMethod 发出
+class FakeStub : public RpcClientStub {
+public:
+    explicit FakeStub(bool ready) : ready_(ready), issued_on_caller_(0), issued_elsewhere_(0) {}
+
+    bool callMethod(const std::string&, const google::protobuf::Message&, google::protobuf::Message&) override {
+        return false;
+    }
+
+    void asyncCallMethod(const std::string& method_name, const google::protobuf::Message&,
+                         google::protobuf::Message*, CallCallback done) override {
+        if (std::this_thread::get_id() != caller_) {
+            issued_elsewhere_++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20)); // 模拟建连，协程此时早已挂起
+        }
+        done(method_name == "Ok", method_name == "Ok" ? "" : "fake failure");
+    }
+
+    bool tryAsyncCallMethod(const std::string& method_name, const google::protobuf::Message&,
+                            google::protobuf::Message*, CallCallback done) override {
+        if (!ready_) {
+            return false;
+        }
+        issued_on_caller_++;
+        done(method_name == "Ok", method_name == "Ok" ? "" : "fake failure");
+        return true;
+    }
+
+    void setCaller(std::thread::id caller) { caller_ = caller; }
+
+    bool ready_;
+    std::thread::id caller_;
+    std::atomic<int> issued_on_caller_;
+    std::atomic<int> issued_elsewhere_;
+};
+
+Task<int> awaitTwice(RpcClientStub& stub) {
+    AddRequest request;
+    AddResponse response;
+    int succeeded = 0;
+    bool first = co_await awaitCall(stub, "Ok", request, &response);
+    succeeded += first ? 1 : 0;
+    bool second = co_await awaitCall(stub, "Fail", request, &response);
+    succeeded += second ? 1 : 0;
+    co_return succeeded;
+}
+
+Task<void> runAwaitTwice(RpcClientStub& stub, std::promise<int>& result) {
+    int succeeded = co_await awaitTwice(stub);
+    result.set_value(succeeded);
+}
+
+void testCompletedBeforeSuspend() {
+    std::cout << "\n=== 测试发出前就完成的调用 ===" << std::endl;
+
+    // 回调在 await_suspend 返回之前就执行：协程不挂起，spawn 返回时已经跑完
+    FakeStub stub(true);
+    stub.setCaller(std::this_thread::get_id());
+    std::promise<int> result;
+    std::future<int> future = result.get_future();
+    spawn(runAwaitTwice(stub, result));
+    assert(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    assert(future.get() == 1);
+    assert(stub.issued_on_caller_.load() == 2 && stub.issued_elsewhere_.load() == 0);
+    std::cout << "✓ 连接就绪时在当前线程发出，完成早于挂起时协程直接继续" << std::endl;
+
+    // 不能马上发出的调用换到 blockingCallPool 发出
+    FakeStub cold(false);
+    cold.setCaller(std::this_thread::get_id());
+    std::promise<int> cold_result;
+    std::future<int> cold_future = cold_result.get_future();
+    spawn(runAwaitTwice(cold, cold_result));
+    assert(cold_future.wait_for(std::chrono::seconds(3)) == std::future_status::ready);
+    assert(cold_future.get() == 1);
+    assert(cold.issued_elsewhere_.load() == 2);
+    std::cout << "✓ 需要建连的调用不在协程所在线程发出" << std::endl;
+}
+
+// 把任务排进队列，由测试线程执行
+class QueueExecutor {
+public:
+    void post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    // 执行一个任务，timeout 内没有返回 false
+    bool runOne(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, timeout, [this]() { return !tasks_.empty(); })) {
+            return false;
+        }
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        task();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+};
+
+Task<void> recordResumeThread(RpcClientStub& stub, std::thread::id& resumed_on, bool& finished) {
+    AddRequest request;
+    AddResponse response;
+    bool ok = co_await awaitCall(stub, "Ok", request, &response);
+    assert(ok);
+    resumed_on = std::this_thread::get_id();
+    finished = true;
+}
+
+void testResumeOnExecutor() {
+    std::cout << "\n=== 测试在执行器上恢复 ===" << std::endl;
+
+    // 调用在 blockingCallPool 的线程里完成，协程仍回到 spawn 时给的执行器上恢复
+    FakeStub stub(false);
+    stub.setCaller(std::this_thread::get_id());
+    QueueExecutor queue;
+    std::thread::id resumed_on;
+    bool finished = false;
+    spawn(recordResumeThread(stub, resumed_on, finished), [&queue](std::function<void()> task) { queue.post(std::move(task)); });
+    assert(!finished);
+    assert(queue.runOne(std::chrono::seconds(3)));
+    assert(finished && resumed_on == std::this_thread::get_id());
+    std::cout << "✓ 协程在执行器所在的线程恢复" << std::endl;
+}
+
+// 下游：返回 a + b
+class BackendCalculator : public CalculatorService {
+public:
+    void Add(google::protobuf::RpcController*, const AddRequest* request, AddResponse* response,
+             google::protobuf::Closure* done) override {
+        response->set_result(request->a() + request->b());
+        done->Run();
+    }
+};
+
+// 前端：协程里连续两次 co_await 下游，第二次发生在 I/O 线程上；a 为负数时抛异常
+class CoroutineFront : public CalculatorService {
+public:
+    explicit CoroutineFront(RpcClientStub& backend) : backend_(backend) {}
+
+    void Add(google::protobuf::RpcController* controller, const AddRequest* request, AddResponse* response,
+             google::protobuf::Closure* done) override {
+        runCoroutine(controller, done, forward(request, response));
+    }
+
+    std::atomic<int> resumed_off_worker{0};
+
+private:
+    RpcClientStub& backend_;
+
+    Task<void> forward(const AddRequest* request, AddResponse* response) {
+        if (request->a() < 0) {
+            throw std::runtime_error("negative operand");
+        }
+        std::thread::id worker = std::this_thread::get_id();
+        AddResponse partial;
+        bool first = co_await awaitCall(backend_, "Add", *request, &partial);
+        if (!first) {
+            throw std::runtime_error("backend call failed");
+        }
+        if (std::this_thread::get_id() != worker) {
+            resumed_off_worker++;
+        }
+        AddRequest again;
+        again.set_a(partial.result());
+        again.set_b(request->b());
+        bool second = co_await awaitCall(backend_, "Add", again, response);
+        if (!second) {
+            throw std::runtime_error("backend call failed");
+        }
+    }
+};
+
+void testCoroutineServiceHandler() {
+    std::cout << "\n=== 测试协程服务方法 ===" << std::endl;
+
+    BackendCalculator backend_service;
+    RpcServerConfig backend_config;
+    backend_config.host = "127.0.0.1";
+    backend_config.port = 8910;
+    backend_config.thread_pool_size = 1;
+    backend_config.enable_registry = false;
+    RpcServer backend(backend_config);
+    backend.registerService(&backend_service);
+    assert(backend.start());
+
+    // 下游 stub 还没连接：第一次调用的建连与握手交给 blockingCallPool，不在服务端线程里做
+    RpcClientStubImpl backend_stub("CalculatorService", "127.0.0.1", 8910);
+    CoroutineFront front_service(backend_stub);
+    RpcServerConfig front_config = backend_config;
+    front_config.port = 8911;
+    RpcServer front(front_config);
+    front.registerService(&front_service);
+    assert(front.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    RpcClientStubImpl client("CalculatorService", "127.0.0.1", 8911);
+    AddRequest request;
+    request.set_a(1);
+    request.set_b(2);
+    AddResponse response;
+    assert(client.callMethod("Add", request, response) && response.result() == 5);
+    assert(client.callMethod("Add", request, response) && response.result() == 5);
+    // 第一次要先建连，必然挂起后在 I/O 线程恢复；第二次连接已就绪，回复赶在挂起之前到达时直接在工作线程里继续
+    assert(front_service.resumed_off_worker.load() >= 1);
+    std::cout << "✓ co_await 下游后在 I/O 线程恢复，两次下游调用结果正确" << std::endl;
+
+    // 协程抛出的异常作为错误响应回给客户端
+    request.set_a(-1);
+    assert(!client.callMethod("Add", request, response));
+    std::cout << "✓ 协程抛出异常时客户端收到失败" << std::endl;
+
+    client.disconnect();
+    front.stop();
+    backend_stub.disconnect();
+    backend.stop();
+}
+
+int main() {
+    // 线程池在第一次换线程发出调用时按设置的线程数创建，之后不能再改
+    assert(setBlockingCallThreads(3));
+    testCompletedBeforeSuspend();
+    testResumeOnExecutor();
+    testCoroutineServiceHandler();
+    assert(!setBlockingCallThreads(4) && detail::blockingCallPool().getThreadCount() == 3);
+    std::cout << "\n协程接口测试通过" << std::endl;
+    return 0;
+}
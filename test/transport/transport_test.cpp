@@ -1,6 +1,16 @@
 #include "../../include/tcp_server.h"
 #include "../../include/tcp_client.h"
 #include "../../include/tcp_connection.h"
+#include "../../include/slot_map.h"
+#include "../../include/timer_wheel.h"
+#include "../../include/io_uring_ring.h"
+#include "../../include/shm_server.h"
+#include "../../include/client_connection.h"
+#include "../../include/connection_pool.h"
+#include "../../include/rpc_client.h"
+#include "../../include/rpc_serser.h"
+#include "../../proto/calculator.pb.h"
+#include "../../include/rpc_protocol_helper.h"
 #include <iostream>          // 输入输出流头文件
 #include <thread>            // 线程相关头文件
 #include <chrono>            // 时间相关头文件
@@ -8,6 +18,15 @@
 #include <vector>            // 向量容器头文件
 #include <string>            // 字符串头文件
 #include <atomic>            // 原子操作头文件
+#include <mutex>             // 互斥锁头文件
+#include <future>            // promise / future
+#include <sys/stat.h>        // stat
+#include <sys/mman.h>        // memfd_create
+#include <fcntl.h>           // memfd 封条
+#include <unistd.h>          // dup / ftruncate / pread
+#include <sys/socket.h>      // 只 listen 不 accept 的服务端
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 using namespace rpc;
 
@@ -85,6 +104,17 @@ void testServerClientConnection() {
     assert(ret);
     std::cout << "✓ 客户端发送消息成功" << std::endl;
 
+    // 服务器不回复：receive 等到接收超时返回 false，连接仍可用
+    client->setReceiveTimeout(50);
+    const uint8_t* reply = nullptr;
+    size_t reply_length = 0;
+    auto wait_begin = std::chrono::steady_clock::now();
+    assert(!client->receive(reply, reply_length));
+    auto waited_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - wait_begin).count();
+    assert(waited_ms >= 40 && waited_ms < 1000);
+    assert(client->getState() == ConnectionState::CONNECTED);
+    std::cout << "✓ 没有数据时 receive 在接收超时后返回（" << waited_ms << "ms）" << std::endl;
+
     // 断开客户端连接
     client->disconnect();
     assert(client->getState() == ConnectionState::DISCONNECTED);
@@ -152,12 +182,1386 @@ void testConcurrentConnections() {
     std::cout << "并发连接测试通过" << std::endl;
 }
 
+// 测试多 reactor：连接按轮询分配到各 I/O 循环，消息在各自循环中解码
+void testMultiReactor() {
+    std::cout << "\n=== 测试多 Reactor ===" << std::endl;
+
+    TcpServerConfig config;
+    config.io_thread_count = 4;
+    auto server = std::make_unique<TcpServerImpl>(config);
+
+    std::atomic<int> message_count{0};
+    server->setConnectionCallback([&message_count](std::shared_ptr<TcpConnection> conn) {
+        conn->setMessageCallback([&message_count](std::shared_ptr<TcpConnection>, const std::vector<uint8_t>& data) {
+            if (std::string(data.begin(), data.end()) == "ping") {
+                message_count++;
+            }
+        });
+    });
+    assert(server->start(8893, "127.0.0.1"));
+    assert(server->getIoLoopCount() == 4);
+    std::cout << "✓ 服务器启动成功，I/O 循环数: " << server->getIoLoopCount() << std::endl;
+
+    // 每个客户端发送一帧 "ping"
+    const int num_clients = 8;
+    FrameCodec codec;
+    std::string payload = "ping";
+    auto frame = codec.encode(std::vector<uint8_t>(payload.begin(), payload.end()));
+    std::vector<std::unique_ptr<TcpClient>> clients;
+    for (int i = 0; i < num_clients; ++i) {
+        std::unique_ptr<TcpClient> client = std::make_unique<TcpClientImpl>();
+        assert(client->connect("127.0.0.1", 8893));
+        assert(client->send(frame));
+        clients.push_back(std::move(client));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    // 每个循环分到相同数量的连接
+    assert(server->getConnectionCount() == num_clients);
+    for (size_t count : server->getLoopConnectionCounts()) {
+        assert(count == num_clients / 4);
+    }
+    assert(message_count.load() == num_clients);
+    std::cout << "✓ 连接均匀分配到各 I/O 循环，收到消息数: " << message_count.load() << std::endl;
+
+    clients.clear();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    assert(server->getConnectionCount() == 0);
+    server->stop();
+
+    g_stats.tests_passed++;
+    std::cout << "多 Reactor 测试通过" << std::endl;
+}
+
+// 测试 SO_REUSEPORT：每个 I/O 循环一个监听 socket，由内核分摊新连接
+void testReusePortListeners() {
+    std::cout << "\n=== 测试 SO_REUSEPORT 多监听 ===" << std::endl;
+
+    TcpServerConfig config;
+    config.io_thread_count = 4;
+    config.reuse_port = true;
+    config.listen_backlog = 4096;
+    auto server = std::make_unique<TcpServerImpl>(config);
+    assert(server->start(8894, "127.0.0.1"));
+    std::cout << "✓ 服务器启动成功（SO_REUSEPORT）" << std::endl;
+
+    // 一次性发起一批连接，模拟重连风暴
+    const int num_clients = 32;
+    std::vector<std::unique_ptr<TcpClient>> clients;
+    for (int i = 0; i < num_clients; ++i) {
+        std::unique_ptr<TcpClient> client = std::make_unique<TcpClientImpl>();
+        assert(client->connect("127.0.0.1", 8894));
+        clients.push_back(std::move(client));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    assert(server->getConnectionCount() == num_clients);
+    int busy_loops = 0;
+    for (size_t count : server->getLoopConnectionCounts()) {
+        if (count > 0) {
+            busy_loops++;
+        }
+    }
+    assert(busy_loops > 1);
+    std::cout << "✓ 所有连接均被接受，分布在 " << busy_loops << " 个循环上" << std::endl;
+
+    clients.clear();
+    server->stop();
+
+    g_stats.tests_passed++;
+    std::cout << "SO_REUSEPORT 多监听测试通过" << std::endl;
+}
+
+// 测试非阻塞写：对端不读时 send 立即返回，数据积压在输出缓冲区并触发高/低水位回调
+void testBufferedWriteWithWatermarks() {
+    std::cout << "\n=== 测试输出缓冲区与高低水位 ===" << std::endl;
+
+    auto server = std::make_unique<TcpServerImpl>();
+    std::atomic<int> high_water_count{0};
+    std::atomic<int> low_water_count{0};
+    std::shared_ptr<TcpConnection> server_conn;
+    std::mutex conn_mutex;
+    server->setConnectionCallback([&](std::shared_ptr<TcpConnection> conn) {
+        conn->setHighWaterMarkCallback([&high_water_count](std::shared_ptr<TcpConnection>, size_t) {
+            high_water_count++;
+        }, 1024 * 1024);
+        conn->setLowWaterMarkCallback([&low_water_count](std::shared_ptr<TcpConnection>) {
+            low_water_count++;
+        }, 0);
+        std::lock_guard<std::mutex> lock(conn_mutex);
+        server_conn = conn;
+    });
+    assert(server->start(8895, "127.0.0.1"));
+
+    std::unique_ptr<TcpClientImpl> client = std::make_unique<TcpClientImpl>();
+    assert(client->connect("127.0.0.1", 8895));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // 客户端暂不读取，服务器连续发送 8MB：send 不应阻塞
+    const size_t chunk_size = 256 * 1024;
+    const int chunks = 32;
+    std::vector<uint8_t> chunk(chunk_size, 'x');
+    auto begin = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(conn_mutex);
+        assert(server_conn);
+        for (int i = 0; i < chunks; ++i) {
+            assert(server_conn->send(chunk));
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+    assert(elapsed < 1000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));  // 等待 I/O 循环处理发送队列
+    assert(high_water_count.load() == 1);
+    std::cout << "✓ 对端不读时 send 未阻塞（" << elapsed << "ms），高水位回调已触发" << std::endl;
+
+    // 客户端读完全部数据，输出缓冲区由 EPOLLOUT 逐步清空
+    size_t total = 0;
+    std::vector<uint8_t> buf(64 * 1024);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (total < chunk_size * chunks && std::chrono::steady_clock::now() < deadline) {
+        ssize_t n = recv(client->getSocketFd(), buf.data(), buf.size(), 0);
+        if (n > 0) {
+            total += n;
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    assert(total == chunk_size * chunks);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(low_water_count.load() == 1);
+    std::cout << "✓ 收到全部 " << total << " 字节，低水位回调已触发" << std::endl;
+
+    {
+        std::lock_guard<std::mutex> lock(conn_mutex);
+        server_conn.reset();
+    }
+    client->disconnect();
+    server->stop();
+
+    g_stats.tests_passed++;
+    std::cout << "输出缓冲区与高低水位测试通过" << std::endl;
+}
+
+// 测试多个工作线程并发向同一连接发送：每一帧必须完整、不被其他帧穿插
+void testConcurrentSendsFromWorkers() {
+    std::cout << "\n=== 测试多线程并发发送 ===" << std::endl;
+
+    auto server = std::make_unique<TcpServerImpl>();
+    std::shared_ptr<TcpConnection> server_conn;
+    std::mutex conn_mutex;
+    server->setConnectionCallback([&](std::shared_ptr<TcpConnection> conn) {
+        std::lock_guard<std::mutex> lock(conn_mutex);
+        server_conn = conn;
+    });
+    assert(server->start(8896, "127.0.0.1"));
+
+    std::unique_ptr<TcpClientImpl> client = std::make_unique<TcpClientImpl>();
+    assert(client->connect("127.0.0.1", 8896));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::shared_ptr<TcpConnection> conn;
+    {
+        std::lock_guard<std::mutex> lock(conn_mutex);
+        conn = server_conn;
+    }
+    assert(conn);
+
+    // 每个线程发送内容全为自己编号的帧，长度各不相同
+    const int num_threads = 8;
+    const int frames_per_thread = 200;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < num_threads; ++t) {
+        workers.emplace_back([conn, t]() {
+            FrameCodec codec;
+            for (int i = 0; i < frames_per_thread; ++i) {
+                std::vector<uint8_t> payload(100 + (i * 37) % 3000, static_cast<uint8_t>('a' + t));
+                conn->send(codec.encode(payload));
+            }
+        });
+    }
+
+    // 客户端逐帧接收并校验
+    int received = 0;
+    bool all_intact = true;
+    while (received < num_threads * frames_per_thread) {
+        std::vector<uint8_t> frame;
+        if (!client->receive(frame)) {
+            break;
+        }
+        for (uint8_t byte : frame) {
+            if (byte != frame[0]) {
+                all_intact = false;
+            }
+        }
+        received++;
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    assert(all_intact);
+    assert(received == num_threads * frames_per_thread);
+    std::cout << "✓ 收到 " << received << " 帧，全部完整" << std::endl;
+
+    conn.reset();
+    {
+        std::lock_guard<std::mutex> lock(conn_mutex);
+        server_conn.reset();
+    }
+    client->disconnect();
+    server->stop();
+
+    g_stats.tests_passed++;
+    std::cout << "多线程并发发送测试通过" << std::endl;
+}
+
+// 测试读取预算：预算极小时，一次性灌入的大量帧仍会在后续轮次中全部读完（边沿触发不丢事件）
+void testReadBudgetDrainsPipelinedFrames() {
+    std::cout << "\n=== 测试读取预算与待读队列 ===" << std::endl;
+
+    TcpServerConfig config;
+    config.read_budget_bytes = 64;  // 每轮最多读 64 字节
+    config.read_budget_frames = 1;  // 每轮最多解码 1 帧
+    auto server = std::make_unique<TcpServerImpl>(config);
+    std::atomic<int> frames_received{0};
+    server->setConnectionCallback([&frames_received](std::shared_ptr<TcpConnection> conn) {
+        conn->setMessageCallback([&frames_received](std::shared_ptr<TcpConnection>, const std::vector<uint8_t>&) {
+            frames_received++;
+        });
+    });
+    assert(server->start(8897, "127.0.0.1"));
+
+    std::unique_ptr<TcpClientImpl> client = std::make_unique<TcpClientImpl>();
+    assert(client->connect("127.0.0.1", 8897));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // 一次写出 500 帧
+    const int frame_count = 500;
+    FrameCodec codec;
+    std::vector<uint8_t> batch;
+    for (int i = 0; i < frame_count; ++i) {
+        std::vector<uint8_t> frame = codec.encode(std::vector<uint8_t>(200, 'r'));
+        batch.insert(batch.end(), frame.begin(), frame.end());
+    }
+    assert(client->send(batch));
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (frames_received.load() < frame_count && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assert(frames_received.load() == frame_count);
+    std::cout << "✓ 预算为 1 帧/轮时仍收到全部 " << frames_received.load() << " 帧" << std::endl;
+
+    client->disconnect();
+    server->stop();
+
+    g_stats.tests_passed++;
+    std::cout << "读取预算测试通过" << std::endl;
+}
+
+// 测试帧数预算：一次读进来的多帧也按预算分轮解码，其他连接不用等它全部处理完
+void testFrameBudgetWithinOneRead() {
+    std::cout << "\n=== 测试一次读取内的帧数预算 ===" << std::endl;
+
+    TcpServerConfig config;
+    config.read_budget_frames = 1;  // 字节预算保持默认，一次读就能读进全部帧
+    auto server = std::make_unique<TcpServerImpl>(config);
+    std::atomic<int> connections{0};
+    std::atomic<int> bulk_received{0};
+    std::atomic<int> bulk_seen_by_other{-1};
+    server->setConnectionCallback([&](std::shared_ptr<TcpConnection> conn) {
+        if (conn->getState() != ConnectionState::CONNECTED) {
+            return;
+        }
+        if (connections++ == 0) {
+            // 第一个连接：每帧处理 1ms
+            conn->setMessageCallback([&bulk_received](std::shared_ptr<TcpConnection>, const std::vector<uint8_t>&) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                bulk_received++;
+            });
+        } else {
+            conn->setMessageCallback([&](std::shared_ptr<TcpConnection>, const std::vector<uint8_t>&) {
+                bulk_seen_by_other = bulk_received.load();
+            });
+        }
+    });
+    assert(server->start(8907, "127.0.0.1"));
+
+    auto bulk = std::make_unique<TcpClientImpl>();
+    assert(bulk->connect("127.0.0.1", 8907));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto other = std::make_unique<TcpClientImpl>();
+    assert(other->connect("127.0.0.1", 8907));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    const int frame_count = 200;
+    FrameCodec codec;
+    std::vector<uint8_t> batch;
+    for (int i = 0; i < frame_count; ++i) {
+        std::vector<uint8_t> frame = codec.encode(std::vector<uint8_t>(16, 'b'));
+        batch.insert(batch.end(), frame.begin(), frame.end());
+    }
+    assert(bulk->send(batch));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    assert(other->send(codec.encode(std::vector<uint8_t>(16, 'o'))));
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((bulk_received.load() < frame_count || bulk_seen_by_other.load() < 0) &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assert(bulk_received.load() == frame_count);
+    // 原先一次读进来的 200 帧在同一轮里全部解码，另一个连接要等约 200ms
+    assert(bulk_seen_by_other.load() >= 0 && bulk_seen_by_other.load() < frame_count);
+    std::cout << "✓ 另一个连接的帧在第 " << bulk_seen_by_other.load() << " 帧之后处理，缓冲区里剩下的帧在后续轮次解码完" << std::endl;
+
+    bulk->disconnect();
+    other->disconnect();
+    server->stop();
+
+    g_stats.tests_passed++;
+    std::cout << "帧数预算测试通过" << std::endl;
+}
+
+// 测试连接表：O(1) 插入/删除，槽位复用后旧句柄失效
+void testSlotMapGenerationHandles() {
+    std::cout << "\n=== 测试带代数的连接表 ===" << std::endl;
+
+    SlotMap<std::string> table;
+    uint64_t a = table.insert("a");
+    uint64_t b = table.insert("b");
+    assert(a != SlotMap<std::string>::kInvalidHandle && b != a);
+    assert(table.size() == 2);
+    assert(*table.get(a) == "a");
+
+    std::string removed;
+    assert(table.remove(a, &removed));
+    assert(removed == "a");
+    assert(table.get(a) == nullptr);
+    assert(!table.remove(a));
+
+    // 复用 a 的槽位，但代数不同，旧句柄仍然无效
+    uint64_t c = table.insert("c");
+    assert(static_cast<uint32_t>(c) == static_cast<uint32_t>(a));
+    assert(c != a);
+    assert(table.get(a) == nullptr);
+    assert(*table.get(c) == "c");
+    assert(table.get(SlotMap<std::string>::kInvalidHandle) == nullptr);
+    std::cout << "✓ 槽位复用后旧句柄失效" << std::endl;
+
+    // 大量插入后逆序删除
+    std::vector<uint64_t> handles;
+    for (int i = 0; i < 50000; ++i) {
+        handles.push_back(table.insert(std::to_string(i)));
+    }
+    for (auto it = handles.rbegin(); it != handles.rend(); ++it) {
+        assert(table.remove(*it));
+    }
+    assert(table.size() == 2);
+    table.clear();
+    assert(table.empty() && table.get(b) == nullptr);
+    std::cout << "✓ 50000 个句柄插入/删除完成" << std::endl;
+
+    g_stats.tests_passed++;
+    std::cout << "连接表测试通过" << std::endl;
+}
+
+// 测试时间轮：各层定时器按时到期，取消的不执行
+void testTimerWheel() {
+    std::cout << "\n=== 测试分层时间轮 ===" << std::endl;
+
+    const uint64_t start = 1000000;
+    TimerWheel wheel(10, start);
+    std::vector<uint64_t> fired_at;  // 每个定时器到期时 advance 推进到的时刻
+    uint64_t now = start;
+    auto record = [&fired_at, &now]() { fired_at.push_back(now); };
+
+    wheel.addTimer(25, record, start);                   // 第 0 层
+    wheel.addTimer(5000, record, start);               // 第 1 层（500 tick）
+    wheel.addTimer(3 * 60 * 1000, record, start);        // 第 2 层（18000 tick）
+    TimerWheel::TimerId cancelled = wheel.addTimer(100, [&fired_at]() { fired_at.push_back(0); }, start);
+    assert(wheel.size() == 4);
+    assert(wheel.cancelTimer(cancelled));
+    assert(!wheel.cancelTimer(cancelled));
+    assert(wheel.nextTimeoutMs(start) == 30);  // 第一个非空槽在第 3 个 tick
+
+    // 按 10ms 步进，模拟 timerfd 驱动
+    while (fired_at.size() < 3 && now < start + 4 * 60 * 1000) {
+        now += 10;
+        wheel.advance(now);
+    }
+    assert(fired_at.size() == 3);
+    assert(fired_at[0] >= start + 25 && fired_at[0] <= start + 40);
+    assert(fired_at[1] >= start + 5000 && fired_at[1] <= start + 5010);
+    assert(fired_at[2] >= start + 180000 && fired_at[2] <= start + 180010);
+    assert(wheel.empty() && wheel.nextTimeoutMs(now) == -1);
+    std::cout << "✓ 三层定时器按时到期，已取消的定时器未执行" << std::endl;
+
+    // 回调里添加新定时器，一次推进较长时间
+    int chain = 0;
+    std::function<void()> again = [&]() {
+        if (++chain < 5) {
+            wheel.addTimer(1000, again, now);
+        }
+    };
+    wheel.addTimer(1000, again, now);
+    wheel.advance(now + 10000);
+    assert(chain == 5);
+    std::cout << "✓ 回调中添加的定时器正常执行" << std::endl;
+
+    // 空闲一段时间（没有定时器，timerfd 不触发，也就没有 advance）后添加：按添加时刻计算到期时间
+    now += 10000;
+    assert(wheel.empty());
+    uint64_t idle_added = now + 60 * 1000;
+    bool idle_fired = false;
+    wheel.addTimer(5000, [&idle_fired]() { idle_fired = true; }, idle_added);
+    assert(wheel.advance(idle_added + 10) == 0 && !idle_fired);
+    assert(wheel.nextTimeoutMs(idle_added) > 0);
+    assert(wheel.advance(idle_added + 4990) == 0 && !idle_fired);
+    assert(wheel.advance(idle_added + 5000) == 1 && idle_fired);
+
+    // 已有定时器时 tick 可能落后（timerfd 只在最近的到期时刻触发）：新定时器同样从添加时刻算起
+    now = idle_added + 5000;
+    wheel.addTimer(2500, []() {}, now);
+    uint64_t lagging_added = now + 2000;
+    bool lagging_fired = false;
+    wheel.addTimer(1000, [&lagging_fired]() { lagging_fired = true; }, lagging_added);
+    assert(wheel.advance(lagging_added + 10) == 0 && !lagging_fired);
+    assert(wheel.advance(lagging_added + 990) == 1 && !lagging_fired);  // 只有 2500ms 的那个
+    assert(wheel.advance(lagging_added + 1000) == 1 && lagging_fired);
+    std::cout << "✓ 空闲或 tick 落后时添加的定时器不会提前到期" << std::endl;
+
+    g_stats.tests_passed++;
+    std::cout << "时间轮测试通过" << std::endl;
+}
+
+// 测试空闲连接超时：服务器关闭长时间没有数据的连接
+void testIdleConnectionTimeout() {
+    std::cout << "\n=== 测试空闲连接超时 ===" << std::endl;
+
+    TcpServerConfig config;
+    config.idle_timeout_ms = 300;
+    auto server = std::make_unique<TcpServerImpl>(config);
+    std::atomic<int> closed{0};
+    server->setConnectionCallback([&closed](std::shared_ptr<TcpConnection> conn) {
+        conn->setConnectionCallback([&closed](std::shared_ptr<TcpConnection> c) {
+            if (c->getState() == ConnectionState::DISCONNECTED) {
+                closed++;
+            }
+        });
+    });
+    assert(server->start(8898, "127.0.0.1"));
+
+    // 活跃客户端每 100ms 发一帧，空闲客户端什么也不发
+    std::unique_ptr<TcpClientImpl> active = std::make_unique<TcpClientImpl>();
+    std::unique_ptr<TcpClientImpl> idle = std::make_unique<TcpClientImpl>();
+    assert(active->connect("127.0.0.1", 8898));
+    assert(idle->connect("127.0.0.1", 8898));
+    FrameCodec codec;
+    std::vector<uint8_t> ping = codec.encode(std::vector<uint8_t>(8, 'p'));
+    for (int i = 0; i < 8; ++i) {
+        assert(active->send(ping));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    // 空闲连接已被关闭，活跃连接仍在
+    assert(server->getConnectionCount() == 1);
+    assert(closed.load() == 1);
+    char byte;
+    assert(recv(idle->getSocketFd(), &byte, 1, 0) == 0);  // 对端已关闭
+    std::cout << "✓ 空闲连接在超时后被关闭，活跃连接保持" << std::endl;
+
+    active->disconnect();
+    idle->disconnect();
+    server->stop();
+
+    g_stats.tests_passed++;
+    std::cout << "空闲连接超时测试通过" << std::endl;
+}
+
+// 测试 io_uring 后端：回显、流水线保序、大帧跨多个 provided buffer
+void testIoUringBackend() {
+    std::cout << "\n=== 测试 io_uring 后端 ===" << std::endl;
+
+    if (!IoUringRing::isSupported()) {
+        std::cout << "当前内核不支持 io_uring，跳过（工厂会退回 epoll）" << std::endl;
+        g_stats.tests_passed++;
+        return;
+    }
+
+    TcpServerConfig config;
+    config.io_thread_count = 2;
+    config.io_backend = "io_uring";
+    std::unique_ptr<TcpServer> server = createTcpServer(config);
+    FrameCodec codec;
+    server->setConnectionCallback([&codec](std::shared_ptr<TcpConnection> conn) {
+        conn->setMessageCallback([&codec](std::shared_ptr<TcpConnection> c, const std::vector<uint8_t>& data) {
+            c->send(codec.encode(data));  // 原样回显
+        });
+    });
+    assert(server->start(8899, "127.0.0.1"));
+
+    std::vector<std::thread> threads;
+    std::atomic<int> echoed{0};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t, &echoed]() {
+            FrameCodec client_codec;
+            std::shared_ptr<TcpClient> client = createTcpClient("io_uring");
+            assert(client->connect("127.0.0.1", 8899));
+
+            // 一问一答
+            for (int i = 0; i < 50; ++i) {
+                std::vector<uint8_t> payload(1 + (i * 37) % 512, static_cast<uint8_t>('a' + t));
+                assert(client->send(client_codec.encode(payload)));
+                std::vector<uint8_t> reply;
+                assert(client->receive(reply));
+                assert(reply == payload);
+                echoed++;
+            }
+
+            // 一次写出 100 帧，按序收回
+            std::vector<uint8_t> batch;
+            for (int i = 0; i < 100; ++i) {
+                std::vector<uint8_t> frame = client_codec.encode(std::vector<uint8_t>(8, static_cast<uint8_t>(i)));
+                batch.insert(batch.end(), frame.begin(), frame.end());
+            }
+            assert(client->send(batch));
+            for (int i = 0; i < 100; ++i) {
+                std::vector<uint8_t> reply;
+                assert(client->receive(reply));
+                assert(reply.size() == 8 && reply[0] == static_cast<uint8_t>(i));
+                echoed++;
+            }
+
+            // 1MB 大帧
+            std::vector<uint8_t> large(1024 * 1024, static_cast<uint8_t>(t));
+            assert(client->send(client_codec.encode(large)));
+            std::vector<uint8_t> reply;
+            assert(client->receive(reply));
+            assert(reply == large);
+            echoed++;
+
+            client->disconnect();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(echoed.load() == 4 * 151);
+    std::cout << "✓ 4 个客户端回显 " << echoed.load() << " 帧（含流水线与 1MB 大帧）" << std::endl;
+
+    server->stop();
+
+    g_stats.tests_passed++;
+    std::cout << "io_uring 后端测试通过" << std::endl;
+}
+
+// 测试 Unix 域套接字：unix:/path 与抽象命名空间，epoll 与 io_uring 两种后端
+void testUnixDomainSocket() {
+    std::cout << "\n=== 测试 Unix 域套接字 ===" << std::endl;
+
+    const std::string path = "/tmp/myrpc_transport_test.sock";
+    std::vector<std::string> backends = {"epoll"};
+    if (IoUringRing::isSupported()) {
+        backends.push_back("io_uring");
+    }
+    for (const std::string& backend : backends) {
+        for (const std::string& address : {"unix:" + path, std::string("unix:@myrpc_transport_test")}) {
+            TcpServerConfig config;
+            config.io_thread_count = 2;
+            config.io_backend = backend;
+            std::unique_ptr<TcpServer> server = createTcpServer(config);
+            FrameCodec codec;
+            std::string peer;
+            std::mutex peer_mutex;
+            server->setConnectionCallback([&](std::shared_ptr<TcpConnection> conn) {
+                {
+                    std::lock_guard<std::mutex> lock(peer_mutex);
+                    peer = conn->getRemoteAddress();
+                }
+                conn->setMessageCallback([&codec](std::shared_ptr<TcpConnection> c, const std::vector<uint8_t>& data) {
+                    c->send(codec.encode(data));
+                });
+            });
+            assert(server->start(0, address));
+
+            std::shared_ptr<TcpClient> client = createTcpClient(backend);
+            assert(client->connect(address, 0));
+            for (int i = 0; i < 20; ++i) {
+                std::vector<uint8_t> payload(64 + i, static_cast<uint8_t>(i));
+                assert(client->send(codec.encode(payload)));
+                std::vector<uint8_t> reply;
+                assert(client->receive(reply));
+                assert(reply == payload);
+            }
+            {
+                std::lock_guard<std::mutex> lock(peer_mutex);
+                assert(peer == address);  // 对端未绑定时用监听地址标识
+            }
+            client->disconnect();
+            server->stop();
+
+            struct stat st;
+            assert(stat(path.c_str(), &st) != 0);  // 停止后删除 socket 文件
+            std::cout << "✓ " << backend << " 后端经 " << address << " 回显 20 帧" << std::endl;
+        }
+    }
+
+    // 地址非法
+    SocketAddress invalid;
+    assert(!invalid.parse("unix:", 0));
+    assert(!invalid.parse("unix:/" + std::string(200, 'x'), 0));
+
+    g_stats.tests_passed++;
+    std::cout << "Unix 域套接字测试通过" << std::endl;
+}
+
+void testSharedMemoryTransport() {
+    std::cout << "\n=== 测试共享内存传输 ===" << std::endl;
+
+    // 环本身：部分写入与回绕
+    {
+        ShmRegion region;
+        assert(region.create(4096));
+        ShmRing& ring = region.getClientToServer();
+        std::vector<uint8_t> chunk(3000, 'a');
+        assert(ring.write(chunk.data(), chunk.size()) == 3000);
+        assert(ring.write(chunk.data(), chunk.size()) == 4096 - 3000);  // 环满，只写入一部分
+        Buffer out;
+        assert(ring.readInto(out) == 4096);
+        std::vector<uint8_t> wrapped(2500);
+        for (size_t i = 0; i < wrapped.size(); ++i) {
+            wrapped[i] = static_cast<uint8_t>(i);
+        }
+        assert(ring.write(wrapped.data(), wrapped.size()) == wrapped.size());  // 跨越环尾
+        Buffer in;
+        assert(ring.readInto(in) == static_cast<ssize_t>(wrapped.size()));
+        assert(in.retrieveAllAsVector() == wrapped);
+        assert(ring.prepareConsumerWait());  // 空环可以睡眠
+        ring.cancelConsumerWait();
+        assert(!region.create(5000));  // 容量必须是 2 的幂
+    }
+
+    // 服务端只接受大小已封死的 memfd：否则对端映射后缩小它，服务端访问环时 SIGBUS
+    {
+        ShmRegion client;
+        assert(client.create(4096));
+        const size_t region_size = 4096 + 2 * 4096;
+        assert(ftruncate(client.getFd(ShmRegion::kMemFd), 0) == -1);  // 封死后不能缩小
+        int fds[ShmRegion::kFdCount];
+        for (int i = 0; i < ShmRegion::kFdCount; ++i) {
+            fds[i] = dup(client.getFd(static_cast<ShmRegion::FdIndex>(i)));
+        }
+        ShmRegion accepted;
+        assert(accepted.attach(fds));
+
+        // 内容完全相同、但没有封条的 memfd 被拒绝
+        std::vector<char> contents(region_size);
+        assert(pread(client.getFd(ShmRegion::kMemFd), contents.data(), contents.size(), 0) ==
+               static_cast<ssize_t>(contents.size()));
+        int unsealed[ShmRegion::kFdCount];
+        for (int i = 0; i < ShmRegion::kFdCount; ++i) {
+            unsealed[i] = dup(client.getFd(static_cast<ShmRegion::FdIndex>(i)));
+        }
+        close(unsealed[ShmRegion::kMemFd]);
+        unsealed[ShmRegion::kMemFd] = memfd_create("unsealed", MFD_CLOEXEC);
+        assert(pwrite(unsealed[ShmRegion::kMemFd], contents.data(), contents.size(), 0) ==
+               static_cast<ssize_t>(contents.size()));
+        ShmRegion rejected;
+        assert(!rejected.attach(unsealed));
+
+        // 只有头页的区域（环容量 0）也被拒绝
+        int empty[ShmRegion::kFdCount];
+        for (int i = 0; i < ShmRegion::kFdCount; ++i) {
+            empty[i] = dup(client.getFd(static_cast<ShmRegion::FdIndex>(i)));
+        }
+        close(empty[ShmRegion::kMemFd]);
+        empty[ShmRegion::kMemFd] = memfd_create("empty", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        assert(pwrite(empty[ShmRegion::kMemFd], contents.data(), 4096, 0) == 4096);
+        assert(fcntl(empty[ShmRegion::kMemFd], F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == 0);
+        assert(!rejected.attach(empty));
+        std::cout << "✓ 拒绝未封大小的 memfd 与容量为 0 的区域" << std::endl;
+    }
+
+    const std::string path = "/tmp/myrpc_transport_test.shm";
+    const std::string address = "shm:" + path;
+    TcpServerConfig config;
+    config.io_thread_count = 2;
+    ShmTcpServer server(config);
+    FrameCodec codec;
+    server.setConnectionCallback([&codec](std::shared_ptr<TcpConnection> conn) {
+        conn->setMessageCallback([&codec](std::shared_ptr<TcpConnection> c, const std::vector<uint8_t>& data) {
+            c->send(codec.encode(data));
+        });
+    });
+    assert(server.start(0, address));
+    assert(!ShmTcpServer().start(0, "unix:/tmp/not_shm.sock"));
+
+    std::shared_ptr<TcpClient> client = createTcpClient("epoll", address);
+    assert(client->connect(address, 0));
+
+    // 一问一答
+    for (int i = 0; i < 20; ++i) {
+        std::vector<uint8_t> payload(64 + i, static_cast<uint8_t>(i));
+        assert(client->send(codec.encode(payload)));
+        std::vector<uint8_t> reply;
+        assert(client->receive(reply));
+        assert(reply == payload);
+    }
+
+    // 流水线：先发 200 帧再逐个收
+    const int pipelined = 200;
+    for (int i = 0; i < pipelined; ++i) {
+        assert(client->send(codec.encode(std::vector<uint8_t>(100, static_cast<uint8_t>(i)))));
+    }
+    for (int i = 0; i < pipelined; ++i) {
+        std::vector<uint8_t> reply;
+        assert(client->receive(reply));
+        assert(reply == std::vector<uint8_t>(100, static_cast<uint8_t>(i)));
+    }
+
+    // 比环大的帧：发送方等对端腾出空间分段写入，回复同理
+    std::vector<uint8_t> large(3 * 1024 * 1024);
+    for (size_t i = 0; i < large.size(); ++i) {
+        large[i] = static_cast<uint8_t>(i * 7);
+    }
+    std::vector<uint8_t> large_reply;
+    std::thread large_reader([&]() {
+        assert(client->receive(large_reply));
+    });
+    assert(client->send(codec.encode(large)));
+    large_reader.join();
+    assert(large_reply == large);
+    assert(server.getConnectionCount() == 1);
+
+    // 客户端断开后服务端经控制套接字感知并释放连接
+    client->disconnect();
+    for (int i = 0; i < 100 && server.getConnectionCount() > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assert(server.getConnectionCount() == 0);
+
+    server.stop();
+    struct stat st;
+    assert(stat(path.c_str(), &st) != 0);
+
+    g_stats.tests_passed++;
+    std::cout << "共享内存传输测试通过" << std::endl;
+}
+
+// 测试发送超时：对端不读、发送缓冲区满时 send 最多等到发送超时，失败返回并断开连接，不空转
+void testSendTimeout() {
+    std::cout << "\n=== 测试发送超时 ===" << std::endl;
+
+    // 只 listen 不 accept：连接在 backlog 里建立，但没有人读
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    assert(listen_fd >= 0);
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(8911);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    assert(bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    assert(listen(listen_fd, 1) == 0);
+
+    TcpClientImpl client;
+    assert(client.connect("127.0.0.1", 8911));
+    client.setSendTimeout(200);
+    std::vector<uint8_t> frame(64 * 1024 * 1024, 's');
+    auto start = std::chrono::steady_clock::now();
+    assert(!client.send(frame));
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    assert(elapsed >= 150 && elapsed < 2000);
+    assert(client.getState() == ConnectionState::DISCONNECTED);
+    std::cout << "✓ 对端不读时 send 在 " << elapsed << "ms 后超时失败" << std::endl;
+
+    client.disconnect();
+    close(listen_fd);
+
+    g_stats.tests_passed++;
+    std::cout << "发送超时测试通过" << std::endl;
+}
+
+// 测试多路复用连接：多个线程同时在一条连接上调用，服务端攒齐后倒序回复，每个调用拿到自己的响应；
+// 关闭连接时没有回复的在途调用以失败完成
+void testMultiplexedClientConnection() {
+    std::cout << "\n=== 测试多路复用客户端连接 ===" << std::endl;
+
+    const int num_calls = 32;
+    auto server = std::make_unique<TcpServerImpl>();
+    std::mutex requests_mutex;
+    std::vector<uint64_t> request_ids;
+    server->setConnectionCallback([&](std::shared_ptr<TcpConnection> conn) {
+        conn->setMessageCallback([&](std::shared_ptr<TcpConnection> conn, const std::vector<uint8_t>& data) {
+            FrameHeader header;
+            assert(header.decode(data.data(), data.size()));
+            std::vector<uint64_t> batch;
+            {
+                std::lock_guard<std::mutex> lock(requests_mutex);
+                request_ids.push_back(header.request_id);
+                if (request_ids.size() == num_calls) {
+                    batch.assign(request_ids.rbegin(), request_ids.rend());
+                }
+            }
+            FrameCodec codec;
+            for (uint64_t request_id : batch) {
+                RpcResponse response;
+                response.request_id = request_id;
+                response.success = true;
+                MethodDirectoryProto payload;
+                payload.set_service_name("reply-" + std::to_string(request_id));
+                Buffer out;
+                RpcProtocolHelper::serializeFramedResponse(response, &payload, 0, out);
+                codec.encode(out);
+                conn->send(std::move(out));
+            }
+        });
+    });
+    assert(server->start(8900, "127.0.0.1"));
+
+    std::shared_ptr<TcpClient> client = std::make_shared<TcpClientImpl>();
+    assert(client->connect("127.0.0.1", 8900));
+    auto connection = std::make_shared<ClientConnection>(client, "TestService");
+
+    auto makeFrame = [](uint64_t request_id) {
+        FrameHeader header;
+        header.request_id = request_id;
+        MethodDirectoryProto request;
+        request.set_service_name("request-" + std::to_string(request_id));
+        Buffer frame;
+        RpcProtocolHelper::serializeFramedRequest(header, request, frame);
+        FrameCodec().encode(frame);
+        return frame;
+    };
+
+    // 所有调用同时在途：服务端要等第 num_calls 个请求到了才回复
+    std::atomic<int> matched{0};
+    std::vector<std::thread> callers;
+    for (int i = 0; i < num_calls; ++i) {
+        callers.emplace_back([&]() {
+            uint64_t request_id = connection->nextRequestId();
+            MethodDirectoryProto reply;
+            RpcResponse response = connection->call(request_id, makeFrame(request_id), &reply, 5000);
+            if (response.success && response.request_id == request_id &&
+                reply.service_name() == "reply-" + std::to_string(request_id)) {
+                matched++;
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    assert(matched.load() == num_calls);
+    assert(connection->pendingCount() == 0);
+    std::cout << "✓ " << num_calls << " 个并发调用共用一条连接，倒序响应全部对上号" << std::endl;
+
+    // 服务端不再回复：异步调用过了截止时间由读线程的时间轮以超时失败完成，不用等下一轮扫描
+    std::promise<RpcResponse> expired;
+    uint64_t expired_id = connection->nextRequestId();
+    MethodDirectoryProto expired_reply;
+    auto expire_start = std::chrono::steady_clock::now();
+    connection->start(expired_id, makeFrame(expired_id), &expired_reply, 100,
+                      [&expired](RpcResponse& response, ClientConnection::ReplyFormat format) {
+        assert(format == ClientConnection::ReplyFormat::kNone);
+        expired.set_value(response);
+    });
+    std::future<RpcResponse> expired_future = expired.get_future();
+    assert(expired_future.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+    auto expire_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - expire_start).count();
+    assert(expire_elapsed >= 100 && expire_elapsed < 180);
+    RpcResponse expired_response = expired_future.get();
+    assert(!expired_response.success && expired_response.request_id == expired_id);
+    assert(connection->pendingCount() == 0 && connection->isOpen());
+    std::cout << "✓ 过期的异步调用以超时完成: " << expired_response.error_message << std::endl;
+
+    // 关闭连接时在途调用以失败完成
+    std::promise<RpcResponse> orphan;
+    uint64_t request_id = connection->nextRequestId();
+    MethodDirectoryProto reply;
+    connection->start(request_id, makeFrame(request_id), &reply, 5000,
+                      [&orphan](RpcResponse& response, ClientConnection::ReplyFormat format) {
+        assert(format == ClientConnection::ReplyFormat::kNone);
+        orphan.set_value(response);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(connection->pendingCount() == 1);
+    connection->close();
+    RpcResponse orphan_response = orphan.get_future().get();
+    assert(!orphan_response.success && orphan_response.request_id == request_id);
+    assert(!connection->isOpen());
+    std::cout << "✓ 关闭连接时在途调用以失败完成: " << orphan_response.error_message << std::endl;
+
+    server->stop();
+
+    g_stats.tests_passed++;
+    std::cout << "多路复用客户端连接测试通过" << std::endl;
+}
+
+// 测试握手途中连接断开：不能当成对端是旧版本而降级，lookupMethodId 抛异常，连接仍未就绪
+void testHandshakeConnectionLost() {
+    std::cout << "\n=== 测试握手途中连接断开 ===" << std::endl;
+
+    auto server = std::make_unique<TcpServerImpl>();
+    std::atomic<int> handshakes{0};
+    server->setConnectionCallback([&](std::shared_ptr<TcpConnection> conn) {
+        conn->setMessageCallback([&](std::shared_ptr<TcpConnection> conn, const std::vector<uint8_t>&) {
+            handshakes++;
+            conn->close();
+        });
+    });
+    assert(server->start(8909, "127.0.0.1"));
+
+    std::shared_ptr<TcpClient> client = std::make_shared<TcpClientImpl>();
+    assert(client->connect("127.0.0.1", 8909));
+    auto connection = std::make_shared<ClientConnection>(client, "TestService");
+
+    uint32_t method_id = 0;
+    bool threw = false;
+    try {
+        connection->lookupMethodId("Add", method_id);
+    } catch (const std::exception& e) {
+        threw = true;
+        std::cout << "✓ 握手失败: " << e.what() << std::endl;
+    }
+    assert(threw && handshakes.load() == 1);
+    assert(!connection->isDirectoryReady() && !connection->isOpen());
+    std::cout << "✓ 连接断开没有被当成旧版本服务端" << std::endl;
+
+    connection->close();
+    server->stop();
+
+    g_stats.tests_passed++;
+    std::cout << "握手途中连接断开测试通过" << std::endl;
+}
+
+// a 为负数时 SetFailed，否则返回 a + b
+class FailingCalculator : public CalculatorService {
+public:
+    void Add(google::protobuf::RpcController* controller, const AddRequest* request, AddResponse* response,
+             google::protobuf::Closure* done) override {
+        if (request->a() < 0) {
+            controller->SetFailed("negative operand");
+        } else {
+            response->set_result(request->a() + request->b());
+        }
+        done->Run();
+    }
+};
+
+void testCallMethodReportsServerFailure() {
+    std::cout << "\n=== 测试同步调用返回服务端失败 ===" << std::endl;
+
+    FailingCalculator service;
+    RpcServerConfig config;
+    config.host = "127.0.0.1";
+    config.port = 8906;
+    config.thread_pool_size = 1;
+    config.enable_registry = false;
+    RpcServer server(config);
+    server.registerService(&service);
+    assert(server.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    RpcClientStubImpl stub("CalculatorService", "127.0.0.1", 8906);
+    AddRequest request;
+    request.set_a(1);
+    request.set_b(2);
+    AddResponse response;
+    assert(stub.callMethod("Add", request, response) && response.result() == 3);
+
+    // SetFailed 的调用同步、异步都报告失败
+    request.set_a(-1);
+    assert(!stub.callMethod("Add", request, response));
+    std::future<bool> failed = stub.asyncCallMethod("Add", request, &response);
+    assert(!failed.get());
+    std::cout << "✓ 服务端 SetFailed 时 callMethod 与 asyncCallMethod 都返回失败" << std::endl;
+
+    stub.disconnect();
+    server.stop();
+
+    g_stats.tests_passed++;
+    std::cout << "同步调用失败测试通过" << std::endl;
+}
+
+// a 不小于 100 时在另一个线程里等 a 毫秒再运行 done，否则立即返回 a + b
+class SlowCalculator : public CalculatorService {
+public:
+    ~SlowCalculator() {
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    void Add(google::protobuf::RpcController*, const AddRequest* request, AddResponse* response,
+             google::protobuf::Closure* done) override {
+        int32_t a = request->a();
+        int32_t b = request->b();
+        if (a < 100) {
+            response->set_result(a + b);
+            done->Run();
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        workers_.emplace_back([response, done, a, b]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(a));
+            response->set_result(a + b);
+            done->Run();
+        });
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::thread> workers_;
+};
+
+// 以旧格式发出一次 Add 调用
+bool sendLegacyAdd(TcpClientImpl& client, uint64_t request_id, int32_t a, int32_t b) {
+    AddRequest add;
+    add.set_a(a);
+    add.set_b(b);
+    std::string data = add.SerializeAsString();
+    RpcRequest request;
+    request.request_id = request_id;
+    request.service_name = "CalculatorService";
+    request.method_name = "Add";
+    request.request_data.assign(data.begin(), data.end());
+    FrameCodec codec;
+    return client.send(codec.encode(RpcProtocolHelper::serializeRequest(request)));
+}
+
+void testRequestTimeout() {
+    std::cout << "\n=== 测试服务端请求超时 ===" << std::endl;
+
+    SlowCalculator service;
+    RpcServerConfig config;
+    config.host = "127.0.0.1";
+    config.port = 8908;
+    config.thread_pool_size = 1;
+    config.enable_registry = false;
+    config.request_timeout_ms = 100;
+    RpcServer server(config);
+    server.registerService(&service);
+    assert(server.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    TcpClientImpl client;
+    assert(client.connect("127.0.0.1", 8908));
+    client.setReceiveTimeout(2000);
+
+    // 执行 300ms 的调用在 100ms 时收到超时错误
+    assert(sendLegacyAdd(client, 1, 300, 1));
+    std::vector<uint8_t> frame;
+    assert(client.receive(frame));
+    RpcResponse timed_out = RpcProtocolHelper::parseResponse(frame);
+    assert(timed_out.request_id == 1 && !timed_out.success);
+    assert(timed_out.error_message.find("timeout") != std::string::npos);
+    std::cout << "✓ 超过 request_timeout_ms 的调用收到超时错误: " << timed_out.error_message << std::endl;
+
+    // 迟到的 done 不再回复
+    client.setReceiveTimeout(500);
+    assert(!client.receive(frame));
+    std::cout << "✓ 超时后才运行的 done 没有发出响应" << std::endl;
+
+    // 按时完成的调用回复后取消定时器，不在时间轮上留到超时
+    client.setReceiveTimeout(2000);
+    for (uint64_t id = 2; id < 12; ++id) {
+        assert(sendLegacyAdd(client, id, 1, 2));
+        assert(client.receive(frame));
+        RpcResponse ok = RpcProtocolHelper::parseResponse(frame);
+        AddResponse result;
+        assert(ok.request_id == id && ok.success);
+        assert(result.ParseFromArray(ok.response_data.data(), static_cast<int>(ok.response_data.size())));
+        assert(result.result() == 3);
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+    while (server.getPendingRequestTimers() > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(server.getPendingRequestTimers() == 0);
+    std::cout << "✓ 按时回复的调用没有留下超时定时器" << std::endl;
+
+    client.disconnect();
+    server.stop();
+
+    g_stats.tests_passed++;
+    std::cout << "请求超时测试通过" << std::endl;
+}
+
+// 固定实例列表的注册中心，记下被查询的次数
+class StaticRegistry : public ServiceRegistry {
+public:
+    explicit StaticRegistry(std::vector<ServiceInstance> instances, std::atomic<int>& discoveries)
+        : instances_(std::move(instances)), discoveries_(discoveries) {}
+
+    bool registerService(const ServiceInstance&) override { return true; }
+    bool unregisterService(const std::string&, const std::string&) override { return true; }
+    std::vector<ServiceInstance> discoverService(const std::string&) override {
+        discoveries_++;
+        return instances_;
+    }
+    bool subsribeService(const std::string&, ServiceInstanceCallback) override { return true; }
+    bool unsubsribeService(const std::string&) override { return true; }
+    bool sendHeartbeat(const std::string&, const std::string&) override { return true; }
+    std::vector<std::string> getAllService() override { return {"CalculatorService"}; }
+
+private:
+    std::vector<ServiceInstance> instances_;
+    std::atomic<int>& discoveries_;
+};
+
+// 测试服务发现模式下不阻塞地发起调用：发现过实例、连接池里有握手过的连接时直接发出，不再查注册中心
+void testNonBlockingDiscoveryCall() {
+    std::cout << "\n=== 测试服务发现模式下不阻塞地发起调用 ===" << std::endl;
+
+    SlowCalculator service;
+    RpcServerConfig config;
+    config.host = "127.0.0.1";
+    config.port = 8910;
+    config.thread_pool_size = 1;
+    config.enable_registry = false;
+    RpcServer server(config);
+    server.registerService(&service);
+    assert(server.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::atomic<int> discoveries{0};
+    std::vector<ServiceInstance> instances{ServiceInstance("CalculatorService", "127.0.0.1", 8910)};
+    RpcClientStubImpl stub("CalculatorService", std::make_unique<StaticRegistry>(instances, discoveries));
+    stub.setPreferUnixSocket(false);
+
+    AddRequest request;
+    request.set_a(1);
+    request.set_b(2);
+    AddResponse response;
+    bool called = false;
+    auto mark_called = [&called](bool, const std::string&) { called = true; };
+    assert(!stub.tryAsyncCallMethod("Add", request, &response, mark_called));
+    assert(!called && discoveries.load() == 0);
+    std::cout << "✓ 还没发现过实例时不发出" << std::endl;
+
+    // 阻塞的调用查注册中心、建连、握手，之后同一实例的调用直接用连接池里的连接
+    assert(stub.callMethod("Add", request, response) && response.result() == 3);
+    assert(discoveries.load() == 1);
+    request.set_a(2);
+    request.set_b(3);
+    std::promise<bool> done;
+    assert(stub.tryAsyncCallMethod("Add", request, &response, [&done](bool success, const std::string&) {
+        done.set_value(success);
+    }));
+    std::future<bool> done_future = done.get_future();
+    assert(done_future.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+    assert(done_future.get() && response.result() == 5);
+    assert(stub.asyncCallMethod("Add", request, &response).get() && response.result() == 5);
+    assert(discoveries.load() == 1);
+    std::cout << "✓ 发现过实例、连接已握手后不查注册中心直接发出" << std::endl;
+
+    // 发现结果过期（1 秒）后交回给阻塞的调用重新查注册中心
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    assert(!stub.tryAsyncCallMethod("Add", request, &response, mark_called));
+    assert(!called && discoveries.load() == 1);
+    assert(stub.asyncCallMethod("Add", request, &response).get() && discoveries.load() == 2);
+    std::cout << "✓ 发现结果过期后不发出，由异步调用重新查注册中心" << std::endl;
+
+    stub.disconnect();
+    ClientConnectionPool::instance().clear();
+    server.stop();
+
+    g_stats.tests_passed++;
+    std::cout << "服务发现模式不阻塞调用测试通过" << std::endl;
+}
+
+void testAsyncRetryAfterConnectionLost() {
+    std::cout << "\n=== 测试连接断开后在回调里重试 ===" << std::endl;
+
+    // 只收不回的服务端：调用一直在途，直到服务端停止
+    auto server = std::make_unique<TcpServerImpl>();
+    server->setConnectionCallback([](std::shared_ptr<TcpConnection> conn) {
+        conn->setMessageCallback([](std::shared_ptr<TcpConnection>, const std::vector<uint8_t>&) {});
+    });
+    assert(server->start(8905, "127.0.0.1"));
+
+    RpcClientStubImpl stub("TestService", "127.0.0.1", 8905);
+    stub.setFrameHeader(false);
+    MethodDirectoryProto request;
+    MethodDirectoryProto first_reply;
+    MethodDirectoryProto retry_reply;
+    std::promise<std::string> first_error;
+    std::promise<bool> retried;
+    // 回调在读线程里执行：重试会换下已断开的连接，放开它的最后一个外部引用
+    stub.asyncCallMethod("Lookup", request, &first_reply, [&](bool success, const std::string& error_message) {
+        first_error.set_value(success ? "" : error_message);
+        stub.asyncCallMethod("Lookup", request, &retry_reply, [&retried](bool retry_success, const std::string&) {
+            retried.set_value(retry_success);
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    server->stop();
+
+    std::future<std::string> first_future = first_error.get_future();
+    assert(first_future.wait_for(std::chrono::seconds(3)) == std::future_status::ready);
+    assert(!first_future.get().empty());
+    std::future<bool> retried_future = retried.get_future();
+    assert(retried_future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+    assert(!retried_future.get());
+    stub.disconnect();
+    std::cout << "✓ 在读线程的回调里重试、换下自身所在的连接不会 join 自己" << std::endl;
+
+    g_stats.tests_passed++;
+    std::cout << "回调重试测试通过" << std::endl;
+}
+
+void testClientConnectionPool() {
+    std::cout << "\n=== 测试客户端连接池 ===" << std::endl;
+
+    // 两个实例，都只收不回：在途调用一直挂着，用来让连接"忙"
+    std::vector<std::unique_ptr<TcpServerImpl>> servers;
+    for (uint16_t port : {8901, 8902}) {
+        auto server = std::make_unique<TcpServerImpl>();
+        server->setConnectionCallback([](std::shared_ptr<TcpConnection> conn) {
+            conn->setMessageCallback([](std::shared_ptr<TcpConnection>, const std::vector<uint8_t>&) {});
+        });
+        assert(server->start(port, "127.0.0.1"));
+        servers.push_back(std::move(server));
+    }
+
+    ConnectionPoolConfig config;
+    config.min_connections = 1;
+    config.max_connections = 2;
+    config.max_pending_per_connection = 1;
+    config.idle_timeout_ms = 200;
+    config.unhealthy_backoff_ms = 300;
+    ClientConnectionPool pool(config);
+
+    std::atomic<int> connects{0};
+    auto connector = [&connects](uint16_t port) {
+        return [&connects, port]() -> std::shared_ptr<ClientConnection> {
+            connects++;
+            std::shared_ptr<TcpClient> client = std::make_shared<TcpClientImpl>();
+            if (!client->connect("127.0.0.1", port)) {
+                return nullptr;
+            }
+            return std::make_shared<ClientConnection>(client, "TestService");
+        };
+    };
+    std::string key_a = ClientConnectionPool::makeKey("TestService", "127.0.0.1:8901", "epoll");
+    std::string key_b = ClientConnectionPool::makeKey("TestService", "127.0.0.1:8902", "epoll");
+    std::string key_dead = ClientConnectionPool::makeKey("TestService", "127.0.0.1:8903", "epoll");
+
+    // 轮询两个实例：每个实例只建一次连接，之后一直复用
+    std::shared_ptr<ClientConnection> first_a;
+    for (int i = 0; i < 20; ++i) {
+        bool use_a = i % 2 == 0;
+        std::shared_ptr<ClientConnection> connection = pool.acquire(use_a ? key_a : key_b, connector(use_a ? 8901 : 8902));
+        assert(connection && connection->isOpen());
+        if (use_a) {
+            assert(!first_a || connection == first_a);
+            first_a = connection;
+        }
+    }
+    assert(connects.load() == 2 && pool.totalConnects() == 2);
+    std::cout << "✓ 在两个实例间轮换 20 次只建了 2 条连接" << std::endl;
+
+    // 连接忙（在途调用达到上限）时再建一条分担，到上限后不再新建
+    FrameHeader header;
+    header.request_id = first_a->nextRequestId();
+    MethodDirectoryProto request;
+    Buffer frame;
+    RpcProtocolHelper::serializeFramedRequest(header, request, frame);
+    FrameCodec().encode(frame);
+    MethodDirectoryProto reply;
+    std::promise<RpcResponse> expired;
+    first_a->start(header.request_id, frame, &reply, 100, [&expired](RpcResponse& response, ClientConnection::ReplyFormat) {
+        expired.set_value(response);
+    });
+    assert(!pool.tryAcquire(key_a)); // 要再建一条，不建连的取用取不到
+    std::shared_ptr<ClientConnection> second_a = pool.acquire(key_a, connector(8901));
+    assert(second_a && second_a != first_a);
+    assert(pool.connectionCount(key_a) == 2 && connects.load() == 3);
+    assert(pool.acquire(key_a, connector(8901)) == second_a);
+    assert(pool.tryAcquire(key_a) == second_a && connects.load() == 3);
+    std::cout << "✓ 连接忙时扩到第 2 条，空闲的那条优先被取用" << std::endl;
+
+    // 空闲超时后回收到 min_connections 条
+    assert(!expired.get_future().get().success);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    assert(pool.reapIdle() == 1);
+    assert(pool.connectionCount(key_a) == 1 && pool.connectionCount(key_b) == 1);
+    std::cout << "✓ 空闲连接回收到每个端点 1 条" << std::endl;
+
+    // 已断开的连接在取用时换掉
+    std::shared_ptr<ClientConnection> survivor = pool.acquire(key_a, connector(8901));
+    survivor->close();
+    std::shared_ptr<ClientConnection> replacement = pool.acquire(key_a, connector(8901));
+    assert(replacement && replacement != survivor && replacement->isOpen());
+    assert(pool.connectionCount(key_a) == 1);
+    std::cout << "✓ 断开的连接被移出并重新建连" << std::endl;
+
+    // 建连失败：端点标为不健康，退避期内不再尝试，过后恢复可用
+    int before = connects.load();
+    assert(!pool.acquire(key_dead, connector(8903)));
+    assert(!pool.isHealthy(key_dead));
+    assert(!pool.acquire(key_dead, connector(8903)));
+    assert(!pool.tryAcquire(key_dead));
+    assert(connects.load() == before + 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(350));
+    assert(pool.isHealthy(key_dead));
+    std::cout << "✓ 建连失败的端点在退避期内被跳过" << std::endl;
+
+    // 完成回调在读线程里从连接池重新取连接：换下已断开的这条连接时不会 join 读线程自己
+    FrameHeader lost_header;
+    lost_header.request_id = replacement->nextRequestId();
+    Buffer lost_frame;
+    RpcProtocolHelper::serializeFramedRequest(lost_header, request, lost_frame);
+    FrameCodec().encode(lost_frame);
+    std::promise<bool> reacquired;
+    replacement->start(lost_header.request_id, lost_frame, &reply, 5000, [&](RpcResponse& response, ClientConnection::ReplyFormat) {
+        pool.acquire(key_a, connector(8901));
+        reacquired.set_value(response.success);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    servers[0]->stop();
+    std::future<bool> reacquired_future = reacquired.get_future();
+    assert(reacquired_future.wait_for(std::chrono::seconds(3)) == std::future_status::ready);
+    assert(!reacquired_future.get() && !replacement->isOpen());
+    std::cout << "✓ 在断开连接的完成回调里重新取连接" << std::endl;
+
+    pool.clear();
+    assert(pool.connectionCount(key_a) == 0 && !replacement->isOpen());
+    for (auto& server : servers) {
+        server->stop();
+    }
+
+    g_stats.tests_passed++;
+    std::cout << "客户端连接池测试通过" << std::endl;
+}
+
 int main(){
     try {
         // 运行测试
         testTcpServerBasic();
         testServerClientConnection();
         testConcurrentConnections();
+        testMultiReactor();
+        testReusePortListeners();
+        testBufferedWriteWithWatermarks();
+        testConcurrentSendsFromWorkers();
+        testReadBudgetDrainsPipelinedFrames();
+        testFrameBudgetWithinOneRead();
+        testSlotMapGenerationHandles();
+        testTimerWheel();
+        testIdleConnectionTimeout();
+        testIoUringBackend();
+        testUnixDomainSocket();
+        testSharedMemoryTransport();
+        testSendTimeout();
+        testMultiplexedClientConnection();
+        testHandshakeConnectionLost();
+        testCallMethodReportsServerFailure();
+        testRequestTimeout();
+        testNonBlockingDiscoveryCall();
+        testAsyncRetryAfterConnectionLost();
+        testClientConnectionPool();
 
         std::cout << "\n==========================================" << std::endl;
         std::cout << "           测试结果统计" << std::endl;